@@ -27,6 +27,7 @@
 #include "StudioModelRenderer.h"
 #include "GameStudioModelRenderer.h"
 #include "svd_render.h"
+#include "r_profile.h"
 
 //
 // Override the StudioModelRender virtual member functions here to implement custom bone
@@ -52,6 +53,9 @@ CGameStudioModelRenderer::CGameStudioModelRenderer( void )
 // Hooks to class implementation
 ////////////////////////////////////
 
+// The studio timer goes on the engine's calls rather than the draw functions,
+// a dead player's body is a model drawn through StudioDrawPlayer
+
 /*
 ====================
 R_StudioDrawPlayer
@@ -60,6 +64,8 @@ R_StudioDrawPlayer
 */
 int R_StudioDrawPlayer( int flags, entity_state_t *pplayer )
 {
+	R_PROFILE_SCOPE( PROF_STUDIO );
+
 	return g_StudioRenderer.StudioDrawPlayer( flags, pplayer );
 }
 
@@ -75,6 +81,8 @@ R_StudioDrawModel
 */
 int R_StudioDrawModel( int flags )
 {
+   R_PROFILE_SCOPE( PROF_STUDIO );
+
    return g_StudioRenderer.StudioDrawModel( flags );
 }
 
@@ -89,6 +97,17 @@ void R_StudioInit( void )
 	g_StudioRenderer.Init();
 }
 
+/*
+====================
+R_StudioVidInit
+
+====================
+*/
+void R_StudioVidInit( void )
+{
+	g_StudioRenderer.VidInit();
+}
+
 // The simple drawing interface we'll pass back to the engine
 r_studio_interface_t studio =
 {
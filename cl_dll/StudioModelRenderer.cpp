@@ -42,6 +42,7 @@
 #include "pm_defs.h"
 #include "elightlist.h"
 #include "fog.h"
+#include "r_profile.h"
 
 void NormalizeAngles(float* angles);
 #define GL_DEPTH_CLAMP 0x864F
@@ -82,6 +83,7 @@ void CStudioModelRenderer::Init( void )
 
 	m_pCvarDrawShadows		= CVAR_CREATE( "gl_shadows", "2", FCVAR_ARCHIVE );
 	m_pCvarShadowVolumeExtrudeDistance = CVAR_CREATE("gl_shadow_extrude_distance", "2048", FCVAR_ARCHIVE);
+	m_pCvarLightCache		= CVAR_CREATE( "r_studio_lightcache", "1", FCVAR_ARCHIVE );
 
 	m_pChromeSprite			= IEngineStudio.GetChromeSprite();
 
@@ -94,6 +96,33 @@ void CStudioModelRenderer::Init( void )
 	m_protationmatrix		= (float (*)[3][4])IEngineStudio.StudioGetRotationMatrix();
 }
 
+/*
+====================
+VidInit
+
+====================
+*/
+void CStudioModelRenderer::VidInit( void )
+{
+	// Entity indexes mean something else on the new level
+	for (int i = 0; i < MAX_LIGHTCACHE_ENTITIES; i++)
+	{
+		m_lightCache[i].recorded = false;
+		m_lightCache[i].pmodel = NULL;
+		m_lightCache[i].lights.clear();
+		m_lightCache[i].colors.clear();
+	}
+
+	m_pLightCache = NULL;
+	m_bLightCacheValid = false;
+
+	// Model data is reloaded on level change
+	m_glowShellNormals.clear();
+	m_pGlowShellNormals = NULL;
+	m_meshTexCoords.clear();
+	m_pMeshTexCoords = NULL;
+}
+
 /*
 ====================
 CStudioModelRenderer
@@ -122,6 +151,19 @@ CStudioModelRenderer::CStudioModelRenderer( void )
 	m_pRenderModel		= NULL;
 	m_pCvarShadowVolumeExtrudeDistance = NULL;
 	m_shadowLightType = SL_TYPE_LIGHTVECTOR;
+	m_pCvarLightCache	= NULL;
+	m_pLightCache		= NULL;
+	m_bLightCacheValid	= false;
+	m_iLightCacheColor	= 0;
+	m_pGlowShellNormals	= NULL;
+	m_pMeshTexCoords	= NULL;
+	m_bFogFarBand		= false;
+
+	for (int i = 0; i < MAX_LIGHTCACHE_ENTITIES; i++)
+	{
+		m_lightCache[i].recorded = false;
+		m_lightCache[i].pmodel = NULL;
+	}
 
 	memset(m_pEntityLights, 0, sizeof(m_pEntityLights));
 
@@ -944,6 +986,8 @@ StudioSetupBones
 */
 void CStudioModelRenderer::StudioSetupBones ( void )
 {
+	R_PROFILE_SCOPE( PROF_BONES );
+
 	int					i;
 	double				f;
 
@@ -1373,9 +1417,12 @@ int CStudioModelRenderer::StudioDrawModel( int flags )
 		if (!IEngineStudio.StudioCheckBBox ())
 			return 0;
 
-		if (gFog.CullFogBBox(m_vMins, m_vMaxs))
+		int fogLevel = gFog.GetFogLevel(m_vMins, m_vMaxs);
+		if (fogLevel == FOG_CULLED)
 			return 0;
 
+		m_bFogFarBand = (fogLevel == FOG_FARBAND);
+
 		(*m_pModelsDrawn)++;
 		(*m_pStudioModelCount)++; // render data cache cookie
 
@@ -1812,9 +1859,12 @@ int CStudioModelRenderer::StudioDrawPlayer( int flags, entity_state_t *pplayer )
 		if (!IEngineStudio.StudioCheckBBox ())
 			return 0;
 
-		if (gFog.CullFogBBox(m_vMins, m_vMaxs))
+		int fogLevel = gFog.GetFogLevel(m_vMins, m_vMaxs);
+		if (fogLevel == FOG_CULLED)
 			return 0;
 
+		m_bFogFarBand = (fogLevel == FOG_FARBAND);
+
 		(*m_pModelsDrawn)++;
 		(*m_pStudioModelCount)++; // render data cache cookie
 
@@ -17,6 +17,10 @@
 #include "elight.h"
 #include "svdformat.h"
 #include "r_studioint.h"
+#include "r_studioqueue.h"
+
+#include <vector>
+#include <map>
 
 enum shadow_lightype_t
 {
@@ -24,6 +28,68 @@ enum shadow_lightype_t
 	SL_TYPE_POINTLIGHT
 };
 
+#define MAX_LIGHTCACHE_ENTITIES	1024
+
+// Final vertex colors of an entity, kept while it doesn't move
+struct studiolightcache_t
+{
+	// Colors were stored for the state below
+	bool			recorded;
+
+	model_t*		pmodel;
+	int				body;
+	int				skin;
+	int				effects;
+	int				rendermode;
+	int				weaponmodel;
+	bool			queued;
+
+	unsigned int	bonehash;
+	vec3_t			origin;
+
+	// Cvars that affect model lighting
+	float			lightparams[8];
+
+	// Result of GetModelLighting
+	float			ambientlight;
+	float			shadelight;
+	vec3_t			color;
+	vec3_t			lightdir;
+
+	// Entity lights the colors were calculated with
+	std::vector<elight_t>	lights;
+	vec3_t			viewdir;
+
+	std::vector<Vector>		colors;
+};
+
+// Smoothed vertex normals of a submodel, used to inflate glow shells
+struct glowshellnormals_t
+{
+	// Model data the normals were built from
+	studiohdr_t*	pheader;
+	int				length;
+
+	std::vector<Vector>		normals;
+};
+
+// Normalized texcoords of a submodel's meshes, in tricmd order
+struct studiotexcoords_t
+{
+	// Model data the texcoords were built from
+	studiohdr_t*	pheader;
+	studiohdr_t*	ptextureheader;
+	int				length;
+
+	// Texture size each mesh was normalized with
+	std::vector<short>		widths;
+	std::vector<short>		heights;
+
+	// First texcoord of each mesh
+	std::vector<int>		firstcoords;
+	std::vector<float>		coords;
+};
+
 extern engine_studio_api_t IEngineStudio;
 
 /*
@@ -42,6 +108,9 @@ public:
 	// Initialization
 	virtual void Init( void );
 
+	// Level change
+	virtual void VidInit( void );
+
 public:  
 	// Public Interfaces
 	virtual int StudioDrawModel ( int flags);
@@ -128,15 +197,30 @@ public:
 	// Draws meshes for a model
 	virtual void StudioDrawPoints( void );
 
+	// Builds normalized texcoords for the current submodel, or finds them if already built
+	virtual void StudioSetupMeshTexCoords( void );
+
+	// Returns the normalized texcoords of a mesh, NULL if they don't match this texture
+	const float* StudioGetMeshTexCoords( mstudiomesh_t* pmesh, mstudiotexture_t* ptexture );
+
 	// Draw a single mesh
 	virtual void StudioDrawMesh( mstudiomesh_t* pmesh, mstudiotexture_t* ptexture, float alpha );
 
+	// Tells if meshes of the current entity can go into the deferred render queue
+	virtual bool StudioShouldQueueMeshes( void );
+
+	// Submit a single mesh to the deferred render queue
+	virtual void StudioQueueMesh( mstudiomesh_t* pmesh, mstudiotexture_t* ptexture, float alpha, studioqueue_pass_t pass );
+
 	// Gets lighting information for model
 	virtual void StudioDynamicLight( void );
 
 	// Gets entity lights for a model
 	virtual void StudioEntityLight( void );
 
+	// Restores lighting from the cache if the entity didn't change since the last frame
+	virtual bool StudioCheckLightCache( void );
+
 	// Sets the ambient light vectors
 	virtual void StudioSetLightVectors( void );
 
@@ -307,6 +391,9 @@ public:
 	vec3_t			m_vMins;
 	vec3_t			m_vMaxs;
 
+	// Entity is deep in the fog, skip elights
+	bool			m_bFogFarBand;
+
 	// Array of lights
 	elight_t*		m_pEntityLights[MAX_MODEL_ENTITY_LIGHTS];
 	unsigned int	m_iNumEntityLights;
@@ -329,16 +416,32 @@ public:
 	vec3_t			m_chromeUp[MAXSTUDIOBONES];
 	vec3_t			m_chromeRight[MAXSTUDIOBONES];
 
-	// Gathered normal vectors for vertexes
-	vec3_t			m_vertexNormals[MAXSTUDIOVERTS];
-	// Number of normals gathered for each vertex
-	int				m_vertexNumNormals[MAXSTUDIOVERTS];
+	// Smoothed normals for each submodel drawn with a glow shell
+	std::map<const mstudiomodel_t*, glowshellnormals_t> m_glowShellNormals;
+	// Normals of the current submodel
+	const Vector*	m_pGlowShellNormals;
+
+	// Normalized texcoords for each submodel drawn
+	std::map<const mstudiomodel_t*, studiotexcoords_t> m_meshTexCoords;
+	// Texcoords of the current submodel
+	const studiotexcoords_t* m_pMeshTexCoords;
 	// Chrome origin
 	Vector			m_chromeOrigin;
 
 	// Basic lighting info
 	alight_t		m_lightingInfo;
 
+	// Cached lighting for entities that don't move
+	studiolightcache_t	m_lightCache[MAX_LIGHTCACHE_ENTITIES];
+	// Cache entry of the current entity, NULL if it isn't cached
+	studiolightcache_t*	m_pLightCache;
+	// Current entity is drawn with the cached colors
+	bool			m_bLightCacheValid;
+	// Next cached color to use
+	unsigned int	m_iLightCacheColor;
+
+	cvar_t*			m_pCvarLightCache;
+
 	// Closest entity light
 	int				m_iClosestLight;
 
@@ -20,6 +20,7 @@
 
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include <string.h>
 #include <stdio.h>
 #include "parsemsg.h"
@@ -77,8 +78,8 @@ int CHudAmmoSecondary :: Draw(float flTime)
 		x -= (gHUD.GetSpriteRect(m_HUD_ammoicon).right - gHUD.GetSpriteRect(m_HUD_ammoicon).left);
 		y -= (gHUD.GetSpriteRect(m_HUD_ammoicon).top - gHUD.GetSpriteRect(m_HUD_ammoicon).bottom);
 
-		SPR_Set( gHUD.GetSprite(m_HUD_ammoicon), r, g, b );
-		SPR_DrawAdditive( 0, x, y, &gHUD.GetSpriteRect(m_HUD_ammoicon) );
+		g_HudSpriteBatch.Set( gHUD.GetSprite(m_HUD_ammoicon), r, g, b );
+		g_HudSpriteBatch.DrawAdditive( 0, x, y, &gHUD.GetSpriteRect(m_HUD_ammoicon) );
 	}
 	else
 	{  // move the cursor by the '0' char instead, since we don't have an icon to work with
@@ -19,6 +19,7 @@
 
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include "parsemsg.h"
 
 #include <string.h>
@@ -133,8 +134,8 @@ int HistoryResource :: DrawAmmoHistory( float flTime )
 				int xpos = ScreenWidth - 24;
 				if ( spr && *spr )    // weapon isn't loaded yet so just don't draw the pic
 				{ // the dll has to make sure it has sent info the weapons you need
-					SPR_Set( *spr, r, g, b );
-					SPR_DrawAdditive( 0, xpos, ypos, &rcPic );
+					g_HudSpriteBatch.Set( *spr, r, g, b );
+					g_HudSpriteBatch.DrawAdditive( 0, xpos, ypos, &rcPic );
 				}
 
 				// Draw the number
@@ -158,8 +159,8 @@ int HistoryResource :: DrawAmmoHistory( float flTime )
 
 				int ypos = ScreenHeight - (AMMO_PICKUP_PICK_HEIGHT + (AMMO_PICKUP_GAP * i));
 				int xpos = ScreenWidth - (weap->rcInactive.right - weap->rcInactive.left);
-				SPR_Set( weap->hInactive, r, g, b );
-				SPR_DrawAdditive( 0, xpos, ypos, &weap->rcInactive );
+				g_HudSpriteBatch.Set( weap->hInactive, r, g, b );
+				g_HudSpriteBatch.DrawAdditive( 0, xpos, ypos, &weap->rcInactive );
 			}
 			else if ( rgAmmoHistory[i].type == HISTSLOT_ITEM )
 			{
@@ -177,8 +178,8 @@ int HistoryResource :: DrawAmmoHistory( float flTime )
 				int ypos = ScreenHeight - (AMMO_PICKUP_PICK_HEIGHT + (AMMO_PICKUP_GAP * i));
 				int xpos = ScreenWidth - (rect.right - rect.left) - 10;
 
-				SPR_Set( gHUD.GetSprite( rgAmmoHistory[i].iId ), r, g, b );
-				SPR_DrawAdditive( 0, xpos, ypos, &rect );
+				g_HudSpriteBatch.Set( gHUD.GetSprite( rgAmmoHistory[i].iId ), r, g, b );
+				g_HudSpriteBatch.DrawAdditive( 0, xpos, ypos, &rect );
 			}
 		}
 	}
@@ -20,6 +20,7 @@
 
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include "parsemsg.h"
 
 #include <string.h>
@@ -143,13 +144,13 @@ int CHudBattery::Draw(float flTime)
 	if ( !m_SpriteHandle_t2 )
 		m_SpriteHandle_t2 = gHUD.GetSprite( gHUD.GetSpriteIndex( "suit_full" ) );
 
-	SPR_Set(m_SpriteHandle_t1, r, g, b );
-	SPR_DrawAdditive( 0,  x, y - iOffset, m_prc1);
+	g_HudSpriteBatch.Set(m_SpriteHandle_t1, r, g, b );
+	g_HudSpriteBatch.DrawAdditive( 0,  x, y - iOffset, m_prc1);
 
 	if (rc.bottom > rc.top)
 	{
-		SPR_Set(m_SpriteHandle_t2, r, g, b );
-		SPR_DrawAdditive( 0, x, y - iOffset + (rc.top - m_prc2->top), &rc);
+		g_HudSpriteBatch.Set(m_SpriteHandle_t2, r, g, b );
+		g_HudSpriteBatch.DrawAdditive( 0, x, y - iOffset + (rc.top - m_prc2->top), &rc);
 	}
 
 	x += (m_prc1->right - m_prc1->left);
@@ -17,6 +17,7 @@
 //
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include "parsemsg.h"
 
 #include <string.h>
@@ -137,8 +138,8 @@ int CHudDeathNotice :: Draw( float flTime )
 			}
 
 			// Draw death weapon
-			SPR_Set( gHUD.GetSprite(id), r, g, b );
-			SPR_DrawAdditive( 0, x, y, &gHUD.GetSpriteRect(id) );
+			g_HudSpriteBatch.Set( gHUD.GetSprite(id), r, g, b );
+			g_HudSpriteBatch.DrawAdditive( 0, x, y, &gHUD.GetSpriteRect(id) );
 
 			x += (gHUD.GetSpriteRect(id).right - gHUD.GetSpriteRect(id).left);
 
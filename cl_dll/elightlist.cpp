@@ -18,7 +18,8 @@
 // implementation of CHudAmmo class
 //
 
-#include <Windows.h>
+#include <windows.h>
+#include <algorithm>
 
 #include "hud.h"
 #include "cl_util.h"
@@ -39,6 +40,7 @@
 #include "elightlist.h"
 #include "com_model.h"
 #include "r_studioint.h"
+#include "r_profile.h"
 
 // Class declaration
 CELightList gELightList;
@@ -80,6 +82,8 @@ void CELightList::Init( void )
 	glActiveTexture = (PFNGLACTIVETEXTUREPROC)wglGetProcAddress("glActiveTexture");
 
 	m_pCvarDebugELights = CVAR_CREATE( "r_debug_elights", "0", FCVAR_CLIENTDLL );
+	m_pCvarMaxELights = CVAR_CREATE( "r_elights_max", "128", FCVAR_ARCHIVE );
+	m_pCvarELightCull = CVAR_CREATE( "r_elights_cull", "0.02", FCVAR_ARCHIVE );
 }
 
 /*
@@ -96,6 +100,8 @@ void CELightList::VidInit( void )
 	memset(m_pTempEntityLights, 0, sizeof(m_pTempEntityLights));
 	m_iNumTempEntityLights = NULL;
 
+	m_iNumFrameLights = 0;
+
 	// Get pointer to first elight
 	m_pGoldSrcELights = gEngfuncs.pEfxAPI->CL_AllocElight(0);
 	m_pGoldSrcDLights = gEngfuncs.pEfxAPI->CL_AllocDlight(0);
@@ -176,42 +182,58 @@ void CELightList::RemoveEntityLight( int entindex )
 
 /*
 ====================
-GetLightList
+AddLight
 
 ====================
 */
-void CELightList::GetLightList( vec3_t& origin, const vec3_t& mins, const vec3_t& maxs, elight_t** lightArray, unsigned int* numLights )
+void CELightList::AddLight( int key, int flags, const vec3_t& origin, int r, int g, int b, float radius, float life, float decay )
 {
-	// Set this to zero
-	*numLights = NULL;
+	dlight_t* plights[2] = { NULL, NULL };
 
-	gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
+	if(flags & LIGHT_DLIGHT)
+		plights[0] = gEngfuncs.pEfxAPI->CL_AllocDlight(key);
 
-	for(int i = 0; i < m_iNumEntityLights; i++)
-	{
-		if((*numLights) == MAX_MODEL_ENTITY_LIGHTS)
-			return;
+	if(flags & LIGHT_ELIGHT)
+		plights[1] = gEngfuncs.pEfxAPI->CL_AllocElight(key);
 
-		elight_t* plight = &m_pEntityLights[i];
-
-		if(CheckBBox(plight, mins, maxs))
-			continue;
+	float die = gEngfuncs.GetClientTime() + life;
 
-		static pmtrace_t traceResult;
-		gEngfuncs.pEventAPI->EV_PlayerTrace( (float *)origin, (float *)plight->origin, PM_WORLD_ONLY, -1, &traceResult );
-		if(traceResult.fraction != 1.0 || traceResult.allsolid || traceResult.startsolid)
+	for(int i = 0; i < 2; i++)
+	{
+		dlight_t* pdlight = plights[i];
+		if(!pdlight)
 			continue;
 
-		lightArray[*numLights] = plight;
-		(*numLights)++;
+		VectorCopy(origin, pdlight->origin);
+		pdlight->color.r = clamp(r, 0, 255);
+		pdlight->color.g = clamp(g, 0, 255);
+		pdlight->color.b = clamp(b, 0, 255);
+		pdlight->radius = radius;
+		pdlight->die = die;
+		pdlight->decay = decay;
 	}
+}
+
+/*
+====================
+GetLightList
 
-	for(int i = 0; i < m_iNumTempEntityLights; i++)
+====================
+*/
+void CELightList::GetLightList( vec3_t& origin, const vec3_t& mins, const vec3_t& maxs, elight_t** lightArray, unsigned int* numLights )
+{
+	// Set this to zero
+	*numLights = NULL;
+
+	gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
+
+	// Only lights that survived CullFrameLights
+	for(int i = 0; i < m_iNumFrameLights; i++)
 	{
 		if((*numLights) == MAX_MODEL_ENTITY_LIGHTS)
 			return;
 
-		elight_t* plight = &m_pTempEntityLights[i];
+		elight_t* plight = m_pFrameLights[i];
 
 		if(CheckBBox(plight, mins, maxs))
 			continue;
@@ -255,31 +277,62 @@ bool CELightList::CheckBBox( elight_t* plight, const vec3_t& vmins, const vec3_t
 	return false;
 }
 
+/*
+====================
+AddTempLight
+
+====================
+*/
+void CELightList::AddTempLight( const dlight_t* pdlight, float radius )
+{
+	if(m_iNumTempEntityLights == MAX_GOLDSRC_ELIGHTS)
+		return;
+
+	elight_t* plight = &m_pTempEntityLights[m_iNumTempEntityLights];
+	m_iNumTempEntityLights++;
+
+	plight->entindex = pdlight->key;
+	VectorCopy(pdlight->origin, plight->origin);
+	plight->color.x = (float)pdlight->color.r/255.0f;
+	plight->color.y = (float)pdlight->color.g/255.0f;
+	plight->color.z = (float)pdlight->color.b/255.0f;
+	plight->radius = radius;
+	plight->temporary = true;
+	plight->isSpot = false;
+
+	for(int i = 0; i < 3; i++)
+	{
+		plight->mins[i] = plight->origin[i] - plight->radius;
+		plight->maxs[i] = plight->origin[i] + plight->radius;
+	}
+}
+
 /*
 ====================
 CalcRefDef
 
 ====================
 */
-void CELightList::CalcRefDef( void )
+void CELightList::CalcRefDef( ref_params_t* pparams )
 {
+	R_PROFILE_SCOPE( PROF_ELIGHTS );
+
 	// Reset to zero
 	m_iNumTempEntityLights = 0;
 
 	float fltime = gEngfuncs.GetClientTime();
 
+	// Lights the engine makes itself (TE_DLIGHT, EF_BRIGHTLIGHT, explosions)
+	// can only be found in the slots, so those are still walked. They go
+	// straight into the temp pool though, AddEntityLight would search the
+	// whole persistent list for every one of them.
 	dlight_t* pdlight = m_pGoldSrcELights;
 	for(int i = 0; i < MAX_GOLDSRC_ELIGHTS; i++, pdlight++)
 	{
 		if(!pdlight->radius || pdlight->die < fltime)
 			continue;
 
-		vec3_t lightColor;
-		lightColor.x = (float)pdlight->color.r/255.0f;
-		lightColor.y = (float)pdlight->color.g/255.0f;
-		lightColor.z = (float)pdlight->color.b/255.0f;
-
-		AddEntityLight( pdlight->key, pdlight->origin, lightColor, pdlight->radius*8, true );
+		AddTempLight( pdlight, pdlight->radius*8 );
 	}
 
 	pdlight = m_pGoldSrcDLights;
@@ -288,12 +341,7 @@ void CELightList::CalcRefDef( void )
 		if(!pdlight->radius || pdlight->die < fltime)
 			continue;
 
-		vec3_t lightColor;
-		lightColor.x = (float)pdlight->color.r/255.0f;
-		lightColor.y = (float)pdlight->color.g/255.0f;
-		lightColor.z = (float)pdlight->color.b/255.0f;
-
-		AddEntityLight( pdlight->key, pdlight->origin, lightColor, pdlight->radius, true );
+		AddTempLight( pdlight, pdlight->radius );
 	}
 
 	if(!m_readLightsRad)
@@ -301,6 +349,99 @@ void CELightList::CalcRefDef( void )
 		ReadLightsRadFile();
 		m_readLightsRad = true;
 	}
+
+	CullFrameLights( pparams->vieworg );
+}
+
+struct elightrank_t
+{
+	elight_t*	plight;
+	float		importance;
+	int			order;
+};
+
+static elightrank_t g_lightRanks[MAX_FRAME_ELIGHTS];
+
+/*
+====================
+LightImportance
+
+How much a light can matter to what's on
+screen, radius x brightness / view distance
+====================
+*/
+static float LightImportance( const elight_t* plight, const vec3_t& vieworg )
+{
+	float brightness = max(plight->color.x, max(plight->color.y, plight->color.z));
+
+	float dist = (plight->origin - vieworg).Length();
+	if(dist < 1)
+		dist = 1;
+
+	return plight->radius * brightness / dist;
+}
+
+static bool RankMoreImportant( const elightrank_t& a, const elightrank_t& b )
+{
+	return a.importance > b.importance;
+}
+
+static bool RankStorageOrder( const elightrank_t& a, const elightrank_t& b )
+{
+	return a.order < b.order;
+}
+
+/*
+====================
+CullFrameLights
+
+====================
+*/
+void CELightList::CullFrameLights( const vec3_t& vieworg )
+{
+	float flCull = m_pCvarELightCull->value;
+
+	int iMaxLights = m_pCvarMaxELights->value;
+	if(iMaxLights <= 0 || iMaxLights > MAX_FRAME_ELIGHTS)
+		iMaxLights = MAX_FRAME_ELIGHTS;
+
+	int numRanked = 0;
+	for(int i = 0; i < m_iNumEntityLights + m_iNumTempEntityLights; i++)
+	{
+		elight_t* plight;
+		if(i < m_iNumEntityLights)
+			plight = &m_pEntityLights[i];
+		else
+			plight = &m_pTempEntityLights[i - m_iNumEntityLights];
+
+		// Black or tiny and far away, not worth a trace per model
+		float importance = LightImportance(plight, vieworg);
+		if(importance <= 0 || importance < flCull)
+			continue;
+
+		elightrank_t& rank = g_lightRanks[numRanked];
+		numRanked++;
+
+		rank.plight = plight;
+		rank.importance = importance;
+		rank.order = i;
+	}
+
+	// Keep the strongest ones
+	if(numRanked > iMaxLights)
+	{
+		std::nth_element(g_lightRanks, g_lightRanks + iMaxLights, g_lightRanks + numRanked, RankMoreImportant);
+		numRanked = iMaxLights;
+
+		// Back to storage order, so a model's light list doesn't get
+		// shuffled by the camera moving and miss the lighting cache
+		std::sort(g_lightRanks, g_lightRanks + numRanked, RankStorageOrder);
+	}
+
+	for(int i = 0; i < numRanked; i++)
+		m_pFrameLights[i] = g_lightRanks[i].plight;
+
+	m_iNumFrameLights = numRanked;
 }
 
 /*
@@ -11,12 +11,13 @@
 #pragma once
 #endif
 
-#include <Windows.h>
+#include <windows.h>
 
 #include "elight.h"
 #include "dlight.h"
 #include <vector>
 #include "com_model.h"
+#include "ref_params.h"
 
 #include "gl/gl.h"
 #include "gl/glext.h"
@@ -26,6 +27,18 @@
 #define MAX_GOLDSRC_DLIGHTS		32
 #define MAX_TEXLIGHTS			1024
 
+// Most lights handed to the studio renderer in a frame
+#define MAX_FRAME_ELIGHTS		(MAX_ENTITY_LIGHTS + MAX_GOLDSRC_ELIGHTS)
+
+// What an AddLight call puts in the engine
+#define LIGHT_DLIGHT			(1<<0)	// lights the world
+#define LIGHT_ELIGHT			(1<<1)	// lights models
+
+// Keys for client-side lights, kept out of the entity index range
+// so they don't steal the slots of entity muzzle flashes
+#define LIGHTKEY_FLASHLIGHT		-999
+#define LIGHTKEY_LASERSPOT		-1000
+
 /*
 ====================
 CELightList
@@ -59,7 +72,7 @@ public:
 public:
 	void Init( void );
 	void VidInit( void );
-	void CalcRefDef( void );
+	void CalcRefDef( ref_params_t* pparams );
 	void ReadLightsRadFile( void );
 	void DrawNormal( void );
 
@@ -68,10 +81,17 @@ public:
 	void AddEntityLight( int entindex, const vec3_t& origin, const vec3_t& color, float radius, bool isTemporary );
 	void RemoveEntityLight( int entindex );
 
+	// Client light effects, fills in the engine slots for the key
+	void AddLight( int key, int flags, const vec3_t& origin, int r, int g, int b, float radius, float life, float decay = 0 );
+
 	void GetLightList( vec3_t& origin, const vec3_t& mins, const vec3_t& maxs, elight_t** lightArray, unsigned int* numLights );
 
 	bool CheckBBox( elight_t* plight, const vec3_t& vmins, const vec3_t& vmaxs );
 
+private:
+	void AddTempLight( const dlight_t* pdlight, float radius );
+	void CullFrameLights( const vec3_t& vieworg );
+
 private:
 	elight_t	m_pEntityLights[MAX_ENTITY_LIGHTS];
 	int			m_iNumEntityLights;
@@ -85,11 +105,17 @@ private:
 	texlight_t	m_texLights[MAX_TEXLIGHTS];
 	int			m_numTexLights;
 
+	// Lights worth evaluating this frame, in storage order
+	elight_t*	m_pFrameLights[MAX_FRAME_ELIGHTS];
+	int			m_iNumFrameLights;
+
 	bool		m_readLightsRad;
 
 	PFNGLACTIVETEXTUREPROC			glActiveTexture;
 
 	cvar_t*		m_pCvarDebugELights;
+	cvar_t*		m_pCvarMaxELights;
+	cvar_t*		m_pCvarELightCull;
 };
 
 extern CELightList gELightList;
@@ -20,8 +20,13 @@
 #include "pmtrace.h"	
 #include "pm_shared.h"
 #include "fog.h"
+#include "com_model.h"
+#include "r_studioint.h"
 
 #include "r_water.h"
+#include "r_particles.h"
+#include "r_tempmodels.h"
+#include "elightlist.h"
 
 #define DLLEXPORT __declspec( dllexport )
 
@@ -32,6 +37,9 @@ extern vec3_t v_origin;
 extern globalvars_t* gpGlobals;
 extern cvar_t* r_drawlegs;
 extern ref_params_t g_refparams;
+extern engine_studio_api_t IEngineStudio;
+
+mleaf_t* Mod_PointInLeaf( vec3_t p, model_t* model );
 
 int g_iAlive = 1;
 
@@ -649,15 +657,7 @@ void DLLEXPORT HUD_StudioEvent( const struct mstudioevent_s *event, const struct
 		{
 			idx = ent->index + 1;
 		}
-		dlight_t* dl = gEngfuncs.pEfxAPI->CL_AllocDlight(idx);
-
-		VectorCopy(ent->attachment[0], dl->origin);
-		dl->die = gEngfuncs.GetClientTime() + 0.45f;
-		dl->color.r = 255;
-		dl->color.g = 192;
-		dl->color.b = 64;
-		dl->decay = 512;
-		dl->radius = 150;
+		gELightList.AddLight(idx, LIGHT_DLIGHT, ent->attachment[0], 255, 192, 64, 150, 0.45f, 512);
 	}
 
 	switch( event->event )
@@ -710,27 +710,23 @@ void DLLEXPORT HUD_TempEntUpdate (
 	int			i;
 	TEMPENTITY	*pTemp, *pnext, *pprev;
 	float		freq, gravity, gravitySlow, life, fastFreq;
+	bool		bPlayersSolid = false;
+	model_t		*pWorld;
 
 	if (r_drawlegs->value != 0.0f)
 	{
 		Callback_AddVisibleEntity(gEngfuncs.GetLocalPlayer());
 	}
 
+	// Impact debris and shells live outside the tempent list
+	g_ImpactParticles.Update(frametime, client_time, cl_gravity);
+	g_TempModels.Update(frametime, client_time, cl_gravity, Callback_AddVisibleEntity);
+
 	// Nothing to simulate
 	if ( !*ppTempEntActive )		
 		return;
 
-	// in order to have tents collide with players, we have to run the player prediction code so
-	// that the client has the player list. We run this code once when we detect any COLLIDEALL 
-	// tent, then set this BOOL to true so the code doesn't get run again if there's more than
-	// one COLLIDEALL ent for this update. (often are).
-	gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction( false, true );
-
-	// Store off the old count
-	gEngfuncs.pEventAPI->EV_PushPMStates();
-
-	// Now add in all of the players.
-	gEngfuncs.pEventAPI->EV_SetSolidPlayers ( -1 );	
+	pWorld = IEngineStudio.GetModelByIndex( 1 );
 
 	// !!!BUGBUG	-- This needs to be time based
 	gTempEntFrame = (gTempEntFrame+1) & 31;
@@ -901,6 +897,23 @@ void DLLEXPORT HUD_TempEntUpdate (
 				{
 					pmtrace_t pmtrace;
 					physent_t *pe;
+
+					// in order to have tents collide with players, we have to run the player prediction code so
+					// that the client has the player list. We run this code once when we detect any COLLIDEALL 
+					// tent, then set this BOOL to true so the code doesn't get run again if there's more than
+					// one COLLIDEALL ent for this update. (often are).
+					if ( !bPlayersSolid )
+					{
+						gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction( false, true );
+
+						// Store off the old count
+						gEngfuncs.pEventAPI->EV_PushPMStates();
+
+						// Now add in all of the players.
+						gEngfuncs.pEventAPI->EV_SetSolidPlayers ( -1 );
+
+						bPlayersSolid = true;
+					}
 				
 					gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
 
@@ -926,10 +939,19 @@ void DLLEXPORT HUD_TempEntUpdate (
 				else if ( pTemp->flags & FTENT_COLLIDEWORLD )
 				{
 					pmtrace_t pmtrace;
-					
-					gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
+					mleaf_t *pLeaf = pWorld ? Mod_PointInLeaf( pTemp->entity.origin, pWorld ) : NULL;
+
+					// Leafs are convex, a move that stays inside one open leaf can't hit the world
+					if ( pLeaf && pLeaf->contents != CONTENTS_SOLID && pLeaf == Mod_PointInLeaf( pTemp->entity.prevstate.origin, pWorld ) )
+					{
+						pmtrace.fraction = 1;
+					}
+					else
+					{
+						gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
 
-					gEngfuncs.pEventAPI->EV_PlayerTrace( pTemp->entity.prevstate.origin, pTemp->entity.origin, PM_STUDIO_BOX | PM_WORLD_ONLY, -1, &pmtrace );					
+						gEngfuncs.pEventAPI->EV_PlayerTrace( pTemp->entity.prevstate.origin, pTemp->entity.origin, PM_STUDIO_BOX | PM_WORLD_ONLY, -1, &pmtrace );
+					}
 
 					if ( pmtrace.fraction != 1 )
 					{
@@ -1066,7 +1088,8 @@ void DLLEXPORT HUD_TempEntUpdate (
 
 finish:
 	// Restore state info
-	gEngfuncs.pEventAPI->EV_PopPMStates();
+	if ( bPlayersSolid )
+		gEngfuncs.pEventAPI->EV_PopPMStates();
 }
 
 /*
@@ -34,6 +34,8 @@
 
 #include "r_studioint.h"
 #include "com_model.h"
+#include "r_particles.h"
+#include "elightlist.h"
 
 extern engine_studio_api_t IEngineStudio;
 
@@ -94,36 +96,10 @@ void MuzzleFlash(int index, float r, float g, float b, float a, float radius, fl
 {
 	cl_entity_s* entity = gEngfuncs.GetViewModel();
 
-	dlight_s* dl = gEngfuncs.pEfxAPI->CL_AllocDlight(entity->index);
-	dlight_s* el = gEngfuncs.pEfxAPI->CL_AllocElight(entity->index);
-	if (dl)
-	{
-		if (vecOrigin != Vector(0, 0, 0))
-			dl->origin = vecOrigin;
-		else
-			dl->origin = entity->attachment[index];
-
-		dl->color.r = r * a;
-		dl->color.g = g * a;
-		dl->color.b = b * a;
-		dl->die = gEngfuncs.GetClientTime() + life;
-		dl->radius = radius;
-		dl->decay = decay;
-	}
-	if (el)
-	{
-		if (vecOrigin != Vector(0, 0, 0))
-			el->origin = vecOrigin;
-		else
-			el->origin = entity->attachment[index];
-
-		el->color.r = r * a;
-		el->color.g = g * a;
-		el->color.b = b * a;
-		el->die = gEngfuncs.GetClientTime() + life;
-		el->radius = radius;
-		el->decay = decay;
-	}
+	if (vecOrigin == Vector(0, 0, 0))
+		vecOrigin = entity->attachment[index];
+
+	gELightList.AddLight(entity->index, LIGHT_DLIGHT | LIGHT_ELIGHT, vecOrigin, r * a, g * a, b * a, radius, life, decay);
 }
 
 // play a strike sound based on the texture that was hit by the attack traceline.  VecSrc/VecEnd are the
@@ -524,21 +500,9 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 
 	int a, r, g, b;
 
-	int m_iParticle = 0;
 	float scale;
 	if (Material == 0) // concrete, tile
 	{
-		switch (gEngfuncs.pfnRandomLong(0, 3))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_concrete01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_concrete02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_concrete03.spr"); break;
-
-		case 3: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_concrete04.spr"); break;
-		}
-
 		fDoSparks = (gEngfuncs.pfnRandomLong(1, 2) == 1);
 		fDoPuffs = true;
 		fDoMuzzle = false;
@@ -553,15 +517,6 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (Material == 1) // metal, vent, grate
 	{
-		switch (gEngfuncs.pfnRandomLong(0, 2))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_metal01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_metal02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_metal03.spr"); break;
-		}
-
 		fDoSparks = (gEngfuncs.pfnRandomLong(1, 2) == 1);
 		fDoPuffs = false;
 		fDoMuzzle = true;
@@ -571,16 +526,6 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (Material == 2) // wood
 	{
-
-		switch (gEngfuncs.pfnRandomLong(0, 2))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_wood01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_wood02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_wood03.spr"); break;
-		}
-
 		fDoPuffs = true;
 		fDoSparks = false;
 		fDoMuzzle = false;
@@ -595,18 +540,6 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (Material == 3) // dirt
 	{
-
-		switch (gEngfuncs.pfnRandomLong(0, 3))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_dirt01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_dirt02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_dirt03.spr"); break;
-
-		case 3: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_dirt04.spr"); break;
-		}
-
 		fDoPuffs = true;
 		fDoSparks = false;
 		fDoMuzzle = false;
@@ -621,17 +554,6 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (Material == 4) // glass
 	{
-		switch (gEngfuncs.pfnRandomLong(0, 3))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_glass01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_glass02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_glass03.spr"); break;
-
-		case 3: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_glass04.spr"); break;
-		}
-
 		fDoPuffs = false;
 		fDoSparks = false;
 		fDoMuzzle = false;
@@ -641,17 +563,6 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (Material == 5) // computer
 	{
-		switch (gEngfuncs.pfnRandomLong(0, 3))
-		{
-		case 0: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_computer01.spr"); break;
-
-		case 1: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_computer02.spr"); break;
-
-		case 2: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_computer03.spr"); break;
-
-		case 3: m_iParticle = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/debris_computer04.spr"); break;
-		}
-
 		fDoPuffs = false;
 		fDoSparks = (gEngfuncs.pfnRandomLong(1, 2) == 1);
 		fDoMuzzle = false;
@@ -662,29 +573,12 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	if (DoPuff != 0)
 	{
 		if (fDoPuffs)
-		{ // get sprite index
-			int iWallsmoke = gEngfuncs.pEventAPI->EV_FindModelIndex("sprites/debris/smokepuff.spr");
-			// create sprite
-			TEMPENTITY* pTemp = gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos,
+		{ // smoke puff, drawn by the impact particle pool
+			g_ImpactParticles.AddPuff(pTrace->endpos,
 
 				forward * gEngfuncs.pfnRandomFloat(10, 30) + right * gEngfuncs.pfnRandomFloat(-6, 6) + up * gEngfuncs.pfnRandomFloat(0, 6),
 
-				0.7, iWallsmoke, kRenderTransAdd, kRenderFxNone, 1.0, 0.3, FTENT_SPRANIMATE | FTENT_FADEOUT | FTENT_COLLIDEKILL);
-			if (pTemp)
-			{ // sprite created successfully, adjust some things
-
-				pTemp->fadeSpeed = 3.0;
-
-				pTemp->entity.curstate.framerate = 25.0;
-
-				pTemp->entity.curstate.renderamt = a;
-
-				pTemp->entity.curstate.rendercolor.r = r;
-
-				pTemp->entity.curstate.rendercolor.g = g;
-
-				pTemp->entity.curstate.rendercolor.b = b;
-			}
+				0.7, r, g, b, a);
 		}
 
 		int iRand = gEngfuncs.pfnRandomLong(0, 0x7FFF);
@@ -707,45 +601,17 @@ void EV_HLDM_Particles(vec_t Pos_X, vec_t Pos_Y, vec_t Pos_Z, float PosNorm_X, f
 	}
 	if (fDoMuzzle)
 	{
-		dlight_t* dl = gEngfuncs.pEfxAPI->CL_AllocDlight(0);
-
-		dl->origin = pTrace->endpos;
-
-		dl->color.r = 255; // red
-
-		dl->color.g = 255; // green
-
-		dl->color.b = 128; // blue
-
-		dl->radius = 100;
-
-		dl->die = gEngfuncs.GetClientTime() + 0.01;
+		gELightList.AddLight(0, LIGHT_DLIGHT, pTrace->endpos, 255, 255, 128, 100, 0.01);
 
 		gEngfuncs.pEfxAPI->R_MuzzleFlash(pTrace->endpos, 11);
 	}
-	float NumParticles = gEngfuncs.pfnRandomFloat(2, 5);
-	int Options = FTENT_SLOWGRAVITY | FTENT_COLLIDEKILL | FTENT_ROTATE;
 	if (fDoParticles)
 	{ // make much particles!
-		if (NumParticles >= 2)
-		{
-			gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale, m_iParticle, kRenderTransAlpha, kRenderFxNone, 1.0, 20, Options);
-			gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale, m_iParticle, kRenderTransAlpha, kRenderFxNone, 1.0, 20, Options);
-		}
-
-		if (NumParticles >= 3)
-		{
-			gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale, m_iParticle, kRenderTransAlpha, kRenderFxNone, 1.0, 20, Options);
-		}
-
-		if (NumParticles >= 4)
-		{
-			gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale, m_iParticle, kRenderTransAlpha, kRenderFxNone, 1.0, 20, Options);
-		}
-
-		if (NumParticles == 5)
+		int DebrisSprite = g_ImpactParticles.PickDebrisSprite(Material);
+		int NumParticles = gEngfuncs.pfnRandomLong(2, 4);
+		for (int i = 0; i < NumParticles; i++)
 		{
-			gEngfuncs.pEfxAPI->R_TempSprite(pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale, m_iParticle, kRenderTransAlpha, kRenderFxNone, 1.0, 20, Options);
+			g_ImpactParticles.AddDebris(Material, DebrisSprite, pTrace->endpos, forward * gEngfuncs.pfnRandomFloat(80, 120) + right * gEngfuncs.pfnRandomFloat(-124, 124) + up * gEngfuncs.pfnRandomFloat(-30, 30), scale);
 		}
 	}
 }
@@ -64,6 +64,9 @@ Init
 void CFog::Init( void )
 {
 	HOOK_MESSAGE( Fog );
+
+	// Fraction of the way from fog start to end where the far band begins
+	m_pCvarFogLOD = CVAR_CREATE( "r_fog_lod", "0.8", FCVAR_ARCHIVE );
 }
 
 /*
@@ -76,6 +79,7 @@ void CFog::VidInit( void )
 {
 	m_iEndDist = NULL;
 	m_iStartDist = NULL;
+	m_flFarBandDist = 0;
 }
 
 /*
@@ -135,11 +139,14 @@ CalcRefDef
 */
 void CFog::CalcRefDef( ref_params_t* pparams )
 {
-	for(int i = 0; i < 3; i++)
-	{
-		m_vFogBBoxMin[i] = pparams->vieworg[i] - m_iEndDist;
-		m_vFogBBoxMax[i] = pparams->vieworg[i] + m_iEndDist;
-	}
+	VectorCopy(pparams->vieworg, m_vViewOrigin);
+	AngleVectors(pparams->viewangles, m_vViewForward, NULL, NULL);
+
+	float flFraction = m_pCvarFogLOD->value;
+	if(flFraction > 0 && flFraction < 1)
+		m_flFarBandDist = m_iStartDist + (m_iEndDist - m_iStartDist) * flFraction;
+	else
+		m_flFarBandDist = m_iEndDist;
 
 	RenderFog();
 }
@@ -152,28 +159,53 @@ CullFogBBox
 */
 bool CFog::CullFogBBox ( const vec3_t& mins, const vec3_t& maxs )
 {
-	if(!m_iStartDist && !m_iEndDist)
+	return GetFogLevel(mins, maxs) == FOG_CULLED;
+}
+
+/*
+====================
+CullFogSphere
+
+====================
+*/
+bool CFog::CullFogSphere ( const vec3_t& origin, float radius )
+{
+	if(m_iEndDist <= 0)
 		return false;
 
-	if (mins[0] > m_vFogBBoxMax[0]) 
-		return true;
+	float flDepth = DotProduct(origin - m_vViewOrigin, m_vViewForward) - radius;
+	return flDepth >= m_iEndDist;
+}
+
+/*
+====================
+GetFogLevel
 
-	if (mins[1] > m_vFogBBoxMax[1]) 
-		return true;
+====================
+*/
+int CFog::GetFogLevel ( const vec3_t& mins, const vec3_t& maxs )
+{
+	if(m_iEndDist <= 0)
+		return FOG_CLEAR;
 
-	if (mins[2] > m_vFogBBoxMax[2]) 
-		return true;
+	// Eye depth of the box corner closest to the view plane
+	float flDepth = 0;
+	for(int i = 0; i < 3; i++)
+	{
+		float center = (mins[i] + maxs[i]) * 0.5f;
+		float extent = (maxs[i] - mins[i]) * 0.5f;
 
-	if (maxs[0] < m_vFogBBoxMin[0]) 
-		return true;
+		flDepth += (center - m_vViewOrigin[i]) * m_vViewForward[i];
+		flDepth -= extent * fabs(m_vViewForward[i]);
+	}
 
-	if (maxs[1] < m_vFogBBoxMin[1]) 
-		return true;
+	if(flDepth >= m_iEndDist)
+		return FOG_CULLED;
 
-	if (maxs[2] < m_vFogBBoxMin[2]) 
-		return true;
+	if(flDepth >= m_flFarBandDist)
+		return FOG_FARBAND;
 
-	return false;
+	return FOG_CLEAR;
 }
 
 /*
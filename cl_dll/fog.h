@@ -13,6 +13,14 @@
 
 #include "ref_params.h"
 
+// How far into the fog something is
+enum foglevel_t
+{
+	FOG_CLEAR = 0,
+	FOG_FARBAND,		// mostly fogged, cheap lighting will do
+	FOG_CULLED			// completely past the fog end
+};
+
 /*
 ====================
 CFog
@@ -32,13 +40,21 @@ public:
 
 	void CalcRefDef( ref_params_t* pparams );
 	bool CullFogBBox ( const vec3_t& mins, const vec3_t& maxs );
+	bool CullFogSphere ( const vec3_t& origin, float radius );
+	int GetFogLevel ( const vec3_t& mins, const vec3_t& maxs );
 
 private:
 	int	m_iEndDist;
 	int m_iStartDist;
 	
-	vec3_t m_vFogBBoxMin;
-	vec3_t m_vFogBBoxMax;
+	// Fog goes by eye depth, so culling does too
+	vec3_t m_vViewOrigin;
+	vec3_t m_vViewForward;
+
+	// Distance the far band starts at
+	float m_flFarBandDist;
+
+	cvar_t* m_pCvarFogLOD;
 
 	static vec3_t m_vFogColor;
 };
@@ -24,6 +24,7 @@
 
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include "parsemsg.h"
 #include <string.h>
 
@@ -235,8 +236,8 @@ int CHudHealth::Draw(float flTime)
 		y = ScreenHeight - gHUD.m_iFontHeight - gHUD.m_iFontHeight / 2;
 		x = CrossWidth /2;
 
-		SPR_Set(gHUD.GetSprite(m_HUD_cross), r, g, b);
-		SPR_DrawAdditive(0, x, y, &gHUD.GetSpriteRect(m_HUD_cross));
+		g_HudSpriteBatch.Set(gHUD.GetSprite(m_HUD_cross), r, g, b);
+		g_HudSpriteBatch.DrawAdditive(0, x, y, &gHUD.GetSpriteRect(m_HUD_cross));
 
 		x = CrossWidth + HealthWidth / 2;
 
@@ -332,11 +333,11 @@ int CHudHealth::DrawPain(float flTime)
 		GetPainColor(r,g,b);
 		shade = a * max( m_fAttackFront, 0.5 );
 		ScaleColors(r, g, b, shade);
-		SPR_Set(m_SpriteHandle_t, r, g, b );
+		g_HudSpriteBatch.Set(m_SpriteHandle_t, r, g, b );
 
 		x = ScreenWidth/2 - SPR_Width(m_SpriteHandle_t, 0)/2;
 		y = ScreenHeight/2 - SPR_Height(m_SpriteHandle_t,0) * 3;
-		SPR_DrawAdditive(0, x, y, NULL);
+		g_HudSpriteBatch.DrawAdditive(0, x, y, NULL);
 		m_fAttackFront = max( 0, m_fAttackFront - fFade );
 	} else
 		m_fAttackFront = 0;
@@ -346,11 +347,11 @@ int CHudHealth::DrawPain(float flTime)
 		GetPainColor(r,g,b);
 		shade = a * max( m_fAttackRight, 0.5 );
 		ScaleColors(r, g, b, shade);
-		SPR_Set(m_SpriteHandle_t, r, g, b );
+		g_HudSpriteBatch.Set(m_SpriteHandle_t, r, g, b );
 
 		x = ScreenWidth/2 + SPR_Width(m_SpriteHandle_t, 1) * 2;
 		y = ScreenHeight/2 - SPR_Height(m_SpriteHandle_t,1)/2;
-		SPR_DrawAdditive(1, x, y, NULL);
+		g_HudSpriteBatch.DrawAdditive(1, x, y, NULL);
 		m_fAttackRight = max( 0, m_fAttackRight - fFade );
 	} else
 		m_fAttackRight = 0;
@@ -360,11 +361,11 @@ int CHudHealth::DrawPain(float flTime)
 		GetPainColor(r,g,b);
 		shade = a * max( m_fAttackRear, 0.5 );
 		ScaleColors(r, g, b, shade);
-		SPR_Set(m_SpriteHandle_t, r, g, b );
+		g_HudSpriteBatch.Set(m_SpriteHandle_t, r, g, b );
 
 		x = ScreenWidth/2 - SPR_Width(m_SpriteHandle_t, 2)/2;
 		y = ScreenHeight/2 + SPR_Height(m_SpriteHandle_t,2) * 2;
-		SPR_DrawAdditive(2, x, y, NULL);
+		g_HudSpriteBatch.DrawAdditive(2, x, y, NULL);
 		m_fAttackRear = max( 0, m_fAttackRear - fFade );
 	} else
 		m_fAttackRear = 0;
@@ -374,11 +375,11 @@ int CHudHealth::DrawPain(float flTime)
 		GetPainColor(r,g,b);
 		shade = a * max( m_fAttackLeft, 0.5 );
 		ScaleColors(r, g, b, shade);
-		SPR_Set(m_SpriteHandle_t, r, g, b );
+		g_HudSpriteBatch.Set(m_SpriteHandle_t, r, g, b );
 
 		x = ScreenWidth/2 - SPR_Width(m_SpriteHandle_t, 3) * 3;
 		y = ScreenHeight/2 - SPR_Height(m_SpriteHandle_t,3)/2;
-		SPR_DrawAdditive(3, x, y, NULL);
+		g_HudSpriteBatch.DrawAdditive(3, x, y, NULL);
 
 		m_fAttackLeft = max( 0, m_fAttackLeft - fFade );
 	} else
@@ -408,8 +409,8 @@ int CHudHealth::DrawDamage(float flTime)
 		if (m_bitsDamage & giDmgFlags[i])
 		{
 			pdmg = &m_dmg[i];
-			SPR_Set(gHUD.GetSprite(m_HUD_dmg_bio + i), r, g, b );
-			SPR_DrawAdditive(0, pdmg->x, pdmg->y, &gHUD.GetSpriteRect(m_HUD_dmg_bio + i));
+			g_HudSpriteBatch.Set(gHUD.GetSprite(m_HUD_dmg_bio + i), r, g, b );
+			g_HudSpriteBatch.DrawAdditive(0, pdmg->x, pdmg->y, &gHUD.GetSpriteRect(m_HUD_dmg_bio + i));
 		}
 	}
 
@@ -26,6 +26,8 @@
 #include "entity_types.h"
 #include "r_efx.h"
 #include "ref_params.h"
+#include "../elightlist.h"
+#include "../tracecache.h"
 
 extern BEAM *pBeam;
 extern BEAM *pBeam2;
@@ -51,8 +53,6 @@ void UpdateBeams ( void )
 	vec3_t forward, vecSrc, vecEnd, origin, angles, right, up;
 	vec3_t view_ofs;
 	pmtrace_t tr;
-	cl_entity_t *pthisplayer = gEngfuncs.GetLocalPlayer();
-	int idx = pthisplayer->index;
 	cl_entity_s* view = gEngfuncs.GetViewModel();
 		
 	// Get our exact viewangles from engine
@@ -67,18 +67,7 @@ void UpdateBeams ( void )
 	
 	VectorMA( vecSrc, 2048, forward, vecEnd );
 
-	gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction( false, true );	
-						
-	// Store off the old count
-	gEngfuncs.pEventAPI->EV_PushPMStates();
-					
-	// Now add in all of the players.
-	gEngfuncs.pEventAPI->EV_SetSolidPlayers ( idx - 1 );	
-
-	gEngfuncs.pEventAPI->EV_SetTraceHull( 2 );
-	gEngfuncs.pEventAPI->EV_PlayerTrace(vecSrc, vecEnd, PM_NORMAL, -1, &tr);
-
-	gEngfuncs.pEventAPI->EV_PopPMStates();
+	g_TraceCache.PlayerTrace( vecSrc, vecEnd, 2, PM_NORMAL, &tr );
 
 	pBeam->source = view->attachment[0];
 	pBeam2->source = view->attachment[0];
@@ -156,12 +145,9 @@ void Game_AddObjects( void )
 
 void UpdateFlashlight(ref_params_t* pparams)
 {
-	dlight_t* dl;
 	Vector forward, vecSrc, vecEnd, origin, angles, right, up;
 	Vector view_ofs;
 	pmtrace_t tr;
-	cl_entity_t* pthisplayer = gEngfuncs.GetLocalPlayer();
-	int idx = pthisplayer->index;
 
 	if (!gHUD.m_bFlashlight)
 	{
@@ -177,28 +163,10 @@ void UpdateFlashlight(ref_params_t* pparams)
 
 	VectorMA(vecSrc, 8192, forward, vecEnd);
 
-	gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction(0, 1);
-
-	// Store off the old count
-	gEngfuncs.pEventAPI->EV_PushPMStates();
-
-	// Now add in all of the players.
-	gEngfuncs.pEventAPI->EV_SetSolidPlayers(idx - 1);
+	// Same ray as the laser spot when there's no punch, they share the trace
+	g_TraceCache.PlayerTrace(vecSrc, vecEnd, 2, PM_STUDIO_BOX, &tr);
 
-	gEngfuncs.pEventAPI->EV_SetTraceHull(2);
-	gEngfuncs.pEventAPI->EV_PlayerTrace(vecSrc, vecEnd, PM_STUDIO_BOX, -1, &tr);
-
-	gEngfuncs.pEventAPI->EV_PopPMStates();
-
-	dl = gEngfuncs.pEfxAPI->CL_AllocDlight(-999);
-	if (dl)
-	{
-		dl->origin = tr.endpos;
-		dl->radius = 100;
-		dl->decay = 512;
-		dl->die = gEngfuncs.GetClientTime() + 0.1f;
-		dl->color = { 255, 255, 255 };
-	}
+	gELightList.AddLight(LIGHTKEY_FLASHLIGHT, LIGHT_DLIGHT, tr.endpos, 255, 255, 255, 100, 0.1f, 512);
 }
 
 #define MAX_LIGHTS 7
@@ -206,8 +174,6 @@ void UpdateFlashlight(ref_params_t* pparams)
 tempent_s* pLaserSpot = NULL;
 extern cvar_s* cl_lw;
 
-dlight_s* pSpotDl[MAX_LIGHTS] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
-dlight_s* pSpotEl = { NULL };
 void CheckSuspend()
 {
 	if (gHUD.m_iLaserState > 2 && gHUD.m_iLaserSuspendTime < gEngfuncs.GetClientTime())
@@ -241,52 +207,22 @@ void UpdateLaserSpot()
 	Vector forward, vecSrc, vecEnd, origin, angles, right, up;
 	Vector view_ofs;
 	pmtrace_t tr;
-	cl_entity_t* pthisplayer = gEngfuncs.GetLocalPlayer();
-	int idx = pthisplayer->index;
 	VectorCopy(g_pparams.vieworg, origin);
 	VectorCopy(g_pparams.cl_viewangles, angles);
 	AngleVectors(angles, forward, right, up);
 	VectorCopy(origin, vecSrc);
 	VectorMA(vecSrc, 8192, forward, vecEnd);
-	gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction(false, true);
-	// Store off the old count
-	gEngfuncs.pEventAPI->EV_PushPMStates();
-	// Now add in all of the players.
-	gEngfuncs.pEventAPI->EV_SetSolidPlayers(idx - 1);
-	gEngfuncs.pEventAPI->EV_SetTraceHull(2);
-	gEngfuncs.pEventAPI->EV_PlayerTrace(vecSrc, vecEnd, PM_STUDIO_BOX, -1, &tr);
-	gEngfuncs.pEventAPI->EV_PopPMStates();
+	// Called from several places each frame, only the first one traces
+	g_TraceCache.PlayerTrace(vecSrc, vecEnd, 2, PM_STUDIO_BOX, &tr);
 	if (pLaserSpot)
 	{
 		pLaserSpot->entity.origin = pLaserSpot->entity.curstate.origin = tr.endpos;
 		pLaserSpot->die = gEngfuncs.GetClientTime() + 0.1;
 
-		if (!pSpotEl)
-			pSpotEl = gEngfuncs.pEfxAPI->CL_AllocElight(idx + 1);
-
+		// Stacked dlights so the dot shows up on the world
 		for (int i = 0; i < MAX_LIGHTS; i++)
-		{
-			if (!pSpotDl[i])
-				pSpotDl[i] = gEngfuncs.pEfxAPI->CL_AllocDlight((idx)+i);
-
-			if (pSpotDl[i])
-			{
-				pSpotDl[i]->color.r = 255;
-				pSpotDl[i]->color.g = 0;
-				pSpotDl[i]->color.b = 0;
-				pSpotDl[i]->radius = 23;
-				pSpotDl[i]->origin = pLaserSpot->entity.origin;
-				pSpotDl[i]->die = gEngfuncs.GetClientTime() + 0.035f;
-			}
-		}
-		if (pSpotDl)
-		{
-			pSpotEl->color.r = 255;
-			pSpotEl->color.g = 0;
-			pSpotEl->color.b = 0;
-			pSpotEl->radius = 35;
-			pSpotEl->origin = pLaserSpot->entity.origin;
-			pSpotEl->die = gEngfuncs.GetClientTime() + 0.035f;
-		}
+			gELightList.AddLight(LIGHTKEY_LASERSPOT - i, LIGHT_DLIGHT, pLaserSpot->entity.origin, 255, 0, 0, 23, 0.035f);
+
+		gELightList.AddLight(LIGHTKEY_LASERSPOT, LIGHT_ELIGHT, pLaserSpot->entity.origin, 255, 0, 0, 35, 0.035f);
 	}
 }
\ No newline at end of file
@@ -37,6 +37,13 @@
 #include "elightlist.h"
 #include "svd_render.h"
 #include "svdformat.h"
+#include "r_studioqueue.h"
+#include "r_lightgrid.h"
+#include "r_particles.h"
+#include "r_tempmodels.h"
+#include "hud_spritebatch.h"
+#include "tracecache.h"
+#include "r_profile.h"
 #include "event_api.h"
 
 extern tempent_s* pLaserSpot;
@@ -89,6 +96,7 @@ static CHLVoiceStatusHelper g_VoiceStatusHelper;
 extern client_sprite_t *GetSpriteList(client_sprite_t *pList, const char *psz, int iRes, int iCount);
 
 extern cvar_t *sensitivity;
+extern void R_StudioVidInit( void );
 cvar_t *cl_lw = NULL;
 
 // HLRETAIL
@@ -836,6 +844,12 @@ void CHud :: Init( void )
 
 	SVD_Init();
 
+	g_StudioRenderQueue.Init();
+	g_LightProbeGrid.Init();
+	g_ImpactParticles.Init();
+	g_HudSpriteBatch.Init();
+	R_PROFILE_INIT();
+
 	m_bLevelChange = false;
 }
 
@@ -847,6 +861,7 @@ CHud :: ~CHud()
 	delete [] m_rgSpriteHandle_ts;
 	delete [] m_rgrcRects;
 	delete [] m_rgszSpriteNames;
+	delete [] m_rgiSpriteHash;
 
 	if ( m_pHudList )
 	{
@@ -864,17 +879,76 @@ CHud :: ~CHud()
 	SVD_Shutdown();
 }
 
+// HashSpriteName()
+// FNV-1a over the part of the name GetSpriteIndex compares
+static unsigned int HashSpriteName( const char *SpriteName )
+{
+	unsigned int hash = 2166136261u;
+
+	for ( int i = 0; i < MAX_SPRITE_NAME_LENGTH && SpriteName[i]; i++ )
+	{
+		hash ^= (unsigned char)SpriteName[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+// BuildSpriteHash()
+// fills the name lookup table once the hud.txt names are loaded
+void CHud :: BuildSpriteHash( void )
+{
+	delete [] m_rgiSpriteHash;
+
+	// keep the table at most half full
+	m_iSpriteHashSize = 16;
+	while ( m_iSpriteHashSize < m_iSpriteCount * 2 )
+		m_iSpriteHashSize <<= 1;
+
+	m_rgiSpriteHash = new int[m_iSpriteHashSize];
+	memset( m_rgiSpriteHash, -1, sizeof(int) * m_iSpriteHashSize );
+
+	for ( int i = 0; i < m_iSpriteCount; i++ )
+	{
+		const char *pszName = m_rgszSpriteNames + (i * MAX_SPRITE_NAME_LENGTH);
+		int slot = HashSpriteName( pszName ) & (m_iSpriteHashSize - 1);
+
+		// the first of several sprites with the same name wins, like the old linear search
+		bool bDuplicate = false;
+		while ( m_rgiSpriteHash[slot] != -1 )
+		{
+			if ( strncmp( pszName, m_rgszSpriteNames + (m_rgiSpriteHash[slot] * MAX_SPRITE_NAME_LENGTH), MAX_SPRITE_NAME_LENGTH ) == 0 )
+			{
+				bDuplicate = true;
+				break;
+			}
+
+			slot = (slot + 1) & (m_iSpriteHashSize - 1);
+		}
+
+		if ( !bDuplicate )
+			m_rgiSpriteHash[slot] = i;
+	}
+}
+
 // GetSpriteIndex()
 // searches through the sprite list loaded from hud.txt for a name matching SpriteName
 // returns an index into the gHUD.m_rgSpriteHandle_ts[] array
 // returns 0 if sprite not found
 int CHud :: GetSpriteIndex( const char *SpriteName )
 {
-	// look through the loaded sprite name list for SpriteName
-	for ( int i = 0; i < m_iSpriteCount; i++ )
+	if ( !m_rgiSpriteHash )
+		return -1; // invalid sprite
+
+	// probe the name table until an empty slot
+	int slot = HashSpriteName( SpriteName ) & (m_iSpriteHashSize - 1);
+	while ( m_rgiSpriteHash[slot] != -1 )
 	{
+		int i = m_rgiSpriteHash[slot];
 		if ( strncmp( SpriteName, m_rgszSpriteNames + (i * MAX_SPRITE_NAME_LENGTH), MAX_SPRITE_NAME_LENGTH ) == 0 )
 			return i;
+
+		slot = (slot + 1) & (m_iSpriteHashSize - 1);
 	}
 
 	return -1; // invalid sprite
@@ -939,6 +1013,8 @@ void CHud :: VidInit( void )
 
 				p++;
 			}
+
+			BuildSpriteHash();
 		}
 	}
 	else
@@ -988,6 +1064,12 @@ void CHud :: VidInit( void )
 	gELightList.VidInit();
 	gFog.VidInit();
 	SVD_VidInit();
+	g_StudioRenderQueue.VidInit();
+	g_LightProbeGrid.VidInit();
+	g_ImpactParticles.VidInit();
+	g_TempModels.VidInit();
+	g_TraceCache.VidInit();
+	R_StudioVidInit();
 
 	m_bLevelChange = true;
 }
@@ -106,7 +106,7 @@ struct HUDLIST {
 //
 //-----------------------------------------------------
 //
-#include "..\game_shared\voice_status.h"
+#include "../game_shared/voice_status.h"
 #include "hud_spectator.h"
 
 
@@ -631,6 +631,8 @@ private:
 	SpriteHandle_t *m_rgSpriteHandle_ts;	/*[HUD_SPRITE_COUNT]*/			// the sprites loaded from hud.txt
 	wrect_t *m_rgrcRects;	/*[HUD_SPRITE_COUNT]*/
 	char *m_rgszSpriteNames; /*[HUD_SPRITE_COUNT][MAX_SPRITE_NAME_LENGTH]*/
+	int *m_rgiSpriteHash;	// open addressed table of sprite indexes, keyed by name
+	int m_iSpriteHashSize;	// power of two
 	struct cvar_s* default_fov;
 	screen_shake_t m_ScreenShake;
 
@@ -647,6 +649,7 @@ public:
 
 	
 	int GetSpriteIndex( const char *SpriteName );	// gets a sprite index, for use in the m_rgSpriteHandle_ts[] array
+	void BuildSpriteHash( void );
 
 	CHudAmmo		m_Ammo;
 	CHudHealth		m_Health;
@@ -670,7 +673,7 @@ public:
 	int Redraw( float flTime, int intermission );
 	int UpdateClientData( client_data_t *cdata, float time );
 
-	CHud() : m_iSpriteCount(0), m_pHudList(NULL) {}  
+	CHud() : m_iSpriteCount(0), m_pHudList(NULL), m_rgiSpriteHash(NULL), m_iSpriteHashSize(0) {}  
 	~CHud();			// destructor, frees allocated memory
 
 	// user messages
@@ -18,8 +18,10 @@
 #include <math.h>
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 
 #include "vgui_TeamFortressViewport.h"
+#include "r_profile.h"
 
 void HUD_DrawBloodOverlay(void);
 
@@ -106,6 +108,9 @@ int CHud :: Redraw( float flTime, int intermission )
 {
 	HUD_DrawBloodOverlay();
 
+	// Everything rendered for this frame has been timed by now
+	R_PROFILE_ENDFRAME( flTime );
+
 	m_fOldTime = m_flTime;	// save time of previous redraw
 	m_flTime = flTime;
 	m_flTimeDelta = (double)m_flTime - m_fOldTime;
@@ -155,6 +160,10 @@ int CHud :: Redraw( float flTime, int intermission )
 	// if no redrawing is necessary
 	// return 0;
 	
+	// Additive sprites from the HUD elements are batched until something
+	// else is drawn over them, or the HUD pass ends
+	g_HudSpriteBatch.Begin();
+
 	if ( m_pCvarDraw->value )
 	{
 		HUDLIST *pList = m_pHudList;
@@ -176,6 +185,8 @@ int CHud :: Redraw( float flTime, int intermission )
 		}
 	}
 
+	g_HudSpriteBatch.Flush();
+
 	// are we in demo mode? do we need to draw the logo in the top corner?
 	if (m_iLogo)
 	{
@@ -288,8 +299,8 @@ int CHud :: DrawHudNumber( int x, int y, int iFlags, int iNumber, int r, int g,
 		if (iNumber >= 100)
 		{
 			 k = iNumber/100;
-			SPR_Set(GetSprite(m_HUD_number_0 + k), r, g, b );
-			SPR_DrawAdditive( 0, x, y, &GetSpriteRect(m_HUD_number_0 + k));
+			g_HudSpriteBatch.Set(GetSprite(m_HUD_number_0 + k), r, g, b );
+			g_HudSpriteBatch.DrawAdditive( 0, x, y, &GetSpriteRect(m_HUD_number_0 + k));
 			x += iWidth;
 		}
 		else if (iFlags & (DHN_3DIGITS))
@@ -302,8 +313,8 @@ int CHud :: DrawHudNumber( int x, int y, int iFlags, int iNumber, int r, int g,
 		if (iNumber >= 10)
 		{
 			k = (iNumber % 100)/10;
-			SPR_Set(GetSprite(m_HUD_number_0 + k), r, g, b );
-			SPR_DrawAdditive( 0, x, y, &GetSpriteRect(m_HUD_number_0 + k));
+			g_HudSpriteBatch.Set(GetSprite(m_HUD_number_0 + k), r, g, b );
+			g_HudSpriteBatch.DrawAdditive( 0, x, y, &GetSpriteRect(m_HUD_number_0 + k));
 			x += iWidth;
 		}
 		else if (iFlags & (DHN_3DIGITS | DHN_2DIGITS))
@@ -314,13 +325,13 @@ int CHud :: DrawHudNumber( int x, int y, int iFlags, int iNumber, int r, int g,
 
 		// SPR_Draw ones
 		k = iNumber % 10;
-		SPR_Set(GetSprite(m_HUD_number_0 + k), r, g, b );
-		SPR_DrawAdditive(0,  x, y, &GetSpriteRect(m_HUD_number_0 + k));
+		g_HudSpriteBatch.Set(GetSprite(m_HUD_number_0 + k), r, g, b );
+		g_HudSpriteBatch.DrawAdditive(0,  x, y, &GetSpriteRect(m_HUD_number_0 + k));
 		x += iWidth;
 	} 
 	else if (iFlags & DHN_DRAWZERO) 
 	{
-		SPR_Set(GetSprite(m_HUD_number_0), r, g, b );
+		g_HudSpriteBatch.Set(GetSprite(m_HUD_number_0), r, g, b );
 
 		// SPR_Draw 100's
 		if (iFlags & (DHN_3DIGITS))
@@ -337,7 +348,7 @@ int CHud :: DrawHudNumber( int x, int y, int iFlags, int iNumber, int r, int g,
 
 		// SPR_Draw ones
 		
-		SPR_DrawAdditive( 0,  x, y, &GetSpriteRect(m_HUD_number_0));
+		g_HudSpriteBatch.DrawAdditive( 0,  x, y, &GetSpriteRect(m_HUD_number_0));
 		x += iWidth;
 	}
 
@@ -355,8 +366,8 @@ int CHud::DrawHl2HudNumber(int x, int y, int iFlags, int iNumber, int r, int g,
 		if (iNumber >= 100)
 		{
 			k = iNumber / 100;
-			SPR_Set(GetSprite(hl2_bnumber_0), r, g, b);
-			SPR_DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
+			g_HudSpriteBatch.Set(GetSprite(hl2_bnumber_0), r, g, b);
+			g_HudSpriteBatch.DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
 			x += iWidth;
 		}
 		else if (iFlags & (DHN_3DIGITS))
@@ -369,8 +380,8 @@ int CHud::DrawHl2HudNumber(int x, int y, int iFlags, int iNumber, int r, int g,
 		if (iNumber >= 10)
 		{
 			k = (iNumber % 100) / 10;
-			SPR_Set(GetSprite(hl2_bnumber_0), r, g, b);
-			SPR_DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
+			g_HudSpriteBatch.Set(GetSprite(hl2_bnumber_0), r, g, b);
+			g_HudSpriteBatch.DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
 			x += iWidth;
 		}
 		else if (iFlags & (DHN_3DIGITS | DHN_2DIGITS))
@@ -381,13 +392,13 @@ int CHud::DrawHl2HudNumber(int x, int y, int iFlags, int iNumber, int r, int g,
 
 		// SPR_Draw ones
 		k = iNumber % 10;
-		SPR_Set(GetSprite(hl2_bnumber_0), r, g, b);
-		SPR_DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
+		g_HudSpriteBatch.Set(GetSprite(hl2_bnumber_0), r, g, b);
+		g_HudSpriteBatch.DrawAdditive(k, x, y, &GetSpriteRect(hl2_bnumber_0));
 		x += iWidth;
 	}
 	else if (iFlags & DHN_DRAWZERO)
 	{
-		SPR_Set(GetSprite(hl2_bnumber_0), r, g, b);
+		g_HudSpriteBatch.Set(GetSprite(hl2_bnumber_0), r, g, b);
 
 		// SPR_Draw 100's
 		if (iFlags & (DHN_3DIGITS))
@@ -404,7 +415,7 @@ int CHud::DrawHl2HudNumber(int x, int y, int iFlags, int iNumber, int r, int g,
 
 		// SPR_Draw ones
 
-		SPR_DrawAdditive(0, x, y, &GetSpriteRect(hl2_bnumber_0));
+		g_HudSpriteBatch.DrawAdditive(0, x, y, &GetSpriteRect(hl2_bnumber_0));
 		x += iWidth;
 	}
 
@@ -148,6 +148,7 @@ int CHudSpectator::Init()
 	memset( &m_OverviewData, 0, sizeof(m_OverviewData));
 	memset( &m_OverviewEntities, 0, sizeof(m_OverviewEntities));
 	m_lastPrimaryObject = m_lastSecondaryObject = 0;
+	m_bOverviewTilesValid = false;
 
 	gEngfuncs.pfnAddCommand ("spec_mode", SpectatorMode );
 	gEngfuncs.pfnAddCommand ("spec_decal", SpectatorSpray );
@@ -202,17 +203,23 @@ void UTIL_StringToVector( float * pVector, const char *pString )
 	}
 }
 
-int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
+//-----------------------------------------------------------------------------
+// UTIL_FindEntitiesInMap(): 
+// Looks for several classnames in one pass over the entity lump, names 
+// earlier in the list win. Returns the index of the name found or -1
+//-----------------------------------------------------------------------------
+int UTIL_FindEntitiesInMap(const char ** names, int numNames, float * origin, float * angle)
 {
-	int				n,found = 0;
+	int				n,found,best = -1;
 	char			keyname[256];
 	char			token[1024];
+	vec3_t			entOrigin, entAngle;
 
 	cl_entity_t *	pEnt = gEngfuncs.GetEntityByIndex( 0 );	// get world model
 
-	if ( !pEnt ) return 0;
+	if ( !pEnt ) return -1;
 
-	if ( !pEnt->model )	return 0;
+	if ( !pEnt->model )	return -1;
 
 	char * data = pEnt->model->entities;
 
@@ -225,17 +232,20 @@ int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
 
 		if (!data)
 		{
-			gEngfuncs.Con_DPrintf("UTIL_FindEntityInMap: EOF without closing brace\n");
-			return 0;
+			gEngfuncs.Con_DPrintf("UTIL_FindEntitiesInMap: EOF without closing brace\n");
+			return -1;
 		}
 
 		if (token[0] != '{')
 		{
-			gEngfuncs.Con_DPrintf("UTIL_FindEntityInMap: expected {\n");
-			return 0;
+			gEngfuncs.Con_DPrintf("UTIL_FindEntitiesInMap: expected {\n");
+			return -1;
 		}
 
 		// we parse the first { now parse entities properties
+		found = -1;
+		VectorCopy( vec3_origin, entOrigin );
+		VectorCopy( vec3_origin, entAngle );
 		
 		while ( 1 )
 		{	
@@ -246,8 +256,8 @@ int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
 
 			if (!data)
 			{	
-				gEngfuncs.Con_DPrintf("UTIL_FindEntityInMap: EOF without closing brace\n");
-				return 0;
+				gEngfuncs.Con_DPrintf("UTIL_FindEntitiesInMap: EOF without closing brace\n");
+				return -1;
 			};
 			
 			strcpy (keyname, token);
@@ -264,21 +274,25 @@ int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
 			data = gEngfuncs.COM_ParseFile(data, token);
 			if (!data)
 			{	
-				gEngfuncs.Con_DPrintf("UTIL_FindEntityInMap: EOF without closing brace\n");
-				return 0;
+				gEngfuncs.Con_DPrintf("UTIL_FindEntitiesInMap: EOF without closing brace\n");
+				return -1;
 			};
 	
 			if (token[0] == '}')
 			{
-				gEngfuncs.Con_DPrintf("UTIL_FindEntityInMap: closing brace without data");
-				return 0;
+				gEngfuncs.Con_DPrintf("UTIL_FindEntitiesInMap: closing brace without data");
+				return -1;
 			}
 
 			if (!strcmp(keyname,"classname"))
 			{
-				if (!strcmp(token, name ))
+				for ( int i = 0; i < numNames; i++ )
 				{
-					found = 1;	// thats our entity
+					if (!strcmp(token, names[i] ))
+					{
+						found = i;	// thats our entity
+						break;
+					}
 				}
 			};
 
@@ -288,42 +302,49 @@ int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
 				
 				if (y >= 0)
 				{
-					angle[0] = 0.0f;
-					angle[1] = y;
+					entAngle[0] = 0.0f;
+					entAngle[1] = y;
 				}
 				else if ((int)y == -1)
 				{
-					angle[0] = -90.0f;
-					angle[1] =   0.0f;;
+					entAngle[0] = -90.0f;
+					entAngle[1] =   0.0f;;
 				}
 				else
 				{
-					angle[0] = 90.0f;
-					angle[1] =  0.0f;
+					entAngle[0] = 90.0f;
+					entAngle[1] =  0.0f;
 				}
 
-				angle[2] =  0.0f;
+				entAngle[2] =  0.0f;
 			}
 
 			if( !strcmp( keyname, "angles" ) )
 			{
-				UTIL_StringToVector(angle, token);
+				UTIL_StringToVector(entAngle, token);
 			}
 			
 			if (!strcmp(keyname,"origin"))
 			{
-				UTIL_StringToVector(origin, token);
+				UTIL_StringToVector(entOrigin, token);
 
 			};
 				
 		} // while (1)
 
-		if (found)
-			return 1;
+		if ( found >= 0 && ( best < 0 || found < best ) )
+		{
+			best = found;
+			VectorCopy( entOrigin, origin );
+			VectorCopy( entAngle, angle );
 
+			// can't do better than the first name
+			if ( best == 0 )
+				break;
+		}
 	}
 
-	return 0;	// we search all entities, but didn't found the correct
+	return best;	// -1 if we search all entities, but didn't found the correct
 
 }
 
@@ -334,17 +355,10 @@ int UTIL_FindEntityInMap(char * name, float * origin, float * angle)
 
 void CHudSpectator::SetSpectatorStartPosition()
 {
-	// search for info_player start
-	if ( UTIL_FindEntityInMap( "trigger_camera",  m_cameraOrigin, m_cameraAngles ) )
-		iJumpSpectator = 1;
-
-	else if ( UTIL_FindEntityInMap( "info_player_start",  m_cameraOrigin, m_cameraAngles ) )
-		iJumpSpectator = 1;
+	static const char *startNames[] = { "trigger_camera", "info_player_start", "info_player_deathmatch", "info_player_coop" };
 
-	else if ( UTIL_FindEntityInMap( "info_player_deathmatch",  m_cameraOrigin, m_cameraAngles ) )
-		iJumpSpectator = 1;
-
-	else if ( UTIL_FindEntityInMap( "info_player_coop",  m_cameraOrigin, m_cameraAngles ) )
+	// search for info_player start
+	if ( UTIL_FindEntitiesInMap( startNames, sizeof( startNames ) / sizeof( startNames[0] ), m_cameraOrigin, m_cameraAngles ) >= 0 )
 		iJumpSpectator = 1;
 	else
 	{
@@ -385,7 +399,6 @@ int CHudSpectator::Draw(float flTime)
 {
 	int lx;
 
-	char string[256];
 	float * color;
 
 	// draw only in spectator mode
@@ -423,9 +436,7 @@ int CHudSpectator::Draw(float flTime)
 	if ( !m_drawnames->value )
 		return 1;
 	
-	// make sure we have player info
-	gViewPort->GetAllPlayersInfo();
-
+	bool bPlayerInfo = false;
 
 	// loop through all the players and draw additional infos to their sprites on the map
 	for (int i = 0; i < MAX_PLAYERS; i++)
@@ -433,6 +444,13 @@ int CHudSpectator::Draw(float flTime)
 
 		if ( m_vPlayerPos[i][2]<0 )	// marked as invisible ?
 			continue;
+
+		// make sure we have player info, only once some name is shown
+		if ( !bPlayerInfo )
+		{
+			gViewPort->GetAllPlayersInfo();
+			bPlayerInfo = true;
+		}
 		
 		// check if name would be in inset window
 		if ( m_pip->value != INSET_OFF )
@@ -447,12 +465,14 @@ int CHudSpectator::Draw(float flTime)
 		color = GetClientColor( i+1 );
 
 		// draw the players name and health underneath
-		sprintf(string, "%s", g_PlayerInfoList[i+1].name );
+		const char *name = g_PlayerInfoList[i+1].name;
+		if ( !name )
+			continue;
 		
-		lx = strlen(string)*3; // 3 is avg. character length :)
+		lx = strlen(name)*3; // 3 is avg. character length :)
 
 		gEngfuncs.pfnDrawSetTextColor( color[0], color[1], color[2] );
-		DrawConsoleString( m_vPlayerPos[i][0]-lx,m_vPlayerPos[i][1], string);
+		DrawConsoleString( m_vPlayerPos[i][0]-lx,m_vPlayerPos[i][1], name);
 		
 	}
 
@@ -1056,6 +1076,9 @@ bool CHudSpectator::ParseOverviewFile( )
 
 void CHudSpectator::LoadMapSprites()
 {
+	// tile count depends on the map image
+	m_bOverviewTilesValid = false;
+
 	// right now only support for one map layer
 	if (m_OverviewData.layers > 0 )
 	{
@@ -1065,15 +1088,15 @@ void CHudSpectator::LoadMapSprites()
 		m_MapSprite = NULL; // the standard "unkown map" sprite will be used instead
 }
 
-void CHudSpectator::DrawOverviewLayer()
+void CHudSpectator::BuildOverviewLayer()
 {
-	float screenaspect, xs, ys, xStep, yStep, x,y,z;
-	int ix,iy,i,xTiles,yTiles,frame;
+	float screenaspect, xs, ys, xStep, yStep, x,y;
+	int ix,iy,i,xTiles,yTiles;
 
-	qboolean	hasMapImage = m_MapSprite?TRUE:FALSE;
-	model_t *   dummySprite = (struct model_s *)gEngfuncs.GetSpritePointer( m_hsprUnkownMap);
+	m_OverviewTiles.clear();
+	m_bOverviewTilesValid = true;
 
-	if ( hasMapImage)
+	if ( m_MapSprite )
 	{
 		i = m_MapSprite->numframes / (4*3);
 		i = int(sqrt(double(i)));
@@ -1086,23 +1109,13 @@ void CHudSpectator::DrawOverviewLayer()
 		yTiles = 6;
 	}
 
-
 	screenaspect = 4.0f/3.0f;	
 
-
 	xs = m_OverviewData.origin[0];
 	ys = m_OverviewData.origin[1];
-	z  = ( 90.0f - v_angles[0] ) / 90.0f;		
-	z *= m_OverviewData.layersHeights[0]; // gOverviewData.z_min - 32;	
-
-	// i = r_overviewTexture + ( layer*OVERVIEW_X_TILES*OVERVIEW_Y_TILES );
-
-	gEngfuncs.pTriAPI->RenderMode( kRenderTransTexture );
-	gEngfuncs.pTriAPI->CullFace( TRI_NONE );
-	gEngfuncs.pTriAPI->Color4f( 1.0, 1.0, 1.0, 1.0 );
 
-	frame = 0;
-	
+	m_OverviewTiles.resize( xTiles * yTiles );
+	overviewTile_t *tile = m_OverviewTiles.data();
 
 	// rotated view ?
 	if ( m_OverviewData.rotated )
@@ -1116,28 +1129,22 @@ void CHudSpectator::DrawOverviewLayer()
 		{
 			x = xs - (4096.0f / (m_OverviewData.zoom));
 
-			for (ix = 0; ix < xTiles; ix++)
+			for (ix = 0; ix < xTiles; ix++, tile++)
 			{
-				if (hasMapImage)
-					gEngfuncs.pTriAPI->SpriteTexture( m_MapSprite, frame );
-				else
-					gEngfuncs.pTriAPI->SpriteTexture( dummySprite, 0 );
+				tile->frame = iy * xTiles + ix;
 
-				gEngfuncs.pTriAPI->Begin( TRI_QUADS );
-					gEngfuncs.pTriAPI->TexCoord2f( 0, 0 );
-					gEngfuncs.pTriAPI->Vertex3f (x, y, z);
+				tile->texcoords[0][0] = 0; tile->texcoords[0][1] = 0;
+				tile->xy[0][0] = x; tile->xy[0][1] = y;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 1, 0 );
-					gEngfuncs.pTriAPI->Vertex3f (x+xStep ,y,  z);
+				tile->texcoords[1][0] = 1; tile->texcoords[1][1] = 0;
+				tile->xy[1][0] = x+xStep; tile->xy[1][1] = y;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 1, 1 );
-					gEngfuncs.pTriAPI->Vertex3f (x+xStep, y+yStep, z);
+				tile->texcoords[2][0] = 1; tile->texcoords[2][1] = 1;
+				tile->xy[2][0] = x+xStep; tile->xy[2][1] = y+yStep;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 0, 1 );
-					gEngfuncs.pTriAPI->Vertex3f (x, y+yStep, z);
-				gEngfuncs.pTriAPI->End();
+				tile->texcoords[3][0] = 0; tile->texcoords[3][1] = 1;
+				tile->xy[3][0] = x; tile->xy[3][1] = y+yStep;
 
-				frame++;
 				x+= xStep;
 			}
 
@@ -1149,48 +1156,86 @@ void CHudSpectator::DrawOverviewLayer()
 		xStep = -(2*4096.0f / m_OverviewData.zoom ) / xTiles;
 		yStep = -(2*4096.0f / (m_OverviewData.zoom* screenaspect) ) / yTiles;
 
-				
 		x = xs + (4096.0f / (m_OverviewData.zoom * screenaspect ));
 
-		
-		
 		for (ix = 0; ix < yTiles; ix++)
 		{
-			
 			y = ys + (4096.0f / (m_OverviewData.zoom));	
 						
-			for (iy = 0; iy < xTiles; iy++)	
+			for (iy = 0; iy < xTiles; iy++, tile++)	
 			{
-				if (hasMapImage)
-					gEngfuncs.pTriAPI->SpriteTexture( m_MapSprite, frame );
-				else
-					gEngfuncs.pTriAPI->SpriteTexture( dummySprite, 0 );
+				tile->frame = ix * xTiles + iy;
 
-				gEngfuncs.pTriAPI->Begin( TRI_QUADS );
-					gEngfuncs.pTriAPI->TexCoord2f( 0, 0 );
-					gEngfuncs.pTriAPI->Vertex3f (x, y, z);
+				tile->texcoords[0][0] = 0; tile->texcoords[0][1] = 0;
+				tile->xy[0][0] = x; tile->xy[0][1] = y;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 0, 1 );
-					gEngfuncs.pTriAPI->Vertex3f (x+xStep ,y,  z);
+				tile->texcoords[1][0] = 0; tile->texcoords[1][1] = 1;
+				tile->xy[1][0] = x+xStep; tile->xy[1][1] = y;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 1, 1 );
-					gEngfuncs.pTriAPI->Vertex3f (x+xStep, y+yStep, z);
+				tile->texcoords[2][0] = 1; tile->texcoords[2][1] = 1;
+				tile->xy[2][0] = x+xStep; tile->xy[2][1] = y+yStep;
 
-					gEngfuncs.pTriAPI->TexCoord2f( 1, 0 );
-					gEngfuncs.pTriAPI->Vertex3f (x, y+yStep, z);
-				gEngfuncs.pTriAPI->End();
+				tile->texcoords[3][0] = 1; tile->texcoords[3][1] = 0;
+				tile->xy[3][0] = x; tile->xy[3][1] = y+yStep;
 
-				frame++;
-				
 				y+=yStep;
 			}
 
 			x+= xStep;
-			
 		}
 	}
 }
 
+void CHudSpectator::DrawOverviewLayer()
+{
+	float z;
+	int i,j;
+
+	if ( !m_bOverviewTilesValid )
+		BuildOverviewLayer();
+
+	qboolean	hasMapImage = m_MapSprite?TRUE:FALSE;
+	model_t *   dummySprite = (struct model_s *)gEngfuncs.GetSpritePointer( m_hsprUnkownMap);
+
+	// only the height follows the view pitch
+	z  = ( 90.0f - v_angles[0] ) / 90.0f;		
+	z *= m_OverviewData.layersHeights[0]; // gOverviewData.z_min - 32;	
+
+	gEngfuncs.pTriAPI->RenderMode( kRenderTransTexture );
+	gEngfuncs.pTriAPI->CullFace( TRI_NONE );
+	gEngfuncs.pTriAPI->Color4f( 1.0, 1.0, 1.0, 1.0 );
+
+	// the unknown map tile is the same texture everywhere, draw it in one go
+	if ( !hasMapImage )
+	{
+		gEngfuncs.pTriAPI->SpriteTexture( dummySprite, 0 );
+		gEngfuncs.pTriAPI->Begin( TRI_QUADS );
+	}
+
+	for (i = 0; i < (int)m_OverviewTiles.size(); i++)
+	{
+		const overviewTile_t *tile = &m_OverviewTiles[i];
+
+		if ( hasMapImage )
+		{
+			gEngfuncs.pTriAPI->SpriteTexture( m_MapSprite, tile->frame );
+			gEngfuncs.pTriAPI->Begin( TRI_QUADS );
+		}
+
+		for (j = 0; j < 4; j++)
+		{
+			gEngfuncs.pTriAPI->TexCoord2f( tile->texcoords[j][0], tile->texcoords[j][1] );
+			gEngfuncs.pTriAPI->Vertex3f( tile->xy[j][0], tile->xy[j][1], z );
+		}
+
+		if ( hasMapImage )
+			gEngfuncs.pTriAPI->End();
+	}
+
+	if ( !hasMapImage )
+		gEngfuncs.pTriAPI->End();
+}
+
 void CHudSpectator::DrawOverviewEntities()
 {
 	int				i,ir,ig,ib;
@@ -1215,92 +1260,142 @@ void CHudSpectator::DrawOverviewEntities()
 	for (i=0; i < MAX_PLAYERS; i++ )
 		m_vPlayerPos[i][2] = -1;	// mark as invisible 
 
-	// draw all players
+	// find the sprites in use, icons are drawn in one batch per sprite
+	SpriteHandle_t	sprites[MAX_OVERVIEW_ENTITIES];
+	int				numSprites = 0;
+	int				j;
+	bool			anyPlayers = false;
+
 	for (i=0 ; i < MAX_OVERVIEW_ENTITIES ; i++)
 	{
 		if ( !m_OverviewEntities[i].SpriteHandle_t )
 			continue;
 
-		SpriteHandle_tModel = (struct model_s *)gEngfuncs.GetSpritePointer( m_OverviewEntities[i].SpriteHandle_t );
-		ent = m_OverviewEntities[i].entity;
-		
-		gEngfuncs.pTriAPI->SpriteTexture( SpriteHandle_tModel, 0 );
-		gEngfuncs.pTriAPI->RenderMode( kRenderTransTexture );
+		if ( m_OverviewEntities[i].entity->player )
+			anyPlayers = true;
 
-		// see R_DrawSpriteModel
-		// draws players sprite
+		for (j = 0; j < numSprites; j++)
+		{
+			if ( sprites[j] == m_OverviewEntities[i].SpriteHandle_t )
+				break;
+		}
 
-		AngleVectors(ent->angles, right, up, NULL );
+		if ( j == numSprites )
+			sprites[numSprites++] = m_OverviewEntities[i].SpriteHandle_t;
+	}
 
-		VectorCopy(ent->origin,origin);
+	// draw all players
+	gEngfuncs.pTriAPI->RenderMode( kRenderTransTexture );
 
-		gEngfuncs.pTriAPI->Begin( TRI_QUADS );
+	for (j = 0; j < numSprites; j++)
+	{
+		SpriteHandle_tModel = (struct model_s *)gEngfuncs.GetSpritePointer( sprites[j] );
+		gEngfuncs.pTriAPI->SpriteTexture( SpriteHandle_tModel, 0 );
 
+		gEngfuncs.pTriAPI->Begin( TRI_QUADS );
 		gEngfuncs.pTriAPI->Color4f( 1.0, 1.0, 1.0, 1.0 );
-		
-		gEngfuncs.pTriAPI->TexCoord2f (1, 0);
-		VectorMA (origin,  16.0f * sizeScale, up, point);
-		VectorMA (point,   16.0f * sizeScale, right, point);
-		point[2] *= zScale;
-		gEngfuncs.pTriAPI->Vertex3fv (point);
 
-		gEngfuncs.pTriAPI->TexCoord2f (0, 0);
-		
-		VectorMA (origin,  16.0f * sizeScale, up, point);
-		VectorMA (point,  -16.0f * sizeScale, right, point);
-		point[2] *= zScale;
-		gEngfuncs.pTriAPI->Vertex3fv (point);
-
-		gEngfuncs.pTriAPI->TexCoord2f (0,1);
-		VectorMA (origin, -16.0f * sizeScale, up, point);
-		VectorMA (point,  -16.0f * sizeScale, right, point);
-		point[2] *= zScale;
-		gEngfuncs.pTriAPI->Vertex3fv (point);
-
-		gEngfuncs.pTriAPI->TexCoord2f (1,1);
-		VectorMA (origin, -16.0f * sizeScale, up, point);
-		VectorMA (point,   16.0f * sizeScale, right, point);
-		point[2] *= zScale;
-		gEngfuncs.pTriAPI->Vertex3fv (point);
+		for (i=0 ; i < MAX_OVERVIEW_ENTITIES ; i++)
+		{
+			if ( m_OverviewEntities[i].SpriteHandle_t != sprites[j] )
+				continue;
 
-		gEngfuncs.pTriAPI->End ();
+			ent = m_OverviewEntities[i].entity;
 
-		
-		if ( !ent->player)
-			continue;
-		// draw line under player icons
-		origin[2] *= zScale;
+			// see R_DrawSpriteModel
+			// draws players sprite
 
+			AngleVectors(ent->angles, right, up, NULL );
+
+			VectorCopy(ent->origin,origin);
+
+			gEngfuncs.pTriAPI->TexCoord2f (1, 0);
+			VectorMA (origin,  16.0f * sizeScale, up, point);
+			VectorMA (point,   16.0f * sizeScale, right, point);
+			point[2] *= zScale;
+			gEngfuncs.pTriAPI->Vertex3fv (point);
+
+			gEngfuncs.pTriAPI->TexCoord2f (0, 0);
+			
+			VectorMA (origin,  16.0f * sizeScale, up, point);
+			VectorMA (point,  -16.0f * sizeScale, right, point);
+			point[2] *= zScale;
+			gEngfuncs.pTriAPI->Vertex3fv (point);
+
+			gEngfuncs.pTriAPI->TexCoord2f (0,1);
+			VectorMA (origin, -16.0f * sizeScale, up, point);
+			VectorMA (point,  -16.0f * sizeScale, right, point);
+			point[2] *= zScale;
+			gEngfuncs.pTriAPI->Vertex3fv (point);
+
+			gEngfuncs.pTriAPI->TexCoord2f (1,1);
+			VectorMA (origin, -16.0f * sizeScale, up, point);
+			VectorMA (point,   16.0f * sizeScale, right, point);
+			point[2] *= zScale;
+			gEngfuncs.pTriAPI->Vertex3fv (point);
+		}
+
+		gEngfuncs.pTriAPI->End ();
+	}
+
+	if ( anyPlayers )
+	{
+		// draw lines under player icons, all with the same beam sprite
 		gEngfuncs.pTriAPI->RenderMode( kRenderTransAdd );
 		
 		SpriteHandle_tModel = (struct model_s *)gEngfuncs.GetSpritePointer( m_hsprBeam );
 		gEngfuncs.pTriAPI->SpriteTexture( SpriteHandle_tModel, 0 );
-		
-		gEngfuncs.pTriAPI->Color4f(r, g, b, 0.3);
 
 		gEngfuncs.pTriAPI->Begin ( TRI_QUADS );
-		gEngfuncs.pTriAPI->TexCoord2f (1, 0);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]+4, origin[2]-zScale);
-		gEngfuncs.pTriAPI->TexCoord2f (0, 0);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]-4, origin[2]-zScale);
-		gEngfuncs.pTriAPI->TexCoord2f (0, 1);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]-4,z);
-		gEngfuncs.pTriAPI->TexCoord2f (1, 1);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]+4,z);
-		gEngfuncs.pTriAPI->End ();
+		gEngfuncs.pTriAPI->Color4f(r, g, b, 0.3);
+
+		for (i=0 ; i < MAX_OVERVIEW_ENTITIES ; i++)
+		{
+			if ( !m_OverviewEntities[i].SpriteHandle_t )
+				continue;
+
+			ent = m_OverviewEntities[i].entity;
+			if ( !ent->player)
+				continue;
+
+			VectorCopy(ent->origin,origin);
+			origin[2] *= zScale;
+
+			gEngfuncs.pTriAPI->TexCoord2f (1, 0);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]+4, origin[2]-zScale);
+			gEngfuncs.pTriAPI->TexCoord2f (0, 0);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]-4, origin[2]-zScale);
+			gEngfuncs.pTriAPI->TexCoord2f (0, 1);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]-4,z);
+			gEngfuncs.pTriAPI->TexCoord2f (1, 1);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]+4,z);
+
+			gEngfuncs.pTriAPI->TexCoord2f (1, 0);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]+4, origin[2]-zScale);
+			gEngfuncs.pTriAPI->TexCoord2f (0, 0);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]-4, origin[2]-zScale);
+			gEngfuncs.pTriAPI->TexCoord2f (0, 1);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]-4,z);
+			gEngfuncs.pTriAPI->TexCoord2f (1, 1);
+			gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]+4,z);
+		}
 
-		gEngfuncs.pTriAPI->Begin ( TRI_QUADS );
-		gEngfuncs.pTriAPI->TexCoord2f (1, 0);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]+4, origin[2]-zScale);
-		gEngfuncs.pTriAPI->TexCoord2f (0, 0);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]-4, origin[2]-zScale);
-		gEngfuncs.pTriAPI->TexCoord2f (0, 1);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]+4, origin[1]-4,z);
-		gEngfuncs.pTriAPI->TexCoord2f (1, 1);
-		gEngfuncs.pTriAPI->Vertex3f (origin[0]-4, origin[1]+4,z);
 		gEngfuncs.pTriAPI->End ();
+	}
+
+	// calculate screen position for name and infromation in hud::draw()
+	for (i=0 ; i < MAX_OVERVIEW_ENTITIES && anyPlayers ; i++)
+	{
+		if ( !m_OverviewEntities[i].SpriteHandle_t )
+			continue;
+
+		ent = m_OverviewEntities[i].entity;
+		if ( !ent->player)
+			continue;
+
+		VectorCopy(ent->origin,origin);
+		origin[2] *= zScale;
 
-		// calculate screen position for name and infromation in hud::draw()
 		if ( gEngfuncs.pTriAPI->WorldToScreen(origin,screen) )
 			continue;	// object is behind viewer
 
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "cl_entity.h"
+#include <vector>
 
 
 
@@ -54,6 +55,13 @@ typedef struct overviewEntity_s {
 
 #define	 MAX_OVERVIEW_ENTITIES		128
 
+// One map image tile of the overview layer, corners in draw order
+typedef struct overviewTile_s {
+	int			frame;
+	float		xy[4][2];
+	float		texcoords[4][2];
+} overviewTile_t;
+
 class CHudSpectator : public CHudBase
 {
 public:
@@ -69,6 +77,7 @@ public:
 	void DrawOverviewEntities();
 	void GetMapPosition( float * returnvec );
 	void DrawOverviewLayer();
+	void BuildOverviewLayer();
 	void LoadMapSprites();
 	bool ParseOverviewFile();
 	bool IsActivePlayer(cl_entity_t * ent);
@@ -122,6 +131,10 @@ private:
 	wrect_t		m_crosshairRect;
 
 	struct model_s * m_MapSprite;	// each layer image is saved in one sprite, where each tile is a sprite frame
+
+	// Overview tiles only depend on the overview file, so they're built once per map
+	std::vector<overviewTile_t>	m_OverviewTiles;
+	bool		m_bOverviewTilesValid;
 	float		m_flNextObserverInput;
 	float		m_zoomDelta;
 	float		m_moveDelta;
@@ -0,0 +1,357 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Batches additive HUD sprites into a few quad lists per frame
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <algorithm>
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "triangleapi.h"
+
+#include "hud_spritebatch.h"
+
+// Class declaration
+CHudSpriteBatch g_HudSpriteBatch;
+
+extern mspriteframe_t* GetSpriteFrame( model_t* mod, int frame );
+
+/*
+====================
+QuadBatchLess
+
+====================
+*/
+static bool QuadBatchLess( const hudspritequad_t& a, const hudspritequad_t& b )
+{
+	if (a.pmodel != b.pmodel)
+		return a.pmodel < b.pmodel;
+
+	return a.frame < b.frame;
+}
+
+/*
+====================
+CHudSpriteBatch
+
+====================
+*/
+CHudSpriteBatch::CHudSpriteBatch( void )
+{
+	m_bActive = false;
+	m_hCurrentSprite = 0;
+	m_currentColor[0] = m_currentColor[1] = m_currentColor[2] = 255;
+	m_pCvarBatch = NULL;
+	m_bHooked = false;
+}
+
+/*
+====================
+Init
+
+====================
+*/
+void CHudSpriteBatch::Init( void )
+{
+	m_pCvarBatch = CVAR_CREATE( "hud_batch", "1", FCVAR_ARCHIVE );
+
+	m_quads.reserve(256);
+}
+
+/*
+====================
+Begin
+
+====================
+*/
+void CHudSpriteBatch::Begin( void )
+{
+	m_quads.clear();
+	m_bActive = m_pCvarBatch && m_pCvarBatch->value > 0;
+
+	if (m_bActive)
+		HookEngine();
+}
+
+/*
+====================
+HookEngine
+
+====================
+*/
+void CHudSpriteBatch::HookEngine( void )
+{
+	if (m_bHooked)
+		return;
+
+	m_engineFuncs = gEngfuncs;
+
+	m_batchTriAPI = *gEngfuncs.pTriAPI;
+	m_batchTriAPI.RenderMode = HookRenderMode;
+	m_batchTriAPI.Begin = HookBegin;
+
+	gEngfuncs.pfnSPR_Draw = HookSPR_Draw;
+	gEngfuncs.pfnSPR_DrawHoles = HookSPR_DrawHoles;
+	gEngfuncs.pfnSPR_DrawAdditive = HookSPR_DrawAdditive;
+	gEngfuncs.pfnSPR_EnableScissor = HookSPR_EnableScissor;
+	gEngfuncs.pfnSPR_DisableScissor = HookSPR_DisableScissor;
+	gEngfuncs.pfnFillRGBA = HookFillRGBA;
+	gEngfuncs.pfnDrawCharacter = HookDrawCharacter;
+	gEngfuncs.pfnDrawConsoleString = HookDrawConsoleString;
+	gEngfuncs.pTriAPI = &m_batchTriAPI;
+
+	m_bHooked = true;
+}
+
+/*
+====================
+UnhookEngine
+
+====================
+*/
+void CHudSpriteBatch::UnhookEngine( void )
+{
+	if (!m_bHooked)
+		return;
+
+	gEngfuncs.pfnSPR_Draw = m_engineFuncs.pfnSPR_Draw;
+	gEngfuncs.pfnSPR_DrawHoles = m_engineFuncs.pfnSPR_DrawHoles;
+	gEngfuncs.pfnSPR_DrawAdditive = m_engineFuncs.pfnSPR_DrawAdditive;
+	gEngfuncs.pfnSPR_EnableScissor = m_engineFuncs.pfnSPR_EnableScissor;
+	gEngfuncs.pfnSPR_DisableScissor = m_engineFuncs.pfnSPR_DisableScissor;
+	gEngfuncs.pfnFillRGBA = m_engineFuncs.pfnFillRGBA;
+	gEngfuncs.pfnDrawCharacter = m_engineFuncs.pfnDrawCharacter;
+	gEngfuncs.pfnDrawConsoleString = m_engineFuncs.pfnDrawConsoleString;
+	gEngfuncs.pTriAPI = m_engineFuncs.pTriAPI;
+
+	m_bHooked = false;
+}
+
+// ================================= //
+// =====	Engine hooks		===== //
+// ================================= //
+
+// Anything drawn outside the batch has to land on top of what was
+// batched before it, so the pending quads go out first
+
+void CHudSpriteBatch::HookSPR_Draw( int frame, int x, int y, const wrect_t* prc )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnSPR_Draw(frame, x, y, prc);
+}
+
+void CHudSpriteBatch::HookSPR_DrawHoles( int frame, int x, int y, const wrect_t* prc )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnSPR_DrawHoles(frame, x, y, prc);
+}
+
+void CHudSpriteBatch::HookSPR_DrawAdditive( int frame, int x, int y, const wrect_t* prc )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnSPR_DrawAdditive(frame, x, y, prc);
+}
+
+void CHudSpriteBatch::HookSPR_EnableScissor( int x, int y, int width, int height )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnSPR_EnableScissor(x, y, width, height);
+}
+
+void CHudSpriteBatch::HookSPR_DisableScissor( void )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnSPR_DisableScissor();
+}
+
+void CHudSpriteBatch::HookFillRGBA( int x, int y, int width, int height, int r, int g, int b, int a )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pfnFillRGBA(x, y, width, height, r, g, b, a);
+}
+
+int CHudSpriteBatch::HookDrawCharacter( int x, int y, int number, int r, int g, int b )
+{
+	g_HudSpriteBatch.Submit();
+	return g_HudSpriteBatch.m_engineFuncs.pfnDrawCharacter(x, y, number, r, g, b);
+}
+
+int CHudSpriteBatch::HookDrawConsoleString( int x, int y, char* string )
+{
+	g_HudSpriteBatch.Submit();
+	return g_HudSpriteBatch.m_engineFuncs.pfnDrawConsoleString(x, y, string);
+}
+
+void CHudSpriteBatch::HookRenderMode( int mode )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pTriAPI->RenderMode(mode);
+}
+
+void CHudSpriteBatch::HookBegin( int primitiveCode )
+{
+	g_HudSpriteBatch.Submit();
+	g_HudSpriteBatch.m_engineFuncs.pTriAPI->Begin(primitiveCode);
+}
+
+/*
+====================
+Set
+
+====================
+*/
+void CHudSpriteBatch::Set( SpriteHandle_t hspr, int r, int g, int b )
+{
+	if (!m_bActive)
+	{
+		SPR_Set(hspr, r, g, b);
+		return;
+	}
+
+	m_hCurrentSprite = hspr;
+	m_currentColor[0] = clamp(r, 0, 255);
+	m_currentColor[1] = clamp(g, 0, 255);
+	m_currentColor[2] = clamp(b, 0, 255);
+}
+
+/*
+====================
+DrawAdditive
+
+====================
+*/
+void CHudSpriteBatch::DrawAdditive( int frame, int x, int y, const wrect_t* prc )
+{
+	if (!m_bActive)
+	{
+		SPR_DrawAdditive(frame, x, y, prc);
+		return;
+	}
+
+	if (!m_hCurrentSprite)
+		return;
+
+	model_t* pmodel = (model_t*)gEngfuncs.GetSpritePointer(m_hCurrentSprite);
+	if (!pmodel)
+		return;
+
+	mspriteframe_t* pframe = GetSpriteFrame(pmodel, frame);
+	if (!pframe || pframe->width <= 0 || pframe->height <= 0)
+		return;
+
+	wrect_t rc;
+	if (prc)
+	{
+		rc = *prc;
+	}
+	else
+	{
+		rc.left = rc.top = 0;
+		rc.right = pframe->width;
+		rc.bottom = pframe->height;
+	}
+
+	// Same clipping to the frame the engine does
+	rc.left = max(rc.left, 0);
+	rc.top = max(rc.top, 0);
+	rc.right = min(rc.right, pframe->width);
+	rc.bottom = min(rc.bottom, pframe->height);
+
+	if (rc.right <= rc.left || rc.bottom <= rc.top)
+		return;
+
+	hudspritequad_t quad;
+	quad.pmodel = pmodel;
+	quad.frame = frame;
+	quad.x = x + gHUD.m_flHudLagOfs[0];
+	quad.y = y + gHUD.m_flHudLagOfs[1];
+	quad.width = rc.right - rc.left;
+	quad.height = rc.bottom - rc.top;
+	quad.texcoords[0] = (float)rc.left / pframe->width;
+	quad.texcoords[1] = (float)rc.top / pframe->height;
+	quad.texcoords[2] = (float)rc.right / pframe->width;
+	quad.texcoords[3] = (float)rc.bottom / pframe->height;
+	quad.color[0] = m_currentColor[0];
+	quad.color[1] = m_currentColor[1];
+	quad.color[2] = m_currentColor[2];
+
+	m_quads.push_back(quad);
+}
+
+/*
+====================
+Flush
+
+====================
+*/
+void CHudSpriteBatch::Flush( void )
+{
+	Submit();
+	UnhookEngine();
+
+	m_bActive = false;
+}
+
+/*
+====================
+Submit
+
+Draws the pending quads. Called before every draw the
+batch doesn't own, so they're all additive and adjacent.
+====================
+*/
+void CHudSpriteBatch::Submit( void )
+{
+	if (m_quads.empty())
+		return;
+
+	std::sort(m_quads.begin(), m_quads.end(), QuadBatchLess);
+
+	// Straight to the engine, the hooks would come back here
+	triangleapi_t* pTriAPI = m_engineFuncs.pTriAPI;
+
+	pTriAPI->RenderMode(kRenderTransAdd);
+	pTriAPI->CullFace(TRI_NONE);
+	pTriAPI->Brightness(1.0);
+
+	size_t first = 0;
+	while (first < m_quads.size())
+	{
+		size_t end = first + 1;
+		while (end < m_quads.size() && !QuadBatchLess(m_quads[first], m_quads[end]))
+			end++;
+
+		pTriAPI->SpriteTexture(m_quads[first].pmodel, m_quads[first].frame);
+		pTriAPI->Begin(TRI_QUADS);
+
+		for (size_t i = first; i < end; i++)
+		{
+			const hudspritequad_t& quad = m_quads[i];
+
+			pTriAPI->Color4ub(quad.color[0], quad.color[1], quad.color[2], 255);
+
+			pTriAPI->TexCoord2f(quad.texcoords[0], quad.texcoords[1]);
+			pTriAPI->Vertex3f(quad.x, quad.y, 0);
+
+			pTriAPI->TexCoord2f(quad.texcoords[0], quad.texcoords[3]);
+			pTriAPI->Vertex3f(quad.x, quad.y + quad.height, 0);
+
+			pTriAPI->TexCoord2f(quad.texcoords[2], quad.texcoords[3]);
+			pTriAPI->Vertex3f(quad.x + quad.width, quad.y + quad.height, 0);
+
+			pTriAPI->TexCoord2f(quad.texcoords[2], quad.texcoords[1]);
+			pTriAPI->Vertex3f(quad.x + quad.width, quad.y, 0);
+		}
+
+		pTriAPI->End();
+		first = end;
+	}
+
+	pTriAPI->RenderMode(kRenderNormal);
+	pTriAPI->CullFace(TRI_FRONT);
+
+	m_quads.clear();
+}
@@ -0,0 +1,93 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Batches additive HUD sprites into a few quad lists per frame
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( HUD_SPRITEBATCH_H )
+#define HUD_SPRITEBATCH_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+#include <vector>
+#include "triangleapi.h"
+
+struct hudspritequad_t
+{
+	// Sprite and frame, quads are grouped by these
+	struct model_s*	pmodel;
+	int				frame;
+
+	float			x, y;
+	float			width, height;
+	float			texcoords[4];
+	byte			color[3];
+};
+
+/*
+====================
+CHudSpriteBatch
+
+Drop-in for SPR_Set/SPR_DrawAdditive. While active,
+the engine's HUD draw functions and the triangle API
+are routed through the batch, and any draw that isn't
+batched submits the pending quads first. Pending quads
+are then always one unbroken run of additive draws,
+which don't depend on order, so they're sorted by
+texture without changing the result.
+====================
+*/
+class CHudSpriteBatch
+{
+public:
+	CHudSpriteBatch( void );
+
+public:
+	void Init( void );
+
+	// hud_redraw.cpp -> CHud::Redraw()
+	void Begin( void );
+	void Flush( void );
+
+	void Set( SpriteHandle_t hspr, int r, int g, int b );
+	void DrawAdditive( int frame, int x, int y, const wrect_t* prc );
+
+private:
+	void Submit( void );
+
+	void HookEngine( void );
+	void UnhookEngine( void );
+
+	// Installed in gEngfuncs between Begin and Flush
+	static void HookSPR_Draw( int frame, int x, int y, const wrect_t* prc );
+	static void HookSPR_DrawHoles( int frame, int x, int y, const wrect_t* prc );
+	static void HookSPR_DrawAdditive( int frame, int x, int y, const wrect_t* prc );
+	static void HookSPR_EnableScissor( int x, int y, int width, int height );
+	static void HookSPR_DisableScissor( void );
+	static void HookFillRGBA( int x, int y, int width, int height, int r, int g, int b, int a );
+	static int HookDrawCharacter( int x, int y, int number, int r, int g, int b );
+	static int HookDrawConsoleString( int x, int y, char* string );
+	static void HookRenderMode( int mode );
+	static void HookBegin( int primitiveCode );
+
+private:
+	std::vector<hudspritequad_t> m_quads;
+
+	// Between Begin and Flush, draws outside it go straight to the engine
+	bool			m_bActive;
+
+	SpriteHandle_t	m_hCurrentSprite;
+	byte			m_currentColor[3];
+
+	cvar_t*			m_pCvarBatch;
+
+	// What gEngfuncs held before HookEngine, the batch draws through these
+	cl_enginefunc_t	m_engineFuncs;
+	triangleapi_t	m_batchTriAPI;
+	bool			m_bHooked;
+};
+
+extern CHudSpriteBatch g_HudSpriteBatch;
+#endif // HUD_SPRITEBATCH_H
@@ -0,0 +1,287 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Grid of ambient light probes sampled from the world lightmaps
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <memory.h>
+#include <math.h>
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "studio_util.h"
+#include "r_studioint.h"
+#include "pm_defs.h"
+
+#include "r_lightgrid.h"
+
+// How far below the highest usable floor a probe may sit before
+// it's considered to be in a different room
+#define LIGHTGRID_FLOOR_TOLERANCE	48
+
+// Class declaration
+CLightProbeGrid g_LightProbeGrid;
+
+extern engine_studio_api_t IEngineStudio;
+extern int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, const vec3_t &end, vec3_t &color, vec3_t *pimpact );
+
+/*
+====================
+CLightProbeGrid
+
+====================
+*/
+CLightProbeGrid::CLightProbeGrid( void )
+{
+	m_pWorld = NULL;
+	m_flSpacing = LIGHTGRID_SPACING;
+	m_pCvarLightGrid = NULL;
+
+	VectorClear(m_vMins);
+	m_iSize[0] = m_iSize[1] = m_iSize[2] = 0;
+}
+
+/*
+====================
+Init
+
+====================
+*/
+void CLightProbeGrid::Init( void )
+{
+	m_pCvarLightGrid = CVAR_CREATE( "r_lightgrid", "1", FCVAR_ARCHIVE );
+}
+
+/*
+====================
+VidInit
+
+====================
+*/
+void CLightProbeGrid::VidInit( void )
+{
+	// Grid is rebuilt for the new world on first use
+	m_probes.clear();
+	m_pWorld = NULL;
+}
+
+/*
+====================
+SetupGrid
+
+====================
+*/
+bool CLightProbeGrid::SetupGrid( void )
+{
+	model_t* pworld = IEngineStudio.GetModelByIndex(1);
+	if (!pworld || !pworld->lightdata)
+		return false;
+
+	if (pworld == m_pWorld)
+		return !m_probes.empty();
+
+	m_pWorld = pworld;
+	m_probes.clear();
+
+	// Probes are only allocated here, they get sampled the
+	// first time an entity needs them so loading isn't slowed down
+	m_flSpacing = LIGHTGRID_SPACING;
+	while (true)
+	{
+		int numprobes = 1;
+		for (int i = 0; i < 3; i++)
+		{
+			m_iSize[i] = (int)ceil((pworld->maxs[i] - pworld->mins[i]) / m_flSpacing) + 1;
+			if (m_iSize[i] < 2)
+				m_iSize[i] = 2;
+
+			numprobes *= m_iSize[i];
+		}
+
+		if (numprobes <= LIGHTGRID_MAX_PROBES)
+		{
+			lightprobe_t emptyprobe;
+			memset(&emptyprobe, 0, sizeof(emptyprobe));
+
+			m_probes.resize(numprobes, emptyprobe);
+			break;
+		}
+
+		m_flSpacing *= 2;
+	}
+
+	VectorCopy(pworld->mins, m_vMins);
+	return true;
+}
+
+/*
+====================
+GetProbe
+
+====================
+*/
+lightprobe_t* CLightProbeGrid::GetProbe( int x, int y, int z )
+{
+	lightprobe_t* pprobe = &m_probes[(z * m_iSize[1] + y) * m_iSize[0] + x];
+	if (!(pprobe->flags & LIGHTPROBE_SAMPLED))
+		SampleProbe(pprobe, x, y, z);
+
+	return pprobe;
+}
+
+/*
+====================
+SampleProbe
+
+====================
+*/
+void CLightProbeGrid::SampleProbe( lightprobe_t* pprobe, int x, int y, int z )
+{
+	pprobe->flags = LIGHTPROBE_SAMPLED;
+
+	Vector vecSrc;
+	vecSrc.x = m_vMins[0] + x * m_flSpacing;
+	vecSrc.y = m_vMins[1] + y * m_flSpacing;
+	vecSrc.z = m_vMins[2] + z * m_flSpacing;
+
+	if (gEngfuncs.PM_PointContents(vecSrc, NULL) == CONTENTS_SOLID)
+		return;
+
+	Vector vecEnd = vecSrc - Vector(0, 0, 8192);
+
+	// Get main sample
+	Vector lightcolor;
+	Vector impact;
+	if (!RecursiveLightPoint(m_pWorld, m_pWorld->nodes, vecSrc, vecEnd, lightcolor, &impact))
+		return;
+
+	// Shifted samples that miss keep the last color
+	Vector color = lightcolor;
+	float values[4];
+
+	// Get sample 1
+	Vector shiftSrc = vecSrc - Vector(16, 16, 0);
+	Vector shiftEnd = vecEnd - Vector(16, 16, 0);
+
+	RecursiveLightPoint(m_pWorld, m_pWorld->nodes, shiftSrc, shiftEnd, color, NULL);
+	values[0] = (color.x + color.y + color.z) / 3.0f;
+
+	// Get sample 2
+	shiftSrc = shiftSrc + Vector(32, 0, 0);
+	shiftEnd = shiftEnd + Vector(32, 0, 0);
+
+	RecursiveLightPoint(m_pWorld, m_pWorld->nodes, shiftSrc, shiftEnd, color, NULL);
+	values[1] = (color.x + color.y + color.z) / 3.0f;
+
+	// Get sample 3
+	shiftSrc = shiftSrc + Vector(0, 32, 0);
+	shiftEnd = shiftEnd + Vector(0, 32, 0);
+
+	RecursiveLightPoint(m_pWorld, m_pWorld->nodes, shiftSrc, shiftEnd, color, NULL);
+	values[2] = (color.x + color.y + color.z) / 3.0f;
+
+	// Get sample 4
+	shiftSrc = shiftSrc - Vector(32, 0, 0);
+	shiftEnd = shiftEnd - Vector(32, 0, 0);
+
+	RecursiveLightPoint(m_pWorld, m_pWorld->nodes, shiftSrc, shiftEnd, color, NULL);
+	values[3] = (color.x + color.y + color.z) / 3.0f;
+
+	VectorCopy(lightcolor, pprobe->color);
+	pprobe->gradient[0] = values[0] - values[1] - values[2] + values[3];
+	pprobe->gradient[1] = values[1] + values[0] - values[2] - values[3];
+	pprobe->floorz = impact.z;
+	pprobe->flags |= LIGHTPROBE_VALID;
+}
+
+/*
+====================
+GetLighting
+
+====================
+*/
+bool CLightProbeGrid::GetLighting( const Vector& position, Vector& color, Vector& direction )
+{
+	if (!m_pCvarLightGrid || m_pCvarLightGrid->value < 1)
+		return false;
+
+	if (!SetupGrid())
+		return false;
+
+	int cell[3];
+	float frac[3];
+	for (int i = 0; i < 3; i++)
+	{
+		float f = (position[i] - m_vMins[i]) / m_flSpacing;
+		cell[i] = (int)floor(f);
+
+		if (cell[i] < 0)
+			cell[i] = 0;
+		else if (cell[i] > m_iSize[i] - 2)
+			cell[i] = m_iSize[i] - 2;
+
+		frac[i] = f - cell[i];
+		if (frac[i] < 0)
+			frac[i] = 0;
+		else if (frac[i] > 1)
+			frac[i] = 1;
+	}
+
+	lightprobe_t* pprobes[8];
+	float weights[8];
+	float bestfloor = -99999;
+
+	for (int i = 0; i < 8; i++)
+	{
+		int dx = i & 1;
+		int dy = (i >> 1) & 1;
+		int dz = (i >> 2) & 1;
+
+		weights[i] = (dx ? frac[0] : 1 - frac[0])
+			* (dy ? frac[1] : 1 - frac[1])
+			* (dz ? frac[2] : 1 - frac[2]);
+
+		pprobes[i] = GetProbe(cell[0] + dx, cell[1] + dy, cell[2] + dz);
+
+		// Probes standing on a floor above us are in another room
+		if (!(pprobes[i]->flags & LIGHTPROBE_VALID) || pprobes[i]->floorz > position.z)
+		{
+			pprobes[i] = NULL;
+			continue;
+		}
+
+		if (pprobes[i]->floorz > bestfloor)
+			bestfloor = pprobes[i]->floorz;
+	}
+
+	float totalweight = 0;
+	float gradient[2] = { 0, 0 };
+	color = Vector(0, 0, 0);
+
+	for (int i = 0; i < 8; i++)
+	{
+		if (!pprobes[i])
+			continue;
+
+		// Same for probes whose floor is far below the nearest one
+		if (pprobes[i]->floorz < bestfloor - LIGHTGRID_FLOOR_TOLERANCE)
+			continue;
+
+		VectorMA(color, weights[i], pprobes[i]->color, color);
+		gradient[0] += pprobes[i]->gradient[0] * weights[i];
+		gradient[1] += pprobes[i]->gradient[1] * weights[i];
+		totalweight += weights[i];
+	}
+
+	if (totalweight < 0.001)
+		return false;
+
+	VectorScale(color, 1.0f / totalweight, color);
+	direction[0] = gradient[0] / totalweight;
+	direction[1] = gradient[1] / totalweight;
+	direction[2] = -1;
+
+	return true;
+}
@@ -0,0 +1,77 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( R_LIGHTGRID_H )
+#define R_LIGHTGRID_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+#include <vector>
+
+// Distance between two probes on each axis
+#define LIGHTGRID_SPACING		64
+// Upper limit on probe count, spacing is doubled until the world fits
+#define LIGHTGRID_MAX_PROBES	131072
+
+#define LIGHTPROBE_SAMPLED		1	// Probe has been sampled from the lightmaps
+#define LIGHTPROBE_VALID		2	// Probe is in open space and hit a lit surface
+
+struct lightprobe_t
+{
+	byte	flags;
+
+	// Ambient term
+	float	color[3];
+
+	// Horizontal light gradient, same as the four shifted
+	// samples GetModelLighting used to take every frame
+	float	gradient[2];
+
+	// Height of the lit surface below the probe
+	float	floorz;
+};
+
+/*
+====================
+CLightProbeGrid
+
+====================
+*/
+class CLightProbeGrid
+{
+public:
+	CLightProbeGrid( void );
+
+public:
+	void Init( void );
+	void VidInit( void );
+
+	// studio_util.cpp -> GetModelLighting()
+	// Returns false if no probe around the point can be used
+	bool GetLighting( const Vector& position, Vector& color, Vector& direction );
+
+private:
+	bool SetupGrid( void );
+	lightprobe_t* GetProbe( int x, int y, int z );
+	void SampleProbe( lightprobe_t* pprobe, int x, int y, int z );
+
+private:
+	std::vector<lightprobe_t> m_probes;
+
+	// World the grid was set up for
+	model_t*	m_pWorld;
+
+	vec3_t		m_vMins;
+	int			m_iSize[3];
+	float		m_flSpacing;
+
+	cvar_t*		m_pCvarLightGrid;
+};
+
+extern CLightProbeGrid g_LightProbeGrid;
+#endif // R_LIGHTGRID_H
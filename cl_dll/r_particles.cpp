@@ -0,0 +1,518 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Pooled bullet impact debris and smoke puffs
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <memory.h>
+#include <math.h>
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "triangleapi.h"
+#include "pm_defs.h"
+
+#include "r_particles.h"
+#include "fog.h"
+
+// Class declaration
+CImpactParticles g_ImpactParticles;
+
+extern vec3_t v_angles;
+extern mspriteframe_t* GetSpriteFrame( model_t* mod, int frame );
+
+// Debris sprites for each impact material
+static const char* g_szDebrisSprites[NUM_IMPACT_MATERIALS][MAX_MATERIAL_SPRITES] =
+{
+	{ "sprites/debris/debris_concrete01.spr", "sprites/debris/debris_concrete02.spr", "sprites/debris/debris_concrete03.spr", "sprites/debris/debris_concrete04.spr" },
+	{ "sprites/debris/debris_metal01.spr", "sprites/debris/debris_metal02.spr", "sprites/debris/debris_metal03.spr", NULL },
+	{ "sprites/debris/debris_wood01.spr", "sprites/debris/debris_wood02.spr", "sprites/debris/debris_wood03.spr", NULL },
+	{ "sprites/debris/debris_dirt01.spr", "sprites/debris/debris_dirt02.spr", "sprites/debris/debris_dirt03.spr", "sprites/debris/debris_dirt04.spr" },
+	{ "sprites/debris/debris_glass01.spr", "sprites/debris/debris_glass02.spr", "sprites/debris/debris_glass03.spr", "sprites/debris/debris_glass04.spr" },
+	{ "sprites/debris/debris_computer01.spr", "sprites/debris/debris_computer02.spr", "sprites/debris/debris_computer03.spr", "sprites/debris/debris_computer04.spr" }
+};
+
+/*
+====================
+CImpactParticles
+
+====================
+*/
+CImpactParticles::CImpactParticles( void )
+{
+	memset(m_debrisPools, 0, sizeof(m_debrisPools));
+	memset(m_iNumDebrisSprites, 0, sizeof(m_iNumDebrisSprites));
+	memset(&m_puffPool, 0, sizeof(m_puffPool));
+
+	m_bSpritesLoaded = false;
+	m_flTime = 0;
+	m_iContentsFrame = 0;
+}
+
+/*
+====================
+Init
+
+====================
+*/
+void CImpactParticles::Init( void )
+{
+	// Same settings the tempents used to be spawned with
+	for (int i = 0; i < NUM_IMPACT_MATERIALS; i++)
+	{
+		m_iNumDebrisSprites[i] = 0;
+		for (int j = 0; j < MAX_MATERIAL_SPRITES; j++)
+		{
+			if (!g_szDebrisSprites[i][j])
+				break;
+
+			particlepool_t* ppool = &m_debrisPools[i][j];
+			ppool->pszSprite = g_szDebrisSprites[i][j];
+			ppool->rendermode = kRenderTransAlpha;
+			ppool->gravity = 0.5;
+			ppool->framerate = 0;
+			ppool->fadespeed = 0;
+			ppool->life = 20.0;
+			m_iNumDebrisSprites[i]++;
+		}
+	}
+
+	m_puffPool.pszSprite = "sprites/debris/smokepuff.spr";
+	m_puffPool.rendermode = kRenderTransAdd;
+	m_puffPool.gravity = 0;
+	m_puffPool.framerate = 25.0;
+	m_puffPool.fadespeed = 3.0;
+	m_puffPool.life = 0.3;
+}
+
+/*
+====================
+VidInit
+
+====================
+*/
+void CImpactParticles::VidInit( void )
+{
+	for (int i = 0; i < NUM_IMPACT_MATERIALS; i++)
+	{
+		for (int j = 0; j < m_iNumDebrisSprites[i]; j++)
+		{
+			m_debrisPools[i][j].pmodel = NULL;
+			m_debrisPools[i][j].count = 0;
+		}
+	}
+
+	m_puffPool.pmodel = NULL;
+	m_puffPool.count = 0;
+
+	m_bSpritesLoaded = false;
+	m_flTime = 0;
+	m_iContentsFrame = 0;
+}
+
+/*
+====================
+LoadSprites
+
+====================
+*/
+void CImpactParticles::LoadSprites( void )
+{
+	particlepool_t* ppools[NUM_IMPACT_MATERIALS * MAX_MATERIAL_SPRITES + 1];
+	int numpools = 0;
+
+	for (int i = 0; i < NUM_IMPACT_MATERIALS; i++)
+	{
+		for (int j = 0; j < m_iNumDebrisSprites[i]; j++)
+			ppools[numpools++] = &m_debrisPools[i][j];
+	}
+	ppools[numpools++] = &m_puffPool;
+
+	for (int i = 0; i < numpools; i++)
+	{
+		int modelindex = 0;
+		particlepool_t* ppool = ppools[i];
+		ppool->pmodel = gEngfuncs.CL_LoadModel(ppool->pszSprite, &modelindex);
+
+		if (ppool->pmodel && ppool->pmodel->type == mod_sprite)
+			ppool->numframes = ((msprite_t*)ppool->pmodel->cache.data)->numframes;
+		else
+			ppool->pmodel = NULL;
+	}
+
+	m_bSpritesLoaded = true;
+}
+
+/*
+====================
+AllocParticle
+
+====================
+*/
+int CImpactParticles::AllocParticle( particlepool_t* ppool )
+{
+	if (ppool->count < MAX_POOL_PARTICLES)
+		return ppool->count++;
+
+	// Pool is full, reuse the oldest particle. Removal moves particles
+	// around, so the slot order says nothing about age, the die time does
+	int oldest = 0;
+	for (int i = 1; i < ppool->count; i++)
+	{
+		if (ppool->die[i] < ppool->die[oldest])
+			oldest = i;
+	}
+
+	return oldest;
+}
+
+/*
+====================
+PickDebrisSprite
+
+====================
+*/
+int CImpactParticles::PickDebrisSprite( int material )
+{
+	if (material < 0 || material >= NUM_IMPACT_MATERIALS || !m_iNumDebrisSprites[material])
+		return -1;
+
+	return gEngfuncs.pfnRandomLong(0, m_iNumDebrisSprites[material] - 1);
+}
+
+/*
+====================
+AddDebris
+
+====================
+*/
+void CImpactParticles::AddDebris( int material, int sprite, const Vector& origin, const Vector& velocity, float scale )
+{
+	if (material < 0 || material >= NUM_IMPACT_MATERIALS)
+		return;
+
+	if (sprite < 0 || sprite >= m_iNumDebrisSprites[material])
+		return;
+
+	if (!m_bSpritesLoaded)
+		LoadSprites();
+
+	particlepool_t* ppool = &m_debrisPools[material][sprite];
+	if (!ppool->pmodel)
+		return;
+
+	int i = AllocParticle(ppool);
+	ppool->originx[i] = origin[0];
+	ppool->originy[i] = origin[1];
+	ppool->originz[i] = origin[2];
+	ppool->velocityx[i] = velocity[0];
+	ppool->velocityy[i] = velocity[1];
+	ppool->velocityz[i] = velocity[2];
+	ppool->roll[i] = gEngfuncs.pfnRandomFloat(0, 360);
+	ppool->rollspeed[i] = gEngfuncs.pfnRandomFloat(-255, 255);
+	ppool->frame[i] = 0;
+	ppool->scale[i] = scale;
+	ppool->die[i] = m_flTime + ppool->life;
+	ppool->alpha[i] = 1.0;
+	ppool->color[i][0] = ppool->color[i][1] = ppool->color[i][2] = 255;
+}
+
+/*
+====================
+AddPuff
+
+====================
+*/
+void CImpactParticles::AddPuff( const Vector& origin, const Vector& velocity, float scale, int r, int g, int b, int a )
+{
+	if (!m_bSpritesLoaded)
+		LoadSprites();
+
+	particlepool_t* ppool = &m_puffPool;
+	if (!ppool->pmodel)
+		return;
+
+	int i = AllocParticle(ppool);
+	ppool->originx[i] = origin[0];
+	ppool->originy[i] = origin[1];
+	ppool->originz[i] = origin[2];
+	ppool->velocityx[i] = velocity[0];
+	ppool->velocityy[i] = velocity[1];
+	ppool->velocityz[i] = velocity[2];
+	ppool->roll[i] = 0;
+	ppool->rollspeed[i] = 0;
+	ppool->frame[i] = 0;
+	ppool->scale[i] = scale;
+	ppool->die[i] = m_flTime + ppool->life;
+	ppool->alpha[i] = a / 255.0f;
+	ppool->color[i][0] = r;
+	ppool->color[i][1] = g;
+	ppool->color[i][2] = b;
+}
+
+/*
+====================
+SimulatePool
+
+====================
+*/
+void CImpactParticles::SimulatePool( particlepool_t* ppool, float frametime, float gravity )
+{
+	int count = ppool->count;
+
+	// Straight loops over the arrays, the compiler vectorizes these
+	float* __restrict originx = ppool->originx;
+	float* __restrict originy = ppool->originy;
+	float* __restrict originz = ppool->originz;
+	float* __restrict velocityx = ppool->velocityx;
+	float* __restrict velocityy = ppool->velocityy;
+	float* __restrict velocityz = ppool->velocityz;
+
+	float gravitystep = gravity * ppool->gravity * frametime;
+	for (int i = 0; i < count; i++)
+		velocityz[i] -= gravitystep;
+
+	for (int i = 0; i < count; i++)
+	{
+		originx[i] += velocityx[i] * frametime;
+		originy[i] += velocityy[i] * frametime;
+		originz[i] += velocityz[i] * frametime;
+	}
+
+	float* __restrict roll = ppool->roll;
+	float* __restrict rollspeed = ppool->rollspeed;
+	for (int i = 0; i < count; i++)
+		roll[i] += rollspeed[i] * frametime;
+
+	if (ppool->framerate)
+	{
+		float* __restrict frame = ppool->frame;
+		float framestep = ppool->framerate * frametime;
+		for (int i = 0; i < count; i++)
+			frame[i] += framestep;
+	}
+
+	// Only a slice of the particles asks for the world contents each update
+	int contentsPhase = m_iContentsFrame % PARTICLE_CONTENTS_STRIDE;
+
+	// Remove dead particles by moving the last one into their slot
+	for (int i = 0; i < ppool->count; )
+	{
+		bool bDead = false;
+
+		if (ppool->framerate && ppool->frame[i] >= ppool->numframes)
+		{
+			// Animation doesn't loop
+			bDead = true;
+		}
+		else if (ppool->die[i] < m_flTime)
+		{
+			// Fade out once the life is over
+			float life = ppool->die[i] - m_flTime;
+			if (!ppool->fadespeed || (1 + life * ppool->fadespeed) <= 0)
+				bDead = true;
+		}
+
+		if (!bDead && (i % PARTICLE_CONTENTS_STRIDE) == contentsPhase)
+		{
+			// Die on impact with the world
+			vec3_t origin;
+			origin[0] = ppool->originx[i];
+			origin[1] = ppool->originy[i];
+			origin[2] = ppool->originz[i];
+
+			if (gEngfuncs.PM_PointContents(origin, NULL) == CONTENTS_SOLID)
+				bDead = true;
+		}
+
+		if (!bDead)
+		{
+			i++;
+			continue;
+		}
+
+		int last = --ppool->count;
+		ppool->originx[i] = ppool->originx[last];
+		ppool->originy[i] = ppool->originy[last];
+		ppool->originz[i] = ppool->originz[last];
+		ppool->velocityx[i] = ppool->velocityx[last];
+		ppool->velocityy[i] = ppool->velocityy[last];
+		ppool->velocityz[i] = ppool->velocityz[last];
+		ppool->roll[i] = ppool->roll[last];
+		ppool->rollspeed[i] = ppool->rollspeed[last];
+		ppool->frame[i] = ppool->frame[last];
+		ppool->scale[i] = ppool->scale[last];
+		ppool->die[i] = ppool->die[last];
+		ppool->alpha[i] = ppool->alpha[last];
+		ppool->color[i][0] = ppool->color[last][0];
+		ppool->color[i][1] = ppool->color[last][1];
+		ppool->color[i][2] = ppool->color[last][2];
+	}
+}
+
+/*
+====================
+Update
+
+====================
+*/
+void CImpactParticles::Update( double frametime, double client_time, double cl_gravity )
+{
+	m_flTime = client_time;
+
+	// Don't simulate while paused
+	if (frametime <= 0)
+		return;
+
+	for (int i = 0; i < NUM_IMPACT_MATERIALS; i++)
+	{
+		for (int j = 0; j < m_iNumDebrisSprites[i]; j++)
+		{
+			if (m_debrisPools[i][j].count)
+				SimulatePool(&m_debrisPools[i][j], frametime, cl_gravity);
+		}
+	}
+
+	if (m_puffPool.count)
+		SimulatePool(&m_puffPool, frametime, cl_gravity);
+
+	m_iContentsFrame++;
+}
+
+/*
+====================
+DrawPool
+
+====================
+*/
+void CImpactParticles::DrawPool( particlepool_t* ppool, const Vector& right, const Vector& up )
+{
+	static int visibleParticles[MAX_POOL_PARTICLES];
+	static int sortedParticles[MAX_POOL_PARTICLES];
+	static int frameCounts[MAX_POOL_PARTICLES + 1];
+
+	// Nothing past the fog end needs drawing
+	int numVisible = 0;
+	for (int i = 0; i < ppool->count; i++)
+	{
+		Vector vOrigin = Vector(ppool->originx[i], ppool->originy[i], ppool->originz[i]);
+		if (!gFog.CullFogSphere(vOrigin, ppool->scale[i] * 32))
+			visibleParticles[numVisible++] = i;
+	}
+
+	if (!numVisible)
+		return;
+
+	int numframes = ppool->framerate ? ppool->numframes : 1;
+	if (numframes > MAX_POOL_PARTICLES)
+		numframes = MAX_POOL_PARTICLES;
+
+	// Counting sort by frame, so each frame is one batch
+	memset(frameCounts, 0, sizeof(int) * (numframes + 1));
+	for (int j = 0; j < numVisible; j++)
+	{
+		int i = visibleParticles[j];
+		int frame = ppool->framerate ? (int)ppool->frame[i] : 0;
+		frameCounts[clamp(frame, 0, numframes - 1) + 1]++;
+	}
+
+	for (int i = 1; i <= numframes; i++)
+		frameCounts[i] += frameCounts[i - 1];
+
+	for (int j = 0; j < numVisible; j++)
+	{
+		int i = visibleParticles[j];
+		int frame = ppool->framerate ? (int)ppool->frame[i] : 0;
+		sortedParticles[frameCounts[clamp(frame, 0, numframes - 1)]++] = i;
+	}
+
+	gEngfuncs.pTriAPI->RenderMode(ppool->rendermode);
+
+	// frameCounts now holds the end of each frame's run
+	int first = 0;
+	for (int frame = 0; frame < numframes; frame++)
+	{
+		int end = frameCounts[frame];
+		if (first == end)
+			continue;
+
+		mspriteframe_t* pframe = GetSpriteFrame(ppool->pmodel, frame);
+		if (!pframe)
+		{
+			first = end;
+			continue;
+		}
+
+		gEngfuncs.pTriAPI->SpriteTexture(ppool->pmodel, frame);
+		gEngfuncs.pTriAPI->Begin(TRI_QUADS);
+
+		for (int j = first; j < end; j++)
+		{
+			int i = sortedParticles[j];
+
+			float alpha = ppool->alpha[i];
+			if (ppool->die[i] < m_flTime)
+				alpha *= 1 + (ppool->die[i] - m_flTime) * ppool->fadespeed;
+
+			gEngfuncs.pTriAPI->Color4f(ppool->color[i][0] / 255.0f, ppool->color[i][1] / 255.0f, ppool->color[i][2] / 255.0f, alpha);
+
+			// Roll the sprite axes
+			float flRoll = ppool->roll[i] * (M_PI / 180.0);
+			float sr = sin(flRoll);
+			float cr = cos(flRoll);
+
+			Vector vRight = (right * cr - up * sr) * ppool->scale[i];
+			Vector vUp = (right * sr + up * cr) * ppool->scale[i];
+			Vector vOrigin = Vector(ppool->originx[i], ppool->originy[i], ppool->originz[i]);
+
+			gEngfuncs.pTriAPI->TexCoord2f(0, 1);
+			gEngfuncs.pTriAPI->Vertex3fv(vOrigin + vUp * pframe->down + vRight * pframe->left);
+
+			gEngfuncs.pTriAPI->TexCoord2f(0, 0);
+			gEngfuncs.pTriAPI->Vertex3fv(vOrigin + vUp * pframe->up + vRight * pframe->left);
+
+			gEngfuncs.pTriAPI->TexCoord2f(1, 0);
+			gEngfuncs.pTriAPI->Vertex3fv(vOrigin + vUp * pframe->up + vRight * pframe->right);
+
+			gEngfuncs.pTriAPI->TexCoord2f(1, 1);
+			gEngfuncs.pTriAPI->Vertex3fv(vOrigin + vUp * pframe->down + vRight * pframe->right);
+		}
+
+		gEngfuncs.pTriAPI->End();
+		first = end;
+	}
+}
+
+/*
+====================
+Draw
+
+====================
+*/
+void CImpactParticles::Draw( void )
+{
+	if (!m_bSpritesLoaded)
+		return;
+
+	Vector forward, right, up;
+	gEngfuncs.pfnAngleVectors(v_angles, forward, right, up);
+
+	gEngfuncs.pTriAPI->CullFace(TRI_NONE);
+
+	for (int i = 0; i < NUM_IMPACT_MATERIALS; i++)
+	{
+		for (int j = 0; j < m_iNumDebrisSprites[i]; j++)
+		{
+			if (m_debrisPools[i][j].count && m_debrisPools[i][j].pmodel)
+				DrawPool(&m_debrisPools[i][j], right, up);
+		}
+	}
+
+	if (m_puffPool.count && m_puffPool.pmodel)
+		DrawPool(&m_puffPool, right, up);
+
+	gEngfuncs.pTriAPI->RenderMode(kRenderNormal);
+	gEngfuncs.pTriAPI->CullFace(TRI_FRONT);
+}
@@ -0,0 +1,119 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Pooled bullet impact debris and smoke puffs
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( R_PARTICLES_H )
+#define R_PARTICLES_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+// Hard cap for each sprite, the oldest particle is recycled when full
+#define MAX_POOL_PARTICLES		256
+// Each particle checks the world contents once every this many updates
+#define PARTICLE_CONTENTS_STRIDE	4
+// Most sprites a single impact material can pick from
+#define MAX_MATERIAL_SPRITES	4
+
+// Same material numbers as the server sends with the impact message
+enum impactmaterial_t
+{
+	IMPACT_CONCRETE = 0,
+	IMPACT_METAL,
+	IMPACT_WOOD,
+	IMPACT_DIRT,
+	IMPACT_GLASS,
+	IMPACT_COMPUTER,
+
+	NUM_IMPACT_MATERIALS
+};
+
+// All particles using one sprite, stored as arrays so
+// the simulation loops run over contiguous floats
+struct particlepool_t
+{
+	const char*	pszSprite;
+	int			rendermode;
+
+	// Fraction of world gravity applied
+	float		gravity;
+	// Sprite frames per second, 0 for a single frame
+	float		framerate;
+	// Rate the alpha drops at once the particle's life is over
+	float		fadespeed;
+	// Seconds a particle lives before it starts fading, same for the whole
+	// pool so the earliest die time is also the oldest particle
+	float		life;
+
+	// Loaded with the first impact of the level
+	model_t*	pmodel;
+	int			numframes;
+
+	int			count;
+
+	float		originx[MAX_POOL_PARTICLES];
+	float		originy[MAX_POOL_PARTICLES];
+	float		originz[MAX_POOL_PARTICLES];
+	float		velocityx[MAX_POOL_PARTICLES];
+	float		velocityy[MAX_POOL_PARTICLES];
+	float		velocityz[MAX_POOL_PARTICLES];
+	float		roll[MAX_POOL_PARTICLES];
+	float		rollspeed[MAX_POOL_PARTICLES];
+	float		frame[MAX_POOL_PARTICLES];
+	float		scale[MAX_POOL_PARTICLES];
+	float		die[MAX_POOL_PARTICLES];
+	float		alpha[MAX_POOL_PARTICLES];
+	byte		color[MAX_POOL_PARTICLES][3];
+};
+
+/*
+====================
+CImpactParticles
+
+====================
+*/
+class CImpactParticles
+{
+public:
+	CImpactParticles( void );
+
+public:
+	void Init( void );
+	void VidInit( void );
+
+	// ev_hldm.cpp -> EV_HLDM_Particles()
+	int PickDebrisSprite( int material );
+	void AddDebris( int material, int sprite, const Vector& origin, const Vector& velocity, float scale );
+	void AddPuff( const Vector& origin, const Vector& velocity, float scale, int r, int g, int b, int a );
+
+	// entity.cpp -> HUD_TempEntUpdate()
+	void Update( double frametime, double client_time, double cl_gravity );
+	// tri.cpp -> HUD_DrawTransparentTriangles()
+	void Draw( void );
+
+private:
+	void LoadSprites( void );
+	int AllocParticle( particlepool_t* ppool );
+	void SimulatePool( particlepool_t* ppool, float frametime, float gravity );
+	void DrawPool( particlepool_t* ppool, const Vector& right, const Vector& up );
+
+private:
+	particlepool_t	m_debrisPools[NUM_IMPACT_MATERIALS][MAX_MATERIAL_SPRITES];
+	int				m_iNumDebrisSprites[NUM_IMPACT_MATERIALS];
+
+	particlepool_t	m_puffPool;
+
+	// Sprites are looked up once per level
+	bool			m_bSpritesLoaded;
+
+	// Client time of the last update
+	float			m_flTime;
+	// Update count, picks which particles check contents this frame
+	int				m_iContentsFrame;
+};
+
+extern CImpactParticles g_ImpactParticles;
+#endif // R_PARTICLES_H
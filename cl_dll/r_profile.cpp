@@ -0,0 +1,205 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Scoped timers for the client render code
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "hud.h"
+#include "cl_util.h"
+#include "r_profile.h"
+
+#if defined( R_PROFILE )
+
+#include <stdio.h>
+#include <string.h>
+
+// Class declaration
+CRenderProfiler g_RenderProfiler;
+
+// First console line used by the overlay
+#define PROFILE_OVERLAY_LINE	4
+
+// Names used for the overlay and CSV columns
+static const char* g_szProfileScopeNames[NUM_PROFILE_SCOPES] =
+{
+	"calcrefdef",
+	"elights",
+	"svd",
+	"studio",
+	"bones",
+	"lighting",
+	"shadows",
+	"studioqueue",
+	"water",
+	"ripples",
+	"screenglow"
+};
+
+/*
+====================
+CRenderProfiler
+
+====================
+*/
+CRenderProfiler::CRenderProfiler( void )
+{
+	m_iNumFrames = 0;
+	m_iCurrentFrame = 0;
+	m_bActive = false;
+	m_pCvarProfile = NULL;
+
+	memset(m_frames, 0, sizeof(m_frames));
+	memset(&m_frame, 0, sizeof(m_frame));
+}
+
+/*
+====================
+Init
+
+====================
+*/
+void CRenderProfiler::Init( void )
+{
+	m_pCvarProfile = CVAR_CREATE( "r_profile", "0", 0 );
+	gEngfuncs.pfnAddCommand( "r_profile_dump", CmdDumpCSV );
+}
+
+/*
+====================
+AddSample
+
+====================
+*/
+void CRenderProfiler::AddSample( profilescope_t scope, double msec )
+{
+	m_frame.msec[scope] += msec;
+	m_frame.calls[scope]++;
+}
+
+/*
+====================
+EndFrame
+
+====================
+*/
+void CRenderProfiler::EndFrame( float time )
+{
+	if (m_bActive)
+	{
+		m_frame.time = time;
+		m_frames[m_iCurrentFrame] = m_frame;
+
+		m_iCurrentFrame = (m_iCurrentFrame + 1) % PROFILE_HISTORY_FRAMES;
+		if (m_iNumFrames < PROFILE_HISTORY_FRAMES)
+			m_iNumFrames++;
+
+		DrawOverlay();
+	}
+
+	memset(&m_frame, 0, sizeof(m_frame));
+
+	// Only switch on frame boundaries so no frame is half measured
+	bool bActive = m_pCvarProfile && m_pCvarProfile->value > 0;
+	if (bActive != m_bActive)
+	{
+		m_iNumFrames = 0;
+		m_iCurrentFrame = 0;
+		m_bActive = bActive;
+	}
+}
+
+/*
+====================
+DrawOverlay
+
+====================
+*/
+void CRenderProfiler::DrawOverlay( void )
+{
+	gEngfuncs.Con_NPrintf(PROFILE_OVERLAY_LINE, "%-12s %8s %8s %8s %6s\n", "scope", "min", "avg", "max", "calls");
+
+	for (int i = 0; i < NUM_PROFILE_SCOPES; i++)
+	{
+		float flMin = 99999;
+		float flMax = 0;
+		float flTotal = 0;
+		int iCalls = 0;
+
+		for (int j = 0; j < m_iNumFrames; j++)
+		{
+			profileframe_t* pframe = &m_frames[j];
+			if (pframe->msec[i] < flMin)
+				flMin = pframe->msec[i];
+			if (pframe->msec[i] > flMax)
+				flMax = pframe->msec[i];
+
+			flTotal += pframe->msec[i];
+			iCalls += pframe->calls[i];
+		}
+
+		gEngfuncs.Con_NPrintf(PROFILE_OVERLAY_LINE + i + 1, "%-12s %8.3f %8.3f %8.3f %6d\n", g_szProfileScopeNames[i],
+			flMin, flTotal / m_iNumFrames, flMax, iCalls / m_iNumFrames);
+	}
+}
+
+/*
+====================
+DumpCSV
+
+====================
+*/
+void CRenderProfiler::DumpCSV( void )
+{
+	if (!m_iNumFrames)
+	{
+		gEngfuncs.Con_Printf("r_profile_dump: nothing recorded, set r_profile 1 first\n");
+		return;
+	}
+
+	const char* pszName = gEngfuncs.Cmd_Argc() > 1 ? gEngfuncs.Cmd_Argv(1) : "profile.csv";
+
+	char szPath[256];
+	_snprintf(szPath, sizeof(szPath), "%s/%s", gEngfuncs.pfnGetGameDirectory(), pszName);
+	szPath[sizeof(szPath) - 1] = '\0';
+
+	FILE* pFile = fopen(szPath, "wt");
+	if (!pFile)
+	{
+		gEngfuncs.Con_Printf("r_profile_dump: couldn't open %s\n", szPath);
+		return;
+	}
+
+	fprintf(pFile, "time");
+	for (int i = 0; i < NUM_PROFILE_SCOPES; i++)
+		fprintf(pFile, ",%s_ms,%s_calls", g_szProfileScopeNames[i], g_szProfileScopeNames[i]);
+	fprintf(pFile, "\n");
+
+	// Oldest frame first
+	int iFirst = (m_iNumFrames < PROFILE_HISTORY_FRAMES) ? 0 : m_iCurrentFrame;
+	for (int j = 0; j < m_iNumFrames; j++)
+	{
+		profileframe_t* pframe = &m_frames[(iFirst + j) % PROFILE_HISTORY_FRAMES];
+
+		fprintf(pFile, "%.4f", pframe->time);
+		for (int i = 0; i < NUM_PROFILE_SCOPES; i++)
+			fprintf(pFile, ",%.4f,%d", pframe->msec[i], pframe->calls[i]);
+		fprintf(pFile, "\n");
+	}
+
+	fclose(pFile);
+	gEngfuncs.Con_Printf("r_profile_dump: wrote %d frames to %s\n", m_iNumFrames, szPath);
+}
+
+/*
+====================
+CmdDumpCSV
+
+====================
+*/
+void CRenderProfiler::CmdDumpCSV( void )
+{
+	g_RenderProfiler.DumpCSV();
+}
+
+#endif // R_PROFILE
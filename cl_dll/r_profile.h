@@ -0,0 +1,136 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Scoped timers for the client render code
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( R_PROFILE_H )
+#define R_PROFILE_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+enum profilescope_t
+{
+	PROF_CALCREFDEF = 0,
+	PROF_ELIGHTS,
+	PROF_SVD,
+	PROF_STUDIO,
+	PROF_BONES,
+	PROF_LIGHTING,
+	PROF_SHADOWS,
+	PROF_STUDIOQUEUE,
+	PROF_WATER,
+	PROF_RIPPLES,
+	PROF_SCREENGLOW,
+
+	NUM_PROFILE_SCOPES
+};
+
+#if defined( R_PROFILE )
+
+#include <chrono>
+
+// Number of frames kept for the overlay and CSV dumps
+#define PROFILE_HISTORY_FRAMES	512
+
+struct profileframe_t
+{
+	float	time;
+	float	msec[NUM_PROFILE_SCOPES];
+	int		calls[NUM_PROFILE_SCOPES];
+};
+
+/*
+====================
+CRenderProfiler
+
+====================
+*/
+class CRenderProfiler
+{
+public:
+	CRenderProfiler( void );
+
+public:
+	// hud.cpp -> CHud::Init()
+	void Init( void );
+	// hud_redraw.cpp -> CHud::Redraw()
+	void EndFrame( float time );
+
+	bool IsActive( void ) const { return m_bActive; }
+	void AddSample( profilescope_t scope, double msec );
+
+private:
+	void DrawOverlay( void );
+	void DumpCSV( void );
+
+	static void CmdDumpCSV( void );
+
+private:
+	// Ring buffer of finished frames
+	profileframe_t	m_frames[PROFILE_HISTORY_FRAMES];
+	int				m_iNumFrames;
+	int				m_iCurrentFrame;
+
+	// Frame being measured
+	profileframe_t	m_frame;
+
+	// Set from r_profile once per frame
+	bool			m_bActive;
+
+	cvar_t*			m_pCvarProfile;
+};
+
+extern CRenderProfiler g_RenderProfiler;
+
+/*
+====================
+CProfileScope
+
+====================
+*/
+class CProfileScope
+{
+public:
+	CProfileScope( profilescope_t scope )
+	{
+		m_scope = scope;
+		m_bActive = g_RenderProfiler.IsActive();
+
+		if (m_bActive)
+			m_start = std::chrono::steady_clock::now();
+	}
+
+	~CProfileScope( void )
+	{
+		if (!m_bActive)
+			return;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+		g_RenderProfiler.AddSample(m_scope, elapsed.count());
+	}
+
+private:
+	profilescope_t	m_scope;
+	bool			m_bActive;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#define R_PROFILE_CONCAT2( a, b ) a##b
+#define R_PROFILE_CONCAT( a, b ) R_PROFILE_CONCAT2( a, b )
+
+// Times the rest of the enclosing block
+#define R_PROFILE_SCOPE( scope )	CProfileScope R_PROFILE_CONCAT( profscope, __LINE__ )( scope )
+#define R_PROFILE_INIT()			g_RenderProfiler.Init()
+#define R_PROFILE_ENDFRAME( time )	g_RenderProfiler.EndFrame( time )
+
+#else
+
+#define R_PROFILE_SCOPE( scope )
+#define R_PROFILE_INIT()
+#define R_PROFILE_ENDFRAME( time )
+
+#endif // R_PROFILE
+#endif // R_PROFILE_H
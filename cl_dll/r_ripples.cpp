@@ -9,6 +9,7 @@
 #include "studio.h"
 #include "com_model.h"
 #include "r_ripples.h"
+#include "r_profile.h"
 
 cvar_t* r_ripples = nullptr, * r_ripple_updatetime = nullptr, * r_ripple_spawntime = nullptr,* r_ripple_waves = nullptr, * r_ripple_world_waveheight = nullptr;
 cvar_t* gl_texturemode;
@@ -105,6 +106,8 @@ static int MostSignificantBit(unsigned int v)
 
 void R_AnimateRipples(void)
 {
+	R_PROFILE_SCOPE( PROF_RIPPLES );
+
 	double frametime = gEngfuncs.GetClientTime() - g_ripple.time;
 
 	g_ripple.update = g_ripple.enabled && frametime >= r_ripple_updatetime->value;
@@ -178,6 +181,8 @@ uint32_t* R_GetPixelBuffer(GLuint tex)
 
 void R_UploadRipples(struct texture_s* image)
 {
+	R_PROFILE_SCOPE( PROF_RIPPLES );
+
 	uint32_t* pixels;
 	int wbits, wmask, wshft;
 
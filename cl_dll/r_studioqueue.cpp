@@ -0,0 +1,388 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Deferred, state-sorted submission of studio model meshes
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "windows.h"
+#include "algorithm"
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "studio.h"
+#include "entity_state.h"
+#include "cl_entity.h"
+#include "triangleapi.h"
+
+#include "studio_util.h"
+#include "r_studioint.h"
+
+#include "StudioModelRenderer.h"
+#include "GameStudioModelRenderer.h"
+
+#include "r_studioqueue.h"
+#include "fog.h"
+#include "r_profile.h"
+
+// Class declaration
+CStudioRenderQueue g_StudioRenderQueue;
+
+// The renderer object, created on the stack.
+extern CGameStudioModelRenderer g_StudioRenderer;
+
+// Global engine <-> studio model rendering code interface
+extern engine_studio_api_t IEngineStudio;
+
+/*
+====================
+QueueSortOpaque
+
+====================
+*/
+static bool QueueSortOpaque( const studioqueuemesh_t* pmesh1, const studioqueuemesh_t* pmesh2 )
+{
+	return pmesh1->sortkey < pmesh2->sortkey;
+}
+
+/*
+====================
+QueueSortTranslucent
+
+====================
+*/
+static bool QueueSortTranslucent( const studioqueuemesh_t* pmesh1, const studioqueuemesh_t* pmesh2 )
+{
+	// Back to front
+	return pmesh1->viewdist > pmesh2->viewdist;
+}
+
+/*
+====================
+CStudioRenderQueue
+
+====================
+*/
+CStudioRenderQueue::CStudioRenderQueue( void )
+{
+	m_bOpen = false;
+	m_iNumDrawCalls = 0;
+	m_iNumTextureBinds = 0;
+	m_pCvarStudioQueue = NULL;
+	m_pCvarStudioQueueStats = NULL;
+
+	memset(&m_currentMesh, 0, sizeof(m_currentMesh));
+	VectorClear(m_vViewOrigin);
+}
+
+/*
+====================
+Init
+
+====================
+*/
+void CStudioRenderQueue::Init( void )
+{
+	m_pCvarStudioQueue = CVAR_CREATE( "r_studio_queue", "1", FCVAR_ARCHIVE );
+	m_pCvarStudioQueueStats = CVAR_CREATE( "r_studio_queue_stats", "0", FCVAR_CLIENTDLL );
+
+	m_vertexes.reserve(65536);
+	m_meshes.reserve(2048);
+	m_opaqueMeshes.reserve(2048);
+	m_translucentMeshes.reserve(256);
+	m_indexes.reserve(65536);
+}
+
+/*
+====================
+VidInit
+
+====================
+*/
+void CStudioRenderQueue::VidInit( void )
+{
+	m_vertexes.clear();
+	m_meshes.clear();
+	m_bOpen = false;
+}
+
+/*
+====================
+BeginFrame
+
+====================
+*/
+void CStudioRenderQueue::BeginFrame( const vec3_t& vieworigin )
+{
+	m_vertexes.clear();
+	m_meshes.clear();
+
+	VectorCopy(vieworigin, m_vViewOrigin);
+	m_bOpen = true;
+}
+
+/*
+====================
+IsActive
+
+====================
+*/
+bool CStudioRenderQueue::IsActive( void ) const
+{
+	if (!m_bOpen)
+		return false;
+
+	if (!m_pCvarStudioQueue || m_pCvarStudioQueue->value < 1)
+		return false;
+
+	return IEngineStudio.IsHardware() == 1;
+}
+
+/*
+====================
+BeginMesh
+
+====================
+*/
+studioqueuevert_t* CStudioRenderQueue::BeginMesh( GLuint texture, studioqueue_pass_t pass, int maxvertexes )
+{
+	m_currentMesh.texture = texture;
+	m_currentMesh.pass = pass;
+	m_currentMesh.firstvertex = m_vertexes.size();
+	m_currentMesh.numvertexes = 0;
+
+	// Pass goes in the top bits so opaque draws come before alpha-tested ones
+	m_currentMesh.sortkey = ((unsigned __int64)pass << 32) | (unsigned __int64)texture;
+
+	m_vertexes.resize(m_currentMesh.firstvertex + maxvertexes);
+	return &m_vertexes[m_currentMesh.firstvertex];
+}
+
+/*
+====================
+EndMesh
+
+====================
+*/
+void CStudioRenderQueue::EndMesh( int numvertexes )
+{
+	m_vertexes.resize(m_currentMesh.firstvertex + numvertexes);
+	if (!numvertexes)
+		return;
+
+	m_currentMesh.numvertexes = numvertexes;
+	m_currentMesh.viewdist = 0;
+
+	if (m_currentMesh.pass == SQ_PASS_ADDITIVE || m_currentMesh.pass == SQ_PASS_ALPHABLEND)
+	{
+		// Use the mesh center for back to front sorting
+		vec3_t center;
+		VectorClear(center);
+
+		studioqueuevert_t* pvert = &m_vertexes[m_currentMesh.firstvertex];
+		for (int i = 0; i < numvertexes; i++, pvert++)
+			VectorAdd(center, pvert->origin, center);
+
+		VectorScale(center, 1.0f / (float)numvertexes, center);
+		VectorSubtract(center, m_vViewOrigin, center);
+		m_currentMesh.viewdist = DotProduct(center, center);
+	}
+
+	m_meshes.push_back(m_currentMesh);
+}
+
+/*
+====================
+Flush
+
+====================
+*/
+void CStudioRenderQueue::Flush( void )
+{
+	R_PROFILE_SCOPE( PROF_STUDIOQUEUE );
+
+	m_bOpen = false;
+
+	m_iNumDrawCalls = 0;
+	m_iNumTextureBinds = 0;
+
+	if (m_meshes.empty())
+		return;
+
+	m_opaqueMeshes.clear();
+	m_translucentMeshes.clear();
+
+	for (unsigned int i = 0; i < m_meshes.size(); i++)
+	{
+		studioqueuemesh_t* pmesh = &m_meshes[i];
+		if (pmesh->pass == SQ_PASS_ADDITIVE || pmesh->pass == SQ_PASS_ALPHABLEND)
+			m_translucentMeshes.push_back(pmesh);
+		else
+			m_opaqueMeshes.push_back(pmesh);
+	}
+
+	std::sort(m_opaqueMeshes.begin(), m_opaqueMeshes.end(), QueueSortOpaque);
+	std::sort(m_translucentMeshes.begin(), m_translucentMeshes.end(), QueueSortTranslucent);
+
+	// Same texture state the studio renderer uses
+	glPushAttrib(GL_TEXTURE_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	g_StudioRenderer.glActiveTexture(GL_TEXTURE1);
+	glDisable(GL_TEXTURE_2D);
+	g_StudioRenderer.glActiveTexture(GL_TEXTURE2);
+	glDisable(GL_TEXTURE_2D);
+	g_StudioRenderer.glActiveTexture(GL_TEXTURE3);
+	glDisable(GL_TEXTURE_2D);
+
+	g_StudioRenderer.glActiveTexture(GL_TEXTURE0);
+	glEnable(GL_TEXTURE_2D);
+
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE_ARB);
+	glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB_ARB, GL_MODULATE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE0_RGB_ARB, GL_TEXTURE);
+	glTexEnvi(GL_TEXTURE_ENV, GL_SOURCE1_RGB_ARB, GL_PRIMARY_COLOR_ARB);
+	glTexEnvi(GL_TEXTURE_ENV, GL_RGB_SCALE_ARB, 2);
+
+	glShadeModel(GL_SMOOTH);
+	glDepthFunc(GL_LEQUAL);
+	glDisable(GL_BLEND);
+
+	// Set up interleaved arrays
+	g_StudioRenderer.glClientActiveTexture(GL_TEXTURE0);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+
+	glVertexPointer(3, GL_FLOAT, sizeof(studioqueuevert_t), m_vertexes[0].origin);
+	glColorPointer(4, GL_FLOAT, sizeof(studioqueuevert_t), m_vertexes[0].color);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(studioqueuevert_t), m_vertexes[0].texcoord);
+
+	DrawMeshes(m_opaqueMeshes);
+
+	if (!m_translucentMeshes.empty())
+	{
+		glEnable(GL_BLEND);
+		glDepthMask(GL_FALSE);
+
+		DrawMeshes(m_translucentMeshes);
+
+		glDepthMask(GL_TRUE);
+		glDisable(GL_BLEND);
+	}
+
+	glShadeModel(GL_FLAT);
+
+	glPopClientAttrib();
+	glPopAttrib();
+
+	if (m_pCvarStudioQueueStats->value > 0)
+	{
+		gEngfuncs.Con_NPrintf(0, "Studio queue: %d meshes, %d draw calls, %d texture binds\n",
+			(int)m_meshes.size(), m_iNumDrawCalls, m_iNumTextureBinds);
+	}
+}
+
+/*
+====================
+DrawMeshes
+
+====================
+*/
+void CStudioRenderQueue::DrawMeshes( std::vector<studioqueuemesh_t*>& meshes )
+{
+	GLuint boundTexture = 0;
+	studioqueue_pass_t boundPass = SQ_PASS_OPAQUE;
+	bool bPassSet = false;
+
+	unsigned int i = 0;
+	while (i < meshes.size())
+	{
+		studioqueuemesh_t* pfirst = meshes[i];
+
+		if (!bPassSet || boundPass != pfirst->pass)
+		{
+			if (bPassSet)
+				ResetPassState(boundPass);
+
+			SetupPassState(pfirst->pass);
+			boundPass = pfirst->pass;
+			bPassSet = true;
+		}
+
+		if (boundTexture != pfirst->texture)
+		{
+			glBindTexture(GL_TEXTURE_2D, pfirst->texture);
+			boundTexture = pfirst->texture;
+			m_iNumTextureBinds++;
+		}
+
+		// Merge every following mesh that shares the same state into one draw
+		m_indexes.clear();
+		for (; i < meshes.size(); i++)
+		{
+			studioqueuemesh_t* pmesh = meshes[i];
+			if (pmesh->texture != pfirst->texture || pmesh->pass != pfirst->pass)
+				break;
+
+			for (int j = 0; j < pmesh->numvertexes; j++)
+				m_indexes.push_back(pmesh->firstvertex + j);
+		}
+
+		glDrawElements(GL_TRIANGLES, m_indexes.size(), GL_UNSIGNED_INT, &m_indexes[0]);
+		m_iNumDrawCalls++;
+	}
+
+	if (bPassSet)
+		ResetPassState(boundPass);
+}
+
+/*
+====================
+SetupPassState
+
+====================
+*/
+void CStudioRenderQueue::SetupPassState( studioqueue_pass_t pass )
+{
+	switch (pass)
+	{
+	case SQ_PASS_ALPHATEST:
+		glEnable(GL_ALPHA_TEST);
+		glAlphaFunc(GL_GREATER, 0.5);
+		break;
+	case SQ_PASS_ADDITIVE:
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+		gFog.BlackFog();
+		break;
+	case SQ_PASS_ALPHABLEND:
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+====================
+ResetPassState
+
+====================
+*/
+void CStudioRenderQueue::ResetPassState( studioqueue_pass_t pass )
+{
+	switch (pass)
+	{
+	case SQ_PASS_ALPHATEST:
+		glDisable(GL_ALPHA_TEST);
+		glAlphaFunc(GL_GREATER, 0);
+		break;
+	case SQ_PASS_ADDITIVE:
+		gFog.RenderFog();
+		break;
+	default:
+		break;
+	}
+}
@@ -0,0 +1,110 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose:
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( R_STUDIOQUEUE_H )
+#define R_STUDIOQUEUE_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+#include <windows.h>
+#include <vector>
+
+#include "gl/gl.h"
+#include "gl/glext.h"
+
+enum studioqueue_pass_t
+{
+	SQ_PASS_OPAQUE = 0,
+	SQ_PASS_ALPHATEST,
+	SQ_PASS_ADDITIVE,
+	SQ_PASS_ALPHABLEND
+};
+
+struct studioqueuevert_t
+{
+	float origin[3];
+	float color[4];
+	float texcoord[2];
+};
+
+struct studioqueuemesh_t
+{
+	// Sort key for opaque meshes: pass, then texture
+	unsigned __int64 sortkey;
+
+	// Squared distance to the view, for translucent meshes
+	float viewdist;
+
+	GLuint texture;
+	studioqueue_pass_t pass;
+
+	int firstvertex;
+	int numvertexes;
+};
+
+/*
+====================
+CStudioRenderQueue
+
+====================
+*/
+class CStudioRenderQueue
+{
+public:
+	CStudioRenderQueue( void );
+
+public:
+	void Init( void );
+	void VidInit( void );
+
+	// view.cpp -> V_CalcRefdef()
+	void BeginFrame( const vec3_t& vieworigin );
+	// tri.cpp -> HUD_DrawNormalTriangles()
+	void Flush( void );
+
+	// Tells if studio meshes should be submitted to the queue right now
+	bool IsActive( void ) const;
+
+	// Starts a new mesh, returns pointer to write triangle list vertexes to
+	studioqueuevert_t* BeginMesh( GLuint texture, studioqueue_pass_t pass, int maxvertexes );
+	// Finalizes the mesh begun with BeginMesh
+	void EndMesh( int numvertexes );
+
+private:
+	void DrawMeshes( std::vector<studioqueuemesh_t*>& meshes );
+	void SetupPassState( studioqueue_pass_t pass );
+	void ResetPassState( studioqueue_pass_t pass );
+
+private:
+	std::vector<studioqueuevert_t>	m_vertexes;
+	std::vector<studioqueuemesh_t>	m_meshes;
+
+	std::vector<studioqueuemesh_t*>	m_opaqueMeshes;
+	std::vector<studioqueuemesh_t*>	m_translucentMeshes;
+
+	std::vector<GLuint>				m_indexes;
+
+	// Mesh currently being written
+	studioqueuemesh_t	m_currentMesh;
+
+	// View origin for translucent sorting
+	vec3_t				m_vViewOrigin;
+
+	// TRUE between BeginFrame and Flush
+	bool				m_bOpen;
+
+	// Stats from the last flush
+	int					m_iNumDrawCalls;
+	int					m_iNumTextureBinds;
+
+	cvar_t*				m_pCvarStudioQueue;
+	cvar_t*				m_pCvarStudioQueueStats;
+};
+
+extern CStudioRenderQueue g_StudioRenderQueue;
+#endif // R_STUDIOQUEUE_H
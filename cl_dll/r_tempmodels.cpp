@@ -0,0 +1,392 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Pooled bouncing model tempents, like shell casings
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <memory.h>
+#include <math.h>
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "entity_state.h"
+#include "cl_entity.h"
+#include "pm_defs.h"
+#include "pmtrace.h"
+#include "event_api.h"
+#include "r_studioint.h"
+
+#include "r_tempmodels.h"
+
+// Class declaration
+CTempModels g_TempModels;
+
+extern engine_studio_api_t IEngineStudio;
+extern mleaf_t* Mod_PointInLeaf( vec3_t p, model_t* model );
+
+static const char* g_szShellSounds[] = { "player/pl_shell1.wav", "player/pl_shell2.wav", "player/pl_shell3.wav" };
+static const char* g_szShotShellSounds[] = { "weapons/sshell1.wav", "weapons/sshell2.wav", "weapons/sshell3.wav" };
+
+/*
+====================
+CTempModels
+
+====================
+*/
+CTempModels::CTempModels( void )
+{
+	memset(&m_pool, 0, sizeof(m_pool));
+	m_flTime = 0;
+}
+
+/*
+====================
+VidInit
+
+====================
+*/
+void CTempModels::VidInit( void )
+{
+	// Models and leafs belong to the old level
+	m_pool.count = 0;
+	m_pool.recycle = 0;
+	m_flTime = 0;
+}
+
+/*
+====================
+AllocModel
+
+====================
+*/
+int CTempModels::AllocModel( void )
+{
+	if (m_pool.count < MAX_TEMP_MODELS)
+		return m_pool.count++;
+
+	// Full, replace the oldest one
+	int index = m_pool.recycle;
+	m_pool.recycle = (m_pool.recycle + 1) % MAX_TEMP_MODELS;
+	return index;
+}
+
+/*
+====================
+RemoveModel
+
+====================
+*/
+void CTempModels::RemoveModel( int index )
+{
+	// Move the last model into the slot
+	int last = --m_pool.count;
+	if (index != last)
+	{
+		m_pool.originx[index] = m_pool.originx[last];
+		m_pool.originy[index] = m_pool.originy[last];
+		m_pool.originz[index] = m_pool.originz[last];
+		m_pool.velocityx[index] = m_pool.velocityx[last];
+		m_pool.velocityy[index] = m_pool.velocityy[last];
+		m_pool.velocityz[index] = m_pool.velocityz[last];
+		m_pool.anglesx[index] = m_pool.anglesx[last];
+		m_pool.anglesy[index] = m_pool.anglesy[last];
+		m_pool.anglesz[index] = m_pool.anglesz[last];
+		m_pool.avelocityx[index] = m_pool.avelocityx[last];
+		m_pool.avelocityy[index] = m_pool.avelocityy[last];
+		m_pool.avelocityz[index] = m_pool.avelocityz[last];
+		m_pool.gravity[index] = m_pool.gravity[last];
+		m_pool.die[index] = m_pool.die[last];
+		m_pool.inwater[index] = m_pool.inwater[last];
+		m_pool.resting[index] = m_pool.resting[last];
+		m_pool.soundtype[index] = m_pool.soundtype[last];
+		m_pool.leaf[index] = m_pool.leaf[last];
+		m_pool.entity[index] = m_pool.entity[last];
+	}
+
+	if (m_pool.recycle >= m_pool.count)
+		m_pool.recycle = 0;
+}
+
+/*
+====================
+AddModel
+
+====================
+*/
+void CTempModels::AddModel( const Vector& origin, const Vector& velocity, const Vector& angles, float life, int modelindex, int soundtype )
+{
+	model_t* pmodel = IEngineStudio.GetModelByIndex(modelindex);
+	if (!pmodel)
+		return;
+
+	model_t* pworld = IEngineStudio.GetModelByIndex(1);
+	if (!pworld)
+		return;
+
+	int index = AllocModel();
+
+	m_pool.originx[index] = origin[0];
+	m_pool.originy[index] = origin[1];
+	m_pool.originz[index] = origin[2];
+	m_pool.velocityx[index] = velocity[0];
+	m_pool.velocityy[index] = velocity[1];
+	m_pool.velocityz[index] = velocity[2];
+	m_pool.anglesx[index] = angles[0];
+	m_pool.anglesy[index] = angles[1];
+	m_pool.anglesz[index] = angles[2];
+	m_pool.die[index] = m_flTime + life;
+	m_pool.inwater[index] = 0;
+	m_pool.resting[index] = 0;
+	m_pool.soundtype[index] = soundtype;
+	m_pool.leaf[index] = Mod_PointInLeaf(origin, pworld);
+
+	// Same spin and gravity R_TempModel gives shells
+	if (soundtype == TE_BOUNCE_SHELL || soundtype == TE_BOUNCE_SHOTSHELL)
+	{
+		m_pool.avelocityx[index] = gEngfuncs.pfnRandomFloat(-512, 511);
+		m_pool.avelocityy[index] = gEngfuncs.pfnRandomFloat(-255, 255);
+		m_pool.avelocityz[index] = gEngfuncs.pfnRandomFloat(-255, 255);
+	}
+	else
+	{
+		m_pool.avelocityx[index] = 0;
+		m_pool.avelocityy[index] = 0;
+		m_pool.avelocityz[index] = 0;
+	}
+
+	m_pool.gravity[index] = (soundtype == TE_BOUNCE_SHOTSHELL) ? 0.5 : 1.0;
+
+	cl_entity_t* pent = &m_pool.entity[index];
+	memset(pent, 0, sizeof(*pent));
+	pent->model = pmodel;
+	pent->curstate.modelindex = modelindex;
+	pent->curstate.rendermode = kRenderNormal;
+	pent->curstate.renderamt = 255;
+	pent->curstate.scale = 1.0;
+}
+
+/*
+====================
+PlayHitSound
+
+====================
+*/
+void CTempModels::PlayHitSound( int index, float damp )
+{
+	const char* pszSound;
+	if (m_pool.soundtype[index] == TE_BOUNCE_SHELL)
+		pszSound = g_szShellSounds[gEngfuncs.pfnRandomLong(0, 2)];
+	else if (m_pool.soundtype[index] == TE_BOUNCE_SHOTSHELL)
+		pszSound = g_szShotShellSounds[gEngfuncs.pfnRandomLong(0, 2)];
+	else
+		return;
+
+	// Same thinning the engine does for casings
+	float zvel = fabs(m_pool.velocityz[index]);
+	if (zvel < 200 && gEngfuncs.pfnRandomLong(0, 3))
+		return;
+
+	if (damp <= 0)
+		return;
+
+	vec3_t origin;
+	origin[0] = m_pool.originx[index];
+	origin[1] = m_pool.originy[index];
+	origin[2] = m_pool.originz[index];
+
+	float volume = min(1.0f, zvel / 350.0f);
+	gEngfuncs.pEventAPI->EV_PlaySound(-1, origin, CHAN_AUTO, pszSound, volume, ATTN_NORM, 0, PITCH_NORM);
+}
+
+/*
+====================
+CollideModel
+
+====================
+*/
+void CTempModels::CollideModel( int index, const Vector& prevorigin, float frametime, float gravity )
+{
+	vec3_t origin;
+	origin[0] = m_pool.originx[index];
+	origin[1] = m_pool.originy[index];
+	origin[2] = m_pool.originz[index];
+
+	model_t* pworld = IEngineStudio.GetModelByIndex(1);
+	mleaf_t* pleaf = Mod_PointInLeaf(origin, pworld);
+
+	// Leafs are convex, a move inside an open one can't cross the world
+	if (pleaf == m_pool.leaf[index] && pleaf->contents != CONTENTS_SOLID)
+	{
+		m_pool.inwater[index] = (pleaf->contents == CONTENTS_WATER) ? 1 : 0;
+		return;
+	}
+
+	vec3_t start = prevorigin;
+
+	pmtrace_t tr;
+	gEngfuncs.pEventAPI->EV_SetTraceHull(2);
+	gEngfuncs.pEventAPI->EV_PlayerTrace(start, origin, PM_STUDIO_BOX | PM_WORLD_ONLY, -1, &tr);
+
+	if (tr.fraction != 1)
+	{
+		Vector velocity(m_pool.velocityx[index], m_pool.velocityy[index], m_pool.velocityz[index]);
+
+		// Place at contact point
+		origin = start + velocity * (tr.fraction * frametime);
+
+		// Damp velocity
+		float damp = 0.5;
+		if (tr.plane.normal[2] > 0.9)
+		{
+			// Hit floor while hardly falling, stop here
+			if (velocity[2] <= 0 && velocity[2] >= gravity * frametime * -3)
+			{
+				damp = 0;
+				m_pool.resting[index] = 1;
+				m_pool.gravity[index] = 0;
+				m_pool.avelocityx[index] = 0;
+				m_pool.avelocityy[index] = 0;
+				m_pool.avelocityz[index] = 0;
+				m_pool.anglesx[index] = 0;
+				m_pool.anglesz[index] = 0;
+			}
+		}
+
+		PlayHitSound(index, damp);
+
+		// Reflect velocity
+		if (damp != 0)
+		{
+			float proj = DotProduct(velocity, tr.plane.normal);
+			VectorMA(velocity, -proj * 2, tr.plane.normal, velocity);
+
+			// Reflect rotation (fake)
+			m_pool.anglesy[index] = -m_pool.anglesy[index];
+		}
+
+		velocity = velocity * damp;
+		m_pool.anglesx[index] *= 0.9;
+		m_pool.anglesy[index] *= 0.9;
+		m_pool.anglesz[index] *= 0.9;
+
+		m_pool.originx[index] = origin[0];
+		m_pool.originy[index] = origin[1];
+		m_pool.originz[index] = origin[2];
+		m_pool.velocityx[index] = velocity[0];
+		m_pool.velocityy[index] = velocity[1];
+		m_pool.velocityz[index] = velocity[2];
+
+		pleaf = Mod_PointInLeaf(origin, pworld);
+	}
+
+	m_pool.leaf[index] = pleaf;
+	m_pool.inwater[index] = (!m_pool.resting[index] && pleaf->contents == CONTENTS_WATER) ? 1 : 0;
+}
+
+/*
+====================
+Update
+
+====================
+*/
+void CTempModels::Update( double frametime, double client_time, double cl_gravity, int ( *Callback_AddVisibleEntity )( cl_entity_t* pEntity ) )
+{
+	static float prevoriginx[MAX_TEMP_MODELS];
+	static float prevoriginy[MAX_TEMP_MODELS];
+	static float prevoriginz[MAX_TEMP_MODELS];
+
+	m_flTime = client_time;
+
+	if (!m_pool.count)
+		return;
+
+	// Don't simulate while paused
+	if (frametime > 0)
+	{
+		for (int i = 0; i < m_pool.count; )
+		{
+			if (m_pool.die[i] < m_flTime)
+				RemoveModel(i);
+			else
+				i++;
+		}
+
+		int count = m_pool.count;
+		float step = frametime;
+
+		// Straight loops over the arrays, the compiler vectorizes these
+		float* __restrict originx = m_pool.originx;
+		float* __restrict originy = m_pool.originy;
+		float* __restrict originz = m_pool.originz;
+		float* __restrict velocityx = m_pool.velocityx;
+		float* __restrict velocityy = m_pool.velocityy;
+		float* __restrict velocityz = m_pool.velocityz;
+
+		memcpy(prevoriginx, originx, count * sizeof(float));
+		memcpy(prevoriginy, originy, count * sizeof(float));
+		memcpy(prevoriginz, originz, count * sizeof(float));
+
+		for (int i = 0; i < count; i++)
+		{
+			originx[i] += velocityx[i] * step;
+			originy[i] += velocityy[i] * step;
+			originz[i] += velocityz[i] * step;
+		}
+
+		float* __restrict anglesx = m_pool.anglesx;
+		float* __restrict anglesy = m_pool.anglesy;
+		float* __restrict anglesz = m_pool.anglesz;
+		const float* __restrict avelocityx = m_pool.avelocityx;
+		const float* __restrict avelocityy = m_pool.avelocityy;
+		const float* __restrict avelocityz = m_pool.avelocityz;
+
+		for (int i = 0; i < count; i++)
+		{
+			anglesx[i] += avelocityx[i] * step;
+			anglesy[i] += avelocityy[i] * step;
+			anglesz[i] += avelocityz[i] * step;
+		}
+
+		// Only models that left their leaf get traced
+		for (int i = 0; i < count; i++)
+		{
+			if (m_pool.resting[i])
+				continue;
+
+			Vector prevorigin(prevoriginx[i], prevoriginy[i], prevoriginz[i]);
+			CollideModel(i, prevorigin, step, cl_gravity);
+		}
+
+		// Sink slowly in water, fall everywhere else
+		const float* __restrict gravity = m_pool.gravity;
+		const byte* __restrict inwater = m_pool.inwater;
+		float gravitystep = cl_gravity * step;
+
+		for (int i = 0; i < count; i++)
+		{
+			float watervelocity = min(velocityz[i] - step, 5.0f);
+			float airvelocity = velocityz[i] - gravitystep * gravity[i];
+			velocityz[i] = inwater[i] ? watervelocity : airvelocity;
+		}
+	}
+
+	for (int i = 0; i < m_pool.count; i++)
+	{
+		cl_entity_t* pent = &m_pool.entity[i];
+
+		pent->origin[0] = m_pool.originx[i];
+		pent->origin[1] = m_pool.originy[i];
+		pent->origin[2] = m_pool.originz[i];
+		pent->angles[0] = m_pool.anglesx[i];
+		pent->angles[1] = m_pool.anglesy[i];
+		pent->angles[2] = m_pool.anglesz[i];
+
+		VectorCopy(pent->origin, pent->curstate.origin);
+		VectorCopy(pent->angles, pent->curstate.angles);
+		VectorCopy(pent->angles, pent->latched.prevangles);
+
+		Callback_AddVisibleEntity(pent);
+	}
+}
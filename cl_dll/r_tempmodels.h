@@ -0,0 +1,86 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Pooled bouncing model tempents, like shell casings
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( R_TEMPMODELS_H )
+#define R_TEMPMODELS_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+// Hard cap, the oldest model is recycled when full
+#define MAX_TEMP_MODELS		256
+
+// Tempent kinematics kept as arrays so the integration
+// loops run over contiguous floats
+struct tempmodelpool_t
+{
+	int			count;
+	int			recycle;
+
+	float		originx[MAX_TEMP_MODELS];
+	float		originy[MAX_TEMP_MODELS];
+	float		originz[MAX_TEMP_MODELS];
+	float		velocityx[MAX_TEMP_MODELS];
+	float		velocityy[MAX_TEMP_MODELS];
+	float		velocityz[MAX_TEMP_MODELS];
+	float		anglesx[MAX_TEMP_MODELS];
+	float		anglesy[MAX_TEMP_MODELS];
+	float		anglesz[MAX_TEMP_MODELS];
+	float		avelocityx[MAX_TEMP_MODELS];
+	float		avelocityy[MAX_TEMP_MODELS];
+	float		avelocityz[MAX_TEMP_MODELS];
+	// Fraction of world gravity applied, 0 once at rest
+	float		gravity[MAX_TEMP_MODELS];
+	float		die[MAX_TEMP_MODELS];
+	byte		inwater[MAX_TEMP_MODELS];
+	byte		resting[MAX_TEMP_MODELS];
+	byte		soundtype[MAX_TEMP_MODELS];
+
+	// World leaf the origin is in, a move that stays in
+	// one open leaf can't hit anything and isn't traced
+	struct mleaf_s*	leaf[MAX_TEMP_MODELS];
+
+	cl_entity_t	entity[MAX_TEMP_MODELS];
+};
+
+/*
+====================
+CTempModels
+
+Mod-side replacement for R_TempModel. Collides with
+the world only, like the engine's FTENT_COLLIDEWORLD.
+====================
+*/
+class CTempModels
+{
+public:
+	CTempModels( void );
+
+public:
+	void VidInit( void );
+
+	// ev_common.cpp -> EV_EjectBrass()
+	void AddModel( const Vector& origin, const Vector& velocity, const Vector& angles, float life, int modelindex, int soundtype );
+
+	// entity.cpp -> HUD_TempEntUpdate()
+	void Update( double frametime, double client_time, double cl_gravity, int ( *Callback_AddVisibleEntity )( cl_entity_t* pEntity ) );
+
+private:
+	int AllocModel( void );
+	void RemoveModel( int index );
+	void CollideModel( int index, const Vector& prevorigin, float frametime, float gravity );
+	void PlayHitSound( int index, float damp );
+
+private:
+	tempmodelpool_t	m_pool;
+
+	// Client time of the last update
+	float			m_flTime;
+};
+
+extern CTempModels g_TempModels;
+#endif // R_TEMPMODELS_H
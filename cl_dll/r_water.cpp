@@ -20,6 +20,8 @@
 #include "r_water.h"
 #include "view.h"
 #include "triangleapi.h"
+#include "r_profile.h"
+#include "fog.h"
 
 CWaterRenderer g_WaterRenderer;
 
@@ -471,6 +473,10 @@ void CWaterRenderer::RecursiveDrawWaterWorld(mnode_t* node, model_s* pmodel)
     if (node->contents < 0)
         return; // faces already marked by engine
 
+    // Children are inside this box, none of them can show through the fog either
+    if (gFog.CullFogBBox(node->minmaxs, node->minmaxs + 3))
+        return;
+
     RecursiveDrawWaterWorld(node->children[0], pmodel);
     RecursiveDrawWaterWorld(node->children[1], pmodel);
 
@@ -526,6 +532,9 @@ void CWaterRenderer::DrawWaterForEntity(cl_entity_t* entity)
     if (R_CullBox(mins, maxs))
         return;
 
+    if (gFog.CullFogBBox(mins, maxs))
+        return;
+
     glPushMatrix();
     R_RotateForEntity(entity);
     R_SetRenderMode(entity);
@@ -559,6 +568,8 @@ void CWaterRenderer::DrawWaterForEntity(cl_entity_t* entity)
 
 void CWaterRenderer::Draw()
 {
+	R_PROFILE_SCOPE( PROF_WATER );
+
 	if (!g_ripple.enabled)
 		return;
 
@@ -588,6 +599,8 @@ void CWaterRenderer::Draw()
 
 void CWaterRenderer::DrawTransparent()
 {
+	R_PROFILE_SCOPE( PROF_WATER );
+
 	if (!g_ripple.enabled)
 		return;
 
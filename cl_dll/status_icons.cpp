@@ -17,6 +17,7 @@
 //
 #include "hud.h"
 #include "cl_util.h"
+#include "hud_spritebatch.h"
 #include "const.h"
 #include "entity_state.h"
 #include "cl_entity.h"
@@ -66,8 +67,8 @@ int CHudStatusIcons::Draw( float flTime )
 		{
 			y -= ( m_IconList[i].rc.bottom - m_IconList[i].rc.top ) + 5;
 			
-			SPR_Set( m_IconList[i].spr, m_IconList[i].r, m_IconList[i].g, m_IconList[i].b );
-			SPR_DrawAdditive( 0, x, y, &m_IconList[i].rc );
+			g_HudSpriteBatch.Set( m_IconList[i].spr, m_IconList[i].r, m_IconList[i].g, m_IconList[i].b );
+			g_HudSpriteBatch.DrawAdditive( 0, x, y, &m_IconList[i].rc );
 		}
 	}
 	
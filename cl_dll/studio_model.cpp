@@ -37,6 +37,8 @@
 #include "in_defs.h"
 #include "pm_defs.h"
 #include "fog.h"
+#include "Exports.h"
+#include "r_profile.h"
 
 extern mspriteframe_t* GetSpriteFrame(model_t* mod, int frame);
 extern void GetModelLighting(const Vector& lightposition, int effects, const Vector& skyVector, const Vector& skyColor, float directLight, alight_t& lighting);
@@ -150,6 +152,121 @@ void CStudioModelRenderer::StudioGetMinsMaxs(Vector& outMins, Vector& outMaxs)
     VectorAdd(outMaxs, m_pCurrentEntity->origin, outMaxs);
 }
 
+/*
+====================
+StudioLightsEqual
+
+====================
+*/
+static bool StudioLightsEqual(const elight_t* plight1, const elight_t* plight2)
+{
+    if (!VectorCompare(plight1->origin, plight2->origin) || !VectorCompare(plight1->color, plight2->color))
+        return false;
+
+    if (plight1->radius != plight2->radius || plight1->isSpot != plight2->isSpot)
+        return false;
+
+    if (plight1->isSpot)
+    {
+        if (!VectorCompare(plight1->direction, plight2->direction))
+            return false;
+
+        if (plight1->innerAngle != plight2->innerAngle || plight1->outerAngle != plight2->outerAngle)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+====================
+StudioCheckLightCache
+
+====================
+*/
+bool CStudioModelRenderer::StudioCheckLightCache(void)
+{
+    m_pLightCache = NULL;
+    m_bLightCacheValid = false;
+
+    if (!m_pCvarLightCache || m_pCvarLightCache->value < 1)
+        return false;
+
+    int index = m_pCurrentEntity->index;
+    if (index <= 0 || index >= MAX_LIGHTCACHE_ENTITIES)
+        return false;
+
+    if (m_pCurrentEntity == gEngfuncs.GetViewModel())
+        return false;
+
+    // Hash the bone palette, this catches both animation and movement
+    unsigned int bonehash = 2166136261u;
+    const unsigned int* pbonedata = (const unsigned int*)(*m_pbonetransform);
+    for (int i = 0; i < m_pStudioHeader->numbones * 12; i++)
+        bonehash = (bonehash ^ pbonedata[i]) * 16777619u;
+
+    float lightparams[8];
+    lightparams[0] = m_pCvarDirect->value;
+    lightparams[1] = m_pCvarLambert->value;
+    lightparams[2] = m_pSkylightDirX->value;
+    lightparams[3] = m_pSkylightDirY->value;
+    lightparams[4] = m_pSkylightDirZ->value;
+    lightparams[5] = m_pSkylightColorR->value;
+    lightparams[6] = m_pSkylightColorG->value;
+    lightparams[7] = m_pSkylightColorB->value;
+
+    // Meshes are visited in a different order when drawn right away
+    bool queued = StudioShouldQueueMeshes();
+
+    studiolightcache_t* pcache = &m_lightCache[index];
+    if (pcache->pmodel != m_pRenderModel
+        || pcache->body != m_pCurrentEntity->curstate.body
+        || pcache->skin != m_pCurrentEntity->curstate.skin
+        || pcache->effects != m_pCurrentEntity->curstate.effects
+        || pcache->rendermode != m_pCurrentEntity->curstate.rendermode
+        || pcache->weaponmodel != m_pCurrentEntity->curstate.weaponmodel
+        || pcache->queued != queued
+        || pcache->bonehash != bonehash
+        || !VectorCompare(pcache->origin, m_pCurrentEntity->origin)
+        || memcmp(pcache->lightparams, lightparams, sizeof(lightparams)))
+    {
+        // Changed since the last frame, wait until it stays put
+        pcache->pmodel = m_pRenderModel;
+        pcache->body = m_pCurrentEntity->curstate.body;
+        pcache->skin = m_pCurrentEntity->curstate.skin;
+        pcache->effects = m_pCurrentEntity->curstate.effects;
+        pcache->rendermode = m_pCurrentEntity->curstate.rendermode;
+        pcache->weaponmodel = m_pCurrentEntity->curstate.weaponmodel;
+        pcache->queued = queued;
+        pcache->bonehash = bonehash;
+        VectorCopy(m_pCurrentEntity->origin, pcache->origin);
+        memcpy(pcache->lightparams, lightparams, sizeof(lightparams));
+
+        pcache->recorded = false;
+        pcache->colors.clear();
+        return false;
+    }
+
+    m_pLightCache = pcache;
+
+    if (!pcache->recorded)
+    {
+        // Same as last frame, store the colors this time
+        pcache->recorded = true;
+        pcache->colors.clear();
+        return false;
+    }
+
+    m_lightingInfo.ambientlight = pcache->ambientlight;
+    m_lightingInfo.shadelight = pcache->shadelight;
+    VectorCopy(pcache->color, m_lightingInfo.color);
+    VectorCopy(pcache->lightdir, m_vLightDirection);
+
+    m_bLightCacheValid = true;
+    m_iLightCacheColor = 0;
+    return true;
+}
+
 /*
 ====================
 StudioEntityLight
@@ -158,15 +275,51 @@ StudioEntityLight
 */
 void CStudioModelRenderer::StudioEntityLight(void)
 {
+    R_PROFILE_SCOPE( PROF_LIGHTING );
+
     Vector mins, maxs;
     StudioGetMinsMaxs(mins, maxs);
 
-    // Get elight list
-    gELightList.GetLightList(m_pCurrentEntity->origin, mins, maxs, m_pEntityLights, &m_iNumEntityLights);
+    // Get elight list, far into the fog they (and their specular) can't be seen
+    if (m_bFogFarBand)
+        m_iNumEntityLights = 0;
+    else
+        gELightList.GetLightList(m_pCurrentEntity->origin, mins, maxs, m_pEntityLights, &m_iNumEntityLights);
 
     // Reset this anyway
     m_iClosestLight = -1;
 
+    if (m_pLightCache)
+    {
+        Vector viewDir = (Vector(m_vRenderOrigin) - Vector(m_pCurrentEntity->origin)).Normalize();
+
+        // Cached colors are only good for the same lights, seen from the same side
+        if (m_bLightCacheValid)
+        {
+            bool bMatches = (m_pLightCache->lights.size() == m_iNumEntityLights);
+            for (unsigned int i = 0; bMatches && i < m_iNumEntityLights; i++)
+                bMatches = StudioLightsEqual(&m_pLightCache->lights[i], m_pEntityLights[i]);
+
+            if (bMatches && m_iNumEntityLights > 0)
+                bMatches = VectorCompare(viewDir, m_pLightCache->viewdir) ? true : false;
+
+            if (!bMatches)
+            {
+                m_bLightCacheValid = false;
+                m_pLightCache->colors.clear();
+            }
+        }
+
+        if (!m_bLightCacheValid)
+        {
+            m_pLightCache->lights.clear();
+            for (unsigned int i = 0; i < m_iNumEntityLights; i++)
+                m_pLightCache->lights.push_back(*m_pEntityLights[i]);
+
+            VectorCopy(viewDir, m_pLightCache->viewdir);
+        }
+    }
+
     if (!m_iNumEntityLights)
         return;
 
@@ -193,6 +346,10 @@ void CStudioModelRenderer::StudioEntityLight(void)
             }
         }
 
+        // Cached colors already have this light in them
+        if (m_bLightCacheValid)
+            continue;
+
         for (int j = 0; j < m_pStudioHeader->numbones; j++)
         {
             transOrigin[0] = m_pEntityLights[i]->origin[0] - (*m_pbonetransform)[j][0][3];
@@ -298,6 +455,8 @@ StudioDrawShadow
 */
 void CStudioModelRenderer::StudioDrawShadow(void)
 {
+    R_PROFILE_SCOPE( PROF_SHADOWS );
+
     glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
 
     // Disabable these to avoid slowdown bug
@@ -559,6 +718,10 @@ StudioSetLightVectors
 */
 void CStudioModelRenderer::StudioSetLightVectors(void)
 {
+	// Not needed for cached colors
+	if (m_bLightCacheValid)
+		return;
+
 	for (int j = 0; j < m_pStudioHeader->numbones; j++)
 		VectorIRotate(m_vLightDirection, (*m_pbonetransform)[j], m_lightVectors[j]);
 }
@@ -682,6 +845,22 @@ LightValueforVertex
 */
 __forceinline void CStudioModelRenderer::LightValueforVertex(vec3_t& outColor, int vertindex, int normindex, const vec3_t& normal, const vec3_t& origin)
 {
+    if (m_bLightCacheValid)
+    {
+        if (m_iLightCacheColor < m_pLightCache->colors.size())
+        {
+            outColor = m_pLightCache->colors[m_iLightCacheColor++];
+            return;
+        }
+
+        // Out of sync with the cache, record it again next frame
+        m_pLightCache->recorded = false;
+        m_pLightCache->colors.clear();
+
+        m_bLightCacheValid = false;
+        m_pLightCache = NULL;
+    }
+
     outColor = m_lightValues[normindex];
 
     if (m_iNumEntityLights)
@@ -706,6 +885,9 @@ __forceinline void CStudioModelRenderer::LightValueforVertex(vec3_t& outColor, i
     outColor[0] = clamp(outColor[0], 0.0f, 1.0f);
     outColor[1] = clamp(outColor[1], 0.0f, 1.0f);
     outColor[2] = clamp(outColor[2], 0.0f, 1.0f);
+
+    if (m_pLightCache)
+        m_pLightCache->colors.push_back(outColor);
 }
 
 /*
@@ -725,6 +907,90 @@ __forceinline void CStudioModelRenderer::StudioChrome(int normIndex, int bone, c
 	m_chromeCoords[normIndex][1] = (n + 1.0) * 32; // FIX: make this a float
 }
 
+/*
+====================
+StudioSetupMeshTexCoords
+
+====================
+*/
+void CStudioModelRenderer::StudioSetupMeshTexCoords(void)
+{
+	// Only depends on the model, so build once and keep it
+	studiotexcoords_t& texcoords = m_meshTexCoords[m_pSubModel];
+	if (texcoords.pheader == m_pStudioHeader && texcoords.ptextureheader == m_pTextureHeader
+		&& texcoords.length == m_pStudioHeader->length
+		&& texcoords.firstcoords.size() == (size_t)m_pSubModel->nummesh)
+	{
+		m_pMeshTexCoords = &texcoords;
+		return;
+	}
+
+	mstudiomesh_t* pmeshes = (mstudiomesh_t*)((byte*)m_pStudioHeader + m_pSubModel->meshindex);
+	mstudiotexture_t* ptextures = (mstudiotexture_t*)((byte*)m_pTextureHeader + m_pTextureHeader->textureindex);
+
+	// Normalize with the default skin, other skin families mostly use the same sizes
+	short* pskinref = (short*)((byte*)m_pTextureHeader + m_pTextureHeader->skinindex);
+
+	texcoords.pheader = m_pStudioHeader;
+	texcoords.ptextureheader = m_pTextureHeader;
+	texcoords.length = m_pStudioHeader->length;
+	texcoords.widths.resize(m_pSubModel->nummesh);
+	texcoords.heights.resize(m_pSubModel->nummesh);
+	texcoords.firstcoords.resize(m_pSubModel->nummesh);
+	texcoords.coords.clear();
+
+	for (int j = 0; j < m_pSubModel->nummesh; j++)
+	{
+		mstudiomesh_t* pmesh = &pmeshes[j];
+		mstudiotexture_t* ptexture = &ptextures[pskinref[pmesh->skinref]];
+
+		float scales = 1.0f / (float)ptexture->width;
+		float scalet = 1.0f / (float)ptexture->height;
+
+		texcoords.widths[j] = ptexture->width;
+		texcoords.heights[j] = ptexture->height;
+		texcoords.firstcoords[j] = texcoords.coords.size();
+
+		short* ptricmds = (short*)((byte*)m_pStudioHeader + pmesh->triindex);
+
+		int i = 0;
+		while (i = *(ptricmds++))
+		{
+			if (i < 0)
+				i = -i;
+
+			for (; i > 0; i--, ptricmds += 4)
+			{
+				texcoords.coords.push_back(ptricmds[2] * scales);
+				texcoords.coords.push_back(ptricmds[3] * scalet);
+			}
+		}
+	}
+
+	m_pMeshTexCoords = &texcoords;
+}
+
+/*
+====================
+StudioGetMeshTexCoords
+
+====================
+*/
+const float* CStudioModelRenderer::StudioGetMeshTexCoords(mstudiomesh_t* pmesh, mstudiotexture_t* ptexture)
+{
+	if (!m_pMeshTexCoords)
+		return NULL;
+
+	mstudiomesh_t* pmeshes = (mstudiomesh_t*)((byte*)m_pStudioHeader + m_pSubModel->meshindex);
+	int meshIndex = pmesh - pmeshes;
+
+	if (m_pMeshTexCoords->widths[meshIndex] != ptexture->width
+		|| m_pMeshTexCoords->heights[meshIndex] != ptexture->height)
+		return NULL;
+
+	return m_pMeshTexCoords->coords.data() + m_pMeshTexCoords->firstcoords[meshIndex];
+}
+
 /*
 ====================
 StudioDrawMesh
@@ -747,9 +1013,8 @@ void CStudioModelRenderer::StudioDrawMesh(mstudiomesh_t* pmesh, mstudiotexture_t
 		m_uiActiveTextureId = ptexture->index;
 	}
 
-	// Set to base and scale the texture matrix
-	glLoadIdentity();
-	glScalef(1.0 / (float)ptexture->width, 1.0 / (float)ptexture->height, 1.0);
+	float scales = 1.0f / (float)ptexture->width;
+	float scalet = 1.0f / (float)ptexture->height;
 
 	if (ptexture->flags & STUDIO_NF_CHROME)
 	{
@@ -770,7 +1035,32 @@ void CStudioModelRenderer::StudioDrawMesh(mstudiomesh_t* pmesh, mstudiotexture_t
 			{
 				LightValueforVertex(color, ptricmds[0], ptricmds[1], pstudionorms[ptricmds[1]], pstudioverts[ptricmds[0]]);
 
-				glTexCoord2f(m_chromeCoords[ptricmds[1]][0], m_chromeCoords[ptricmds[1]][1]);
+				glTexCoord2f(m_chromeCoords[ptricmds[1]][0] * scales, m_chromeCoords[ptricmds[1]][1] * scalet);
+				glColor4f(color[0], color[1], color[2], alpha);
+				glVertex3fv(m_vertexTransform[ptricmds[0]]);
+			}
+			glEnd();
+		}
+	}
+	else if (const float* ptexcoords = StudioGetMeshTexCoords(pmesh, ptexture))
+	{
+		while (i = *(ptricmds++))
+		{
+			if (i < 0)
+			{
+				glBegin(GL_TRIANGLE_FAN);
+				i = -i;
+			}
+			else
+			{
+				glBegin(GL_TRIANGLE_STRIP);
+			}
+
+			for (; i > 0; i--, ptricmds += 4, ptexcoords += 2)
+			{
+				LightValueforVertex(color, ptricmds[0], ptricmds[1], pstudionorms[ptricmds[1]], pstudioverts[ptricmds[0]]);
+
+				glTexCoord2fv(ptexcoords);
 				glColor4f(color[0], color[1], color[2], alpha);
 				glVertex3fv(m_vertexTransform[ptricmds[0]]);
 			}
@@ -779,6 +1069,7 @@ void CStudioModelRenderer::StudioDrawMesh(mstudiomesh_t* pmesh, mstudiotexture_t
 	}
 	else
 	{
+		// Skin texture has a different size than the cached texcoords
 		while (i = *(ptricmds++))
 		{
 			if (i < 0)
@@ -795,7 +1086,7 @@ void CStudioModelRenderer::StudioDrawMesh(mstudiomesh_t* pmesh, mstudiotexture_t
 			{
 				LightValueforVertex(color, ptricmds[0], ptricmds[1], pstudionorms[ptricmds[1]], pstudioverts[ptricmds[0]]);
 
-				glTexCoord2i(ptricmds[2], ptricmds[3]);
+				glTexCoord2f(ptricmds[2] * scales, ptricmds[3] * scalet);
 				glColor4f(color[0], color[1], color[2], alpha);
 				glVertex3fv(m_vertexTransform[ptricmds[0]]);
 			}
@@ -804,6 +1095,146 @@ void CStudioModelRenderer::StudioDrawMesh(mstudiomesh_t* pmesh, mstudiotexture_t
 	}
 }
 
+/*
+====================
+StudioShouldQueueMeshes
+
+====================
+*/
+bool CStudioModelRenderer::StudioShouldQueueMeshes(void)
+{
+	if (!g_StudioRenderQueue.IsActive())
+		return false;
+
+	// Transparent entities are sorted and drawn by the engine
+	if (m_pCurrentEntity->curstate.rendermode != kRenderNormal)
+		return false;
+
+	// These use their own depth range, so they have to be drawn right away
+	if (m_pCurrentEntity == gEngfuncs.GetViewModel())
+		return false;
+
+	// The shell is drawn right away without writing depth, so the
+	// body has to be drawn before it too or it covers its own shell
+	if (m_pCurrentEntity->curstate.renderfx == kRenderFxGlowShell)
+		return false;
+
+	if (m_pCurrentEntity == gEngfuncs.GetLocalPlayer() && !CL_IsThirdPerson())
+		return false;
+
+	return true;
+}
+
+/*
+====================
+StudioQueueMesh
+
+====================
+*/
+void CStudioModelRenderer::StudioQueueMesh(mstudiomesh_t* pmesh, mstudiotexture_t* ptexture, float alpha, studioqueue_pass_t pass)
+{
+	int i;
+	vec3_t color;
+
+	static studioqueuevert_t stripverts[MAXSTUDIOVERTS];
+
+	vec3_t* pstudioverts = (vec3_t*)((byte*)m_pStudioHeader + m_pSubModel->vertindex);
+	vec3_t* pstudionorms = (vec3_t*)((byte*)m_pStudioHeader + m_pSubModel->normindex);
+
+	short* ptricmds = (short*)((byte*)m_pStudioHeader + pmesh->triindex);
+
+	// Count the triangle list size first
+	int maxvertexes = 0;
+	while (i = *(ptricmds++))
+	{
+		if (i < 0)
+			i = -i;
+
+		if (i > 2)
+			maxvertexes += (i - 2) * 3;
+
+		ptricmds += 4 * i;
+	}
+
+	if (!maxvertexes)
+		return;
+
+	float scales = 1.0f / (float)ptexture->width;
+	float scalet = 1.0f / (float)ptexture->height;
+	bool isChrome = (ptexture->flags & STUDIO_NF_CHROME) ? true : false;
+	const float* ptexcoords = isChrome ? NULL : StudioGetMeshTexCoords(pmesh, ptexture);
+
+	studioqueuevert_t* poutverts = g_StudioRenderQueue.BeginMesh(ptexture->index, pass, maxvertexes);
+	int numoutverts = 0;
+
+	ptricmds = (short*)((byte*)m_pStudioHeader + pmesh->triindex);
+	while (i = *(ptricmds++))
+	{
+		bool isFan = false;
+		if (i < 0)
+		{
+			isFan = true;
+			i = -i;
+		}
+
+		// Light and transform the strip or fan once
+		int numstripverts = i;
+		for (int j = 0; j < numstripverts; j++, ptricmds += 4)
+		{
+			studioqueuevert_t& vert = stripverts[j];
+			LightValueforVertex(color, ptricmds[0], ptricmds[1], pstudionorms[ptricmds[1]], pstudioverts[ptricmds[0]]);
+
+			VectorCopy(m_vertexTransform[ptricmds[0]], vert.origin);
+			vert.color[0] = color[0];
+			vert.color[1] = color[1];
+			vert.color[2] = color[2];
+			vert.color[3] = alpha;
+
+			if (isChrome)
+			{
+				vert.texcoord[0] = m_chromeCoords[ptricmds[1]][0] * scales;
+				vert.texcoord[1] = m_chromeCoords[ptricmds[1]][1] * scalet;
+			}
+			else if (ptexcoords)
+			{
+				vert.texcoord[0] = ptexcoords[0];
+				vert.texcoord[1] = ptexcoords[1];
+				ptexcoords += 2;
+			}
+			else
+			{
+				vert.texcoord[0] = ptricmds[2] * scales;
+				vert.texcoord[1] = ptricmds[3] * scalet;
+			}
+		}
+
+		// Expand into a triangle list, keeping the winding order
+		for (int j = 2; j < numstripverts; j++)
+		{
+			if (isFan)
+			{
+				poutverts[numoutverts++] = stripverts[0];
+				poutverts[numoutverts++] = stripverts[j - 1];
+				poutverts[numoutverts++] = stripverts[j];
+			}
+			else if (j & 1)
+			{
+				poutverts[numoutverts++] = stripverts[j - 1];
+				poutverts[numoutverts++] = stripverts[j - 2];
+				poutverts[numoutverts++] = stripverts[j];
+			}
+			else
+			{
+				poutverts[numoutverts++] = stripverts[j - 2];
+				poutverts[numoutverts++] = stripverts[j - 1];
+				poutverts[numoutverts++] = stripverts[j];
+			}
+		}
+	}
+
+	g_StudioRenderQueue.EndMesh(numoutverts);
+}
+
 /*
 ====================
 StudioDrawPoints
@@ -841,15 +1272,20 @@ void CStudioModelRenderer::StudioDrawPoints(void)
 		VectorTransform(pstudioverts[i], (*m_pbonetransform)[pvertbone[i]], m_vertexTransform[i]);
 
 	//
-	// Calculate light values
+	// Calculate light values, cached colors already have them
 	//
-	for (int j = 0, normIndex = 0; j < m_pSubModel->nummesh; j++)
+	if (!m_bLightCacheValid)
 	{
-		int flags = ptextures[pskinref[pmeshes[j].skinref]].flags;
-		for (int i = 0; i < pmeshes[j].numnorms; i++, normIndex++)
+		R_PROFILE_SCOPE( PROF_LIGHTING );
+
+		for (int j = 0, normIndex = 0; j < m_pSubModel->nummesh; j++)
 		{
-			StudioLighting(&lightStrength, pnormbone[normIndex], flags, (float*)pstudionorms[normIndex]);
-			VectorScale(m_lightingInfo.color, lightStrength, m_lightValues[normIndex]);
+			int flags = ptextures[pskinref[pmeshes[j].skinref]].flags;
+			for (int i = 0; i < pmeshes[j].numnorms; i++, normIndex++)
+			{
+				StudioLighting(&lightStrength, pnormbone[normIndex], flags, (float*)pstudionorms[normIndex]);
+				VectorScale(m_lightingInfo.color, lightStrength, m_lightValues[normIndex]);
+			}
 		}
 	}
 
@@ -875,16 +1311,39 @@ void CStudioModelRenderer::StudioDrawPoints(void)
 	//
 	// Calculate light data for elights
 	//
-	if (m_iNumEntityLights > 0)
+	if (m_iNumEntityLights > 0 && !m_bLightCacheValid)
 	{
 		for (int i = 0; i < m_pSubModel->numverts; i++)
 			StudioLightsforVertex(i, pvertbone[i], pstudioverts[i]);
 	}
 
-	// Set matrix mode to texture here
-	glMatrixMode(GL_TEXTURE);
+	// Get the normalized texcoords for this submodel
+	StudioSetupMeshTexCoords();
+
+	//
+	// Defer the meshes so they get sorted by state with other entities
+	//
+	if (StudioShouldQueueMeshes())
+	{
+		for (int j = 0; j < m_pSubModel->nummesh; j++)
+		{
+			mstudiomesh_t* pmesh = &pmeshes[j];
+			mstudiotexture_t* ptexture = &ptextures[pskinref[pmesh->skinref]];
+
+			if (ptexture->flags & STUDIO_NF_ADDITIVE)
+				StudioQueueMesh(pmesh, ptexture, alpha, SQ_PASS_ADDITIVE);
+			else if (ptexture->flags & STUDIO_NF_ALPHABLEND)
+				StudioQueueMesh(pmesh, ptexture, alpha * 0.25, SQ_PASS_ALPHABLEND);
+			else if (ptexture->flags & STUDIO_NF_ALPHATEST)
+				StudioQueueMesh(pmesh, ptexture, alpha, SQ_PASS_ALPHATEST);
+			else
+				StudioQueueMesh(pmesh, ptexture, alpha, SQ_PASS_OPAQUE);
+		}
+
+		return;
+	}
 
-	int flags;
+	int flags = 0;
 	for (int j = 0; j < m_pSubModel->nummesh; j++)
 	{
 		mstudiomesh_t* pmesh = &pmeshes[j];
@@ -954,11 +1413,6 @@ void CStudioModelRenderer::StudioDrawPoints(void)
 		glDepthMask(GL_TRUE);
 		glDisable(GL_BLEND);
 	}
-
-	glMatrixMode(GL_TEXTURE);
-	glLoadIdentity();
-
-	glMatrixMode(GL_MODELVIEW);
 }
 
 /*
@@ -1003,15 +1457,24 @@ StudioSetupGlowShellNormals
 */
 void CStudioModelRenderer::StudioSetupGlowShellNormals(void)
 {
+	// Only depends on the model, so build once and keep it
+	glowshellnormals_t& shell = m_glowShellNormals[m_pSubModel];
+	if (shell.pheader == m_pStudioHeader && shell.length == m_pStudioHeader->length
+		&& shell.normals.size() == (size_t)m_pSubModel->numverts)
+	{
+		m_pGlowShellNormals = shell.normals.data();
+		return;
+	}
+
 	vec3_t* pstudionorms = (vec3_t*)((byte*)m_pStudioHeader + m_pSubModel->normindex);
 	mstudiomesh_t* pmeshes = (mstudiomesh_t*)((byte*)m_pStudioHeader + m_pSubModel->meshindex);
 
 	// Reset the array
-	for (int i = 0; i < m_pSubModel->numverts; i++)
-	{
-		m_vertexNormals[i] = Vector(0, 0, 0);
-		m_vertexNumNormals[i] = 0;
-	}
+	shell.pheader = m_pStudioHeader;
+	shell.length = m_pStudioHeader->length;
+	shell.normals.assign(m_pSubModel->numverts, Vector(0, 0, 0));
+
+	std::vector<int> numNormals(m_pSubModel->numverts, 0);
 
 	// Use tricmds to construct the combined normals
 	for (int j = 0; j < m_pSubModel->nummesh; j++)
@@ -1028,15 +1491,20 @@ void CStudioModelRenderer::StudioSetupGlowShellNormals(void)
 
 			for (; i > 0; i--, ptricmds += 4)
 			{
-				VectorAdd(m_vertexNormals[ptricmds[0]], pstudionorms[ptricmds[1]], m_vertexNormals[ptricmds[0]]);
-				m_vertexNumNormals[ptricmds[0]]++;
+				VectorAdd(shell.normals[ptricmds[0]], pstudionorms[ptricmds[1]], shell.normals[ptricmds[0]]);
+				numNormals[ptricmds[0]]++;
 			}
 		}
 	}
 
 	// Calculate final result
 	for (int i = 0; i < m_pSubModel->numverts; i++)
-		VectorScale(m_vertexNormals[i], 1.0f / (float)(m_vertexNumNormals[i]), m_vertexNormals[i]);
+	{
+		if (numNormals[i])
+			VectorScale(shell.normals[i], 1.0f / (float)numNormals[i], shell.normals[i]);
+	}
+
+	m_pGlowShellNormals = shell.normals.data();
 }
 
 /*
@@ -1062,14 +1530,14 @@ void CStudioModelRenderer::StudioDrawGlowShell(void)
 	if (skinNum != 0 && skinNum < m_pTextureHeader->numskinfamilies)
 		pskinref += (skinNum * m_pTextureHeader->numskinref);
 
-	// Set the vectors for this crap
+	// Get the smoothed normals for this submodel
 	StudioSetupGlowShellNormals();
 
 	//
 	// Calculate chrome for each vertex
 	//
 	for (int i = 0; i < m_pSubModel->numverts; i++)
-		StudioChrome(i, pvertbone[i], m_vertexNormals[i]);
+		StudioChrome(i, pvertbone[i], m_pGlowShellNormals[i]);
 
 	//
 	// Transform the vertices
@@ -1079,7 +1547,7 @@ void CStudioModelRenderer::StudioDrawGlowShell(void)
 
 	for (int i = 0; i < m_pSubModel->numverts; i++)
 	{
-		VectorMA(pstudioverts[i], scale, m_vertexNormals[i], vertexPosition);
+		VectorMA(pstudioverts[i], scale, m_pGlowShellNormals[i], vertexPosition);
 		VectorTransform(vertexPosition, (*m_pbonetransform)[pvertbone[i]], m_vertexTransform[i]);
 	}
 
@@ -1098,8 +1566,6 @@ void CStudioModelRenderer::StudioDrawGlowShell(void)
 	glBindTexture(GL_TEXTURE_2D, pframe->gl_texturenum);
 	m_uiActiveTextureId = pframe->gl_texturenum;
 
-	glMatrixMode(GL_TEXTURE);
-
 	for (int j = 0; j < m_pSubModel->nummesh; j++)
 	{
 		mstudiomesh_t* pmesh = &pmeshes[j];
@@ -1107,10 +1573,9 @@ void CStudioModelRenderer::StudioDrawGlowShell(void)
 
 		short* ptricmds = (short*)((byte*)m_pStudioHeader + pmesh->triindex);
 
-		// Set to base and scale the texture matrix
-
-		glLoadIdentity();
-		glScalef(1.0 / (float)ptexture->width, 1.0 / (float)ptexture->height, 1.0);
+		// Chrome coords are scaled by the mesh texture size
+		float scales = 1.0f / (float)ptexture->width;
+		float scalet = 1.0f / (float)ptexture->height;
 
 		int i = 0;
 		while (i = *(ptricmds++))
@@ -1128,19 +1593,12 @@ void CStudioModelRenderer::StudioDrawGlowShell(void)
 
 			for (; i > 0; i--, ptricmds += 4)
 			{
-				glTexCoord2f(m_chromeCoords[ptricmds[0]][0], m_chromeCoords[ptricmds[0]][1]);
+				glTexCoord2f(m_chromeCoords[ptricmds[0]][0] * scales, m_chromeCoords[ptricmds[0]][1] * scalet);
 				glVertex3fv(m_vertexTransform[ptricmds[0]]);
 			}
 			glEnd();
 		}
-
-		glPopMatrix();
 	}
-
-	glMatrixMode(GL_TEXTURE);
-	glLoadIdentity();
-
-	glMatrixMode(GL_MODELVIEW);
 }
 
 /*
@@ -1151,6 +1609,11 @@ StudioDynamicLight
 */
 void CStudioModelRenderer::StudioDynamicLight(void)
 {
+	R_PROFILE_SCOPE( PROF_LIGHTING );
+
+	if (StudioCheckLightCache())
+		return;
+
 	Vector skyVector;
 	skyVector.x = m_pSkylightDirX->value;
 	skyVector.y = m_pSkylightDirY->value;
@@ -1164,4 +1627,12 @@ void CStudioModelRenderer::StudioDynamicLight(void)
 	VectorScale(skyColor, 1.0f / 255.0f, skyColor);
 
 	GetModelLighting(m_pCurrentEntity->origin, m_pCurrentEntity->curstate.effects, skyVector, skyColor, m_pCvarDirect->value, m_lightingInfo);
+
+	if (m_pLightCache)
+	{
+		m_pLightCache->ambientlight = m_lightingInfo.ambientlight;
+		m_pLightCache->shadelight = m_lightingInfo.shadelight;
+		VectorCopy(m_lightingInfo.color, m_pLightCache->color);
+		VectorCopy(m_vLightDirection, m_pLightCache->lightdir);
+	}
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "event_args.h"
 #include "pmtrace.h"
 #include "pm_defs.h"
+#include "r_lightgrid.h"
 
 extern engine_studio_api_t IEngineStudio;
 
@@ -161,13 +162,13 @@ void VectorRotate (const float *in1, float in2[3][4], float *out)
 
 __forceinline float Q_rsqrt( float number )
 {
-        long i;
+        int i;
         float x2, y;
         const float threehalfs = 1.5F;
  
         x2 = number * 0.5F;
         y  = number;
-        i  = * ( long * ) &y;                       // evil floating point bit level hacking
+        i  = * ( int * ) &y;                        // evil floating point bit level hacking
         i  = 0x5f3759df - ( i >> 1 );               // what the fuck?
         y  = * ( float * ) &i;
         y  = y * ( threehalfs - ( x2 * y * y ) );   // 1st iteration
@@ -199,7 +200,7 @@ void ParseColor (vec3_t &out, color24 *lightmap)
 // RecursiveLightPoint
 //
 //===========================================
-int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, const vec3_t &end, vec3_t &color )
+int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, const vec3_t &end, vec3_t &color, vec3_t *pimpact = NULL )
 {
 	float		front, back, frac;
 	int			side;
@@ -220,7 +221,7 @@ int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, co
 	side = front < 0;
 	
 	if ( (back < 0) == side )
-		return RecursiveLightPoint (pworld, node->children[side], start, end, color);
+		return RecursiveLightPoint (pworld, node->children[side], start, end, color, pimpact);
 	
 	frac = front / (front-back);
 	mid[0] = start[0] + (end[0] - start[0])*frac;
@@ -228,7 +229,7 @@ int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, co
 	mid[2] = start[2] + (end[2] - start[2])*frac;
 	
 // go down front side	
-	int r = RecursiveLightPoint (pworld, node->children[side], start, mid, color);
+	int r = RecursiveLightPoint (pworld, node->children[side], start, mid, color, pimpact);
 
 	if (r) 
 		return TRUE;
@@ -284,11 +285,15 @@ int RecursiveLightPoint( model_t* pworld, mnode_t *node, const vec3_t &start, co
 		{
 			color[0] = color[1] = color[2] = 0.5;
 		}
+
+		if (pimpact)
+			VectorCopy(mid, (*pimpact));
+
 		return TRUE;
 	}
 
 // go down back side
-	return RecursiveLightPoint (pworld, node->children[!side], mid, end, color);
+	return RecursiveLightPoint (pworld, node->children[!side], mid, end, color, pimpact);
 }
 
 //===========================================
@@ -333,6 +338,11 @@ void GetModelLighting( const Vector& lightposition, int effects, const Vector& s
 			lightcolor = Vector(1.0, 1.0, 1.0);
 			lightdirection = Vector(0, 0, -1);
 		}
+		else if(!(effects & EF_INVLIGHT) && g_LightProbeGrid.GetLighting(lightposition + Vector(0, 0, 8), lightcolor, lightdirection))
+		{
+			// Interpolated from the probes around us
+			VectorNormalizeFast(lightdirection);
+		}
 		else
 		{
 			Vector vecSrc;
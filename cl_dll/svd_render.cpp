@@ -37,6 +37,7 @@
 #include "svdformat.h"
 #include "svd_render.h"
 #include "fog.h"
+#include "r_profile.h"
 
 // Quake definitions
 #define	SURF_PLANEBACK		2
@@ -376,6 +377,10 @@ void SVD_RecursiveDrawWorld ( mnode_t *node )
 	if (node->contents < 0)
 		return;		// faces already marked by engine
 
+	// Past the fog end the shadow would blend fog color onto fog color
+	if (gFog.CullFogBBox(node->minmaxs, node->minmaxs + 3))
+		return;
+
 	// recurse down the children, Order doesn't matter
 	SVD_RecursiveDrawWorld (node->children[0]);
 	SVD_RecursiveDrawWorld (node->children[1]);
@@ -416,6 +421,8 @@ SVD_CalcRefDef
 */
 void SVD_CalcRefDef ( ref_params_t* pparams )
 {
+	R_PROFILE_SCOPE( PROF_SVD );
+
 	if(IEngineStudio.IsHardware() != 1)
 		return;
 
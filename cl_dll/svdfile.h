@@ -0,0 +1,62 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: On-disk layout of .svd shadow volume data files
+//
+// $NoKeywords: $
+//=============================================================================
+
+#ifndef SVD_FILE_HEADER
+#define SVD_FILE_HEADER
+
+// Kept free of engine headers so tools can read .svd files too
+
+#define SVD_VERSION		4
+
+struct svdedge_t
+{
+	int vertex0;
+	int vertex1;
+	int face0;
+	int face1;
+};
+
+struct svdface_t
+{
+	int vertex0;
+	int vertex1;
+	int vertex2;
+};
+
+struct svdsubmodel_t
+{
+	int faceindex;
+	int numfaces;
+
+	int edgeindex;
+	int numedges;
+
+	int vertinfoindex;
+	int vertexindex;
+	int numverts;
+};
+
+struct svdbodypart_t
+{
+	int base;
+	int submodelindex;
+	int numsubmodels;
+};
+
+struct svdheader_t
+{
+	int version;
+	char modelname[64];
+	int mdl_size;
+
+	int bodypartindex;
+	int numbodyparts;
+
+	int num_faces;
+	int num_edges;
+};
+#endif
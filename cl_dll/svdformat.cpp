@@ -298,7 +298,7 @@ svdheader_t* SVD_Create( char* filename, model_t* pmodel )
 	if (pstudiohdr->numbodyparts == 0)
 	{
 		gEngfuncs.Con_Printf("Error: model %s has 0 submodels\n", pmodel->name);
-		return false;
+		return NULL;
 	}
 	
 	// Allocate the buffer
@@ -10,57 +10,9 @@
 
 #include "com_model.h"
 #include "studio.h"
+#include "svdfile.h"
 
 #define MAX_SVD_FILES	512
-#define SVD_VERSION		4
-
-struct svdedge_t
-{
-	int vertex0;
-	int vertex1;
-	int face0;
-	int face1;
-};
-
-struct svdface_t
-{
-	int vertex0;
-	int vertex1;
-	int vertex2;
-};
-
-struct svdsubmodel_t
-{
-	int faceindex;
-	int numfaces;
-
-	int edgeindex;
-	int numedges;
-
-	int vertinfoindex;
-	int vertexindex;
-	int numverts;
-};
-
-struct svdbodypart_t
-{
-	int base;
-	int submodelindex;
-	int numsubmodels;
-};
-
-struct svdheader_t
-{
-	int version;
-	char modelname[64];
-	int mdl_size;
-
-	int bodypartindex;
-	int numbodyparts;
-
-	int num_faces;
-	int num_edges;
-};
 
 svdheader_t* SVD_Create( char* filename, model_t* pmodel );
 bool SVD_LoadSVDForModel( model_t* pmodel );
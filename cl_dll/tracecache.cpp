@@ -0,0 +1,132 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Shares view traces between the code that runs them each frame
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "pm_defs.h"
+#include "event_api.h"
+
+#include "tracecache.h"
+
+// Class declaration
+CTraceCache g_TraceCache;
+
+/*
+====================
+CTraceCache
+
+====================
+*/
+CTraceCache::CTraceCache( void )
+{
+	m_iNumTraces = 0;
+	m_iNextTrace = 0;
+	m_flFrameTime = -1;
+	m_bPredictionSetup = false;
+}
+
+/*
+====================
+VidInit
+
+====================
+*/
+void CTraceCache::VidInit( void )
+{
+	// Client time starts over on the new level
+	m_iNumTraces = 0;
+	m_iNextTrace = 0;
+	m_flFrameTime = -1;
+	m_bPredictionSetup = false;
+}
+
+/*
+====================
+CheckFrame
+
+====================
+*/
+void CTraceCache::CheckFrame( void )
+{
+	// Nothing moves while the time stands still, so
+	// results stay good until the client time changes
+	float time = gEngfuncs.GetClientTime();
+	if (time == m_flFrameTime)
+		return;
+
+	m_flFrameTime = time;
+	m_iNumTraces = 0;
+	m_iNextTrace = 0;
+	m_bPredictionSetup = false;
+}
+
+/*
+====================
+PlayerTrace
+
+====================
+*/
+void CTraceCache::PlayerTrace( const vec3_t& start, const vec3_t& end, int hull, int traceflags, pmtrace_t* ptr, int player )
+{
+	CheckFrame();
+
+	if (player == -1)
+		player = gEngfuncs.GetLocalPlayer()->index;
+
+	for (int i = 0; i < m_iNumTraces; i++)
+	{
+		const cachedtrace_t& trace = m_traces[i];
+		if (trace.hull != hull || trace.traceflags != traceflags || trace.player != player)
+			continue;
+
+		if (trace.start != start || trace.end != end)
+			continue;
+
+		*ptr = trace.result;
+		return;
+	}
+
+	cachedtrace_t& trace = m_traces[m_iNextTrace];
+	m_iNextTrace = (m_iNextTrace + 1) % MAX_FRAME_TRACES;
+	if (m_iNumTraces < MAX_FRAME_TRACES)
+		m_iNumTraces++;
+
+	VectorCopy(start, trace.start);
+	VectorCopy(end, trace.end);
+	trace.hull = hull;
+	trace.traceflags = traceflags;
+	trace.player = player;
+
+	if (traceflags & PM_WORLD_ONLY)
+	{
+		// Players don't matter, skip the prediction setup
+		gEngfuncs.pEventAPI->EV_SetTraceHull(hull);
+		gEngfuncs.pEventAPI->EV_PlayerTrace(trace.start, trace.end, traceflags, -1, &trace.result);
+	}
+	else
+	{
+		if (!m_bPredictionSetup)
+		{
+			gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction(false, true);
+			m_bPredictionSetup = true;
+		}
+
+		// Store off the old count
+		gEngfuncs.pEventAPI->EV_PushPMStates();
+
+		// Now add in all of the players
+		gEngfuncs.pEventAPI->EV_SetSolidPlayers(player - 1);
+
+		gEngfuncs.pEventAPI->EV_SetTraceHull(hull);
+		gEngfuncs.pEventAPI->EV_PlayerTrace(trace.start, trace.end, traceflags, -1, &trace.result);
+
+		gEngfuncs.pEventAPI->EV_PopPMStates();
+	}
+
+	*ptr = trace.result;
+}
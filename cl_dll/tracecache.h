@@ -0,0 +1,69 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Shares view traces between the code that runs them each frame
+//
+// $NoKeywords: $
+//=============================================================================
+
+#if !defined ( TRACECACHE_H )
+#define TRACECACHE_H
+#if defined( _WIN32 )
+#pragma once
+#endif
+
+#include "pmtrace.h"
+
+// Most distinct traces remembered in a frame, the oldest is replaced when full
+#define MAX_FRAME_TRACES	32
+
+struct cachedtrace_t
+{
+	vec3_t		start;
+	vec3_t		end;
+	int			hull;
+	int			traceflags;
+	int			player;
+
+	pmtrace_t	result;
+};
+
+/*
+====================
+CTraceCache
+
+Memoizes EV_PlayerTrace results for the current frame.
+Traces are run with every player but one solid, the local
+one unless the caller says otherwise, like the view code
+always did. Player prediction is set up once per frame
+instead of once per trace.
+====================
+*/
+class CTraceCache
+{
+public:
+	CTraceCache( void );
+
+public:
+	void VidInit( void );
+
+	// Same as EV_PlayerTrace, reuses the result of an identical trace from this frame.
+	// player is the entity index left out of the solid players, -1 for the local player
+	void PlayerTrace( const vec3_t& start, const vec3_t& end, int hull, int traceflags, pmtrace_t* ptr, int player = -1 );
+
+private:
+	void CheckFrame( void );
+
+private:
+	cachedtrace_t	m_traces[MAX_FRAME_TRACES];
+	int				m_iNumTraces;
+	int				m_iNextTrace;
+
+	// Client time the cached traces belong to
+	float			m_flFrameTime;
+
+	// Player prediction was set up this frame
+	bool			m_bPredictionSetup;
+};
+
+extern CTraceCache g_TraceCache;
+#endif // TRACECACHE_H
@@ -21,6 +21,9 @@
 #include "elightlist.h"
 #include "r_water.h"
 #include "r_studioint.h"
+#include "r_studioqueue.h"
+#include "r_particles.h"
+#include "r_profile.h"
 extern engine_studio_api_t IEngineStudio;
 
 void UpdateLaserSpot();
@@ -96,6 +99,8 @@ void DrawQuad(int width, int height, int ofsX, int ofsY)
 
 void RenderScreenGlow(void)
 {
+	R_PROFILE_SCOPE( PROF_SCREENGLOW );
+
 	// check to see if (a) we can render it, and (b) we're meant to render it
 
 	if (IEngineStudio.IsHardware() != 1)
@@ -243,6 +248,10 @@ Non-transparent triangles-- add them here
 */
 void DLLEXPORT HUD_DrawNormalTriangles( void )
 {
+	// Draw the studio meshes deferred during the solid entity pass. They
+	// belong to the solid pass, so they go in before water writes depth
+	g_StudioRenderQueue.Flush();
+
     g_WaterRenderer.Draw();
 
 	gHUD.m_Spectator.DrawOverview();
@@ -266,6 +275,8 @@ void DLLEXPORT HUD_DrawTransparentTriangles( void )
 
 	UpdateLaserSpot();
 
+	g_ImpactParticles.Draw();
+
     g_WaterRenderer.DrawTransparent();
 
 	gFog.BlackFog();
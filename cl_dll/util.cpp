@@ -18,7 +18,7 @@
 // implementation of class-less helper functions
 //
 
-#include <Windows.h>
+#include <windows.h>
 
 #include <cstdio>
 #include <cstdlib>
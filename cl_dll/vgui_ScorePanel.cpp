@@ -72,6 +72,13 @@ SBColumnInfo g_ColumnInfo[NUM_COLUMNS] =
 #define TEAM_SPECTATORS		2
 #define TEAM_BLANK			3
 
+// Row states that never come out of the sort
+#define ROW_HIDDEN			-1
+#define ROW_UNSTYLED		-2
+
+// scorerow_t highlight for our own name, killer alphas stay below it
+#define ROW_HIGHLIGHT_SELF	256
+
 
 //-----------------------------------------------------------------------------
 // ScorePanel::HitTestPanel.
@@ -245,6 +252,26 @@ void ScorePanel::Initialize( void )
 	m_iNumTeams = 0;
 	memset( g_PlayerExtraInfo, 0, sizeof g_PlayerExtraInfo );
 	memset( g_TeamInfo, 0, sizeof g_TeamInfo );
+
+	// Everyone is on zero, so slot order is score order
+	int i;
+	for ( i = 0; i < MAX_PLAYERS - 1; i++ )
+		m_iPlayerOrder[i] = i + 1;
+
+	for ( i = 0; i < MAX_TEAMS; i++ )
+		m_iTeamOrder[i] = i + 1;
+
+	memset( m_bPlayerDirty, 1, sizeof m_bPlayerDirty );
+	memset( m_iLastPing, 0, sizeof m_iLastPing );
+	memset( m_szLastName, 0, sizeof m_szLastName );
+	m_iLastTeamNumber = 0;
+
+	// Force every label to be restyled on the next fill
+	for ( i = 0; i < NUM_ROWS; i++ )
+	{
+		m_RowState[i].type = ROW_UNSTYLED;
+		m_bRowDirty[i] = true;
+	}
 }
 
 bool HACK_GetPlayerUniqueID( int iPlayer, char playerID[16] )
@@ -268,14 +295,32 @@ void ScorePanel::Update()
 	m_iRows = 0;
 	gViewPort->GetAllPlayersInfo();
 
-	// Clear out sorts
-	for (int i = 0; i < NUM_ROWS; i++)
+	// Pick up ping and name changes, scores come in through ScoreInfo()
+	int i;
+	for ( i = 1; i < MAX_PLAYERS; i++ )
+	{
+		hud_player_info_t *pl_info = &g_PlayerInfoList[i];
+		const char *pszName = pl_info->name ? pl_info->name : "";
+
+		if ( m_iLastPing[i] != pl_info->ping || strncmp( m_szLastName[i], pszName, MAX_PLAYER_NAME_LENGTH - 1 ) )
+		{
+			m_iLastPing[i] = pl_info->ping;
+			strncpy( m_szLastName[i], pszName, MAX_PLAYER_NAME_LENGTH - 1 );
+			m_szLastName[i][MAX_PLAYER_NAME_LENGTH - 1] = 0;
+			m_bPlayerDirty[i] = true;
+		}
+	}
+
+	// The class column depends on which team we're on
+	if ( m_iLastTeamNumber != g_iTeamNumber )
 	{
-		m_iSortedRows[i] = 0;
-		m_iIsATeam[i] = TEAM_NO;
-		m_bHasBeenSorted[i] = false;
+		m_iLastTeamNumber = g_iTeamNumber;
+		memset( m_bPlayerDirty, 1, sizeof m_bPlayerDirty );
 	}
 
+	// Clear out sorts
+	memset( m_bHasBeenSorted, 0, sizeof m_bHasBeenSorted );
+
 	// If it's not teamplay, sort all the players. Otherwise, sort the teams.
 	if ( !gHUD.m_Teamplay )
 		SortPlayers( 0, NULL );
@@ -285,7 +330,13 @@ void ScorePanel::Update()
 	// set scrollbar range
 	m_PlayerList.SetScrollRange(m_iRows);
 
-	FillGrid();
+	// Labels are only touched while the board is up, the dirty flags
+	// keep piling up until then
+	if ( isVisible() )
+	{
+		FillGrid();
+		memset( m_bPlayerDirty, 0, sizeof m_bPlayerDirty );
+	}
 
 	if ( gViewPort->m_pSpectatorPanel->m_menuVisible )
 	{
@@ -297,6 +348,96 @@ void ScorePanel::Update()
 	}
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: Score order, most frags then fewest deaths, ties go to the lower index
+//-----------------------------------------------------------------------------
+static bool PlayerBeats( int a, int b )
+{
+	if ( g_PlayerExtraInfo[a].frags != g_PlayerExtraInfo[b].frags )
+		return g_PlayerExtraInfo[a].frags > g_PlayerExtraInfo[b].frags;
+
+	if ( g_PlayerExtraInfo[a].deaths != g_PlayerExtraInfo[b].deaths )
+		return g_PlayerExtraInfo[a].deaths < g_PlayerExtraInfo[b].deaths;
+
+	return a < b;
+}
+
+static bool TeamBeats( int a, int b )
+{
+	if ( g_TeamInfo[a].frags != g_TeamInfo[b].frags )
+		return g_TeamInfo[a].frags > g_TeamInfo[b].frags;
+
+	if ( g_TeamInfo[a].deaths != g_TeamInfo[b].deaths )
+		return g_TeamInfo[a].deaths < g_TeamInfo[b].deaths;
+
+	return a < b;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: A player's score changed, move them to their new place in the order
+//-----------------------------------------------------------------------------
+void ScorePanel::MovePlayer( int iPlayer )
+{
+	int count = MAX_PLAYERS - 1;
+
+	int pos;
+	for ( pos = 0; pos < count; pos++ )
+	{
+		if ( m_iPlayerOrder[pos] == iPlayer )
+			break;
+	}
+
+	if ( pos == count )
+		return;
+
+	// The rest of the list is still sorted, so shift the player
+	// up past anyone they now beat or down past anyone beating them
+	while ( pos > 0 && PlayerBeats( iPlayer, m_iPlayerOrder[pos - 1] ) )
+	{
+		m_iPlayerOrder[pos] = m_iPlayerOrder[pos - 1];
+		pos--;
+	}
+
+	while ( pos < count - 1 && PlayerBeats( m_iPlayerOrder[pos + 1], iPlayer ) )
+	{
+		m_iPlayerOrder[pos] = m_iPlayerOrder[pos + 1];
+		pos++;
+	}
+
+	m_iPlayerOrder[pos] = iPlayer;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Called by the ScoreInfo message once g_PlayerExtraInfo is updated
+//-----------------------------------------------------------------------------
+void ScorePanel::ScoreInfo( int cl )
+{
+	m_bPlayerDirty[cl] = true;
+	MovePlayer( cl );
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Append a row to the sorted list
+//-----------------------------------------------------------------------------
+void ScorePanel::AddRow( int type, int index )
+{
+	if ( m_iRows >= NUM_ROWS )
+		return;
+
+	m_iSortedRows[ m_iRows ] = index;
+	m_iIsATeam[ m_iRows ] = type;
+
+	// A row that changes hands gets restyled in FillGrid anyway, this
+	// only has to catch new data for the same occupant. Team totals
+	// are a handful of rows, their cells are just compared every time.
+	if ( type == TEAM_NO )
+		m_bRowDirty[ m_iRows ] = m_bPlayerDirty[ index ];
+	else
+		m_bRowDirty[ m_iRows ] = ( type == TEAM_YES );
+
+	m_iRows++;
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: Sort all the teams
 //-----------------------------------------------------------------------------
@@ -360,40 +501,33 @@ void ScorePanel::SortTeams()
 		}
 	}
 
-	// Draw the teams
-	while ( 1 )
+	// The order from the last update is nearly always still right,
+	// so an insertion sort only does the moves for teams that swapped
+	for ( i = 1; i < m_iNumTeams; i++ )
 	{
-		int highest_frags = -99999; int lowest_deaths = 99999;
-		int best_team = 0;
+		int iTeam = m_iTeamOrder[i];
 
-		for ( i = 1; i <= m_iNumTeams; i++ )
-		{
-			if ( g_TeamInfo[i].players < 1 )
-				continue;
+		int j;
+		for ( j = i; j > 0 && TeamBeats( iTeam, m_iTeamOrder[j - 1] ); j-- )
+			m_iTeamOrder[j] = m_iTeamOrder[j - 1];
 
-			if ( !g_TeamInfo[i].already_drawn && g_TeamInfo[i].frags >= highest_frags )
-			{
-				if ( g_TeamInfo[i].frags > highest_frags || g_TeamInfo[i].deaths < lowest_deaths )
-				{
-					best_team = i;
-					lowest_deaths = g_TeamInfo[i].deaths;
-					highest_frags = g_TeamInfo[i].frags;
-				}
-			}
-		}
+		m_iTeamOrder[j] = iTeam;
+	}
 
-		// draw the best team on the scoreboard
-		if ( !best_team )
-			break;
+	// Draw the teams
+	for ( i = 0; i < m_iNumTeams; i++ )
+	{
+		int iTeam = m_iTeamOrder[i];
+
+		if ( g_TeamInfo[iTeam].players < 1 )
+			continue;
 
 		// Put this team in the sorted list
-		m_iSortedRows[ m_iRows ] = best_team;
-		m_iIsATeam[ m_iRows ] = TEAM_YES;
-		g_TeamInfo[best_team].already_drawn = TRUE;  // set the already_drawn to be TRUE, so this team won't get sorted again
-		m_iRows++;
+		AddRow( TEAM_YES, iTeam );
+		g_TeamInfo[iTeam].already_drawn = TRUE;
 
 		// Now sort all the players on this team
-		SortPlayers( 0, g_TeamInfo[best_team].name );
+		SortPlayers( 0, g_TeamInfo[iTeam].name );
 	}
 
 	// Add all the players who aren't in a team yet into spectators
@@ -408,53 +542,34 @@ void ScorePanel::SortPlayers( int iTeam, char *team )
 	bool bCreatedTeam = false;
 
 	// draw the players, in order,  and restricted to team if set
-	while ( 1 )
+	for ( int i = 0; i < MAX_PLAYERS - 1; i++ )
 	{
-		// Find the top ranking player
-		int highest_frags = -99999;	int lowest_deaths = 99999;
-		int best_player;
-		best_player = 0;
+		int iPlayer = m_iPlayerOrder[i];
 
-		for ( int i = 1; i < MAX_PLAYERS; i++ )
-		{
-			if ( m_bHasBeenSorted[i] == false && g_PlayerInfoList[i].name && g_PlayerExtraInfo[i].frags >= highest_frags )
-			{
-				cl_entity_t *ent = gEngfuncs.GetEntityByIndex( i );
+		if ( m_bHasBeenSorted[iPlayer] || !g_PlayerInfoList[iPlayer].name )
+			continue;
 
-				if ( ent && !(team && stricmp(g_PlayerExtraInfo[i].teamname, team)) )  
-				{
-					extra_player_info_t *pl_info = &g_PlayerExtraInfo[i];
-					if ( pl_info->frags > highest_frags || pl_info->deaths < lowest_deaths )
-					{
-						best_player = i;
-						lowest_deaths = pl_info->deaths;
-						highest_frags = pl_info->frags;
-					}
-				}
-			}
-		}
+		if ( team && stricmp( g_PlayerExtraInfo[iPlayer].teamname, team ) )
+			continue;
 
-		if ( !best_player )
-			break;
+		if ( !gEngfuncs.GetEntityByIndex( iPlayer ) )
+			continue;
 
 		// If we haven't created the Team yet, do it first
 		if (!bCreatedTeam && iTeam)
 		{
-			m_iIsATeam[ m_iRows ] = iTeam;
-			m_iRows++;
-
+			AddRow( iTeam, 0 );
 			bCreatedTeam = true;
 		}
 
 		// Put this player in the sorted list
-		m_iSortedRows[ m_iRows ] = best_player;
-		m_bHasBeenSorted[ best_player ] = true;
-		m_iRows++;
+		AddRow( TEAM_NO, iPlayer );
+		m_bHasBeenSorted[ iPlayer ] = true;
 	}
 
 	if (team)
 	{
-		m_iIsATeam[m_iRows++] = TEAM_BLANK;
+		AddRow( TEAM_BLANK, 0 );
 	}
 }
 
@@ -517,12 +632,18 @@ void ScorePanel::RebuildTeams()
 			memset( &g_TeamInfo[i], 0, sizeof(team_info_t) );
 	}
 
+	// Team slots may have been reused, start the order over
+	for ( i = 0; i < m_iNumTeams; i++ )
+		m_iTeamOrder[i] = i + 1;
+
 	// Update the scoreboard
 	Update();
 }
 
-
-void ScorePanel::FillGrid()
+//-----------------------------------------------------------------------------
+// Purpose: Set everything about a row's labels except their text
+//-----------------------------------------------------------------------------
+void ScorePanel::StyleRow( int row, const scorerow_t& state )
 {
 	CSchemeManager *pSchemes = gViewPort->GetSchemeManager();
 	SchemeHandle_t hScheme = pSchemes->getSchemeHandle("Scoreboard Text");
@@ -533,159 +654,229 @@ void ScorePanel::FillGrid()
 	Font *tfont = pSchemes->getFont(hTitleScheme);
 	Font *smallfont = pSchemes->getFont(hSmallScheme);
 
-	// update highlight position
-	int x, y;
-	getApp()->getCursorPos(x, y);
-	cursorMoved(x, y, this);
-
-	// remove highlight row if we're not in squelch mode
-	if (!GetClientVoiceMgr()->IsInSquelchMode())
-	{
-		m_iHighlightRow = -1;
-	}
+	CGrid *pGridRow = &m_PlayerGrids[row];
+	pGridRow->SetRowUnderline(0, false, 0, 0, 0, 0, 0);
 
-	bool bNextRowIsGap = false;
+	m_szCellText2[row][0] = 0;
 
-	int row;
-	for( row=0; row < NUM_ROWS; row++)
+	for(int col=0; col < NUM_COLUMNS; col++)
 	{
-		CGrid *pGridRow = &m_PlayerGrids[row];
-		pGridRow->SetRowUnderline(0, false, 0, 0, 0, 0, 0);
+		CLabelHeader *pLabel = &m_PlayerEntries[col][row];
 
-		if(row >= m_iRows)
+		if ( state.type == ROW_HIDDEN )
 		{
-			for(int col=0; col < NUM_COLUMNS; col++)
-				m_PlayerEntries[col][row].setVisible(false);
-		
+			pLabel->setVisible(false);
 			continue;
 		}
 
-		bool bRowIsGap = false;
-		if (bNextRowIsGap)
+		pLabel->setVisible(true);
+		pLabel->setText2("");
+		pLabel->setImage(NULL);
+		pLabel->setFont(sfont);
+		pLabel->setTextOffset(0, 0);
+
+		// The text pass only sets cells that differ from this
+		pLabel->setText("");
+		m_szCellText[col][row][0] = 0;
+
+		int rowheight = 13;
+		if (ScreenHeight > 480)
+		{
+			rowheight = YRES(rowheight);
+		}
+		else
 		{
-			bNextRowIsGap = false;
-			bRowIsGap = true;
+			// more tweaking, make sure icons fit at low res
+			rowheight = 15;
 		}
+		pLabel->setSize(pLabel->getWide(), rowheight);
+		pLabel->setBgColor(0, 0, 0, 255);
 
-		for(int col=0; col < NUM_COLUMNS; col++)
+		if (state.type == TEAM_BLANK)
 		{
-			CLabelHeader *pLabel = &m_PlayerEntries[col][row];
-
-			pLabel->setVisible(true);
-			pLabel->setText2("");
-			pLabel->setImage(NULL);
-			pLabel->setFont(sfont);
-			pLabel->setTextOffset(0, 0);
-			
-			int rowheight = 13;
-			if (ScreenHeight > 480)
+			SetCellText(col, row, " ");
+			continue;
+		}
+		else if ( state.type == TEAM_YES )
+		{
+			int *pColor = iTeamColors[state.teamnumber % iNumberOfTeamColors];
+
+			// team color text for team names
+			pLabel->setFgColor(pColor[0], pColor[1], pColor[2], 0);
+
+			// different height for team header rows
+			rowheight = 20;
+			if (ScreenHeight >= 480)
 			{
 				rowheight = YRES(rowheight);
 			}
-			else
+			pLabel->setSize(pLabel->getWide(), rowheight);
+			pLabel->setFont(tfont);
+
+			if (col == COLUMN_NAME)
 			{
-				// more tweaking, make sure icons fit at low res
-				rowheight = 15;
+				pLabel->setFont2(smallfont);
 			}
-			pLabel->setSize(pLabel->getWide(), rowheight);
-			pLabel->setBgColor(0, 0, 0, 255);
-			
-			char sz[128];
-			hud_player_info_t *pl_info = NULL;
-			team_info_t *team_info = NULL;
 
-			if (m_iIsATeam[row] == TEAM_BLANK)
+			pGridRow->SetRowUnderline(0, true, YRES(3), pColor[0], pColor[1], pColor[2], 0);
+		}
+		else if ( state.type == TEAM_SPECTATORS )
+		{
+			// grey text for spectators
+			pLabel->setFgColor(100, 100, 100, 0);
+
+			// different height for team header rows
+			rowheight = 20;
+			if (ScreenHeight >= 480)
 			{
-				pLabel->setText(" ");
-				continue;
+				rowheight = YRES(rowheight);
 			}
-			else if ( m_iIsATeam[row] == TEAM_YES )
+			pLabel->setSize(pLabel->getWide(), rowheight);
+			pLabel->setFont(tfont);
+
+			pGridRow->SetRowUnderline(0, true, YRES(3), 100, 100, 100, 0);
+		}
+		else
+		{
+			int *pColor = iTeamColors[state.teamnumber % iNumberOfTeamColors];
+
+			// team color text for player names
+			pLabel->setFgColor(pColor[0], pColor[1], pColor[2], 0);
+
+			// Set background color
+			if ( state.highlight == ROW_HIGHLIGHT_SELF ) // if it is their name, draw it a different color
 			{
-				// Get the team's data
-				team_info = &g_TeamInfo[ m_iSortedRows[row] ];
-
-				// team color text for team names
-				pLabel->setFgColor(	iTeamColors[team_info->teamnumber % iNumberOfTeamColors][0],
-									iTeamColors[team_info->teamnumber % iNumberOfTeamColors][1],
-									iTeamColors[team_info->teamnumber % iNumberOfTeamColors][2],
-									0 );
-
-				// different height for team header rows
-				rowheight = 20;
-				if (ScreenHeight >= 480)
-				{
-					rowheight = YRES(rowheight);
-				}
-				pLabel->setSize(pLabel->getWide(), rowheight);
-				pLabel->setFont(tfont);
-
-				pGridRow->SetRowUnderline(	0,
-											true,
-											YRES(3),
-											iTeamColors[team_info->teamnumber % iNumberOfTeamColors][0],
-											iTeamColors[team_info->teamnumber % iNumberOfTeamColors][1],
-											iTeamColors[team_info->teamnumber % iNumberOfTeamColors][2],
-											0 );
+				// Highlight this player
+				pLabel->setFgColor(Scheme::sc_white);
+				pLabel->setBgColor(pColor[0], pColor[1], pColor[2], 196);
 			}
-			else if ( m_iIsATeam[row] == TEAM_SPECTATORS )
+			else if ( state.highlight )
 			{
-				// grey text for spectators
-				pLabel->setFgColor(100, 100, 100, 0);
+				// Killer's name
+				pLabel->setBgColor( 255,0,0, state.highlight );
+			}
 
-				// different height for team header rows
-				rowheight = 20;
-				if (ScreenHeight >= 480)
+			// The voice manager keeps the label and updates the icon itself
+			if ( col == COLUMN_VOICE )
+			{
+				// in HLTV mode allow spectator to turn on/off commentator voice
+				if (!g_PlayerInfoList[state.index].thisplayer || gEngfuncs.IsSpectateOnly() )
 				{
-					rowheight = YRES(rowheight);
+					GetClientVoiceMgr()->UpdateSpeakerImage(pLabel, state.index);
 				}
-				pLabel->setSize(pLabel->getWide(), rowheight);
-				pLabel->setFont(tfont);
-
-				pGridRow->SetRowUnderline(0, true, YRES(3), 100, 100, 100, 0);
 			}
-			else
-			{
-				// team color text for player names
-				pLabel->setFgColor(	iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][0],
-									iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][1],
-									iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][2],
-									0 );
+		}
 
-				// Get the player's data
-				pl_info = &g_PlayerInfoList[ m_iSortedRows[row] ];
+		// Align
+		if (col == COLUMN_NAME || col == COLUMN_CLASS)
+		{
+			pLabel->setContentAlignment( vgui::Label::a_west );
+		}
+		else if (col == COLUMN_TRACKER)
+		{
+			pLabel->setContentAlignment( vgui::Label::a_center );
+		}
+		else
+		{
+			pLabel->setContentAlignment( vgui::Label::a_east );
+		}
+	}
+}
 
-				// Set background color
-				if ( pl_info->thisplayer ) // if it is their name, draw it a different color
-				{
-					// Highlight this player
-					pLabel->setFgColor(Scheme::sc_white);
-					pLabel->setBgColor(	iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][0],
-										iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][1],
-										iTeamColors[ g_PlayerExtraInfo[ m_iSortedRows[row] ].teamnumber % iNumberOfTeamColors ][2],
-										196 );
-				}
-				else if ( m_iSortedRows[row] == m_iLastKilledBy && m_fLastKillTime && m_fLastKillTime > gHUD.m_flTime )
-				{
-					// Killer's name
-					pLabel->setBgColor( 255,0,0, 255 - ((float)15 * (float)(m_fLastKillTime - gHUD.m_flTime)) );
-				}
-			}				
+//-----------------------------------------------------------------------------
+// Purpose: Only hand vgui the text when it actually changed
+//-----------------------------------------------------------------------------
+void ScorePanel::SetCellText( int col, int row, const char *sz )
+{
+	char *pszCache = m_szCellText[col][row];
 
-			// Align 
-			if (col == COLUMN_NAME || col == COLUMN_CLASS)
-			{
-				pLabel->setContentAlignment( vgui::Label::a_west );
-			}
-			else if (col == COLUMN_TRACKER)
+	if ( !strncmp( pszCache, sz, sizeof(m_szCellText[0][0]) - 1 ) )
+		return;
+
+	strncpy( pszCache, sz, sizeof(m_szCellText[0][0]) - 1 );
+	pszCache[sizeof(m_szCellText[0][0]) - 1] = 0;
+
+	m_PlayerEntries[col][row].setText(sz);
+}
+
+void ScorePanel::FillGrid()
+{
+	// update highlight position
+	int x, y;
+	getApp()->getCursorPos(x, y);
+	cursorMoved(x, y, this);
+
+	// remove highlight row if we're not in squelch mode
+	if (!GetClientVoiceMgr()->IsInSquelchMode())
+	{
+		m_iHighlightRow = -1;
+	}
+
+	bool bRestyled[NUM_ROWS];
+	bool bLayoutChanged = false;
+
+	int row;
+	for( row=0; row < NUM_ROWS; row++)
+	{
+		// Work out what the row should look like
+		scorerow_t state;
+		state.type = ROW_HIDDEN;
+		state.index = 0;
+		state.teamnumber = 0;
+		state.highlight = 0;
+
+		if ( row < m_iRows )
+		{
+			state.type = m_iIsATeam[row];
+			state.index = m_iSortedRows[row];
+
+			if ( state.type == TEAM_YES )
 			{
-				pLabel->setContentAlignment( vgui::Label::a_center );
+				state.teamnumber = g_TeamInfo[state.index].teamnumber;
 			}
-			else
+			else if ( state.type == TEAM_NO )
 			{
-				pLabel->setContentAlignment( vgui::Label::a_east );
+				state.teamnumber = g_PlayerExtraInfo[state.index].teamnumber;
+
+				if ( g_PlayerInfoList[state.index].thisplayer )
+					state.highlight = ROW_HIGHLIGHT_SELF;
+				else if ( state.index == m_iLastKilledBy && m_fLastKillTime && m_fLastKillTime > gHUD.m_flTime )
+					state.highlight = 255 - ((float)15 * (float)(m_fLastKillTime - gHUD.m_flTime));
 			}
+		}
+
+		bRestyled[row] = false;
+
+		if ( memcmp( &state, &m_RowState[row], sizeof(scorerow_t) ) )
+		{
+			StyleRow( row, state );
+			m_RowState[row] = state;
+			m_bRowDirty[row] = true;
+
+			bRestyled[row] = true;
+			bLayoutChanged = true;
+		}
+
+		if ( state.type == ROW_HIDDEN || state.type == TEAM_BLANK )
+			continue;
+
+		if ( !m_bRowDirty[row] )
+			continue;
+
+		m_bRowDirty[row] = false;
+
+		hud_player_info_t *pl_info = NULL;
+		team_info_t *team_info = NULL;
+
+		if ( state.type == TEAM_YES )
+			team_info = &g_TeamInfo[ state.index ];
+		else if ( state.type == TEAM_NO )
+			pl_info = &g_PlayerInfoList[ state.index ];
 
+		for(int col=0; col < NUM_COLUMNS; col++)
+		{
 			// Fill out with the correct data
+			char sz[128];
 			strcpy(sz, "");
 			if ( m_iIsATeam[row] )
 			{
@@ -717,8 +908,12 @@ void ScorePanel::FillGrid()
 							sprintf(sz2, "(%d %s)", team_info->players, CHudTextMessage::BufferedLocaliseTextString( "#Player_plural" ) );
 						}
 
-						pLabel->setText2(sz2);
-						pLabel->setFont2(smallfont);
+						if ( strncmp( m_szCellText2[row], sz2, sizeof(m_szCellText2[0]) - 1 ) )
+						{
+							strncpy( m_szCellText2[row], sz2, sizeof(m_szCellText2[0]) - 1 );
+							m_szCellText2[row][sizeof(m_szCellText2[0]) - 1] = 0;
+							m_PlayerEntries[col][row].setText2(sz2);
+						}
 					}
 					break;
 				case COLUMN_VOICE:
@@ -751,12 +946,6 @@ void ScorePanel::FillGrid()
 					sprintf(sz, "%s  ", pl_info->name);
 					break;
 				case COLUMN_VOICE:
-					sz[0] = 0;
-					// in HLTV mode allow spectator to turn on/off commentator voice
-					if (!pl_info->thisplayer || gEngfuncs.IsSpectateOnly() )
-					{
-						GetClientVoiceMgr()->UpdateSpeakerImage(pLabel, m_iSortedRows[row]);
-					}
 					break;
 				case COLUMN_CLASS:
 					// No class for other team's members (unless allied or spectator)
@@ -803,12 +992,19 @@ void ScorePanel::FillGrid()
 				}
 			}
 
-			pLabel->setText(sz);
+			SetCellText(col, row, sz);
 		}
 	}
 
+	if ( !bLayoutChanged )
+		return;
+
+	// Only rows that were restyled can have changed height
 	for(row=0; row < NUM_ROWS; row++)
 	{
+		if ( !bRestyled[row] )
+			continue;
+
 		CGrid *pGridRow = &m_PlayerGrids[row];
 
 		pGridRow->AutoSetRowHeights();
@@ -841,9 +1037,10 @@ void ScorePanel::DeathMsg( int killer, int victim )
 
 void ScorePanel::Open( void )
 {
-	RebuildTeams();
+	// Visible first, so the rebuild fills the labels
 	setVisible(true);
 	m_HitTestPanel.setVisible(true);
+	RebuildTeams();
 }
 
 
@@ -222,6 +222,16 @@ private:
 
 class ScoreTablePanel;
 
+// What a scoreboard row was last styled for. Labels are only
+// restyled when this changes, text is compared per cell.
+struct scorerow_t
+{
+	int		type;		// TEAM_ defines in vgui_ScorePanel.cpp, -1 for a hidden row
+	int		index;		// player or team index
+	int		teamnumber;
+	int		highlight;	// own name / killer background alpha
+};
+
 #include "..\game_shared\vgui_grid.h"
 #include "..\game_shared\vgui_defaultinputsignal.h"
 
@@ -264,6 +274,26 @@ private:
 	CommandButton				*m_pCloseButton;
 	CLabelHeader*	GetPlayerEntry(int x, int y)	{return &m_PlayerEntries[x][y];}
 
+	// Player slots in score order, kept sorted with insertion moves
+	int				m_iPlayerOrder[MAX_PLAYERS];
+	int				m_iTeamOrder[MAX_TEAMS];
+
+	// Set by the score messages, consumed when the rows are built
+	bool			m_bPlayerDirty[MAX_PLAYERS+1];
+	int				m_iLastPing[MAX_PLAYERS+1];
+	char			m_szLastName[MAX_PLAYERS+1][MAX_PLAYER_NAME_LENGTH];
+	int				m_iLastTeamNumber;
+
+	bool			m_bRowDirty[NUM_ROWS];
+	scorerow_t		m_RowState[NUM_ROWS];
+	char			m_szCellText[NUM_COLUMNS][NUM_ROWS][64];
+	char			m_szCellText2[NUM_ROWS][64];
+
+	void			AddRow( int type, int index );
+	void			MovePlayer( int iPlayer );
+	void			StyleRow( int row, const scorerow_t& state );
+	void			SetCellText( int col, int row, const char *sz );
+
 public:
 	
 	int				m_iNumTeams;
@@ -291,6 +321,7 @@ public:
 	void FillGrid();
 
 	void DeathMsg( int killer, int victim );
+	void ScoreInfo( int cl );
 
 	void Initialize( void );
 
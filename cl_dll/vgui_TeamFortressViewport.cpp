@@ -2272,6 +2272,9 @@ int TeamFortressViewport::MsgFunc_ScoreInfo( const char *pszName, int iSize, voi
 		if ( g_PlayerExtraInfo[cl].teamnumber < 0 )
 			 g_PlayerExtraInfo[cl].teamnumber = 0;
 
+		if ( m_pScoreBoard )
+			m_pScoreBoard->ScoreInfo( cl );
+
 		UpdateOnPlayerInfo();
 	}
 
@@ -68,6 +68,8 @@ void UTIL_SmoothInterpolateAngles(float* startAngle, float* endAngle, float* fin
 
 #include "r_studioint.h"
 #include "kbutton.h"
+#include "r_profile.h"
+#include "tracecache.h"
 
 extern engine_studio_api_t IEngineStudio;
 
@@ -605,20 +607,9 @@ void V_HandleWalls(struct ref_params_s* pparams)
 
 	if (gHUD.m_iFOV == gHUD.DefaultFov())
 	{
-		gEngfuncs.pEventAPI->EV_SetUpPlayerPrediction(0, 1);
-
-		// Store off the old count
-		gEngfuncs.pEventAPI->EV_PushPMStates();
-
-		// Now add in all of the players.
-		gEngfuncs.pEventAPI->EV_SetSolidPlayers(idx - 1);
-
-		gEngfuncs.pEventAPI->EV_SetTraceHull(2);
-		gEngfuncs.pEventAPI->EV_PlayerTrace(vecSrc, vecEnd, PM_NORMAL, -1, &tr);
+		g_TraceCache.PlayerTrace(vecSrc, vecEnd, 2, PM_NORMAL, &tr, idx);
 
 		flVal = lerp(flVal, (1.0f - tr.fraction) * 1.5f, pparams->frametime * 12.0f);
-
-		gEngfuncs.pEventAPI->EV_PopPMStates();
 	}
 	else
 	{
@@ -2049,6 +2040,8 @@ ref_params_s g_params;
 extern void UpdateFlashlight(ref_params_t* pparams);
 void DLLEXPORT V_CalcRefdef( struct ref_params_s *pparams )
 {
+	R_PROFILE_SCOPE( PROF_CALCREFDEF );
+
 	// intermission / finale rendering
 	if ( pparams->intermission )
 	{	
@@ -2073,8 +2066,9 @@ void DLLEXPORT V_CalcRefdef( struct ref_params_s *pparams )
 	memcpy(&g_pparams, pparams, sizeof(ref_params_s));
 	memcpy(&g_params, pparams, sizeof(ref_params_s));
 
-	gELightList.CalcRefDef();
+	gELightList.CalcRefDef(pparams);
 	SVD_CalcRefDef(pparams);
+	g_StudioRenderQueue.BeginFrame(pparams->vieworg);
 	gFog.CalcRefDef(pparams);
 	UpdateFlashlight(pparams);
 }
@@ -109,6 +109,11 @@ public:
 	SCRIPTSTATE			m_scriptState;		// internal cinematic state
 	CCineMonster		*m_pCine;
 
+	int					m_iAILod;			// AILOD_ bucket picked on the last think, not saved
+	BOOL				m_fCanWaitForPath;	// StartTask is running, node routes may go through g_PathQueue. Not saved
+	BOOL				m_fWaitingForPath;	// a route is queued, MaintainSchedule holds the task until it's done. Not saved
+	int					m_iPathWait;		// g_PathQueue handle on the route this monster waits for, 0 if none. Not saved
+
 	virtual int		Save( CSave &save ); 
 	virtual int		Restore( CRestore &restore );
 	
@@ -142,6 +147,7 @@ public:
 // stuff written for new state machine
 		virtual void MonsterThink( void );
 		void EXPORT	CallMonsterThink( void ) { this->MonsterThink(); }
+		int AILodBucket( void );
 		virtual int IRelationship ( CBaseEntity *pTarget );
 		virtual void MonsterInit ( void );
 		virtual void MonsterInitDead( void );	// Call after animation/pose is set up
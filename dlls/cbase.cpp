@@ -20,6 +20,7 @@
 #include	"decals.h"
 #include	"gamerules.h"
 #include	"game.h"
+#include	"entitygrid.h"
 
 void EntvarsKeyvalue( entvars_t *pev, KeyValueData *pkvd );
 
@@ -432,6 +433,8 @@ void DispatchObjectCollsionBox( edict_t *pent )
 	}
 	else
 		SetObjectCollisionBox( &pent->v );
+
+	g_EntityGrid.Relink( pent );
 }
 
 
@@ -34,6 +34,8 @@
 #include "soundent.h"
 #include "gamerules.h"
 #include "game.h"
+#include "monsters.h"
+#include "nodes.h"
 #include "customentity.h"
 #include "weapons.h"
 #include "weaponinfo.h"
@@ -41,6 +43,9 @@
 #include "netadr.h"
 #include "effects.h"
 #include "UserMessages.h"
+#include "entitygrid.h"
+#include "perception.h"
+#include "pathqueue.h"
 
 extern DLL_GLOBAL ULONG		g_ulModelIndexPlayer;
 extern DLL_GLOBAL BOOL		g_fGameOver;
@@ -430,6 +435,16 @@ void ClientCommand( edict_t *pEntity )
 			CLIENT_PRINTF( pEntity, print_console, UTIL_VarArgs( "\"fov\" is \"%d\"\n", (int)GetClassPtr((CBasePlayer *)pev)->m_iFOV ) );
 		}
 	}
+	else if ( FStrEq(pcmd, "ai_lodlist" ) )
+	{
+		if (g_psv_cheats->value)
+			AILodReport( pEntity );
+	}
+	else if ( FStrEq(pcmd, "ai_nodebench" ) )
+	{
+		if (g_psv_cheats->value)
+			WorldGraph.NearestNodeBenchmark( pEntity, CMD_ARGC() > 1 ? atoi( CMD_ARGV(1) ) : 1000 );
+	}
 	else if ( FStrEq(pcmd, "use" ) )
 	{
 		GetClassPtr((CBasePlayer *)pev)->SelectItem((char *)CMD_ARGV(1));
@@ -549,6 +564,9 @@ void ServerDeactivate( void )
 
 	// Peform any shutdown operations here...
 	//
+
+	// Don't lose routing tables still building in the background
+	WorldGraph.FinishRoutingTables();
 }
 
 void ServerActivate( edict_t *pEdictList, int edictCount, int clientMax )
@@ -649,6 +667,15 @@ void StartFrame( void )
 	gpGlobals->teamplay = teamplay.value;
 	g_ulFrameCount++;
 
+	// Pick up anything that moved without being relinked
+	g_EntityGrid.Sweep();
+
+	g_Perception.BeginFrame();
+	g_PathQueue.BeginFrame();
+
+	// Install the node routing tables if they were building in the background
+	WorldGraph.CheckRoutingTables();
+
 	CBaseEntity* ent = nullptr;
 	for (int i = 0; i < gpGlobals->maxEntities; i++)
 	{
@@ -0,0 +1,306 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+//=========================================================
+// entitygrid.cpp - spatial grid for server entity queries
+//=========================================================
+
+#include	<algorithm>
+#include	"extdll.h"
+#include	"util.h"
+#include	"cbase.h"
+#include	"entitygrid.h"
+
+CEntityGrid g_EntityGrid;
+
+//=========================================================
+// GridTableForFlags - which table an entity with these
+// flags belongs in
+//=========================================================
+static int GridTableForFlags( int flags )
+{
+	return ( flags & (FL_CLIENT|FL_MONSTER) ) ? GRID_MONSTERS : GRID_ALL;
+}
+
+CEntityGrid :: CEntityGrid( void )
+{
+	m_queryStamp = 0;
+}
+
+//=========================================================
+// Clear - drops everything, called when the world spawns
+//=========================================================
+void CEntityGrid :: Clear( void )
+{
+	for ( int t = 0; t < GRID_TABLES; t++ )
+	{
+		for ( int i = 0; i < GRID_CELLS * GRID_CELLS; i++ )
+			m_cells[t][i].clear();
+
+		m_oversize[t].clear();
+	}
+
+	m_entities.clear();
+	m_results.clear();
+	m_queryStamp = 0;
+}
+
+//=========================================================
+// EnsureSize - maxEntities isn't known until the dll is
+// running, so the per entity records are sized lazily
+//=========================================================
+void CEntityGrid :: EnsureSize( void )
+{
+	if ( (int)m_entities.size() >= gpGlobals->maxEntities )
+		return;
+
+	gridentity_t empty;
+	memset( &empty, 0, sizeof( empty ) );
+	empty.table = -1;
+
+	m_entities.resize( gpGlobals->maxEntities, empty );
+	m_results.reserve( gpGlobals->maxEntities );
+}
+
+//=========================================================
+// CellRange - cells touched by a box, clamped to the grid
+// so anything outside lands in the border cells
+//=========================================================
+void CEntityGrid :: CellRange( const Vector &mins, const Vector &maxs, short *rect )
+{
+	const float offset = GRID_CELL_SIZE * GRID_CELLS * 0.5;
+
+	for ( int i = 0; i < 2; i++ )
+	{
+		int lo = (int)floor( ( mins[i] + offset ) / GRID_CELL_SIZE );
+		int hi = (int)floor( ( maxs[i] + offset ) / GRID_CELL_SIZE );
+
+		// An inverted box can still touch entities that span it
+		if ( lo > hi )
+		{
+			int temp = lo;
+			lo = hi;
+			hi = temp;
+		}
+
+		rect[i] = (short)max( 0, min( lo, GRID_CELLS - 1 ) );
+		rect[i+2] = (short)max( 0, min( hi, GRID_CELLS - 1 ) );
+	}
+}
+
+void CEntityGrid :: AddToCells( int index, int table, const short *rect, bool oversize )
+{
+	if ( oversize )
+	{
+		m_oversize[table].push_back( index );
+		return;
+	}
+
+	for ( int y = rect[1]; y <= rect[3]; y++ )
+	{
+		for ( int x = rect[0]; x <= rect[2]; x++ )
+			m_cells[table][y * GRID_CELLS + x].push_back( index );
+	}
+}
+
+static void RemoveIndex( std::vector<int> &list, int index )
+{
+	for ( size_t i = 0; i < list.size(); i++ )
+	{
+		if ( list[i] == index )
+		{
+			list[i] = list.back();
+			list.pop_back();
+			return;
+		}
+	}
+}
+
+void CEntityGrid :: RemoveFromCells( int index, int table, const short *rect, bool oversize )
+{
+	if ( oversize )
+	{
+		RemoveIndex( m_oversize[table], index );
+		return;
+	}
+
+	for ( int y = rect[1]; y <= rect[3]; y++ )
+	{
+		for ( int x = rect[0]; x <= rect[2]; x++ )
+			RemoveIndex( m_cells[table][y * GRID_CELLS + x], index );
+	}
+}
+
+//=========================================================
+// Relink - moves an entity to the cells its current bounds
+// cover. The linked box includes the origin, since
+// UTIL_MonstersInSphere tests origin x/y, not the bounds.
+//=========================================================
+void CEntityGrid :: Relink( edict_t *pent )
+{
+	if ( !pent )
+		return;
+
+	int index = ENTINDEX( pent );
+	if ( index <= 0 )
+		return;
+
+	EnsureSize();
+	if ( index >= (int)m_entities.size() )
+		return;
+
+	if ( pent->free )
+	{
+		Unlink( index );
+		return;
+	}
+
+	gridentity_t *pGrid = &m_entities[index];
+	const entvars_t *pev = &pent->v;
+
+	Vector mins, maxs;
+	for ( int i = 0; i < 3; i++ )
+	{
+		mins[i] = min( pev->absmin[i], pev->origin[i] );
+		maxs[i] = max( pev->absmax[i], pev->origin[i] );
+	}
+
+	short rect[4];
+	CellRange( mins, maxs, rect );
+
+	int table = GridTableForFlags( pev->flags );
+	bool oversize = ( rect[2] - rect[0] >= GRID_OVERSIZE ) || ( rect[3] - rect[1] >= GRID_OVERSIZE );
+
+	if ( pGrid->table != table || pGrid->oversize != oversize ||
+		 ( !oversize && memcmp( pGrid->rect, rect, sizeof( rect ) ) ) )
+	{
+		if ( pGrid->table >= 0 )
+			RemoveFromCells( index, pGrid->table, pGrid->rect, pGrid->oversize );
+
+		AddToCells( index, table, rect, oversize );
+
+		pGrid->table = table;
+		pGrid->oversize = oversize;
+		memcpy( pGrid->rect, rect, sizeof( rect ) );
+	}
+
+	pGrid->absmin = pev->absmin;
+	pGrid->absmax = pev->absmax;
+	pGrid->origin = pev->origin;
+	pGrid->flags = pev->flags;
+}
+
+void CEntityGrid :: Unlink( int index )
+{
+	if ( index <= 0 || index >= (int)m_entities.size() )
+		return;
+
+	gridentity_t *pGrid = &m_entities[index];
+	if ( pGrid->table < 0 )
+		return;
+
+	RemoveFromCells( index, pGrid->table, pGrid->rect, pGrid->oversize );
+	pGrid->table = -1;
+}
+
+//=========================================================
+// Sweep - once a frame, relinks anything whose bounds,
+// origin or flags changed without going through the engine,
+// and unlinks freed edicts
+//=========================================================
+void CEntityGrid :: Sweep( void )
+{
+	EnsureSize();
+
+	edict_t *pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+	if ( !pEdict )
+		return;
+
+	for ( int i = 1; i < (int)m_entities.size(); i++, pEdict++ )
+	{
+		gridentity_t *pGrid = &m_entities[i];
+
+		if ( pEdict->free )
+		{
+			if ( pGrid->table >= 0 )
+				Unlink( i );
+			continue;
+		}
+
+		if ( pGrid->table < 0 ||
+			 pGrid->flags != pEdict->v.flags ||
+			 pGrid->origin != pEdict->v.origin ||
+			 pGrid->absmin != pEdict->v.absmin ||
+			 pGrid->absmax != pEdict->v.absmax )
+		{
+			Relink( pEdict );
+		}
+	}
+}
+
+//=========================================================
+// Query - entities linked in cells touching the box. A
+// flagMask that only wants clients or monsters just reads
+// that table, anything else has to read both.
+//=========================================================
+int CEntityGrid :: Query( const Vector &mins, const Vector &maxs, int flagMask, const int **ppIndices )
+{
+	EnsureSize();
+	m_results.clear();
+
+	if ( ++m_queryStamp == 0 )
+	{
+		for ( size_t i = 0; i < m_entities.size(); i++ )
+			m_entities[i].stamp = 0;
+		m_queryStamp = 1;
+	}
+
+	int firstTable = GRID_ALL;
+	if ( flagMask && !( flagMask & ~(FL_CLIENT|FL_MONSTER) ) )
+		firstTable = GRID_MONSTERS;
+
+	short rect[4];
+	CellRange( mins, maxs, rect );
+
+	for ( int t = firstTable; t < GRID_TABLES; t++ )
+	{
+		for ( int y = rect[1]; y <= rect[3]; y++ )
+		{
+			for ( int x = rect[0]; x <= rect[2]; x++ )
+			{
+				const std::vector<int> &cell = m_cells[t][y * GRID_CELLS + x];
+
+				for ( size_t i = 0; i < cell.size(); i++ )
+				{
+					gridentity_t *pGrid = &m_entities[cell[i]];
+					if ( pGrid->stamp == m_queryStamp )
+						continue;
+
+					pGrid->stamp = m_queryStamp;
+					m_results.push_back( cell[i] );
+				}
+			}
+		}
+
+		// Oversize entities are few, the caller's box test sorts them out
+		for ( size_t i = 0; i < m_oversize[t].size(); i++ )
+			m_results.push_back( m_oversize[t][i] );
+	}
+
+	// Callers stop at listMax, keep the same order the edict walk had
+	std::sort( m_results.begin(), m_results.end() );
+
+	*ppIndices = m_results.empty() ? NULL : &m_results[0];
+	return (int)m_results.size();
+}
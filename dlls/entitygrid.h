@@ -0,0 +1,81 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+#ifndef ENTITYGRID_H
+#define ENTITYGRID_H
+
+#include <vector>
+
+//=========================================================
+// Uniform 2D grid of entity bounds, used by UTIL_EntitiesInBox
+// and UTIL_MonstersInSphere instead of walking every edict.
+// Entities are relinked from pfnAbsBox, UTIL_SetOrigin and
+// UTIL_SetSize, and a sweep in StartFrame catches anything
+// that moved pev directly.
+//=========================================================
+#define	GRID_CELL_SIZE		256
+#define	GRID_CELLS			32		// per axis, covers +/-4096
+#define	GRID_OVERSIZE		4		// spanning more cells than this on an axis goes to the oversize list
+
+// Tables
+#define	GRID_ALL			0
+#define	GRID_MONSTERS		1		// FL_CLIENT|FL_MONSTER
+#define	GRID_TABLES			2
+
+typedef struct gridentity_s
+{
+	int		table;			// -1 when unlinked
+	short	rect[4];		// first x, first y, last x, last y cell
+	bool	oversize;
+
+	// Values the entity was linked with, to see if the sweep needs to relink it
+	Vector	absmin;
+	Vector	absmax;
+	Vector	origin;
+	int		flags;
+
+	unsigned int stamp;		// last query that returned this entity
+} gridentity_t;
+
+class CEntityGrid
+{
+public:
+	CEntityGrid( void );
+
+	void	Clear( void );
+	void	Relink( edict_t *pent );
+	void	Unlink( int index );
+	void	Sweep( void );
+
+	// Fills the indices of entities in the tables whose linked bounds touch mins/maxs,
+	// sorted by index. The caller still has to run its own tests against pev.
+	int		Query( const Vector &mins, const Vector &maxs, int flagMask, const int **ppIndices );
+
+private:
+	void	EnsureSize( void );
+	void	CellRange( const Vector &mins, const Vector &maxs, short *rect );
+	void	AddToCells( int index, int table, const short *rect, bool oversize );
+	void	RemoveFromCells( int index, int table, const short *rect, bool oversize );
+
+	std::vector<int>			m_cells[GRID_TABLES][GRID_CELLS * GRID_CELLS];
+	std::vector<int>			m_oversize[GRID_TABLES];
+
+	std::vector<gridentity_t>	m_entities;
+	std::vector<int>			m_results;
+	unsigned int				m_queryStamp;
+};
+
+extern CEntityGrid g_EntityGrid;
+
+#endif // ENTITYGRID_H
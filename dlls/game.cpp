@@ -41,6 +41,15 @@ cvar_t	allowmonsters={"mp_allowmonsters","0", FCVAR_SERVER };
 
 cvar_t  mp_chattime = {"mp_chattime","10", FCVAR_SERVER };
 
+cvar_t	ai_lod			= {"ai_lod","1"};				// slow down thinking for monsters no player is near
+cvar_t	ai_lod_dist		= {"ai_lod_dist","2048"};		// closer than this to a player always thinks at full rate
+cvar_t	ai_routes_background = {"ai_routes_background","1"};	// build node routing tables after the map starts
+cvar_t	ai_sightcache	= {"ai_sightcache","0"};		// seconds a Look() trace can be reused, 0 is this frame only
+cvar_t	ai_sighttraces	= {"ai_sighttraces","0", FCVAR_UNLOGGED };	// Look() traces run last frame
+cvar_t	ai_pathbudget	= {"ai_pathbudget","2"};		// milliseconds of node route searches per frame, 0 is no limit
+cvar_t	ai_pathclusters	= {"ai_pathclusters","1"};		// search node clusters first when there are no routing tables
+cvar_t	ai_visbudget	= {"ai_visbudget","2"};			// milliseconds of node visibility traces per frame while the graph builds in the background, 0 is no limit
+
 // Engine Cvars
 cvar_t 	*g_psv_gravity = NULL;
 cvar_t	*g_psv_aim = NULL;
@@ -529,6 +538,15 @@ void GameDLLInit( void )
 
 	CVAR_REGISTER (&mp_chattime);
 
+	CVAR_REGISTER (&ai_lod);
+	CVAR_REGISTER (&ai_lod_dist);
+	CVAR_REGISTER (&ai_routes_background);
+	CVAR_REGISTER (&ai_sightcache);
+	CVAR_REGISTER (&ai_sighttraces);
+	CVAR_REGISTER (&ai_pathbudget);
+	CVAR_REGISTER (&ai_pathclusters);
+	CVAR_REGISTER (&ai_visbudget);
+
 // REGISTER CVARS FOR SKILL LEVEL STUFF
 	// Agrunt
 	CVAR_REGISTER ( &sk_agrunt_health1 );// {"sk_agrunt_health1","0"};
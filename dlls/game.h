@@ -37,6 +37,16 @@ extern cvar_t	teamoverride;
 extern cvar_t	defaultteam;
 extern cvar_t	allowmonsters;
 
+// monster ai
+extern cvar_t	ai_lod;
+extern cvar_t	ai_lod_dist;
+extern cvar_t	ai_routes_background;
+extern cvar_t	ai_sightcache;
+extern cvar_t	ai_sighttraces;
+extern cvar_t	ai_pathbudget;
+extern cvar_t	ai_pathclusters;
+extern cvar_t	ai_visbudget;
+
 // Engine Cvars
 extern cvar_t	*g_psv_gravity;
 extern cvar_t	*g_psv_aim;
@@ -33,6 +33,9 @@
 #include "decals.h"
 #include "soundent.h"
 #include "gamerules.h"
+#include "perception.h"
+#include "pathqueue.h"
+#include "game.h"
 
 #define MONSTER_CUT_CORNER_DIST		8 // 8 means the monster's bounding box is contained without the box of the node in WC
 
@@ -333,7 +336,8 @@ void CBaseMonster :: Look ( int iDistance )
 			{
 				// the looker will want to consider this entity
 				// don't check anything else about an entity that can't be seen, or an entity that you don't care about.
-				if ( IRelationship( pSightEnt ) != R_NO && FInViewCone( pSightEnt ) && !FBitSet( pSightEnt->pev->flags, FL_NOTARGET ) && FVisible( pSightEnt ) )
+				// the trace is shared with pSightEnt's own Look() at us this frame
+				if ( IRelationship( pSightEnt ) != R_NO && FInViewCone( pSightEnt ) && !FBitSet( pSightEnt->pev->flags, FL_NOTARGET ) && g_Perception.FVisible( this, pSightEnt ) )
 				{
 					if ( pSightEnt->IsPlayer() )
 					{
@@ -519,9 +523,94 @@ CSound* CBaseMonster :: PBestScent ( void )
 // Monster Think - calls out to core AI functions and handles this
 // monster's specific animation events
 //=========================================================
+static const float g_flAILodInterval[AILOD_BUCKETS] = { 0.1, 0.3, 1.0 };
+static const char *g_szAILodNames[AILOD_BUCKETS] = { "full", "reduced", "dormant" };
+
+//=========================================================
+// AILodBucket - picks how often the monster needs to think.
+// Monsters outside the PVS already skip Look and Listen in
+// RunAI unless fighting, the slower buckets also think less.
+//=========================================================
+int CBaseMonster :: AILodBucket ( void )
+{
+	if ( !ai_lod.value )
+		return AILOD_FULL;
+
+	// fighting, scripted or dying monsters always get the full rate
+	if ( m_MonsterState == MONSTERSTATE_COMBAT || m_IdealMonsterState == MONSTERSTATE_COMBAT ||
+		 m_MonsterState == MONSTERSTATE_SCRIPT || m_IdealMonsterState == MONSTERSTATE_SCRIPT ||
+		 m_pCine != NULL || m_hEnemy != NULL || pev->deadflag != DEAD_NO )
+		return AILOD_FULL;
+
+	if ( HasConditions( bits_COND_LIGHT_DAMAGE | bits_COND_HEAVY_DAMAGE ) )
+		return AILOD_FULL;
+
+	if ( !FNullEnt( FIND_CLIENT_IN_PVS( edict() ) ) )
+		return AILOD_FULL;
+
+	float flDist = -1;
+
+	for ( int i = 1; i <= gpGlobals->maxClients; i++ )
+	{
+		CBaseEntity *pPlayer = UTIL_PlayerByIndex( i );
+		if ( !pPlayer )
+			continue;
+
+		float flPlayerDist = ( pPlayer->pev->origin - pev->origin ).Length();
+		if ( flDist < 0 || flPlayerDist < flDist )
+			flDist = flPlayerDist;
+	}
+
+	// no one connected yet, nothing to be gained from slowing down
+	if ( flDist < 0 || flDist < ai_lod_dist.value )
+		return AILOD_FULL;
+
+	// moving monsters step by the think interval, keep their steps short
+	if ( flDist < ai_lod_dist.value * 2 || !MovementIsComplete() )
+		return AILOD_REDUCED;
+
+	return AILOD_DORMANT;
+}
+
+//=========================================================
+// AILodReport - lists every monster's think rate bucket
+// to the player's console
+//=========================================================
+void AILodReport( edict_t *pentPlayer )
+{
+	int counts[AILOD_BUCKETS] = { 0 };
+
+	for ( int i = 1; i < gpGlobals->maxEntities; i++ )
+	{
+		edict_t *pEdict = INDEXENT( i );
+		if ( !pEdict || pEdict->free || !( pEdict->v.flags & FL_MONSTER ) )
+			continue;
+
+		CBaseEntity *pEntity = CBaseEntity::Instance( pEdict );
+		CBaseMonster *pMonster = pEntity ? pEntity->MyMonsterPointer() : NULL;
+		if ( !pMonster || pMonster->m_iAILod < 0 || pMonster->m_iAILod >= AILOD_BUCKETS )
+			continue;
+
+		counts[pMonster->m_iAILod]++;
+		CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "%4i %-24s %s\n", i, STRING( pEdict->v.classname ), g_szAILodNames[pMonster->m_iAILod] ) );
+	}
+
+	CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "%i full, %i reduced, %i dormant\n", counts[AILOD_FULL], counts[AILOD_REDUCED], counts[AILOD_DORMANT] ) );
+}
+
 void CBaseMonster :: MonsterThink ( void )
 {
-	pev->nextthink = gpGlobals->time + 0.1;// keep monster thinking.
+	int iLod = AILodBucket();
+	float flThinkDelay = g_flAILodInterval[iLod];
+
+	// spread monsters that drop to a slower rate over several frames, once
+	// shifted they keep that phase as long as they stay in the bucket
+	if ( iLod != m_iAILod && iLod != AILOD_FULL )
+		flThinkDelay += flThinkDelay * ( ENTINDEX( edict() ) % AILOD_STAGGER ) / AILOD_STAGGER;
+
+	m_iAILod = iLod;
+
+	pev->nextthink = gpGlobals->time + flThinkDelay;// keep monster thinking.
 
 	m_flDistTooFar = 1024.0;
 	m_flDistLook = 2048.0;
@@ -2240,6 +2329,7 @@ BOOL CBaseMonster :: FindCover ( Vector vecThreat, Vector vecViewOffset, float f
 	int iMyHullIndex;
 	int iMyNode;
 	int iThreatNode;
+	BOOL fThreatNode;
 	float flDist;
 	Vector	vecLookersOffset;
 	TraceResult tr;
@@ -2264,6 +2354,18 @@ BOOL CBaseMonster :: FindCover ( Vector vecThreat, Vector vecViewOffset, float f
 		return FALSE;
 	}
 
+	if ( m_fWaitingForPath )
+	{
+		return FALSE;
+	}
+	else if ( m_fCanWaitForPath && !g_PathQueue.FHaveBudget() )
+	{// out of route search time this frame, try again next think
+		m_fWaitingForPath = TRUE;
+		return FALSE;
+	}
+
+	CSyncPathSearch search( this );
+
 	iMyNode = WorldGraph.FindNearestNode( pev->origin, this );
 	iThreatNode = WorldGraph.FindNearestNode ( vecThreat, this );
 	iMyHullIndex = WorldGraph.HullIndex( this );
@@ -2273,6 +2375,7 @@ BOOL CBaseMonster :: FindCover ( Vector vecThreat, Vector vecViewOffset, float f
 		ALERT ( at_aiconsole, "FindCover() - %s has no nearest node!\n", STRING(pev->classname));
 		return FALSE;
 	}
+	fThreatNode = ( iThreatNode != NO_NODE && WorldGraph.m_pVisBits != NULL );
 	if ( iThreatNode == NO_NODE )
 	{
 		// ALERT ( at_aiconsole, "FindCover() - Threat has no nearest node!\n" );
@@ -2297,6 +2400,11 @@ BOOL CBaseMonster :: FindCover ( Vector vecThreat, Vector vecViewOffset, float f
 		// provide cover! Also make sure the node is within the mins/maxs of the search.
 		if ( flDist >= flMinDist && flDist < flMaxDist )
 		{
+			// a node that can see the threat's node isn't going to hide us from it,
+			// so only the others need the trace
+			if ( fThreatNode && WorldGraph.FNodeCanSee( nodeNumber, iThreatNode ) )
+				continue;
+
 			UTIL_TraceLine ( node.m_vecOrigin + vecViewOffset, vecLookersOffset, ignore_monsters, ignore_glass,  ENT(pev), &tr );
 
 			// if this node will block the threat's line of sight to me...
@@ -2369,6 +2477,18 @@ BOOL CBaseMonster :: BuildNearestRoute ( Vector vecThreat, Vector vecViewOffset,
 		return FALSE;
 	}
 
+	if ( m_fWaitingForPath )
+	{
+		return FALSE;
+	}
+	else if ( m_fCanWaitForPath && !g_PathQueue.FHaveBudget() )
+	{// out of route search time this frame, try again next think
+		m_fWaitingForPath = TRUE;
+		return FALSE;
+	}
+
+	CSyncPathSearch search( this );
+
 	iMyNode = WorldGraph.FindNearestNode( pev->origin, this );
 	iMyHullIndex = WorldGraph.HullIndex( this );
 
@@ -2777,6 +2897,11 @@ BOOL CBaseMonster :: FGetNodeRoute ( Vector vecDest )
 	int i;
 	int iNumToCopy;
 
+	if ( m_fWaitingForPath )
+	{// already waiting on a route for this task
+		return FALSE;
+	}
+
 	iSrcNode = WorldGraph.FindNearestNode ( pev->origin, this );
 	iDestNode = WorldGraph.FindNearestNode ( vecDest, this );
 
@@ -2796,7 +2921,39 @@ BOOL CBaseMonster :: FGetNodeRoute ( Vector vecDest )
 	// valid src and dest nodes were found, so it's safe to proceed with
 	// find shortest path
 	int iNodeHull = WorldGraph.HullIndex( this ); // make this a monster virtual function
-	iResult = WorldGraph.FindShortestPath ( iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability );
+	int iRequest = -1;
+
+	if ( m_fCanWaitForPath && g_PathQueue.FEnabled() )
+	{
+		iRequest = g_PathQueue.Request( iSrcNode, iDestNode, iNodeHull, m_afCapability );
+	}
+
+	if ( iRequest != -1 )
+	{
+		const pathrequest_t *pRequest = g_PathQueue.Result( iRequest );
+
+		if ( !pRequest )
+		{
+			// queued, MaintainSchedule will start the task again. Hold on
+			// to the request so the route is still there when we come back
+			g_PathQueue.Wait( iRequest, &m_iPathWait );
+			m_fWaitingForPath = TRUE;
+			return FALSE;
+		}
+
+		g_PathQueue.Release( &m_iPathWait );
+
+		iResult = pRequest->cPath;
+		memcpy( iPath, pRequest->iPath, sizeof( iPath ) );
+	}
+	else
+	{
+		g_PathQueue.Release( &m_iPathWait );
+
+		g_PathQueue.BeginSearch();
+		iResult = WorldGraph.FindShortestPath ( iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability, MAX_PATH_SIZE );
+		g_PathQueue.EndSearch();
+	}
 
 	if ( !iResult )
 	{
@@ -2806,7 +2963,7 @@ BOOL CBaseMonster :: FGetNodeRoute ( Vector vecDest )
 #else
 		BOOL bRoutingSave = WorldGraph.m_fRoutingComplete;
 		WorldGraph.m_fRoutingComplete = FALSE;
-		iResult = WorldGraph.FindShortestPath(iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability);
+		iResult = WorldGraph.FindShortestPath(iPath, iSrcNode, iDestNode, iNodeHull, m_afCapability, MAX_PATH_SIZE);
 		WorldGraph.m_fRoutingComplete = bRoutingSave;
 		if ( !iResult )
 		{
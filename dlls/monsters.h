@@ -65,6 +65,15 @@
 #define		MOVE_STUCK_DIST			32 // if a monster can't step this far, it is stuck.
 
 
+// AI level of detail, how often a monster thinks when no player is around
+#define		AILOD_FULL				0 // fighting, scripted, or near a player. Every 0.1 sec
+#define		AILOD_REDUCED			1 // outside the PVS and past ai_lod_dist
+#define		AILOD_DORMANT			2 // past twice ai_lod_dist and standing still
+#define		AILOD_BUCKETS			3
+#define		AILOD_STAGGER			4 // monsters entering a slower bucket are spread over this many phases
+
+extern void AILodReport( edict_t *pentPlayer );
+
 // MoveToOrigin stuff
 #define		MOVE_NORMAL				0// normal move in the direction monster is facing
 #define		MOVE_STRAFE				1// moves in direction specified, no matter which way monster is facing
@@ -16,6 +16,13 @@
 // nodes.cpp - AI node tree stuff.
 //=========================================================
 
+#include	<algorithm>
+#include	<atomic>
+#include	<chrono>
+#include	<string>
+#include	<thread>
+#include	<unordered_map>
+#include	<vector>
 #include	"extdll.h"
 #include	"util.h"
 #include	"cbase.h"
@@ -23,6 +30,7 @@
 #include	"nodes.h"
 #include	"animation.h"
 #include	"doors.h"
+#include	"game.h"
 
 #define	HULL_STEP_SIZE 16// how far the test hull moves on each step
 #define	NODE_HEIGHT	8	// how high to lift nodes off the ground after we drop them all (make stair/ramp mapping easier)
@@ -38,6 +46,154 @@ Vector VecBModelOrigin( entvars_t* pevBModel );
 
 CGraph	WorldGraph;
 
+//=========================================================
+// Static routing tables. One Dijkstra search out of each
+// node gives the first hop toward every other node, which
+// is that node's row of the table, for every hull and door
+// capability. Rows don't depend on each other, so they're
+// handed out to worker threads, and only the compressed
+// rows are kept instead of the whole N*N table.
+//=========================================================
+#define	ROUTE_TABLES		( MAX_NODE_HULLS * 2 )
+#define	ROUTE_LINK_COST		1.0	// added per link, so rows agree with each other across zero length links
+
+class CRouteBuilder
+{
+public:
+	CRouteBuilder( void );
+	~CRouteBuilder( void );
+
+	void	Start( CGraph *pGraph, int cThreads );
+	void	Wait( void );
+	void	Cancel( void );
+
+	inline BOOL Running ( void ) { return ( m_pGraph != NULL ); }
+	inline BOOL Done ( void ) { return ( m_cRowsDone.load() >= m_cRows ); }
+
+	// compressed rows, ROUTE_TABLES blocks of m_cNodes
+	std::vector<std::string>	m_rows;
+	std::vector<int>			m_compressedSize;
+	std::vector<char>			m_needSorting;
+
+private:
+	void	WorkerThread( void );
+	void	BuildRow( CPathSearch &search, int iTable, int iFrom, unsigned short *BestNextNodes, char *pRoute );
+
+	CGraph	*m_pGraph;
+	int		m_cNodes;
+	int		m_cRows;
+
+	// HandleLinkEnt looks at entities, so which links each
+	// capability can use is worked out up front on the main thread
+	std::vector<char>	m_linkUsable;
+
+	std::atomic<int>	m_iNextRow;
+	std::atomic<int>	m_cRowsDone;
+	std::atomic<bool>	m_fCancel;
+	std::vector<std::thread>	m_threads;
+};
+
+static CRouteBuilder g_RouteBuilder;
+
+//=========================================================
+// Node visibility build state. The traces go through the
+// engine, so they can't run on the route builder's threads.
+// In the background they're spread over frames instead,
+// ai_visbudget milliseconds at a time. Bits are only ever
+// set by a finished trace, so FindCover just skips fewer
+// nodes until the build is done. Graphs compiled with
+// utils/nodegraph already have the bits.
+//=========================================================
+static struct
+{
+	BOOL	fRunning;
+	int		iRow;		// next pair to trace
+	int		iCol;
+	int		cTraces;
+	double	flSeconds;	// time spent tracing so far
+} g_VisBuild;
+
+// Set when a background build should save the graph, which
+// waits for both the routing tables and the visibility bits
+static BOOL g_fSaveGraphWhenBuilt;
+
+// FindNearestNode's index, built whenever the graph's pointers get set
+static CNodeTree g_NodeTree;
+static int g_cNearestTraces;// visibility traces FindNearestNode has done, for ai_nodebench
+
+//=========================================================
+// Node clusters for searching without the routing tables.
+// Nodes in the same NODE_CLUSTER_SIZE cube that link to
+// each other make a cluster, and clusters with links
+// between them are neighbors. FindShortestPath finds a
+// corridor of clusters first, then only searches the nodes
+// in it, so a search costs about as much as the route is
+// long instead of as big as the map is. A partial route is
+// only searched through the first few clusters, over the
+// nodes that still lead to the destination, so where it
+// stops is on a real path there. Clusters are built with
+// the node tree, they aren't saved.
+//=========================================================
+#define	NODE_CLUSTER_SIZE	512
+#define	NODE_CLUSTER_WINDOW	2	// clusters past the start's that a partial route is searched through at first
+
+class CNodeClusters
+{
+public:
+	void	Build( CGraph *pGraph );
+	void	Clear( void );
+
+	inline int Count ( void ) { return ( (int)m_clusters.size() ); }
+	inline int Cluster ( int iNode ) { return ( m_nodeCluster[ iNode ] ); }
+
+	// Cluster corridor from iStartNode's cluster to iDestNode's, m_corridor
+	// gets the clusters in order. FALSE if the clusters don't connect.
+	BOOL	FindCorridor( int iStartNode, int iDestNode, int iHullMask );
+
+	// Marks the corridor's nodes that can get to iDestNode, following the links
+	// backwards with the same hull and link ent tests as the search. FALSE if
+	// iStartNode isn't one of them.
+	BOOL	MarkLeadsToDest( CGraph *pGraph, int iStartNode, int iDestNode, int iHullMask, int afCapMask );
+
+	// Limits the next node search to the first cSteps + 1 clusters of the corridor
+	void	SetWindow( int cSteps );
+	inline BOOL InWindow ( int iNode ) { int iStep = m_clusterStep[ m_nodeCluster[ iNode ] ]; return ( iStep >= 0 && iStep <= m_iWindow ); }
+	inline BOOL LeadsToDest ( int iNode ) { return ( !m_fMarked || m_nodeMark[ iNode ] == m_iMark ); }
+	inline BOOL AtFrontier ( int iNode ) { return ( m_iWindow < (int)m_corridor.size() - 1 && m_clusterStep[ m_nodeCluster[ iNode ] ] == m_iWindow ); }
+
+	std::vector<int>	m_corridor;
+
+private:
+	struct cluster_t
+	{
+		Vector2D	vecCenter;
+		int			iFirstEdge;
+		int			cEdges;
+	};
+
+	struct clusteredge_t
+	{
+		int		iCluster;
+		int		afLinkInfo;	// every hull bit some link between the two has
+		float	flCost;
+	};
+
+	std::vector<int>			m_nodeCluster;
+	std::vector<cluster_t>		m_clusters;
+	std::vector<clusteredge_t>	m_edges;
+	std::vector<int>			m_clusterStep;	// place in m_corridor, -1 if it isn't in it
+	int							m_iWindow;
+	std::vector<int>			m_firstInLink;	// links into each node, as m_inLinks[ m_firstInLink[ i ] .. m_firstInLink[ i + 1 ] ]
+	std::vector<int>			m_inLinks;		// link pool indexes
+	std::vector<int>			m_nodeMark;		// m_iMark if the node leads to the destination
+	int							m_iMark;
+	BOOL						m_fMarked;		// the current corridor's nodes are marked
+	std::vector<int>			m_stack;
+	CPathSearch					m_search;
+};
+
+static CNodeClusters g_NodeClusters;
+
 LINK_ENTITY_TO_CLASS( info_node, CNodeEnt );
 LINK_ENTITY_TO_CLASS( info_node_air, CNodeEnt );
 #ifdef __linux__
@@ -51,6 +207,13 @@ LINK_ENTITY_TO_CLASS( info_node_air, CNodeEnt );
 //=========================================================
 void CGraph :: InitGraph( void)
 {
+	// Stop any routing table build, it's reading the graph about to be freed
+	//
+	g_RouteBuilder.Cancel();
+	g_VisBuild.fRunning = FALSE;
+	g_fSaveGraphWhenBuilt = FALSE;
+	g_NodeTree.Clear();
+	g_NodeClusters.Clear();
 
 	// Make the graph unavailable
 	//
@@ -94,6 +257,12 @@ void CGraph :: InitGraph( void)
 		m_pHashLinks = NULL;
 	}
 
+	if ( m_pVisBits )
+	{
+		free ( m_pVisBits );
+		m_pVisBits = NULL;
+	}
+
 	// Zero node and link counts
 	//
 	m_cNodes = 0;
@@ -466,6 +635,37 @@ int	CGraph::NodeType( const CBaseEntity *pEntity )
 }
 
 
+// scratch space for FindShortestPath, reused by every search
+static CPathSearch g_PathSearch;
+
+// path buffer for looking up routes while the routing tables are being built
+static std::vector<int> g_LivePath;
+
+static int LinkHullMask( int iHull )
+{
+	switch( iHull )
+	{
+	case NODE_SMALL_HULL:
+		return bits_LINK_SMALL_HULL;
+	case NODE_HUMAN_HULL:
+		return bits_LINK_HUMAN_HULL;
+	case NODE_LARGE_HULL:
+		return bits_LINK_LARGE_HULL;
+	case NODE_FLY_HULL:
+		return bits_LINK_FLY_HULL;
+	}
+
+	return 0;
+}
+
+static int RouteCapMask( int iCap )
+{
+	if ( iCap == 1 )
+		return bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE;
+
+	return 0;
+}
+
 // Sum up graph weights on the path from iStart to iDest to determine path length
 float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 {
@@ -477,6 +677,29 @@ float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 	int iCurrentNode = iStart;
 	int iCap = CapIndex( afCapMask );
 
+	if ( !m_fRoutingComplete )
+	{// no tables yet, search for the path instead
+		g_LivePath.resize( max( m_cNodes, 2 ) );
+
+		int cPathSize = FindShortestPath( &g_LivePath[0], iStart, iDest, iHull, afCapMask );
+
+		for ( int i = 0; i < cPathSize - 1; i++ )
+		{
+			CNode &node = Node( g_LivePath[i] );
+
+			for ( int j = 0; j < node.m_cNumLinks; j++ )
+			{
+				if ( NodeLink( node, j ).m_iDestNode == g_LivePath[i+1] )
+				{
+					distance += NodeLink( node, j ).m_flWeight;
+					break;
+				}
+			}
+		}
+
+		return distance;
+	}
+
 	while (iCurrentNode != iDest)
 	{
 		if (iMaxLoop-- <= 0)
@@ -513,6 +736,16 @@ float CGraph::PathLength( int iStart, int iDest, int iHull, int afCapMask )
 int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 {
 	int iNext = iCurrentNode;
+
+	if ( !m_fRoutingComplete )
+	{// no tables yet, search for the path instead
+		g_LivePath.resize( max( m_cNodes, 2 ) );
+
+		if ( FindShortestPath( &g_LivePath[0], iCurrentNode, iDest, iHull, RouteCapMask( iCap ) ) > 1 )
+			iNext = g_LivePath[1];
+
+		return iNext;
+	}
 	int nCount = iDest+1;
 	char *pRoute = m_pRouteInfo + m_pNodes[ iCurrentNode ].m_pNextBestNode[iHull][iCap];
 
@@ -566,19 +799,414 @@ int CGraph::NextNodeInRoute( int iCurrentNode, int iDest, int iHull, int iCap )
 }
 
 
+//=========================================================
+// CNodeClusters - Build - groups the nodes and works out
+// which clusters neighbor each other
+//=========================================================
+static inline int ClusterCell( const Vector &vecOrigin, int iAxis )
+{
+	return (int)floor( vecOrigin[ iAxis ] / NODE_CLUSTER_SIZE );
+}
+
+void CNodeClusters :: Build( CGraph *pGraph )
+{
+	int i, j, k;
+	int cNodes = pGraph->m_cNodes;
+
+	Clear();
+
+	m_nodeCluster.assign( cNodes, -1 );
+
+	// flood out along the links, staying in the first node's cube
+	std::vector<int> stack;
+	for ( i = 0; i < cNodes; i++ )
+	{
+		if ( m_nodeCluster[ i ] != -1 )
+			continue;
+
+		int iCluster = Count();
+		const Vector &vecFirst = pGraph->m_pNodes[ i ].m_vecOrigin;
+		cluster_t cluster;
+		int cMembers = 0;
+
+		cluster.vecCenter = Vector2D( 0, 0 );
+		cluster.iFirstEdge = 0;
+		cluster.cEdges = 0;
+
+		m_nodeCluster[ i ] = iCluster;
+		stack.push_back( i );
+
+		while ( !stack.empty() )
+		{
+			CNode &node = pGraph->m_pNodes[ stack.back() ];
+			stack.pop_back();
+
+			cluster.vecCenter = cluster.vecCenter + node.m_vecOrigin.Make2D();
+			cMembers++;
+
+			for ( j = 0; j < node.m_cNumLinks; j++ )
+			{
+				int iDest = pGraph->NodeLink( node, j ).m_iDestNode;
+				const Vector &vecDest = pGraph->m_pNodes[ iDest ].m_vecOrigin;
+
+				if ( m_nodeCluster[ iDest ] != -1 )
+					continue;
+
+				if ( ClusterCell( vecDest, 0 ) != ClusterCell( vecFirst, 0 ) ||
+					ClusterCell( vecDest, 1 ) != ClusterCell( vecFirst, 1 ) ||
+					ClusterCell( vecDest, 2 ) != ClusterCell( vecFirst, 2 ) )
+					continue;
+
+				m_nodeCluster[ iDest ] = iCluster;
+				stack.push_back( iDest );
+			}
+		}
+
+		cluster.vecCenter = cluster.vecCenter / cMembers;
+		m_clusters.push_back( cluster );
+	}
+
+	// each cluster's members, so its edges can be gathered together
+	std::vector<int> first( Count() + 1, 0 );
+	std::vector<int> members( cNodes );
+
+	for ( i = 0; i < cNodes; i++ )
+		first[ m_nodeCluster[ i ] + 1 ]++;
+	for ( i = 0; i < Count(); i++ )
+		first[ i + 1 ] += first[ i ];
+
+	std::vector<int> fill( first.begin(), first.end() - 1 );
+	for ( i = 0; i < cNodes; i++ )
+		members[ fill[ m_nodeCluster[ i ] ]++ ] = i;
+
+	for ( i = 0; i < Count(); i++ )
+	{
+		cluster_t &cluster = m_clusters[ i ];
+		cluster.iFirstEdge = m_edges.size();
+
+		for ( j = first[ i ]; j < first[ i + 1 ]; j++ )
+		{
+			CNode &node = pGraph->m_pNodes[ members[ j ] ];
+
+			for ( k = 0; k < node.m_cNumLinks; k++ )
+			{
+				CLink &link = pGraph->NodeLink( node, k );
+				int iOther = m_nodeCluster[ link.m_iDestNode ];
+
+				if ( iOther == i )
+					continue;
+
+				int iEdge;
+				for ( iEdge = cluster.iFirstEdge; iEdge < (int)m_edges.size(); iEdge++ )
+				{
+					if ( m_edges[ iEdge ].iCluster == iOther )
+						break;
+				}
+
+				if ( iEdge == (int)m_edges.size() )
+				{
+					clusteredge_t edge;
+					edge.iCluster = iOther;
+					edge.afLinkInfo = 0;
+					edge.flCost = ( cluster.vecCenter - m_clusters[ iOther ].vecCenter ).Length();
+					m_edges.push_back( edge );
+				}
+
+				m_edges[ iEdge ].afLinkInfo |= link.m_afLinkInfo;
+			}
+		}
+
+		cluster.cEdges = m_edges.size() - cluster.iFirstEdge;
+	}
+
+	m_clusterStep.assign( Count(), -1 );
+
+	// the links into each node, for following them backwards
+	m_firstInLink.assign( cNodes + 1, 0 );
+	m_inLinks.resize( pGraph->m_cLinks );
+
+	for ( i = 0; i < pGraph->m_cLinks; i++ )
+		m_firstInLink[ pGraph->m_pLinkPool[ i ].m_iDestNode + 1 ]++;
+	for ( i = 0; i < cNodes; i++ )
+		m_firstInLink[ i + 1 ] += m_firstInLink[ i ];
+
+	fill.assign( m_firstInLink.begin(), m_firstInLink.end() - 1 );
+	for ( i = 0; i < pGraph->m_cLinks; i++ )
+		m_inLinks[ fill[ pGraph->m_pLinkPool[ i ].m_iDestNode ]++ ] = i;
+
+	m_nodeMark.assign( cNodes, 0 );
+
+	ALERT ( at_aiconsole, "%d node clusters, %d cluster links\n", Count(), (int)m_edges.size() );
+}
+
+void CNodeClusters :: Clear( void )
+{
+	m_nodeCluster.clear();
+	m_clusters.clear();
+	m_edges.clear();
+	m_clusterStep.clear();
+	m_corridor.clear();
+	m_iWindow = 0;
+	m_firstInLink.clear();
+	m_inLinks.clear();
+	m_nodeMark.clear();
+	m_iMark = 0;
+	m_fMarked = FALSE;
+	m_stack.clear();
+}
+
+//=========================================================
+// CNodeClusters - FindCorridor - A* over the clusters. The
+// edges only say that some link between two clusters lets
+// the hull through, so a corridor isn't a promise there's
+// a path, but no corridor means there isn't one.
+//=========================================================
+BOOL CNodeClusters :: FindCorridor( int iStartNode, int iDestNode, int iHullMask )
+{
+	int i;
+	int iStart = m_nodeCluster[ iStartNode ];
+	int iDest = m_nodeCluster[ iDestNode ];
+
+	for ( i = 0; i < (int)m_corridor.size(); i++ )
+	{
+		m_clusterStep[ m_corridor[ i ] ] = -1;
+	}
+	m_corridor.clear();
+	m_iWindow = 0;
+	m_fMarked = FALSE;
+
+	Vector2D vecDest = m_clusters[ iDest ].vecCenter;
+
+	m_search.Begin( Count() );
+	m_search.Visit( iStart, 0.0, iStart );
+	m_search.m_queue.Insert( iStart, ( m_clusters[ iStart ].vecCenter - vecDest ).Length() );
+
+	while ( !m_search.m_queue.Empty() )
+	{
+		float flPriority;
+		int iCurrent = m_search.m_queue.Remove( flPriority );
+
+		if ( iCurrent == iDest )
+			break;
+
+		cluster_t &cluster = m_clusters[ iCurrent ];
+		float flCurrentCost = m_search.Cost( iCurrent );
+
+		if ( flPriority > flCurrentCost + ( cluster.vecCenter - vecDest ).Length() + 0.0005 )
+			continue;
+
+		for ( i = cluster.iFirstEdge; i < cluster.iFirstEdge + cluster.cEdges; i++ )
+		{
+			clusteredge_t &edge = m_edges[ i ];
+
+			if ( ( edge.afLinkInfo & iHullMask ) != iHullMask )
+				continue;
+
+			float flOurCost = flCurrentCost + edge.flCost;
+			if ( !m_search.Visited( edge.iCluster ) || flOurCost < m_search.Cost( edge.iCluster ) - 0.001 )
+			{
+				m_search.Visit( edge.iCluster, flOurCost, iCurrent );
+				m_search.m_queue.Insert( edge.iCluster, flOurCost + ( m_clusters[ edge.iCluster ].vecCenter - vecDest ).Length() );
+			}
+		}
+	}
+
+	if ( !m_search.Visited( iDest ) )
+	{
+		return FALSE;
+	}
+
+	for ( i = iDest; ; i = m_search.Previous( i ) )
+	{
+		m_corridor.push_back( i );
+		if ( i == iStart )
+			break;
+	}
+	std::reverse( m_corridor.begin(), m_corridor.end() );
+
+	for ( i = 0; i < (int)m_corridor.size(); i++ )
+	{
+		m_clusterStep[ m_corridor[ i ] ] = i;
+	}
+	m_iWindow = m_corridor.size() - 1;
+
+	return TRUE;
+}
+
+//=========================================================
+// CNodeClusters - MarkLeadsToDest - flood fill backwards
+// from the destination over the corridor's nodes. Getting
+// to the edge of a window only means something on nodes
+// that are marked.
+//=========================================================
+BOOL CNodeClusters :: MarkLeadsToDest( CGraph *pGraph, int iStartNode, int iDestNode, int iHullMask, int afCapMask )
+{
+	int i;
+
+	if ( ++m_iMark <= 0 )
+	{// wrapped, start the marks over
+		m_nodeMark.assign( m_nodeMark.size(), 0 );
+		m_iMark = 1;
+	}
+
+	m_fMarked = TRUE;
+	m_nodeMark[ iDestNode ] = m_iMark;
+	m_stack.clear();
+	m_stack.push_back( iDestNode );
+
+	while ( !m_stack.empty() )
+	{
+		int iNode = m_stack.back();
+		m_stack.pop_back();
+
+		for ( i = m_firstInLink[ iNode ]; i < m_firstInLink[ iNode + 1 ]; i++ )
+		{
+			CLink *pLink = &pGraph->m_pLinkPool[ m_inLinks[ i ] ];
+			int iSrcNode = pLink->m_iSrcNode;
+
+			if ( m_nodeMark[ iSrcNode ] == m_iMark || m_clusterStep[ m_nodeCluster[ iSrcNode ] ] < 0 )
+				continue;
+
+			if ( ( pLink->m_afLinkInfo & iHullMask ) != iHullMask )
+				continue;
+
+			if ( pLink->m_pLinkEnt != NULL && !pGraph->HandleLinkEnt ( iSrcNode, pLink->m_pLinkEnt, afCapMask, CGraph::NODEGRAPH_STATIC ) )
+				continue;
+
+			m_nodeMark[ iSrcNode ] = m_iMark;
+			m_stack.push_back( iSrcNode );
+		}
+	}
+
+	return ( m_nodeMark[ iStartNode ] == m_iMark );
+}
+
+void CNodeClusters :: SetWindow( int cSteps )
+{
+	m_iWindow = min( cSteps, (int)m_corridor.size() - 1 );
+}
+
+//=========================================================
+// SearchPath - A* over the nodes from iStart to iDest. With
+// pClusters only the nodes in its window that lead to the
+// destination are searched, and getting to the far cluster
+// of the window counts as arriving. Puts the first cMaxPath nodes of the path in
+// piPath, or all of them if cMaxPath is 0, and returns how
+// long the whole path is.
+//=========================================================
+static int SearchPath( CGraph *pGraph, CPathSearch &search, int *piPath, int cMaxPath, int iStart, int iDest, int iHullMask, int afCapMask, CNodeClusters *pClusters )
+{
+	int i;
+	int iCurrentNode;
+	int iEnd = -1;
+
+	// A new search generation marks all the nodes as unvisited.
+	//
+	search.Begin( pGraph->m_cNodes );
+
+	// Links are weighted by their 2D length, so the 2D distance to the destination
+	// never overestimates what's left, and A* finds the same shortest paths as
+	// a plain Dijkstra search without expanding everything closer than the goal.
+	//
+	Vector2D vecDest = pGraph->m_pNodes[ iDest ].m_vecOrigin.Make2D();
+
+	search.Visit( iStart, 0.0, iStart );// tag this as the origin node
+	search.m_queue.Insert( iStart, ( pGraph->m_pNodes[ iStart ].m_vecOrigin.Make2D() - vecDest ).Length() );// insert start node 
+
+	while ( !search.m_queue.Empty() )
+	{
+		// now pull a node out of the queue
+		float flPriority;
+		iCurrentNode = search.m_queue.Remove(flPriority);
+
+		// For straight-line weights, the following Shortcut works. For arbitrary weights,
+		// it doesn't.
+		//
+		if ( iCurrentNode == iDest || ( pClusters && pClusters->AtFrontier( iCurrentNode ) ) )
+		{
+			iEnd = iCurrentNode;
+			break;
+		}
+
+		CNode *pCurrentNode = &pGraph->m_pNodes[ iCurrentNode ];
+		float flCurrentDistance = search.Cost( iCurrentNode );
+
+		// A shorter way here was found after this entry was queued, that one
+		// gets expanded instead. Shorter always means by more than 0.001.
+		//
+		if ( flPriority > flCurrentDistance + ( pCurrentNode->m_vecOrigin.Make2D() - vecDest ).Length() + 0.0005 )
+			continue;
+
+		for ( i = 0 ; i < pCurrentNode->m_cNumLinks ; i++ )
+		{// run through all of this node's neighbors
+
+			CLink *pLink = &pGraph->m_pLinkPool[ pCurrentNode->m_iFirstLink + i ];
+
+			int iVisitNode = pLink->m_iDestNode;
+			if ( ( pLink->m_afLinkInfo & iHullMask ) != iHullMask )
+			{// monster is too large to walk this connection
+				continue;
+			}
+			if ( pClusters && ( !pClusters->InWindow( iVisitNode ) || !pClusters->LeadsToDest( iVisitNode ) ) )
+			{// outside the corridor, or a dead end
+				continue;
+			}
+			// check the connection from the current node to the node we're about to mark visited and push into the queue
+			if ( pLink->m_pLinkEnt != NULL )
+			{// there's a brush ent in the way! Don't mark this node or put it into the queue unless the monster can negotiate it
+
+				if ( !pGraph->HandleLinkEnt ( iCurrentNode, pLink->m_pLinkEnt, afCapMask, CGraph::NODEGRAPH_STATIC ) )
+				{// monster should not try to go this way.
+					continue;
+				}
+			}
+			float flOurDistance = flCurrentDistance + pLink->m_flWeight;
+			if (  !search.Visited( iVisitNode )
+			   || flOurDistance < search.Cost( iVisitNode ) - 0.001 )
+			{
+				search.Visit( iVisitNode, flOurDistance, iCurrentNode );
+
+				search.m_queue.Insert ( iVisitNode, flOurDistance + ( pGraph->m_pNodes[ iVisitNode ].m_vecOrigin.Make2D() - vecDest ).Length() );
+			}
+		}
+	}
+
+	if ( iEnd == -1 )
+	{// Destination is unreachable, no path found.
+		return 0;
+	}
+
+	// now we must walk backwards through the previous nodes, and count how many connections there are in the path
+	int cPath = 1;// count the end
+	for ( iCurrentNode = iEnd; iCurrentNode != iStart; iCurrentNode = search.Previous( iCurrentNode ) )
+	{
+		cPath++;
+	}
+
+	iCurrentNode = iEnd;
+	for ( i = cPath - 1 ; i >= 0 ; i-- )
+	{
+		if ( !cMaxPath || i < cMaxPath )
+			piPath[ i ] = iCurrentNode;
+		iCurrentNode = search.Previous( iCurrentNode );
+	}
+
+	return cPath;
+}
+
 //=========================================================
 // CGraph - FindShortestPath 
 //
 // accepts a capability mask (afCapMask), and will only 
 // find a path usable by a monster with those capabilities
-// returns the number of nodes copied into supplied array
+// returns the number of nodes copied into supplied array.
+// Without the routing tables, cMaxPath caps how many that
+// is, and a longer path is only searched near the start.
 //=========================================================
-int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask)
+int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, int cMaxPath )
 {
-	int		iVisitNode;
 	int		iCurrentNode;
 	int		iNumPathNodes;
-	int		iHullMask;
 
 	if ( !m_fGraphPresent || !m_fGraphPointersSet )
 	{// protect us in the case that the node graph isn't available or built
@@ -635,101 +1263,47 @@ int CGraph :: FindShortestPath ( int *piPath, int iStart, int iDest, int iHull,
 	}
 	else
 	{
-		CQueuePriority	queue;
+		int iHullMask = LinkHullMask( iHull );
+		int cPath = 0;
 
-		switch( iHull )
+		if ( ai_pathclusters.value && g_NodeClusters.Count() > 1 )
 		{
-		case NODE_SMALL_HULL:
-			iHullMask = bits_LINK_SMALL_HULL;
-			break;
-		case NODE_HUMAN_HULL:
-			iHullMask = bits_LINK_HUMAN_HULL;
-			break;
-		case NODE_LARGE_HULL:
-			iHullMask = bits_LINK_LARGE_HULL;
-			break;
-		case NODE_FLY_HULL:
-			iHullMask = bits_LINK_FLY_HULL;
-			break;
-		}
+			if ( !g_NodeClusters.FindCorridor( iStart, iDest, iHullMask ) )
+			{// the clusters don't connect, so the nodes can't either
+				return 0;
+			}
 
-		// Mark all the nodes as unvisited.
-		//
-		int i;
-		for ( i = 0; i < m_cNodes; i++)
-		{
-			m_pNodes[ i ].m_flClosestSoFar = -1.0;
-		}
+			// A partial path only needs the first few clusters searched. Widen the
+			// window until there's more path than fits or the destination is in it.
+			// Nodes that can't get to the destination are left out first, or the
+			// search could stop at the edge of the window on the way to nowhere.
+			//
+			int cSteps = cMaxPath ? NODE_CLUSTER_WINDOW : g_NodeClusters.m_corridor.size();
 
-		m_pNodes[ iStart ].m_flClosestSoFar = 0.0;
-		m_pNodes[ iStart ].m_iPreviousNode = iStart;// tag this as the origin node
-		queue.Insert( iStart, 0.0 );// insert start node 
-		
-		while ( !queue.Empty() )
-		{
-			// now pull a node out of the queue
-			float flCurrentDistance;
-			iCurrentNode = queue.Remove(flCurrentDistance);
+			if ( cSteps < (int)g_NodeClusters.m_corridor.size() - 1 &&
+				!g_NodeClusters.MarkLeadsToDest( this, iStart, iDest, iHullMask, afCapMask ) )
+			{// no way there through the corridor, the full search below decides
+				cSteps = -1;
+			}
 
-			// For straight-line weights, the following Shortcut works. For arbitrary weights,
-			// it doesn't.
-			//
-			if (iCurrentNode == iDest) break;
+			while ( cSteps >= 0 )
+			{
+				g_NodeClusters.SetWindow( cSteps );
+				cPath = SearchPath( this, g_PathSearch, piPath, cMaxPath, iStart, iDest, iHullMask, afCapMask, &g_NodeClusters );
 
-			CNode *pCurrentNode = &m_pNodes[ iCurrentNode ];
-			
-			for ( i = 0 ; i < pCurrentNode->m_cNumLinks ; i++ )
-			{// run through all of this node's neighbors
-				
-				iVisitNode = INodeLink ( iCurrentNode, i );
-				if ( ( m_pLinkPool[  m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo & iHullMask ) != iHullMask )
-				{// monster is too large to walk this connection
-					//ALERT ( at_aiconsole, "fat ass %d/%d\n",m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_afLinkInfo, iMonsterHull );
-					continue;
-				}
-				// check the connection from the current node to the node we're about to mark visited and push into the queue				
-				if ( m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_pLinkEnt != NULL )
-				{// there's a brush ent in the way! Don't mark this node or put it into the queue unless the monster can negotiate it
-					
-					if ( !HandleLinkEnt ( iCurrentNode, m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i ].m_pLinkEnt, afCapMask, NODEGRAPH_STATIC ) )
-					{// monster should not try to go this way.
-						continue;
-					}
-				}
-				float flOurDistance = flCurrentDistance + m_pLinkPool[ m_pNodes[ iCurrentNode ].m_iFirstLink + i].m_flWeight;
-				if (  m_pNodes[ iVisitNode ].m_flClosestSoFar < -0.5
-				   || flOurDistance < m_pNodes[ iVisitNode ].m_flClosestSoFar - 0.001 )
-				{
-					m_pNodes[iVisitNode].m_flClosestSoFar = flOurDistance;
-					m_pNodes[iVisitNode].m_iPreviousNode = iCurrentNode;
+				if ( !cPath || cPath > cMaxPath || cSteps >= (int)g_NodeClusters.m_corridor.size() - 1 )
+					break;
 
-					queue.Insert ( iVisitNode, flOurDistance );
-				}
+				cSteps *= 2;
 			}
 		}
-		if ( m_pNodes[iDest].m_flClosestSoFar < -0.5 )
-		{// Destination is unreachable, no path found.
-			return 0;
-		}
 
-	// the queue is not empty
-		
-		// now we must walk backwards through the m_iPreviousNode field, and count how many connections there are in the path
-		iCurrentNode = iDest;
-		iNumPathNodes = 1;// count the dest
-		
-		while ( iCurrentNode != iStart )
-		{
-			iNumPathNodes++;
-			iCurrentNode = m_pNodes[ iCurrentNode ].m_iPreviousNode;
+		if ( !cPath )
+		{// no clusters, or the path wanders out of the corridor. Search everything.
+			cPath = SearchPath( this, g_PathSearch, piPath, cMaxPath, iStart, iDest, iHullMask, afCapMask, NULL );
 		}
 
-		iCurrentNode = iDest;
-		for ( i = iNumPathNodes - 1 ; i >= 0 ; i-- )
-		{
-			piPath[ i ] = iCurrentNode;
-			iCurrentNode = m_pNodes [ iCurrentNode ].m_iPreviousNode;
-		}
+		iNumPathNodes = ( cMaxPath && cPath > cMaxPath ) ? cMaxPath : cPath;
 	}
 
 #if 0
@@ -780,21 +1354,6 @@ inline ULONG Hash(void *p, int len)
 	return CRC32_FINAL(ulCrc);
 }
 
-void inline CalcBounds(int &Lower, int &Upper, int Goal, int Best)
-{
-    int Temp = 2*Goal - Best;
-    if (Best > Goal)
-    {
-        Lower = max(0, Temp);
-        Upper = Best;
-    }
-    else
-    {
-        Upper = min(255, Temp);
-        Lower = Best;
-    }
-}
-
 // Convert from [-8192,8192] to [0, 255]
 //
 inline int CALC_RANGE(int x, int lower, int upper)
@@ -803,50 +1362,19 @@ inline int CALC_RANGE(int x, int lower, int upper)
 }
 
 
-void inline UpdateRange(int &minValue, int &maxValue, int Goal, int Best)
-{
-    int Lower, Upper;
-    CalcBounds(Lower, Upper, Goal, Best);
-    if (Upper < maxValue) maxValue = Upper;
-    if (minValue < Lower) minValue = Lower;
-}
-
-void CGraph :: CheckNode(Vector vecOrigin, int iNode)
+//=========================================================
+// CGraph - CheckNode - can vecOrigin see iNode?
+//=========================================================
+int CGraph :: CheckNode( const Vector &vecOrigin, int iNode )
 {
-    // Have we already seen this point before?.
-    //
-    if (m_di[iNode].m_CheckedEvent == m_CheckedCounter) return;
-    m_di[iNode].m_CheckedEvent = m_CheckedCounter;
-
-	float flDist = ( vecOrigin - m_pNodes[ iNode ].m_vecOriginPeek ).Length();
-
-	if ( flDist < m_flShortest )
-	{
-		TraceResult tr;
-
-		// make sure that vecOrigin can trace to this node!
-		UTIL_TraceLine ( vecOrigin, m_pNodes[ iNode ].m_vecOriginPeek, ignore_monsters, 0, &tr );
+	TraceResult tr;
 
-		if ( tr.flFraction == 1.0 )
-		{
-			m_iNearest = iNode;
-			m_flShortest = flDist;
+	g_cNearestTraces++;
 
-			UpdateRange(m_minX, m_maxX, CALC_RANGE(vecOrigin.x, m_RegionMin[0], m_RegionMax[0]), m_pNodes[iNode].m_Region[0]);
-			UpdateRange(m_minY, m_maxY, CALC_RANGE(vecOrigin.y, m_RegionMin[1], m_RegionMax[1]), m_pNodes[iNode].m_Region[1]);
-			UpdateRange(m_minZ, m_maxZ, CALC_RANGE(vecOrigin.z, m_RegionMin[2], m_RegionMax[2]), m_pNodes[iNode].m_Region[2]);
+	// make sure that vecOrigin can trace to this node!
+	UTIL_TraceLine ( vecOrigin, m_pNodes[ iNode ].m_vecOriginPeek, ignore_monsters, 0, &tr );
 
-			// From maxCircle, calculate maximum bounds box. All points must be
-			// simultaneously inside all bounds of the box.
-			//
-			m_minBoxX = CALC_RANGE(vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0]);
-			m_maxBoxX = CALC_RANGE(vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0]);
-			m_minBoxY = CALC_RANGE(vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1]);
-			m_maxBoxY = CALC_RANGE(vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1]);
-			m_minBoxZ = CALC_RANGE(vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2]);
-			m_maxBoxZ = CALC_RANGE(vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2]);
-		}
-	}
+	return ( tr.flFraction == 1.0 );
 }
 
 //=========================================================
@@ -861,8 +1389,7 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  CBaseEntity *pEntity )
 
 int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 {
-	int	i;
-	TraceResult tr;
+	int iNearest;
 
 	if ( !m_fGraphPresent || !m_fGraphPointersSet )
 	{// protect us in the case that the node graph isn't available
@@ -872,201 +1399,37 @@ int	CGraph :: FindNearestNode ( const Vector &vecOrigin,  int afNodeTypes )
 
 	// Check with the cache
 	//
-	ULONG iHash = (CACHE_SIZE-1) & Hash((void *)(const float *)vecOrigin, sizeof(vecOrigin));
-	if (m_Cache[iHash].v == vecOrigin)
-	{
-		//ALERT(at_aiconsole, "Cache Hit.\n");
-		return m_Cache[iHash].n;
-	}
-	else
-	{
-		//ALERT(at_aiconsole, "Cache Miss.\n");
-	}
-
-	// Mark all points as unchecked.
-	//
-	m_CheckedCounter++;
-	if (m_CheckedCounter == 0)
+	if ( g_NodeTree.CacheLookup( vecOrigin, afNodeTypes, iNearest ) )
 	{
-		for (int i = 0; i < m_cNodes; i++)
-		{
-			m_di[i].m_CheckedEvent = 0;
-		}
-		m_CheckedCounter++;
+		return iNearest;
 	}
 
-	m_iNearest = -1;
-	m_flShortest = 999999.0; // just a big number.
-
-	// If we can find a visible point, then let CalcBounds set the limits, but if
-	// we have no visible point at all to start with, then don't restrict the limits.
-	//
-#if 1
-	m_minX = 0; m_maxX = 255;
-	m_minY = 0; m_maxY = 255;
-	m_minZ = 0; m_maxZ = 255;
-	m_minBoxX = 0; m_maxBoxX = 255;
-	m_minBoxY = 0; m_maxBoxY = 255;
-	m_minBoxZ = 0; m_maxBoxZ = 255;
-#else
-	m_minBoxX = CALC_RANGE(vecOrigin.x - flDist, m_RegionMin[0], m_RegionMax[0]);
-	m_maxBoxX = CALC_RANGE(vecOrigin.x + flDist, m_RegionMin[0], m_RegionMax[0]);
-	m_minBoxY = CALC_RANGE(vecOrigin.y - flDist, m_RegionMin[1], m_RegionMax[1]);
-	m_maxBoxY = CALC_RANGE(vecOrigin.y + flDist, m_RegionMin[1], m_RegionMax[1]);
-	m_minBoxZ = CALC_RANGE(vecOrigin.z - flDist, m_RegionMin[2], m_RegionMax[2]);
-	m_maxBoxZ = CALC_RANGE(vecOrigin.z + flDist, m_RegionMin[2], m_RegionMax[2])
-    CalcBounds(m_minX, m_maxX, CALC_RANGE(vecOrigin.x, m_RegionMin[0], m_RegionMax[0]), m_pNodes[m_iNearest].m_Region[0]);
-    CalcBounds(m_minY, m_maxY, CALC_RANGE(vecOrigin.y, m_RegionMin[1], m_RegionMax[1]), m_pNodes[m_iNearest].m_Region[1]);
-    CalcBounds(m_minZ, m_maxZ, CALC_RANGE(vecOrigin.z, m_RegionMin[2], m_RegionMax[2]), m_pNodes[m_iNearest].m_Region[2]);
-#endif
-
-    int halfX = (m_minX+m_maxX)/2;
-    int halfY = (m_minY+m_maxY)/2;
-    int halfZ = (m_minZ+m_maxZ)/2;
-
-    int j;
-
-    for (i = halfX; i >= m_minX; i--)
-    {
-        for (j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-			if (rgY > m_maxBoxY) break;
-            if (rgY < m_minBoxY) continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-            if (rgZ < m_minBoxZ) continue;
-            if (rgZ > m_maxBoxZ) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[0]);
-        }
-    }
-
-    for (i = max(m_minY,halfY+1); i <= m_maxY; i++)
-    {
-        for (j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-            if (rgZ > m_maxBoxZ) break;
-            if (rgZ < m_minBoxZ) continue;
-			int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-            if (rgX < m_minBoxX) continue;
-            if (rgX > m_maxBoxX) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[1]);
-        }
-    }
-
-    for (i = min(m_maxZ,halfZ); i >= m_minZ; i--)
-    {
-        for (j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-            if (rgX > m_maxBoxX) break;
-            if (rgX < m_minBoxX) continue;
-			int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-            if (rgY < m_minBoxY) continue;
-			if (rgY > m_maxBoxY) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[2]);
-        }
-    }
-
-    for (i = max(m_minX,halfX+1); i <= m_maxX; i++)
-    {
-        for (j = m_RangeStart[0][i]; j <= m_RangeEnd[0][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[0]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgY = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[1];
-			if (rgY > m_maxBoxY) break;
-            if (rgY < m_minBoxY) continue;
+	iNearest = NearestVisibleNode( vecOrigin, afNodeTypes );
 
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[0]].m_Region[2];
-            if (rgZ < m_minBoxZ) continue;
-            if (rgZ > m_maxBoxZ) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[0]);
-        }
-    }
-
-    for (i = min(m_maxY,halfY); i >= m_minY; i--)
-    {
-        for (j = m_RangeStart[1][i]; j <= m_RangeEnd[1][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[1]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgZ = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[2];
-            if (rgZ > m_maxBoxZ) break;
-            if (rgZ < m_minBoxZ) continue;
-			int rgX = m_pNodes[m_di[j].m_SortedBy[1]].m_Region[0];
-            if (rgX < m_minBoxX) continue;
-            if (rgX > m_maxBoxX) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[1]);
-        }
-    }
+	g_NodeTree.CacheStore( vecOrigin, afNodeTypes, iNearest );
+	return iNearest;
+}
 
-    for (i = max(m_minZ,halfZ+1); i <= m_maxZ; i++)
-    {
-        for (j = m_RangeStart[2][i]; j <= m_RangeEnd[2][i]; j++)
-        {
-			if (!(m_pNodes[m_di[j].m_SortedBy[2]].m_afNodeInfo & afNodeTypes)) continue;
-
-			int rgX = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[0];
-            if (rgX > m_maxBoxX) break;
-            if (rgX < m_minBoxX) continue;
-			int rgY = m_pNodes[m_di[j].m_SortedBy[2]].m_Region[1];
-            if (rgY < m_minBoxY) continue;
-			if (rgY > m_maxBoxY) continue;
-            CheckNode(vecOrigin, m_di[j].m_SortedBy[2]);
-        }
-    }
+//=========================================================
+// CGraph - NearestVisibleNode - FindNearestNode without the
+// cache. The tree hands nodes out nearest first, so the
+// first one that can be seen is the answer.
+//=========================================================
+int CGraph :: NearestVisibleNode( const Vector &vecOrigin, int afNodeTypes )
+{
+	int iNode;
 
-#if 0
-	// Verify our answers.
-	//
-	int iNearestCheck = -1;
-	m_flShortest = 8192;// find nodes within this radius
+	g_NodeTree.BeginQuery( vecOrigin, afNodeTypes );
 
-	for ( i = 0 ; i < m_cNodes ; i++ )
+	while ( ( iNode = g_NodeTree.NextNode() ) != -1 )
 	{
-		float flDist = ( vecOrigin - m_pNodes[ i ].m_vecOriginPeek ).Length();
-
-		if ( flDist < m_flShortest )
+		if ( CheckNode( vecOrigin, iNode ) )
 		{
-			// make sure that vecOrigin can trace to this node!
-			UTIL_TraceLine ( vecOrigin, m_pNodes[ i ].m_vecOriginPeek, ignore_monsters, 0, &tr );
-
-			if ( tr.flFraction == 1.0 )
-			{
-				iNearestCheck = i;
-				m_flShortest = flDist;
-			}
+			return iNode;
 		}
 	}
 
-	if (iNearestCheck != m_iNearest)
-	{
-		ALERT( at_aiconsole, "NOT closest %d(%f,%f,%f) %d(%f,%f,%f).\n",
-			iNearestCheck,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.x,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.y,
-			m_pNodes[iNearestCheck].m_vecOriginPeek.z,
-			m_iNearest,
-			(m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.x),
-			(m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.y),
-			(m_iNearest == -1?0.0:m_pNodes[m_iNearest].m_vecOriginPeek.z));
-	}
-	if (m_iNearest == -1)
-	{
-		ALERT(at_aiconsole, "All that work for nothing.\n");
-	}
-#endif
-	m_Cache[iHash].v = vecOrigin;
-	m_Cache[iHash].n = m_iNearest;
-	return m_iNearest;
+	return -1;
 }
 
 //=========================================================
@@ -2016,6 +2379,10 @@ void CTestHull :: BuildNodeGraph( void )
 	//
 	WorldGraph.BuildRegionTables();
 
+	// This is used for FindCover
+	//
+	WorldGraph.BuildVisibility( ai_routes_background.value != 0 );
+
 
 	// Push all of the LAND nodes down to the ground now. Leave the water and air nodes alone.
 	//
@@ -2044,12 +2411,19 @@ void CTestHull :: BuildNodeGraph( void )
 	WorldGraph.m_fGraphPointersSet = TRUE;// since the graph was generated, the pointers are ready
 	WorldGraph.m_fRoutingComplete = FALSE; // Optimal routes aren't computed, yet.
 
-	// Compute and compress the routing information.
+	g_NodeTree.Build( WorldGraph.m_pNodes, WorldGraph.m_cNodes );
+	g_NodeClusters.Build( &WorldGraph );
+
+	// Compute and compress the routing information. In the background, the graph
+	// is saved once the routes and the visibility bits are done.
 	//
-	WorldGraph.ComputeStaticRoutingTables();
+	WorldGraph.ComputeStaticRoutingTables( ai_routes_background.value != 0 );
 
+	if ( WorldGraph.m_fRoutingComplete )
+	{
 // save the node graph for this level	
-	WorldGraph.FSaveGraph( (char *)STRING( gpGlobals->mapname ) );
+		WorldGraph.FSaveGraph( (char *)STRING( gpGlobals->mapname ) );
+	}
 	ALERT( at_console, "Done.\n");
 }
 
@@ -2302,1031 +2676,1828 @@ void CQueuePriority::Heap_SiftUp(void)
 }
 
 //=========================================================
-// CGraph - FLoadGraph - attempts to load a node graph from disk.
-// if the current level is maps/snar.bsp, maps/graphs/snar.nod
-// will be loaded. If file cannot be loaded, the node tree
-// will be created and saved to disk.
+// CNodeHeap constructor
 //=========================================================
-int CGraph :: FLoadGraph ( char *szMapName )
+CNodeHeap :: CNodeHeap( void )
 {
-	char	szFilename[MAX_PATH];
-	int		iVersion;
-	int     length;
-	byte    *aMemFile;
-	byte    *pMemFile;
-
-	// make sure the directories have been made
-	char	szDirName[MAX_PATH];
-	GET_GAME_DIR( szDirName );
-	strcat( szDirName, "/maps" );
-	CreateDirectory( szDirName, NULL );
-	strcat( szDirName, "/graphs" );
-	CreateDirectory( szDirName, NULL );
-
-	strcpy ( szFilename, "maps/graphs/" );
-	strcat ( szFilename, szMapName );
-	strcat( szFilename, ".nod" );
-
-	pMemFile = aMemFile = LOAD_FILE_FOR_ME(szFilename, &length);
+	m_cSize = 0;
+	m_cMax = 0;
+	m_heap = NULL;
+}
 
-	if ( !aMemFile )
+CNodeHeap :: ~CNodeHeap( void )
+{
+	if ( m_heap )
 	{
-		return FALSE;
+		free ( m_heap );
+		m_heap = NULL;
 	}
-	else
+}
+
+//=========================================================
+// inserts a value into the priority queue, growing it if
+// it's full
+//=========================================================
+void CNodeHeap :: Insert( int iValue, float fPriority )
+{
+	if ( m_cSize == m_cMax )
 	{
-		// Read the graph version number
-		//
-		length -= sizeof(int);
-		if (length < 0) goto ShortFile;
-		memcpy(&iVersion, pMemFile, sizeof(int));
-		pMemFile += sizeof(int);
+		int cNewMax = m_cMax ? m_cMax * 2 : MAX_STACK_NODES;
+		struct tag_HEAP_NODE *pNewHeap = (struct tag_HEAP_NODE *)realloc ( m_heap, sizeof ( struct tag_HEAP_NODE ) * cNewMax );
 
-		if ( iVersion != GRAPH_VERSION )
+		if ( !pNewHeap )
 		{
-			// This file was written by a different build of the dll!
-			//
-			ALERT ( at_aiconsole, "**ERROR** Graph version is %d, expected %d\n",iVersion, GRAPH_VERSION );
-			goto ShortFile;
+			ALERT ( at_aiconsole, "Couldn't grow node heap!\n" );
+			return;
 		}
 
-		// Read the graph class
-		//
-		length -= sizeof(CGraph);
-		if (length < 0) goto ShortFile;
-		memcpy(this, pMemFile, sizeof(CGraph));
-		pMemFile += sizeof(CGraph);
+		m_heap = pNewHeap;
+		m_cMax = cNewMax;
+	}
 
-		// Set the pointers to zero, just in case we run out of memory.
-		//
-		m_pNodes     = NULL;
-		m_pLinkPool  = NULL;
-		m_di         = NULL;
-		m_pRouteInfo = NULL;
-		m_pHashLinks = NULL;
+    m_heap[ m_cSize ].Priority = fPriority;
+	m_heap[ m_cSize ].Id = iValue;
+    m_cSize++;
+    Heap_SiftUp();
+}
+
+//=========================================================
+// removes the smallest item from the priority queue
+//=========================================================
+int CNodeHeap :: Remove( float &fPriority )
+{
+	int iReturn = m_heap[ 0 ].Id;
+	fPriority = m_heap[ 0 ].Priority;
 
+	m_cSize--;
 
-		// Malloc for the nodes
-		//
-		m_pNodes = ( CNode * )calloc ( sizeof ( CNode ), m_cNodes );
+	m_heap[ 0 ] = m_heap[ m_cSize ];
 
-		if ( !m_pNodes )
-		{
-			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d nodes!\n", m_cNodes );
-			goto NoMemory;
-		}
+    Heap_SiftDown(0);
+    return iReturn;
+}
 
-		// Read in all the nodes
-		//
-		length -= sizeof(CNode) * m_cNodes;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pNodes, pMemFile, sizeof(CNode)*m_cNodes);
-		pMemFile += sizeof(CNode) * m_cNodes;
+void CNodeHeap::Heap_SiftDown(int iSubRoot)
+{
+	int parent = iSubRoot;
+	int child = HEAP_LEFT_CHILD(parent);
 
-		
-		// Malloc for the link pool
-		//
-		m_pLinkPool = ( CLink * )calloc ( sizeof ( CLink ), m_cLinks );
+	struct tag_HEAP_NODE Ref = m_heap[ parent ];
 
-		if ( !m_pLinkPool )
+    while (child < m_cSize)
+	{
+		int rightchild = HEAP_RIGHT_CHILD(parent);
+		if (rightchild < m_cSize)
 		{
-			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d link!\n", m_cLinks );
-			goto NoMemory;
+			if ( m_heap[ rightchild ].Priority < m_heap[ child ].Priority )
+			{
+				child = rightchild;
+			}
 		}
+		if ( Ref.Priority <= m_heap[ child ].Priority )
+			break;
 
-		// Read in all the links
-		//
-		length -= sizeof(CLink)*m_cLinks;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pLinkPool, pMemFile, sizeof(CLink)*m_cLinks);
-		pMemFile += sizeof(CLink)*m_cLinks;
+		m_heap[ parent ] = m_heap[ child ];
+		parent = child;
+		child = HEAP_LEFT_CHILD(parent);
+	}
+	m_heap[ parent ] = Ref;
+}
 
-		// Malloc for the sorting info.
-		//
-		m_di = (DIST_INFO *)calloc( sizeof(DIST_INFO), m_cNodes );
-		if ( !m_di )
-		{
-			ALERT ( at_aiconsole, "***ERROR**\nCouldn't malloc %d entries sorting nodes!\n", m_cNodes );
-			goto NoMemory;
-		}
+void CNodeHeap::Heap_SiftUp(void)
+{
+	int child = m_cSize-1;
+	struct tag_HEAP_NODE Ref = m_heap[ child ];
 
-		// Read it in.
-		//
-		length -= sizeof(DIST_INFO)*m_cNodes;
-		if (length < 0) goto ShortFile;
-		memcpy(m_di, pMemFile, sizeof(DIST_INFO)*m_cNodes);
-		pMemFile += sizeof(DIST_INFO)*m_cNodes;
-
-		// Malloc for the routing info.
-		//
-		m_fRoutingComplete = FALSE;
-		m_pRouteInfo = (char *)calloc( sizeof(char), m_nRouteInfo );
-		if ( !m_pRouteInfo )
-		{
-			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d route bytes!\n", m_nRouteInfo );
-			goto NoMemory;
-		}
-		m_CheckedCounter = 0;
-		for (int i = 0; i < m_cNodes; i++)
-		{
-			m_di[i].m_CheckedEvent = 0;
-		}
-		
-		// Read in the route information.
-		//
-		length -= sizeof(char)*m_nRouteInfo;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pRouteInfo, pMemFile, sizeof(char)*m_nRouteInfo);
-		pMemFile += sizeof(char)*m_nRouteInfo;
-		m_fRoutingComplete = TRUE;;
+	while (child)
+	{
+		int parent = HEAP_PARENT(child);
+		if ( m_heap[ parent ].Priority <= Ref.Priority )
+			break;
 
-		// malloc for the hash links
-		//
-		m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
-		if (!m_pHashLinks)
-		{
-			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d hash link bytes!\n", m_nHashLinks );
-			goto NoMemory;
-		}
+		m_heap[ child ] = m_heap[ parent ];
+		child = parent;
+	}
+	m_heap[ child ] = Ref;
+}
 
-		// Read in the hash link information
-		//
-		length -= sizeof(short)*m_nHashLinks;
-		if (length < 0) goto ShortFile;
-		memcpy(m_pHashLinks, pMemFile, sizeof(short)*m_nHashLinks);
-		pMemFile += sizeof(short)*m_nHashLinks;
+//=========================================================
+// CPathSearch constructor
+//=========================================================
+CPathSearch :: CPathSearch( void )
+{
+	m_cMaxNodes = 0;
+	m_iGeneration = 0;
+	m_pGeneration = NULL;
+	m_pCost = NULL;
+	m_pPrevious = NULL;
+}
 
-		// Set the graph present flag, clear the pointers set flag
-		//
-		m_fGraphPresent = TRUE;
-		m_fGraphPointersSet = FALSE;
-		
-		FREE_FILE(aMemFile);
+CPathSearch :: ~CPathSearch( void )
+{
+	if ( m_pGeneration )
+		free ( m_pGeneration );
+	if ( m_pCost )
+		free ( m_pCost );
+	if ( m_pPrevious )
+		free ( m_pPrevious );
+}
 
-		if (length != 0)
-		{
-			ALERT ( at_aiconsole, "***WARNING***:Node graph was longer than expected by %d bytes.!\n", length);
-		}
+//=========================================================
+// Begin - starts a new search over cNodes nodes. Bumping
+// the generation marks every node unvisited at once.
+//=========================================================
+void CPathSearch :: Begin( int cNodes )
+{
+	if ( cNodes > m_cMaxNodes )
+	{
+		if ( m_pGeneration )
+			free ( m_pGeneration );
+		if ( m_pCost )
+			free ( m_pCost );
+		if ( m_pPrevious )
+			free ( m_pPrevious );
+
+		m_pGeneration = (unsigned int *)calloc ( sizeof ( unsigned int ), cNodes );
+		m_pCost = (float *)calloc ( sizeof ( float ), cNodes );
+		m_pPrevious = (int *)calloc ( sizeof ( int ), cNodes );
+		m_cMaxNodes = cNodes;
+		m_iGeneration = 0;
+	}
 
-		return TRUE;
+	if ( ++m_iGeneration == 0 )
+	{// wrapped, old marks could match again
+		memset ( m_pGeneration, 0, sizeof ( unsigned int ) * m_cMaxNodes );
+		m_iGeneration = 1;
 	}
 
-ShortFile:
-NoMemory:
-	FREE_FILE(aMemFile);
-	return FALSE;
+	m_queue.Clear();
 }
 
 //=========================================================
-// CGraph - FSaveGraph - It's not rocket science.
-// this WILL overwrite existing files.
+// CNodeTree constructor
 //=========================================================
-int CGraph :: FSaveGraph ( char *szMapName )
+CNodeTree :: CNodeTree( void )
 {
-	
-	int		iVersion = GRAPH_VERSION;
-	char	szFilename[MAX_PATH];
-	FILE	*file;
+	m_pTree = NULL;
+	Clear();
+}
 
-	if ( !m_fGraphPresent || !m_fGraphPointersSet )
-	{// protect us in the case that the node graph isn't available or built
-		ALERT ( at_aiconsole, "Graph not ready!\n" );
-		return FALSE;
+CNodeTree :: ~CNodeTree( void )
+{
+	if ( m_pTree )
+		free ( m_pTree );
+}
+
+//=========================================================
+// Clear - forgets the tree and everything in the cache
+//=========================================================
+void CNodeTree :: Clear( void )
+{
+	if ( m_pTree )
+	{
+		free ( m_pTree );
+		m_pTree = NULL;
 	}
 
-	// make sure directories have been made
-	GET_GAME_DIR( szFilename );
-	strcat( szFilename, "/maps" );
-	CreateDirectory( szFilename, NULL );
-	strcat( szFilename, "/graphs" );
-	CreateDirectory( szFilename, NULL );
+	m_pNodes = NULL;
+	m_cNodes = 0;
+	m_iRoot = -1;
+	m_queue.Clear();
 
-	strcat( szFilename, "/" );
-	strcat( szFilename, szMapName );
-	strcat( szFilename, ".nod" );
+	for ( int i = 0; i < NEAREST_CACHE_SIZE; i++ )
+	{
+		m_Cache[ i ].v = g_vecZero;
+		m_Cache[ i ].afNodeTypes = 0;
+		m_Cache[ i ].n = -1;
+	}
+}
 
-	file = fopen ( szFilename, "wb" );
+//=========================================================
+// Build - makes the tree over cNodes nodes. Tree nodes
+// stay in the same array; each range's median becomes the
+// root of its subtree.
+//=========================================================
+void CNodeTree :: Build( CNode *pNodes, int cNodes )
+{
+	Clear();
 
-	ALERT ( at_aiconsole, "Created: %s\n", szFilename );
+	if ( cNodes <= 0 )
+		return;
 
-	if ( !file )
-	{// couldn't create
-		ALERT ( at_aiconsole, "Couldn't Create: %s\n", szFilename );
-		return FALSE;
+	m_pTree = (struct tag_TREE_NODE *)calloc ( sizeof ( struct tag_TREE_NODE ), cNodes );
+	if ( !m_pTree )
+	{
+		ALERT ( at_aiconsole, "Couldn't malloc %d nearest node tree entries!\n", cNodes );
+		return;
 	}
-	else
+
+	m_pNodes = pNodes;
+	m_cNodes = cNodes;
+
+	for ( int i = 0; i < cNodes; i++ )
 	{
-	// write the version
-		fwrite ( &iVersion, sizeof ( int ), 1, file );
+		m_pTree[ i ].iNode = i;
+	}
 
-	// write the CGraph class
-		fwrite ( this, sizeof ( CGraph ), 1, file );
+	m_iRoot = BuildSubtree( 0, cNodes );
+}
 
-	// write the nodes
-		fwrite ( m_pNodes, sizeof ( CNode ), m_cNodes, file );
+int CNodeTree :: BuildSubtree( int iFirst, int cCount )
+{
+	int i;
 
-	// write the links
-		fwrite ( m_pLinkPool, sizeof ( CLink ), m_cLinks, file );
+	if ( cCount <= 0 )
+		return -1;
 
-		fwrite ( m_di, sizeof(DIST_INFO), m_cNodes, file );
+	// bounds and node types of the whole range
+	Vector vecMins = m_pNodes[ m_pTree[ iFirst ].iNode ].m_vecOriginPeek;
+	Vector vecMaxs = vecMins;
+	int afNodeTypes = 0;
 
-		// Write the route info.
-		//
-		if ( m_pRouteInfo && m_nRouteInfo )
-		{
-			fwrite ( m_pRouteInfo, sizeof( char ), m_nRouteInfo, file );
-		}
+	for ( i = iFirst; i < iFirst + cCount; i++ )
+	{
+		const Vector &vecPeek = m_pNodes[ m_pTree[ i ].iNode ].m_vecOriginPeek;
+
+		vecMins.x = min( vecMins.x, vecPeek.x );
+		vecMins.y = min( vecMins.y, vecPeek.y );
+		vecMins.z = min( vecMins.z, vecPeek.z );
+		vecMaxs.x = max( vecMaxs.x, vecPeek.x );
+		vecMaxs.y = max( vecMaxs.y, vecPeek.y );
+		vecMaxs.z = max( vecMaxs.z, vecPeek.z );
+		afNodeTypes |= m_pNodes[ m_pTree[ i ].iNode ].m_afNodeInfo;
+	}
 
-		if (m_pHashLinks && m_nHashLinks)
+	// split on the widest axis
+	Vector vecSize = vecMaxs - vecMins;
+	int iAxis = 0;
+	if ( vecSize.y > vecSize[ iAxis ] )
+		iAxis = 1;
+	if ( vecSize.z > vecSize[ iAxis ] )
+		iAxis = 2;
+
+	int iMid = iFirst + cCount / 2;
+	CNode *pNodes = m_pNodes;
+
+	std::nth_element( m_pTree + iFirst, m_pTree + iMid, m_pTree + iFirst + cCount,
+		[pNodes, iAxis]( const struct tag_TREE_NODE &a, const struct tag_TREE_NODE &b )
 		{
-			fwrite(m_pHashLinks, sizeof(short), m_nHashLinks, file);
-		}
-		fclose ( file );
-		return TRUE;
-	}
+			return pNodes[ a.iNode ].m_vecOriginPeek[ iAxis ] < pNodes[ b.iNode ].m_vecOriginPeek[ iAxis ];
+		} );
+
+	m_pTree[ iMid ].vecMins = vecMins;
+	m_pTree[ iMid ].vecMaxs = vecMaxs;
+	m_pTree[ iMid ].afNodeTypes = afNodeTypes;
+	m_pTree[ iMid ].iLeft = BuildSubtree( iFirst, iMid - iFirst );
+	m_pTree[ iMid ].iRight = BuildSubtree( iMid + 1, iFirst + cCount - iMid - 1 );
+
+	return iMid;
 }
 
 //=========================================================
-// CGraph - FSetGraphPointers - Takes the modelnames of 
-// all of the brush ents that block connections in the node
-// graph and resolves them into pointers to those entities.
-// this is done after loading the graph from disk, whereupon
-// the pointers are not valid.
+// BoxDistance - squared distance from the query point to
+// a subtree's bounds, nothing in the subtree is closer
 //=========================================================
-int CGraph :: FSetGraphPointers ( void )
+float CNodeTree :: BoxDistance( int iTreeNode )
 {
-	int	i;
-	edict_t	*pentLinkEnt;
-
-	for ( i = 0 ; i < m_cLinks ; i++ )
-	{// go through all of the links
-		
-		if ( m_pLinkPool[ i ].m_pLinkEnt != NULL )
-		{
-			char name[5];
-			// when graphs are saved, any valid pointers are will be non-zero, signifying that we should
-			// reset those pointers upon reloading. Any pointers that were NULL when the graph was saved
-			// will be NULL when reloaded, and will ignored by this function.
+	const struct tag_TREE_NODE &node = m_pTree[ iTreeNode ];
+	float flDist = 0;
 
-			// m_szLinkEntModelname is not necessarily NULL terminated (so we can store it in a more alignment-friendly 4 bytes)
-			memcpy( name, m_pLinkPool[ i ].m_szLinkEntModelname, 4 );
-			name[4] = 0;
-			pentLinkEnt =  FIND_ENTITY_BY_STRING( NULL, "model", name );
+	for ( int i = 0; i < 3; i++ )
+	{
+		float flDelta = 0;
 
-			if ( FNullEnt ( pentLinkEnt ) )
-			{
-			// the ent isn't around anymore? Either there is a major problem, or it was removed from the world
-			// ( like a func_breakable that's been destroyed or something ). Make sure that LinkEnt is null.
-				ALERT ( at_aiconsole, "**Could not find model %s\n", name );
-				m_pLinkPool[ i ].m_pLinkEnt = NULL;
-			}
-			else
-			{
-				m_pLinkPool[ i ].m_pLinkEnt = VARS( pentLinkEnt );
+		if ( m_vecQuery[ i ] < node.vecMins[ i ] )
+			flDelta = node.vecMins[ i ] - m_vecQuery[ i ];
+		else if ( m_vecQuery[ i ] > node.vecMaxs[ i ] )
+			flDelta = m_vecQuery[ i ] - node.vecMaxs[ i ];
 
-				if ( !FBitSet( m_pLinkPool[ i ].m_pLinkEnt->flags, FL_GRAPHED ) )
-				{
-					m_pLinkPool[ i ].m_pLinkEnt->flags += FL_GRAPHED;
-				}
-			}
-		}
+		flDist += flDelta * flDelta;
 	}
 
-	// the pointers are now set.
-	m_fGraphPointersSet = TRUE;
-	return TRUE;
+	return flDist;
 }
 
 //=========================================================
-// CGraph - CheckNODFile - this function checks the date of 
-// the BSP file that was just loaded and the date of the a
-// ssociated .NOD file. If the NOD file is not present, or 
-// is older than the BSP file, we rebuild it.
-//
-// returns FALSE if the .NOD file doesn't qualify and needs
-// to be rebuilt.
-//
-// !!!BUGBUG - the file times we get back are 20 hours ahead!
-// since this happens consistantly, we can still correctly 
-// determine which of the 2 files is newer. This needs fixed,
-// though. ( I now suspect that we are getting GMT back from
-// these functions and must compensate for local time ) (sjb)
+// BeginQuery - starts handing out nodes of afNodeTypes
+// nearest vecOrigin
 //=========================================================
-int CGraph :: CheckNODFile ( char *szMapName )
+void CNodeTree :: BeginQuery( const Vector &vecOrigin, int afNodeTypes )
 {
-	int 		retValue;
-
-	char		szBspFilename[MAX_PATH];
-	char		szGraphFilename[MAX_PATH];
-	
+	m_queue.Clear();
+	m_vecQuery = vecOrigin;
+	m_afQueryTypes = afNodeTypes;
 
-	strcpy ( szBspFilename, "maps/" );
-	strcat ( szBspFilename, szMapName );
-	strcat ( szBspFilename, ".bsp" );
+	if ( m_iRoot != -1 && ( m_pTree[ m_iRoot ].afNodeTypes & afNodeTypes ) )
+	{
+		m_queue.Insert( -( m_iRoot + 1 ), BoxDistance( m_iRoot ) );
+	}
+}
 
-	strcpy ( szGraphFilename, "maps/graphs/" );
-	strcat ( szGraphFilename, szMapName );
-	strcat ( szGraphFilename, ".nod" );
-	
-	retValue = TRUE;
+//=========================================================
+// NextNode - opens subtrees until a graph node comes off
+// the front of the queue. Everything still queued is at
+// least that far away, so nodes come out nearest first.
+//=========================================================
+int CNodeTree :: NextNode( void )
+{
+	float flDist;
 
-	int iCompare;
-	if (COMPARE_FILE_TIME(szBspFilename, szGraphFilename, &iCompare))
+	while ( !m_queue.Empty() )
 	{
-		if ( iCompare > 0 )
-		{// BSP file is newer.
-			ALERT ( at_aiconsole, ".NOD File will be updated\n\n" );
-			retValue = FALSE;
+		int iId = m_queue.Remove( flDist );
+
+		if ( iId >= 0 )
+		{
+			return iId;
+		}
+
+		const struct tag_TREE_NODE &node = m_pTree[ -iId - 1 ];
+
+		if ( m_pNodes[ node.iNode ].m_afNodeInfo & m_afQueryTypes )
+		{
+			Vector vecDelta = m_vecQuery - m_pNodes[ node.iNode ].m_vecOriginPeek;
+			m_queue.Insert( node.iNode, DotProduct( vecDelta, vecDelta ) );
+		}
+		if ( node.iLeft != -1 && ( m_pTree[ node.iLeft ].afNodeTypes & m_afQueryTypes ) )
+		{
+			m_queue.Insert( -( node.iLeft + 1 ), BoxDistance( node.iLeft ) );
+		}
+		if ( node.iRight != -1 && ( m_pTree[ node.iRight ].afNodeTypes & m_afQueryTypes ) )
+		{
+			m_queue.Insert( -( node.iRight + 1 ), BoxDistance( node.iRight ) );
 		}
-	}
-	else
-	{
-		retValue = FALSE;
 	}
 
-	return retValue;
+	return -1;
 }
 
-#define ENTRY_STATE_EMPTY -1
-
-struct tagNodePair
+//=========================================================
+// CacheLookup/CacheStore - nearest node answers, keyed by
+// the point and the node types asked for. Monsters that
+// move on different node types standing at the same spot
+// don't knock each other out of the cache.
+//=========================================================
+inline int NearestCacheSlot( const Vector &vecOrigin, int afNodeTypes )
 {
-	short iSrc;
-	short iDest;
-};
-
-void CGraph::HashInsert(int iSrcNode, int iDestNode, int iKey)
-{
-	struct tagNodePair np;
-
-	np.iSrc  = iSrcNode;
-	np.iDest = iDestNode;
-	CRC32_t dwHash;
-	CRC32_INIT(&dwHash);
-	CRC32_PROCESS_BUFFER(&dwHash, &np, sizeof(np));
-	dwHash = CRC32_FINAL(dwHash);
+	float key[4] = { vecOrigin.x, vecOrigin.y, vecOrigin.z, (float)afNodeTypes };
 
-    int di = m_HashPrimes[dwHash&15];
-    int i = (dwHash >> 4) % m_nHashLinks;
-    while (m_pHashLinks[i] != ENTRY_STATE_EMPTY)
-    {
-        i += di;
-        if (i >= m_nHashLinks) i -= m_nHashLinks;
-    }
-	m_pHashLinks[i] = iKey;
+	return (NEAREST_CACHE_SIZE-1) & Hash( (void *)key, sizeof(key) );
 }
 
-void CGraph::HashSearch(int iSrcNode, int iDestNode, int &iKey)
+int CNodeTree :: CacheLookup( const Vector &vecOrigin, int afNodeTypes, int &iNode )
 {
-	struct tagNodePair np;
+	int iSlot = NearestCacheSlot( vecOrigin, afNodeTypes );
 
-	np.iSrc  = iSrcNode;
-	np.iDest = iDestNode;
-	CRC32_t dwHash;
-	CRC32_INIT(&dwHash);
-	CRC32_PROCESS_BUFFER(&dwHash, &np, sizeof(np));
-	dwHash = CRC32_FINAL(dwHash);
-
-    int di = m_HashPrimes[dwHash&15];
-    int i = (dwHash >> 4) % m_nHashLinks;
-    while (m_pHashLinks[i] != ENTRY_STATE_EMPTY)
-    {
-		CLink &link = Link(m_pHashLinks[i]);
-        if (iSrcNode == link.m_iSrcNode && iDestNode == link.m_iDestNode)
-        {
-			break;
-        }
-        else
-        {
-            i += di;
-            if (i >= m_nHashLinks) i -= m_nHashLinks;
-        }
-    }
-	iKey = m_pHashLinks[i];
+	if ( m_Cache[ iSlot ].v == vecOrigin && m_Cache[ iSlot ].afNodeTypes == afNodeTypes )
+	{
+		iNode = m_Cache[ iSlot ].n;
+		return TRUE;
+	}
+	return FALSE;
 }
 
-#define NUMBER_OF_PRIMES 177
+void CNodeTree :: CacheStore( const Vector &vecOrigin, int afNodeTypes, int iNode )
+{
+	int iSlot = NearestCacheSlot( vecOrigin, afNodeTypes );
 
-int Primes[NUMBER_OF_PRIMES] =
-{ 1, 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
-71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151,
-157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239,
-241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337,
-347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433,
-439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541,
-547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607, 613, 617, 619, 631, 641,
-643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709, 719, 727, 733, 739, 743,
-751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827, 829, 839, 853, 857,
-859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941, 947, 953, 967, 971,
-977, 983, 991, 997, 1009, 1013, 1019, 1021, 1031, 1033, 1039, 0 };
+	m_Cache[ iSlot ].v = vecOrigin;
+	m_Cache[ iSlot ].afNodeTypes = afNodeTypes;
+	m_Cache[ iSlot ].n = iNode;
+}
 
-void CGraph::HashChoosePrimes(int TableSize)
+//=========================================================
+// CGraph - NearestNodeBenchmark - times cQueries nearest
+// node lookups at random spots around the graph, against
+// checking every node, and prints the results to the
+// player's console.
+//=========================================================
+void CGraph :: NearestNodeBenchmark( edict_t *pentPlayer, int cQueries )
 {
-    int LargestPrime = TableSize/2;
-    if (LargestPrime > Primes[NUMBER_OF_PRIMES-2])
-    {
-        LargestPrime = Primes[NUMBER_OF_PRIMES-2];
-    }
-    int Spacing = LargestPrime/16;
+	int i, j;
 
-    // Pick a set primes that are evenly spaced from (0 to LargestPrime)
-    // We divide this interval into 16 equal sized zones. We want to find
-    // one prime number that best represents that zone.
-    //
-	int iPrime;
-    for (int iZone = 1, iPrime = 0; iPrime < 16; iZone += Spacing)
-    {
-        // Search for a prime number that is less than the target zone
-        // number given by iZone.
-        //
-        int Lower = Primes[0];
-        for (int jPrime = 0; Primes[jPrime] != 0; jPrime++)
-        {
-            if (jPrime != 0 && TableSize % Primes[jPrime] == 0) continue;
-            int Upper = Primes[jPrime];
-            if (Lower <= iZone && iZone <= Upper)
-            {
-                // Choose the closest lower prime number.
-                //
-                if (iZone - Lower <= Upper - iZone)
-                {
-                    m_HashPrimes[iPrime++] = Lower;
-                }
-                else
-                {
-                    m_HashPrimes[iPrime++] = Upper;
-                }
-                break;
-            }
-            Lower = Upper;
-        }
-    }
+	if ( !m_fGraphPresent || !m_fGraphPointersSet || !g_NodeTree.Count() )
+	{
+		CLIENT_PRINTF( pentPlayer, print_console, "Graph not ready!\n" );
+		return;
+	}
 
-    // Alternate negative and positive numbers
-    //
-    for (iPrime = 0; iPrime < 16; iPrime += 2)
-    {
-        m_HashPrimes[iPrime] = TableSize-m_HashPrimes[iPrime];
-    }
+	cQueries = max( cQueries, 1 );
 
-    // Shuffle the set of primes to reduce correlation with bits in
-    // hash key.
-    //
-    for (iPrime = 0; iPrime < 16-1; iPrime++)
-    {
-        int Pick = RANDOM_LONG(0, 15-iPrime);
-        int Temp = m_HashPrimes[Pick];
-        m_HashPrimes[Pick] = m_HashPrimes[15-iPrime];
-        m_HashPrimes[15-iPrime] = Temp;
-    }
-}
+	// somewhere near a random node, asking for that node's type
+	std::vector<Vector> points( cQueries );
+	std::vector<int> types( cQueries );
+	std::vector<int> answers( cQueries );
 
-// Renumber nodes so that nodes that link together are together.
-//
-#define UNNUMBERED_NODE -1
-void CGraph::SortNodes(void)
-{
-	// We are using m_iPreviousNode to be the new node number.
-	// After assigning new node numbers to everything, we move
-	// things and patchup the links.
-	//
-	int iNodeCnt = 0;
-	m_pNodes[0].m_iPreviousNode = iNodeCnt++;
-	int i;
-	for ( i = 1; i < m_cNodes; i++)
+	for ( i = 0; i < cQueries; i++ )
 	{
-		m_pNodes[i].m_iPreviousNode = UNNUMBERED_NODE;
+		CNode &node = m_pNodes[ RANDOM_LONG( 0, m_cNodes - 1 ) ];
+
+		points[ i ] = node.m_vecOriginPeek + Vector( RANDOM_FLOAT( -256, 256 ), RANDOM_FLOAT( -256, 256 ), RANDOM_FLOAT( -32, 32 ) );
+		types[ i ] = node.m_afNodeInfo & bits_NODE_GROUP_REALM;
 	}
 
-	for (i = 0; i < m_cNodes; i++)
+	// tree, no cache
+	int cTraces = g_cNearestTraces;
+	auto start = std::chrono::steady_clock::now();
+	for ( i = 0; i < cQueries; i++ )
 	{
-		// Run through all of this node's neighbors
-		//
-		for (int j = 0 ; j < m_pNodes[i].m_cNumLinks; j++ )
+		answers[ i ] = NearestVisibleNode( points[ i ], types[ i ] );
+	}
+	double flTree = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	cTraces = g_cNearestTraces - cTraces;
+
+	// every node, tracing to anything closer than the best so far
+	int cBruteTraces = 0;
+	int cWrong = 0;
+	start = std::chrono::steady_clock::now();
+	for ( i = 0; i < cQueries; i++ )
+	{
+		int iNearest = -1;
+		float flShortest = 999999.0;
+
+		for ( j = 0; j < m_cNodes; j++ )
 		{
-			int iDestNode = INodeLink(i, j);
-			if (m_pNodes[iDestNode].m_iPreviousNode == UNNUMBERED_NODE)
+			if ( !( m_pNodes[ j ].m_afNodeInfo & types[ i ] ) )
+				continue;
+
+			float flDist = ( points[ i ] - m_pNodes[ j ].m_vecOriginPeek ).Length();
+			if ( flDist < flShortest )
 			{
-				m_pNodes[iDestNode].m_iPreviousNode = iNodeCnt++;
+				TraceResult tr;
+
+				cBruteTraces++;
+				UTIL_TraceLine ( points[ i ], m_pNodes[ j ].m_vecOriginPeek, ignore_monsters, 0, &tr );
+				if ( tr.flFraction == 1.0 )
+				{
+					iNearest = j;
+					flShortest = flDist;
+				}
 			}
 		}
-	}
 
-	// Assign remaining node numbers to unlinked nodes.
-	//
-	for (i = 0; i < m_cNodes; i++)
-	{
-		if (m_pNodes[i].m_iPreviousNode == UNNUMBERED_NODE)
+		// ties can go either way
+		if ( iNearest != answers[ i ] && ( iNearest == -1 || answers[ i ] == -1 ||
+			( points[ i ] - m_pNodes[ answers[ i ] ].m_vecOriginPeek ).Length() != flShortest ) )
 		{
-			m_pNodes[i].m_iPreviousNode = iNodeCnt++;
+			cWrong++;
 		}
 	}
+	double flBrute = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
 
-	// Alter links to reflect new node numbers.
-	//
-	for (i = 0; i < m_cLinks; i++)
+	// the same spots again through FindNearestNode, once to fill the cache and once to hit it
+	for ( i = 0; i < cQueries; i++ )
 	{
-		m_pLinkPool[i].m_iSrcNode  = m_pNodes[m_pLinkPool[i].m_iSrcNode].m_iPreviousNode;
-		m_pLinkPool[i].m_iDestNode = m_pNodes[m_pLinkPool[i].m_iDestNode].m_iPreviousNode;
+		FindNearestNode( points[ i ], types[ i ] );
 	}
-
-	// Rearrange nodes to reflect new node numbering.
-	//
-	for (i = 0; i < m_cNodes; i++)
+	int cCacheTraces = g_cNearestTraces;
+	start = std::chrono::steady_clock::now();
+	for ( i = 0; i < cQueries; i++ )
 	{
-		while (m_pNodes[i].m_iPreviousNode != i)
-		{
-			// Move current node off to where it should be, and bring
-			// that other node back into the current slot.
-			//
-			int iDestNode = m_pNodes[i].m_iPreviousNode;
-			CNode TempNode = m_pNodes[iDestNode];
-			m_pNodes[iDestNode] = m_pNodes[i];
-			m_pNodes[i] = TempNode;
-		}
+		FindNearestNode( points[ i ], types[ i ] );
 	}
+	double flCached = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+	cCacheTraces = g_cNearestTraces - cCacheTraces;
+
+	CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "%d queries over %d nodes\n", cQueries, m_cNodes ) );
+	CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "tree:    %8.3f ms, %6.2f traces/query\n", flTree * 1000, (float)cTraces / cQueries ) );
+	CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "linear:  %8.3f ms, %6.2f traces/query, %d different\n", flBrute * 1000, (float)cBruteTraces / cQueries, cWrong ) );
+	CLIENT_PRINTF( pentPlayer, print_console, UTIL_VarArgs( "cached:  %8.3f ms, %6.2f traces/query\n", flCached * 1000, (float)cCacheTraces / cQueries ) );
 }
 
-void CGraph::BuildLinkLookups(void)
+//=========================================================
+// CGraph - FLoadGraph - attempts to load a node graph from disk.
+// if the current level is maps/snar.bsp, maps/graphs/snar.nod
+// will be loaded. If file cannot be loaded, the node tree
+// will be created and saved to disk.
+//=========================================================
+int CGraph :: FLoadGraph ( char *szMapName )
 {
-	m_nHashLinks = 3*m_cLinks/2 + 3;
+	char	szFilename[MAX_PATH];
+	int		iVersion;
+	int     length;
+	byte    *aMemFile;
+	byte    *pMemFile;
 
-	HashChoosePrimes(m_nHashLinks);
-	m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
-	if (!m_pHashLinks)
-	{
-		ALERT(at_aiconsole, "Couldn't allocated Link Lookup Table.\n");
-		return;
-	}
-	int i;
-	for ( i = 0; i < m_nHashLinks; i++)
-	{
-		m_pHashLinks[i] = ENTRY_STATE_EMPTY;
-	}
+	// make sure the directories have been made
+	char	szDirName[MAX_PATH];
+	GET_GAME_DIR( szDirName );
+	strcat( szDirName, "/maps" );
+	CreateDirectory( szDirName, NULL );
+	strcat( szDirName, "/graphs" );
+	CreateDirectory( szDirName, NULL );
 
-	for (i = 0; i < m_cLinks; i++)
+	strcpy ( szFilename, "maps/graphs/" );
+	strcat ( szFilename, szMapName );
+	strcat( szFilename, ".nod" );
+
+	pMemFile = aMemFile = LOAD_FILE_FOR_ME(szFilename, &length);
+
+	if ( !aMemFile )
 	{
-		CLink &link = Link(i);
-		HashInsert(link.m_iSrcNode, link.m_iDestNode, i);
+		return FALSE;
 	}
-#if 0
-	for (i = 0; i < m_cLinks; i++)
+	else
 	{
-		CLink &link = Link(i);
-		int iKey;
-		HashSearch(link.m_iSrcNode, link.m_iDestNode, iKey);
-		if (iKey != i)
+		// Read the graph version number
+		//
+		length -= sizeof(int);
+		if (length < 0) goto ShortFile;
+		memcpy(&iVersion, pMemFile, sizeof(int));
+		pMemFile += sizeof(int);
+
+		if ( iVersion != GRAPH_VERSION )
 		{
-			ALERT(at_aiconsole, "HashLinks don't match (%d versus %d)\n", i, iKey);
+			// This file was written by a different build of the dll!
+			//
+			ALERT ( at_aiconsole, "**ERROR** Graph version is %d, expected %d\n",iVersion, GRAPH_VERSION );
+			goto ShortFile;
 		}
-	}
-#endif
-}
-
-void CGraph::BuildRegionTables(void)
-{
-	if (m_di) free(m_di);
 
-	// Go ahead and setup for range searching the nodes for FindNearestNodes
+		// Read the graph class
+		//
+		length -= sizeof(CGraph);
+		if (length < 0) goto ShortFile;
+		memcpy(this, pMemFile, sizeof(CGraph));
+		pMemFile += sizeof(CGraph);
+
+		// Set the pointers to zero, just in case we run out of memory.
+		//
+		m_pNodes     = NULL;
+		m_pLinkPool  = NULL;
+		m_di         = NULL;
+		m_pRouteInfo = NULL;
+		m_pHashLinks = NULL;
+		m_pVisBits   = NULL;
+
+
+		// Malloc for the nodes
+		//
+		m_pNodes = ( CNode * )calloc ( sizeof ( CNode ), m_cNodes );
+
+		if ( !m_pNodes )
+		{
+			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d nodes!\n", m_cNodes );
+			goto NoMemory;
+		}
+
+		// Read in all the nodes
+		//
+		length -= sizeof(CNode) * m_cNodes;
+		if (length < 0) goto ShortFile;
+		memcpy(m_pNodes, pMemFile, sizeof(CNode)*m_cNodes);
+		pMemFile += sizeof(CNode) * m_cNodes;
+
+		
+		// Malloc for the link pool
+		//
+		m_pLinkPool = ( CLink * )calloc ( sizeof ( CLink ), m_cLinks );
+
+		if ( !m_pLinkPool )
+		{
+			ALERT ( at_aiconsole, "**ERROR**\nCouldn't malloc %d link!\n", m_cLinks );
+			goto NoMemory;
+		}
+
+		// Read in all the links
+		//
+		length -= sizeof(CLink)*m_cLinks;
+		if (length < 0) goto ShortFile;
+		memcpy(m_pLinkPool, pMemFile, sizeof(CLink)*m_cLinks);
+		pMemFile += sizeof(CLink)*m_cLinks;
+
+		// Malloc for the sorting info.
+		//
+		m_di = (DIST_INFO *)calloc( sizeof(DIST_INFO), m_cNodes );
+		if ( !m_di )
+		{
+			ALERT ( at_aiconsole, "***ERROR**\nCouldn't malloc %d entries sorting nodes!\n", m_cNodes );
+			goto NoMemory;
+		}
+
+		// Read it in.
+		//
+		length -= sizeof(DIST_INFO)*m_cNodes;
+		if (length < 0) goto ShortFile;
+		memcpy(m_di, pMemFile, sizeof(DIST_INFO)*m_cNodes);
+		pMemFile += sizeof(DIST_INFO)*m_cNodes;
+
+		// Malloc for the routing info.
+		//
+		m_fRoutingComplete = FALSE;
+		m_pRouteInfo = (char *)calloc( sizeof(char), m_nRouteInfo );
+		if ( !m_pRouteInfo )
+		{
+			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d route bytes!\n", m_nRouteInfo );
+			goto NoMemory;
+		}
+		m_CheckedCounter = 0;
+		for (int i = 0; i < m_cNodes; i++)
+		{
+			m_di[i].m_CheckedEvent = 0;
+		}
+		
+		// Read in the route information.
+		//
+		length -= sizeof(char)*m_nRouteInfo;
+		if (length < 0) goto ShortFile;
+		memcpy(m_pRouteInfo, pMemFile, sizeof(char)*m_nRouteInfo);
+		pMemFile += sizeof(char)*m_nRouteInfo;
+		m_fRoutingComplete = TRUE;;
+
+		// malloc for the hash links
+		//
+		m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
+		if (!m_pHashLinks)
+		{
+			ALERT ( at_aiconsole, "***ERROR**\nCounldn't malloc %d hash link bytes!\n", m_nHashLinks );
+			goto NoMemory;
+		}
+
+		// Read in the hash link information
+		//
+		length -= sizeof(short)*m_nHashLinks;
+		if (length < 0) goto ShortFile;
+		memcpy(m_pHashLinks, pMemFile, sizeof(short)*m_nHashLinks);
+		pMemFile += sizeof(short)*m_nHashLinks;
+
+		// malloc for the node visibility
+		//
+		if ( m_nVisBits != VisRowSize() * m_cNodes )
+		{
+			ALERT ( at_aiconsole, "**ERROR** Graph has %d visibility ints, expected %d\n", m_nVisBits, VisRowSize() * m_cNodes );
+			goto ShortFile;
+		}
+
+		m_pVisBits = (unsigned int *)calloc(sizeof(unsigned int), max( m_nVisBits, 1 ));
+		if (!m_pVisBits)
+		{
+			ALERT ( at_aiconsole, "***ERROR**\nCouldn't malloc %d node visibility ints!\n", m_nVisBits );
+			goto NoMemory;
+		}
+
+		// Read in the node visibility
+		//
+		length -= sizeof(unsigned int)*m_nVisBits;
+		if (length < 0) goto ShortFile;
+		memcpy(m_pVisBits, pMemFile, sizeof(unsigned int)*m_nVisBits);
+		pMemFile += sizeof(unsigned int)*m_nVisBits;
+
+		// Set the graph present flag, clear the pointers set flag
+		//
+		m_fGraphPresent = TRUE;
+		m_fGraphPointersSet = FALSE;
+		
+		FREE_FILE(aMemFile);
+
+		if (length != 0)
+		{
+			ALERT ( at_aiconsole, "***WARNING***:Node graph was longer than expected by %d bytes.!\n", length);
+		}
+
+		return TRUE;
+	}
+
+ShortFile:
+NoMemory:
+	FREE_FILE(aMemFile);
+	return FALSE;
+}
+
+//=========================================================
+// CGraph - FSaveGraph - It's not rocket science.
+// this WILL overwrite existing files.
+//=========================================================
+int CGraph :: FSaveGraph ( char *szMapName )
+{
+	
+	int		iVersion = GRAPH_VERSION;
+	char	szFilename[MAX_PATH];
+	FILE	*file;
+
+	if ( !m_fGraphPresent || !m_fGraphPointersSet )
+	{// protect us in the case that the node graph isn't available or built
+		ALERT ( at_aiconsole, "Graph not ready!\n" );
+		return FALSE;
+	}
+
+	// make sure directories have been made
+	GET_GAME_DIR( szFilename );
+	strcat( szFilename, "/maps" );
+	CreateDirectory( szFilename, NULL );
+	strcat( szFilename, "/graphs" );
+	CreateDirectory( szFilename, NULL );
+
+	strcat( szFilename, "/" );
+	strcat( szFilename, szMapName );
+	strcat( szFilename, ".nod" );
+
+	file = fopen ( szFilename, "wb" );
+
+	ALERT ( at_aiconsole, "Created: %s\n", szFilename );
+
+	if ( !file )
+	{// couldn't create
+		ALERT ( at_aiconsole, "Couldn't Create: %s\n", szFilename );
+		return FALSE;
+	}
+	else
+	{
+	// write the version
+		fwrite ( &iVersion, sizeof ( int ), 1, file );
+
+	// write the CGraph class
+		fwrite ( this, sizeof ( CGraph ), 1, file );
+
+	// write the nodes
+		fwrite ( m_pNodes, sizeof ( CNode ), m_cNodes, file );
+
+	// write the links
+		fwrite ( m_pLinkPool, sizeof ( CLink ), m_cLinks, file );
+
+		fwrite ( m_di, sizeof(DIST_INFO), m_cNodes, file );
+
+		// Write the route info.
+		//
+		if ( m_pRouteInfo && m_nRouteInfo )
+		{
+			fwrite ( m_pRouteInfo, sizeof( char ), m_nRouteInfo, file );
+		}
+
+		if (m_pHashLinks && m_nHashLinks)
+		{
+			fwrite(m_pHashLinks, sizeof(short), m_nHashLinks, file);
+		}
+
+		if ( m_pVisBits && m_nVisBits )
+		{
+			fwrite ( m_pVisBits, sizeof( unsigned int ), m_nVisBits, file );
+		}
+		fclose ( file );
+		return TRUE;
+	}
+}
+
+//=========================================================
+// CGraph - FSetGraphPointers - Takes the modelnames of 
+// all of the brush ents that block connections in the node
+// graph and resolves them into pointers to those entities.
+// this is done after loading the graph from disk, whereupon
+// the pointers are not valid.
+//=========================================================
+int CGraph :: FSetGraphPointers ( void )
+{
+	int	i;
+	edict_t	*pentLinkEnt;
+
+	for ( i = 0 ; i < m_cLinks ; i++ )
+	{// go through all of the links
+		
+		if ( m_pLinkPool[ i ].m_pLinkEnt != NULL )
+		{
+			char name[5];
+			// when graphs are saved, any valid pointers are will be non-zero, signifying that we should
+			// reset those pointers upon reloading. Any pointers that were NULL when the graph was saved
+			// will be NULL when reloaded, and will ignored by this function.
+
+			// m_szLinkEntModelname is not necessarily NULL terminated (so we can store it in a more alignment-friendly 4 bytes)
+			memcpy( name, m_pLinkPool[ i ].m_szLinkEntModelname, 4 );
+			name[4] = 0;
+			pentLinkEnt =  FIND_ENTITY_BY_STRING( NULL, "model", name );
+
+			if ( FNullEnt ( pentLinkEnt ) )
+			{
+			// the ent isn't around anymore? Either there is a major problem, or it was removed from the world
+			// ( like a func_breakable that's been destroyed or something ). Make sure that LinkEnt is null.
+				ALERT ( at_aiconsole, "**Could not find model %s\n", name );
+				m_pLinkPool[ i ].m_pLinkEnt = NULL;
+			}
+			else
+			{
+				m_pLinkPool[ i ].m_pLinkEnt = VARS( pentLinkEnt );
+
+				if ( !FBitSet( m_pLinkPool[ i ].m_pLinkEnt->flags, FL_GRAPHED ) )
+				{
+					m_pLinkPool[ i ].m_pLinkEnt->flags += FL_GRAPHED;
+				}
+			}
+		}
+	}
+
+	// the pointers are now set.
+	m_fGraphPointersSet = TRUE;
+
+	g_NodeTree.Build( m_pNodes, m_cNodes );
+	g_NodeClusters.Build( this );
+	return TRUE;
+}
+
+//=========================================================
+// CGraph - CheckNODFile - this function checks the date of 
+// the BSP file that was just loaded and the date of the a
+// ssociated .NOD file. If the NOD file is not present, or 
+// is older than the BSP file, we rebuild it.
+//
+// returns FALSE if the .NOD file doesn't qualify and needs
+// to be rebuilt.
+//
+// !!!BUGBUG - the file times we get back are 20 hours ahead!
+// since this happens consistantly, we can still correctly 
+// determine which of the 2 files is newer. This needs fixed,
+// though. ( I now suspect that we are getting GMT back from
+// these functions and must compensate for local time ) (sjb)
+//=========================================================
+int CGraph :: CheckNODFile ( char *szMapName )
+{
+	int 		retValue;
+
+	char		szBspFilename[MAX_PATH];
+	char		szGraphFilename[MAX_PATH];
+	
+
+	strcpy ( szBspFilename, "maps/" );
+	strcat ( szBspFilename, szMapName );
+	strcat ( szBspFilename, ".bsp" );
+
+	strcpy ( szGraphFilename, "maps/graphs/" );
+	strcat ( szGraphFilename, szMapName );
+	strcat ( szGraphFilename, ".nod" );
+	
+	retValue = TRUE;
+
+	int iCompare;
+	if (COMPARE_FILE_TIME(szBspFilename, szGraphFilename, &iCompare))
+	{
+		if ( iCompare > 0 )
+		{// BSP file is newer.
+			ALERT ( at_aiconsole, ".NOD File will be updated\n\n" );
+			retValue = FALSE;
+		}
+	}
+	else
+	{
+		retValue = FALSE;
+	}
+
+	return retValue;
+}
+
+#define ENTRY_STATE_EMPTY -1
+
+struct tagNodePair
+{
+	short iSrc;
+	short iDest;
+};
+
+void CGraph::HashInsert(int iSrcNode, int iDestNode, int iKey)
+{
+	struct tagNodePair np;
+
+	np.iSrc  = iSrcNode;
+	np.iDest = iDestNode;
+	CRC32_t dwHash;
+	CRC32_INIT(&dwHash);
+	CRC32_PROCESS_BUFFER(&dwHash, &np, sizeof(np));
+	dwHash = CRC32_FINAL(dwHash);
+
+    int di = m_HashPrimes[dwHash&15];
+    int i = (dwHash >> 4) % m_nHashLinks;
+    while (m_pHashLinks[i] != ENTRY_STATE_EMPTY)
+    {
+        i += di;
+        if (i >= m_nHashLinks) i -= m_nHashLinks;
+    }
+	m_pHashLinks[i] = iKey;
+}
+
+void CGraph::HashSearch(int iSrcNode, int iDestNode, int &iKey)
+{
+	struct tagNodePair np;
+
+	np.iSrc  = iSrcNode;
+	np.iDest = iDestNode;
+	CRC32_t dwHash;
+	CRC32_INIT(&dwHash);
+	CRC32_PROCESS_BUFFER(&dwHash, &np, sizeof(np));
+	dwHash = CRC32_FINAL(dwHash);
+
+    int di = m_HashPrimes[dwHash&15];
+    int i = (dwHash >> 4) % m_nHashLinks;
+    while (m_pHashLinks[i] != ENTRY_STATE_EMPTY)
+    {
+		CLink &link = Link(m_pHashLinks[i]);
+        if (iSrcNode == link.m_iSrcNode && iDestNode == link.m_iDestNode)
+        {
+			break;
+        }
+        else
+        {
+            i += di;
+            if (i >= m_nHashLinks) i -= m_nHashLinks;
+        }
+    }
+	iKey = m_pHashLinks[i];
+}
+
+#define NUMBER_OF_PRIMES 177
+
+int Primes[NUMBER_OF_PRIMES] =
+{ 1, 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151,
+157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239,
+241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337,
+347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433,
+439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541,
+547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607, 613, 617, 619, 631, 641,
+643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709, 719, 727, 733, 739, 743,
+751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827, 829, 839, 853, 857,
+859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941, 947, 953, 967, 971,
+977, 983, 991, 997, 1009, 1013, 1019, 1021, 1031, 1033, 1039, 0 };
+
+void CGraph::HashChoosePrimes(int TableSize)
+{
+    int LargestPrime = TableSize/2;
+    if (LargestPrime > Primes[NUMBER_OF_PRIMES-2])
+    {
+        LargestPrime = Primes[NUMBER_OF_PRIMES-2];
+    }
+    int Spacing = LargestPrime/16;
+
+    // Pick a set primes that are evenly spaced from (0 to LargestPrime)
+    // We divide this interval into 16 equal sized zones. We want to find
+    // one prime number that best represents that zone.
+    //
+	int iPrime;
+    for (int iZone = 1, iPrime = 0; iPrime < 16; iZone += Spacing)
+    {
+        // Search for a prime number that is less than the target zone
+        // number given by iZone.
+        //
+        int Lower = Primes[0];
+        for (int jPrime = 0; Primes[jPrime] != 0; jPrime++)
+        {
+            if (jPrime != 0 && TableSize % Primes[jPrime] == 0) continue;
+            int Upper = Primes[jPrime];
+            if (Lower <= iZone && iZone <= Upper)
+            {
+                // Choose the closest lower prime number.
+                //
+                if (iZone - Lower <= Upper - iZone)
+                {
+                    m_HashPrimes[iPrime++] = Lower;
+                }
+                else
+                {
+                    m_HashPrimes[iPrime++] = Upper;
+                }
+                break;
+            }
+            Lower = Upper;
+        }
+    }
+
+    // Alternate negative and positive numbers
+    //
+    for (iPrime = 0; iPrime < 16; iPrime += 2)
+    {
+        m_HashPrimes[iPrime] = TableSize-m_HashPrimes[iPrime];
+    }
+
+    // Shuffle the set of primes to reduce correlation with bits in
+    // hash key.
+    //
+    for (iPrime = 0; iPrime < 16-1; iPrime++)
+    {
+        int Pick = RANDOM_LONG(0, 15-iPrime);
+        int Temp = m_HashPrimes[Pick];
+        m_HashPrimes[Pick] = m_HashPrimes[15-iPrime];
+        m_HashPrimes[15-iPrime] = Temp;
+    }
+}
+
+// Renumber nodes so that nodes that link together are together.
+//
+#define UNNUMBERED_NODE -1
+void CGraph::SortNodes(void)
+{
+	// We are using m_iPreviousNode to be the new node number.
+	// After assigning new node numbers to everything, we move
+	// things and patchup the links.
+	//
+	int iNodeCnt = 0;
+	m_pNodes[0].m_iPreviousNode = iNodeCnt++;
+	int i;
+	for ( i = 1; i < m_cNodes; i++)
+	{
+		m_pNodes[i].m_iPreviousNode = UNNUMBERED_NODE;
+	}
+
+	for (i = 0; i < m_cNodes; i++)
+	{
+		// Run through all of this node's neighbors
+		//
+		for (int j = 0 ; j < m_pNodes[i].m_cNumLinks; j++ )
+		{
+			int iDestNode = INodeLink(i, j);
+			if (m_pNodes[iDestNode].m_iPreviousNode == UNNUMBERED_NODE)
+			{
+				m_pNodes[iDestNode].m_iPreviousNode = iNodeCnt++;
+			}
+		}
+	}
+
+	// Assign remaining node numbers to unlinked nodes.
+	//
+	for (i = 0; i < m_cNodes; i++)
+	{
+		if (m_pNodes[i].m_iPreviousNode == UNNUMBERED_NODE)
+		{
+			m_pNodes[i].m_iPreviousNode = iNodeCnt++;
+		}
+	}
+
+	// Alter links to reflect new node numbers.
+	//
+	for (i = 0; i < m_cLinks; i++)
+	{
+		m_pLinkPool[i].m_iSrcNode  = m_pNodes[m_pLinkPool[i].m_iSrcNode].m_iPreviousNode;
+		m_pLinkPool[i].m_iDestNode = m_pNodes[m_pLinkPool[i].m_iDestNode].m_iPreviousNode;
+	}
+
+	// Rearrange nodes to reflect new node numbering.
+	//
+	for (i = 0; i < m_cNodes; i++)
+	{
+		while (m_pNodes[i].m_iPreviousNode != i)
+		{
+			// Move current node off to where it should be, and bring
+			// that other node back into the current slot.
+			//
+			int iDestNode = m_pNodes[i].m_iPreviousNode;
+			CNode TempNode = m_pNodes[iDestNode];
+			m_pNodes[iDestNode] = m_pNodes[i];
+			m_pNodes[i] = TempNode;
+		}
+	}
+}
+
+void CGraph::BuildLinkLookups(void)
+{
+	m_nHashLinks = 3*m_cLinks/2 + 3;
+
+	HashChoosePrimes(m_nHashLinks);
+	m_pHashLinks = (short *)calloc(sizeof(short), m_nHashLinks);
+	if (!m_pHashLinks)
+	{
+		ALERT(at_aiconsole, "Couldn't allocated Link Lookup Table.\n");
+		return;
+	}
+	int i;
+	for ( i = 0; i < m_nHashLinks; i++)
+	{
+		m_pHashLinks[i] = ENTRY_STATE_EMPTY;
+	}
+
+	for (i = 0; i < m_cLinks; i++)
+	{
+		CLink &link = Link(i);
+		HashInsert(link.m_iSrcNode, link.m_iDestNode, i);
+	}
+#if 0
+	for (i = 0; i < m_cLinks; i++)
+	{
+		CLink &link = Link(i);
+		int iKey;
+		HashSearch(link.m_iSrcNode, link.m_iDestNode, iKey);
+		if (iKey != i)
+		{
+			ALERT(at_aiconsole, "HashLinks don't match (%d versus %d)\n", i, iKey);
+		}
+	}
+#endif
+}
+
+void CGraph::BuildRegionTables(void)
+{
+	if (m_di) free(m_di);
+
+	// Go ahead and setup for range searching the nodes for FindNearestNodes
+	//
+	m_di = (DIST_INFO *)calloc(sizeof(DIST_INFO), m_cNodes);
+	if (!m_di)
+	{
+		ALERT(at_aiconsole, "Couldn't allocated node ordering array.\n");
+		return;
+	}
+
+	// Calculate regions for all the nodes.
+	//
+	//
+	int i;
+	for (i = 0; i < 3; i++)
+	{
+		m_RegionMin[i] =  999999999.0; // just a big number out there;
+		m_RegionMax[i] = -999999999.0; // just a big number out there;
+	}
+	for (i = 0; i < m_cNodes; i++)
+	{
+		if (m_pNodes[i].m_vecOrigin.x < m_RegionMin[0])
+			m_RegionMin[0] = m_pNodes[i].m_vecOrigin.x;
+		if (m_pNodes[i].m_vecOrigin.y < m_RegionMin[1])
+			m_RegionMin[1] = m_pNodes[i].m_vecOrigin.y;
+		if (m_pNodes[i].m_vecOrigin.z < m_RegionMin[2])
+			m_RegionMin[2] = m_pNodes[i].m_vecOrigin.z;
+
+		if (m_pNodes[i].m_vecOrigin.x > m_RegionMax[0])
+			m_RegionMax[0] = m_pNodes[i].m_vecOrigin.x;
+		if (m_pNodes[i].m_vecOrigin.y > m_RegionMax[1])
+			m_RegionMax[1] = m_pNodes[i].m_vecOrigin.y;
+		if (m_pNodes[i].m_vecOrigin.z > m_RegionMax[2])
+			m_RegionMax[2] = m_pNodes[i].m_vecOrigin.z;
+	}
+	for (i = 0; i < m_cNodes; i++)
+	{
+		m_pNodes[i].m_Region[0] = CALC_RANGE(m_pNodes[i].m_vecOrigin.x, m_RegionMin[0], m_RegionMax[0]);
+		m_pNodes[i].m_Region[1] = CALC_RANGE(m_pNodes[i].m_vecOrigin.y, m_RegionMin[1], m_RegionMax[1]);
+		m_pNodes[i].m_Region[2] = CALC_RANGE(m_pNodes[i].m_vecOrigin.z, m_RegionMin[2], m_RegionMax[2]);
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		int j;
+		for ( j = 0; j < NUM_RANGES; j++)
+		{
+			m_RangeStart[i][j] = 255;
+			m_RangeEnd[i][j] = 0;
+		}
+		for (j = 0; j < m_cNodes; j++)
+		{
+			m_di[j].m_SortedBy[i] = j;
+		}
+
+		for (j = 0; j < m_cNodes - 1; j++)
+		{
+			int jNode = m_di[j].m_SortedBy[i];
+			int jCodeX = m_pNodes[jNode].m_Region[0];
+			int jCodeY = m_pNodes[jNode].m_Region[1];
+			int jCodeZ = m_pNodes[jNode].m_Region[2];
+			int jCode;
+			switch (i)
+			{
+			case 0:
+				jCode = (jCodeX << 16) + (jCodeY << 8) + jCodeZ;
+				break;
+			case 1:
+				jCode = (jCodeY << 16) + (jCodeZ << 8) + jCodeX;
+				break;
+			case 2:
+				jCode = (jCodeZ << 16) + (jCodeX << 8) + jCodeY;
+				break;
+			}
+
+			for (int k = j+1; k < m_cNodes; k++)
+			{
+				int kNode = m_di[k].m_SortedBy[i];
+				int kCodeX = m_pNodes[kNode].m_Region[0];
+				int kCodeY = m_pNodes[kNode].m_Region[1];
+				int kCodeZ = m_pNodes[kNode].m_Region[2];
+				int kCode;
+				switch (i)
+				{
+				case 0:
+					kCode = (kCodeX << 16) + (kCodeY << 8) + kCodeZ;
+					break;
+				case 1:
+					kCode = (kCodeY << 16) + (kCodeZ << 8) + kCodeX;
+					break;
+				case 2:
+					kCode = (kCodeZ << 16) + (kCodeX << 8) + kCodeY;
+					break;
+				}
+
+				if (kCode < jCode)
+				{
+					// Swap j and k entries.
+					//
+					int Tmp = m_di[j].m_SortedBy[i];
+					m_di[j].m_SortedBy[i] = m_di[k].m_SortedBy[i];
+					m_di[k].m_SortedBy[i] = Tmp;
+				}
+			}
+		}
+	}
+
+	// Generate lookup tables.
 	//
-	m_di = (DIST_INFO *)calloc(sizeof(DIST_INFO), m_cNodes);
-	if (!m_di)
+	for (i = 0; i < m_cNodes; i++)
 	{
-		ALERT(at_aiconsole, "Couldn't allocated node ordering array.\n");
-		return;
+		int CodeX = m_pNodes[m_di[i].m_SortedBy[0]].m_Region[0];
+		int CodeY = m_pNodes[m_di[i].m_SortedBy[1]].m_Region[1];
+		int CodeZ = m_pNodes[m_di[i].m_SortedBy[2]].m_Region[2];
+
+        if (i < m_RangeStart[0][CodeX])
+        {
+            m_RangeStart[0][CodeX] = i;
+        }
+        if (i < m_RangeStart[1][CodeY])
+        {
+            m_RangeStart[1][CodeY] = i;
+        }
+        if (i < m_RangeStart[2][CodeZ])
+        {
+            m_RangeStart[2][CodeZ] = i;
+        }
+        if (m_RangeEnd[0][CodeX] < i)
+        {
+            m_RangeEnd[0][CodeX] = i;
+        }
+        if (m_RangeEnd[1][CodeY] < i)
+        {
+            m_RangeEnd[1][CodeY] = i;
+        }
+        if (m_RangeEnd[2][CodeZ] < i)
+        {
+            m_RangeEnd[2][CodeZ] = i;
+        }
 	}
 
-	// Calculate regions for all the nodes.
-	//
+	// Initialize the cache.
 	//
+	memset(m_Cache, 0, sizeof(m_Cache));
+}
+
+//=========================================================
+// CGraph - BuildVisibility - traces between the peek
+// positions of every pair of nodes. Glass doesn't block,
+// same as FindCover's trace to the threat. That's
+// m_cNodes * ( m_cNodes - 1 ) / 2 traces, seconds of main
+// thread time on a big map, so in the background they're
+// left to StepVisibility.
+//=========================================================
+void CGraph :: BuildVisibility( BOOL fBackground )
+{
 	int i;
-	for (i = 0; i < 3; i++)
+	int cRow = VisRowSize();
+
+	g_VisBuild.fRunning = FALSE;
+
+	if ( m_pVisBits )
 	{
-		m_RegionMin[i] =  999999999.0; // just a big number out there;
-		m_RegionMax[i] = -999999999.0; // just a big number out there;
+		free ( m_pVisBits );
+		m_pVisBits = NULL;
 	}
-	for (i = 0; i < m_cNodes; i++)
+
+	m_nVisBits = cRow * m_cNodes;
+	m_pVisBits = (unsigned int *)calloc( sizeof(unsigned int), max( m_nVisBits, 1 ) );
+	if ( !m_pVisBits )
 	{
-		if (m_pNodes[i].m_vecOrigin.x < m_RegionMin[0])
-			m_RegionMin[0] = m_pNodes[i].m_vecOrigin.x;
-		if (m_pNodes[i].m_vecOrigin.y < m_RegionMin[1])
-			m_RegionMin[1] = m_pNodes[i].m_vecOrigin.y;
-		if (m_pNodes[i].m_vecOrigin.z < m_RegionMin[2])
-			m_RegionMin[2] = m_pNodes[i].m_vecOrigin.z;
+		ALERT ( at_aiconsole, "Couldn't malloc %d node visibility ints!\n", m_nVisBits );
+		m_nVisBits = 0;
+		return;
+	}
 
-		if (m_pNodes[i].m_vecOrigin.x > m_RegionMax[0])
-			m_RegionMax[0] = m_pNodes[i].m_vecOrigin.x;
-		if (m_pNodes[i].m_vecOrigin.y > m_RegionMax[1])
-			m_RegionMax[1] = m_pNodes[i].m_vecOrigin.y;
-		if (m_pNodes[i].m_vecOrigin.z > m_RegionMax[2])
-			m_RegionMax[2] = m_pNodes[i].m_vecOrigin.z;
+	// every node sees itself
+	for ( i = 0; i < m_cNodes; i++ )
+	{
+		m_pVisBits[ i * cRow + ( i >> 5 ) ] |= 1 << ( i & 31 );
 	}
-	for (i = 0; i < m_cNodes; i++)
+
+	g_VisBuild.fRunning = TRUE;
+	g_VisBuild.iRow = 0;
+	g_VisBuild.iCol = 1;
+	g_VisBuild.cTraces = 0;
+	g_VisBuild.flSeconds = 0;
+
+	if ( fBackground )
 	{
-		m_pNodes[i].m_Region[0] = CALC_RANGE(m_pNodes[i].m_vecOrigin.x, m_RegionMin[0], m_RegionMax[0]);
-		m_pNodes[i].m_Region[1] = CALC_RANGE(m_pNodes[i].m_vecOrigin.y, m_RegionMin[1], m_RegionMax[1]);
-		m_pNodes[i].m_Region[2] = CALC_RANGE(m_pNodes[i].m_vecOrigin.z, m_RegionMin[2], m_RegionMax[2]);
+		ALERT ( at_aiconsole, "Tracing %d node pairs for visibility in the background.\n", m_cNodes * ( m_cNodes - 1 ) / 2 );
+		return;
 	}
 
-	for (i = 0; i < 3; i++)
+	StepVisibility( 0 );
+}
+
+//=========================================================
+// CGraph - StepVisibility - runs visibility traces for up
+// to flBudget milliseconds, 0 runs them all. Returns TRUE
+// once every pair has been traced.
+//=========================================================
+BOOL CGraph :: StepVisibility( float flBudget )
+{
+	TraceResult tr;
+
+	if ( !g_VisBuild.fRunning )
+		return TRUE;
+
+	int cRow = VisRowSize();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	double flElapsed = 0;
+
+	while ( g_VisBuild.iRow < m_cNodes )
 	{
-		int j;
-		for ( j = 0; j < NUM_RANGES; j++)
+		int i = g_VisBuild.iRow;
+		int j = g_VisBuild.iCol;
+
+		if ( j >= m_cNodes )
 		{
-			m_RangeStart[i][j] = 255;
-			m_RangeEnd[i][j] = 0;
+			g_VisBuild.iRow++;
+			g_VisBuild.iCol = g_VisBuild.iRow + 1;
+			continue;
 		}
-		for (j = 0; j < m_cNodes; j++)
+
+		UTIL_TraceLine ( m_pNodes[ i ].m_vecOriginPeek, m_pNodes[ j ].m_vecOriginPeek, ignore_monsters, ignore_glass, NULL, &tr );
+
+		if ( tr.flFraction == 1.0 && !tr.fStartSolid )
 		{
-			m_di[j].m_SortedBy[i] = j;
+			m_pVisBits[ i * cRow + ( j >> 5 ) ] |= 1 << ( j & 31 );
+			m_pVisBits[ j * cRow + ( i >> 5 ) ] |= 1 << ( i & 31 );
+		}
+
+		g_VisBuild.iCol++;
+		g_VisBuild.cTraces++;
+
+		flElapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+		if ( flBudget > 0 && flElapsed >= flBudget )
+			break;
+	}
+
+	flElapsed = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+	g_VisBuild.flSeconds += flElapsed / 1000.0;
+
+	if ( g_VisBuild.iRow < m_cNodes )
+		return FALSE;
+
+	g_VisBuild.fRunning = FALSE;
+	ALERT ( at_aiconsole, "Node visibility: %d traces in %.2f seconds\n", g_VisBuild.cTraces, g_VisBuild.flSeconds );
+	return TRUE;
+}
+
+//=========================================================
+// CompressRouteRow - run length encodes one node's row of
+// the routing table into pRoute, returns its size in bytes.
+// Sets *pfNeedSorting if a next node is too far away (in
+// index) from iFrom to encode. Doesn't touch the graph, so
+// it's safe to call from the route builder threads.
+//=========================================================
+static int CompressRouteRow( int cNodes, int iFrom, const unsigned short *BestNextNodes, char *pRoute, int *pCompressedSize, BOOL *pfNeedSorting )
+{
+	int iLastNode = 9999999; // just really big.
+	int cSequence = 0;
+	int cRepeats = 0;
+	int CompressedSize = 0;
+	char *p = pRoute;
+	for (int i = 0; i < cNodes; i++)
+	{
+		BOOL CanRepeat = ((BestNextNodes[i] == iLastNode) && cRepeats < 127);
+		BOOL CanSequence = (BestNextNodes[i] == i && cSequence < 128);
+
+		if (cRepeats)
+		{
+			if (CanRepeat)
+			{
+				cRepeats++;
+			}
+			else
+			{
+				// Emit the repeat phrase.
+				//
+				CompressedSize += 2; // (count-1, iLastNode-i)
+				*p++ = cRepeats - 1;
+				int a = iLastNode - iFrom;
+				int b = iLastNode - iFrom + cNodes;
+				int c = iLastNode - iFrom - cNodes;
+				if (-128 <= a && a <= 127)
+				{
+					*p++ = a;
+				}
+				else if (-128 <= b && b <= 127)
+				{
+					*p++ = b;
+				}
+				else if (-128 <= c && c <= 127)
+				{
+					*p++ = c;
+				}
+				else
+				{
+					*pfNeedSorting = TRUE;
+				}
+				cRepeats = 0;
+
+				if (CanSequence)
+				{
+					// Start a sequence.
+					//
+					cSequence++;
+				}
+				else
+				{
+					// Start another repeat.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else if (cSequence)
+		{
+			if (CanSequence)
+			{
+				cSequence++;
+			}
+			else
+			{
+				// It may be advantageous to combine
+				// a single-entry sequence phrase with the
+				// next repeat phrase.
+				//
+				if (cSequence == 1 && CanRepeat)
+				{
+					// Combine with repeat phrase.
+					//
+					cRepeats = 2;
+					cSequence = 0;
+				}
+				else
+				{
+					// Emit the sequence phrase.
+					//
+					CompressedSize += 1; // (-count)
+					*p++ = -cSequence;
+					cSequence = 0;
+
+					// Start a repeat sequence.
+					//
+					cRepeats++;
+				}
+			}
+		}
+		else
+		{
+			if (CanSequence)
+			{
+				// Start a sequence phrase.
+				//
+				cSequence++;
+			}
+			else
+			{
+				// Start a repeat sequence.
+				//
+				cRepeats++;
+			}
+		}
+		iLastNode = BestNextNodes[i];
+	}
+	if (cRepeats)
+	{
+		// Emit the repeat phrase.
+		//
+		CompressedSize += 2;
+		*p++ = cRepeats - 1;
+#if 0
+		iLastNode = iFrom + *pRoute;
+		if (iLastNode >= cNodes) iLastNode -= cNodes;
+		else if (iLastNode < 0) iLastNode += cNodes;
+#endif
+		int a = iLastNode - iFrom;
+		int b = iLastNode - iFrom + cNodes;
+		int c = iLastNode - iFrom - cNodes;
+		if (-128 <= a && a <= 127)
+		{
+			*p++ = a;
+		}
+		else if (-128 <= b && b <= 127)
+		{
+			*p++ = b;
+		}
+		else if (-128 <= c && c <= 127)
+		{
+			*p++ = c;
+		}
+		else
+		{
+			*pfNeedSorting = TRUE;
+		}
+	}
+	if (cSequence)
+	{
+		// Emit the Sequence phrase.
+		//
+		CompressedSize += 1;
+		*p++ = -cSequence;
+	}
+
+	*pCompressedSize = CompressedSize;
+	return p - pRoute;
+}
+
+
+CRouteBuilder :: CRouteBuilder( void ) : m_iNextRow( 0 ), m_cRowsDone( 0 ), m_fCancel( false )
+{
+	m_pGraph = NULL;
+	m_cNodes = 0;
+	m_cRows = 0;
+}
+
+//=========================================================
+// Start - snapshots link usability and starts the workers
+//=========================================================
+void CRouteBuilder :: Start( CGraph *pGraph, int cThreads )
+{
+	Cancel();
+
+	m_pGraph = pGraph;
+	m_cNodes = pGraph->m_cNodes;
+	m_cRows = ROUTE_TABLES * m_cNodes;
+
+	m_linkUsable.assign( pGraph->m_cLinks * 2, 1 );
+	for ( int i = 0; i < pGraph->m_cLinks; i++ )
+	{
+		CLink &link = pGraph->m_pLinkPool[ i ];
+		if ( link.m_pLinkEnt == NULL )
+			continue;
+
+		for ( int iCap = 0; iCap < 2; iCap++ )
+		{
+			if ( !pGraph->HandleLinkEnt ( link.m_iSrcNode, link.m_pLinkEnt, RouteCapMask( iCap ), CGraph::NODEGRAPH_STATIC ) )
+				m_linkUsable[ i * 2 + iCap ] = 0;
 		}
+	}
+
+	m_rows.assign( m_cRows, std::string() );
+	m_compressedSize.assign( m_cRows, 0 );
+	m_needSorting.assign( m_cRows, 0 );
+
+	m_iNextRow = 0;
+	m_cRowsDone = 0;
+	m_fCancel = false;
+
+	for ( int i = 0; i < cThreads; i++ )
+		m_threads.push_back( std::thread( &CRouteBuilder::WorkerThread, this ) );
+}
+
+//=========================================================
+// ~CRouteBuilder - ServerDeactivate has normally finished the
+// build already. Joining here would wait, under the loader
+// lock, on threads that need that lock to exit, so anything
+// still running is left to the process teardown.
+//=========================================================
+CRouteBuilder :: ~CRouteBuilder( void )
+{
+	m_fCancel = true;
+
+	for ( size_t i = 0; i < m_threads.size(); i++ )
+	{
+		if ( m_threads[i].joinable() )
+			m_threads[i].detach();
+	}
+}
+
+void CRouteBuilder :: Wait( void )
+{
+	for ( size_t i = 0; i < m_threads.size(); i++ )
+		m_threads[i].join();
+
+	m_threads.clear();
+}
+
+//=========================================================
+// Cancel - stops the workers and throws away their rows,
+// the graph they're reading is about to go away
+//=========================================================
+void CRouteBuilder :: Cancel( void )
+{
+	m_fCancel = true;
+	Wait();
+
+	m_pGraph = NULL;
+	m_rows.clear();
+	m_compressedSize.clear();
+	m_needSorting.clear();
+	m_linkUsable.clear();
+}
+
+void CRouteBuilder :: WorkerThread( void )
+{
+	CPathSearch search;
+	unsigned short *BestNextNodes = new unsigned short[m_cNodes];
+	char *pRoute = new char[m_cNodes*2];
+
+	while ( !m_fCancel )
+	{
+		int iRow = m_iNextRow++;
+		if ( iRow >= m_cRows )
+			break;
+
+		BuildRow( search, iRow / m_cNodes, iRow % m_cNodes, BestNextNodes, pRoute );
+		m_cRowsDone++;
+	}
+
+	delete [] BestNextNodes;
+	delete [] pRoute;
+}
+
+//=========================================================
+// BuildRow - searches out from iFrom, keeping the first hop
+// of each node's path in the search's previous node field.
+// Unreachable nodes, and iFrom itself, route to iFrom.
+//=========================================================
+void CRouteBuilder :: BuildRow( CPathSearch &search, int iTable, int iFrom, unsigned short *BestNextNodes, char *pRoute )
+{
+	int iHullMask = LinkHullMask( iTable / 2 );
+	int iCap = iTable % 2;
+	CNode *pNodes = m_pGraph->m_pNodes;
+	CLink *pLinkPool = m_pGraph->m_pLinkPool;
+
+	search.Begin( m_cNodes );
+	search.Visit( iFrom, 0.0, iFrom );
+	search.m_queue.Insert( iFrom, 0.0 );
 
-		for (j = 0; j < m_cNodes - 1; j++)
+	while ( !search.m_queue.Empty() )
+	{
+		float flPriority;
+		int iCurrentNode = search.m_queue.Remove( flPriority );
+		float flCurrentDistance = search.Cost( iCurrentNode );
+
+		if ( flPriority > flCurrentDistance + 0.0005 )
+			continue;
+
+		CNode *pCurrentNode = &pNodes[ iCurrentNode ];
+		int iFirstHop = search.Previous( iCurrentNode );
+
+		for ( int i = 0; i < pCurrentNode->m_cNumLinks; i++ )
 		{
-			int jNode = m_di[j].m_SortedBy[i];
-			int jCodeX = m_pNodes[jNode].m_Region[0];
-			int jCodeY = m_pNodes[jNode].m_Region[1];
-			int jCodeZ = m_pNodes[jNode].m_Region[2];
-			int jCode;
-			switch (i)
-			{
-			case 0:
-				jCode = (jCodeX << 16) + (jCodeY << 8) + jCodeZ;
-				break;
-			case 1:
-				jCode = (jCodeY << 16) + (jCodeZ << 8) + jCodeX;
-				break;
-			case 2:
-				jCode = (jCodeZ << 16) + (jCodeX << 8) + jCodeY;
-				break;
-			}
+			int iLink = pCurrentNode->m_iFirstLink + i;
+			CLink *pLink = &pLinkPool[ iLink ];
 
-			for (int k = j+1; k < m_cNodes; k++)
-			{
-				int kNode = m_di[k].m_SortedBy[i];
-				int kCodeX = m_pNodes[kNode].m_Region[0];
-				int kCodeY = m_pNodes[kNode].m_Region[1];
-				int kCodeZ = m_pNodes[kNode].m_Region[2];
-				int kCode;
-				switch (i)
-				{
-				case 0:
-					kCode = (kCodeX << 16) + (kCodeY << 8) + kCodeZ;
-					break;
-				case 1:
-					kCode = (kCodeY << 16) + (kCodeZ << 8) + kCodeX;
-					break;
-				case 2:
-					kCode = (kCodeZ << 16) + (kCodeX << 8) + kCodeY;
-					break;
-				}
+			if ( ( pLink->m_afLinkInfo & iHullMask ) != iHullMask )
+				continue;
 
-				if (kCode < jCode)
-				{
-					// Swap j and k entries.
-					//
-					int Tmp = m_di[j].m_SortedBy[i];
-					m_di[j].m_SortedBy[i] = m_di[k].m_SortedBy[i];
-					m_di[k].m_SortedBy[i] = Tmp;
-				}
+			if ( !m_linkUsable[ iLink * 2 + iCap ] )
+				continue;
+
+			int iVisitNode = pLink->m_iDestNode;
+			float flOurDistance = flCurrentDistance + pLink->m_flWeight + ROUTE_LINK_COST;
+
+			if ( !search.Visited( iVisitNode ) || flOurDistance < search.Cost( iVisitNode ) - 0.001 )
+			{
+				search.Visit( iVisitNode, flOurDistance, ( iCurrentNode == iFrom ) ? iVisitNode : iFirstHop );
+				search.m_queue.Insert( iVisitNode, flOurDistance );
 			}
 		}
 	}
 
-	// Generate lookup tables.
-	//
-	for (i = 0; i < m_cNodes; i++)
+	for ( int iTo = 0; iTo < m_cNodes; iTo++ )
 	{
-		int CodeX = m_pNodes[m_di[i].m_SortedBy[0]].m_Region[0];
-		int CodeY = m_pNodes[m_di[i].m_SortedBy[1]].m_Region[1];
-		int CodeZ = m_pNodes[m_di[i].m_SortedBy[2]].m_Region[2];
-
-        if (i < m_RangeStart[0][CodeX])
-        {
-            m_RangeStart[0][CodeX] = i;
-        }
-        if (i < m_RangeStart[1][CodeY])
-        {
-            m_RangeStart[1][CodeY] = i;
-        }
-        if (i < m_RangeStart[2][CodeZ])
-        {
-            m_RangeStart[2][CodeZ] = i;
-        }
-        if (m_RangeEnd[0][CodeX] < i)
-        {
-            m_RangeEnd[0][CodeX] = i;
-        }
-        if (m_RangeEnd[1][CodeY] < i)
-        {
-            m_RangeEnd[1][CodeY] = i;
-        }
-        if (m_RangeEnd[2][CodeZ] < i)
-        {
-            m_RangeEnd[2][CodeZ] = i;
-        }
+		BestNextNodes[iTo] = search.Visited( iTo ) ? search.Previous( iTo ) : iFrom;
 	}
 
-	// Initialize the cache.
-	//
-	memset(m_Cache, 0, sizeof(m_Cache));
+	int iRow = iTable * m_cNodes + iFrom;
+	BOOL fNeedSorting = FALSE;
+	int nRoute = CompressRouteRow( m_cNodes, iFrom, BestNextNodes, pRoute, &m_compressedSize[ iRow ], &fNeedSorting );
+
+	m_rows[ iRow ].assign( pRoute, nRoute );
+	m_needSorting[ iRow ] = fNeedSorting;
 }
 
-void CGraph :: ComputeStaticRoutingTables( void )
+//=========================================================
+// CGraph - ComputeStaticRoutingTables - starts building the
+// routing tables. In the background, FindShortestPath keeps
+// searching live until CheckRoutingTables picks them up.
+//=========================================================
+void CGraph :: ComputeStaticRoutingTables( BOOL fBackground )
 {
-	int nRoutes = m_cNodes*m_cNodes;
-#define FROM_TO(x,y) ((x)*m_cNodes+(y))
-	short *Routes = new short[nRoutes];
+	m_fRoutingComplete = FALSE;
 
-	int *pMyPath = new int[m_cNodes];
-	unsigned short *BestNextNodes = new unsigned short[m_cNodes];
-	char *pRoute = new char[m_cNodes*2];
+	int cThreads = std::thread::hardware_concurrency();
+	if ( fBackground )
+		cThreads--;// leave a core for the server
+	cThreads = max( cThreads, 1 );
 
+	g_RouteBuilder.Start( this, cThreads );
+	g_fSaveGraphWhenBuilt = fBackground;
 
-	if (Routes && pMyPath && BestNextNodes && pRoute)
+	if ( !fBackground )
 	{
-		int nTotalCompressedSize = 0;
-		for (int iHull = 0; iHull < MAX_NODE_HULLS; iHull++)
-		{
-			for (int iCap = 0; iCap < 2; iCap++)
-			{
-				int iCapMask;
-				switch (iCap)
-				{
-				case 0:
-					iCapMask = 0;
-					break;
+		g_RouteBuilder.Wait();
+		PackRoutingTables();
+	}
+	else
+	{
+		ALERT( at_console, "Building routing tables in the background.\n" );
+	}
+}
 
-				case 1:
-					iCapMask = bits_CAP_OPEN_DOORS | bits_CAP_AUTO_DOORS | bits_CAP_USE;
-					break;
-				}
+//=========================================================
+// CGraph - CheckRoutingTables - called every frame, installs
+// background built routing tables once they're done
+//=========================================================
+void CGraph :: CheckRoutingTables( void )
+{
+	BOOL fVisDone = StepVisibility( ai_visbudget.value );
 
+	if ( g_RouteBuilder.Running() && g_RouteBuilder.Done() )
+	{
+		g_RouteBuilder.Wait();
+		PackRoutingTables();
+	}
 
-				// Initialize Routing table to uncalculated.
-				//
-				int iFrom;
-				for ( iFrom = 0; iFrom < m_cNodes; iFrom++)
-				{
-					for (int iTo = 0; iTo < m_cNodes; iTo++)
-					{
-						Routes[FROM_TO(iFrom, iTo)] = -1;
-					}
-				}
+	if ( g_fSaveGraphWhenBuilt && fVisDone && m_fRoutingComplete )
+	{
+		g_fSaveGraphWhenBuilt = FALSE;
+		FSaveGraph( (char *)STRING( gpGlobals->mapname ) );
+		ALERT( at_console, "Routing tables done.\n" );
+	}
+}
 
-				for (iFrom = 0; iFrom < m_cNodes; iFrom++)
-				{
-					for (int iTo = m_cNodes-1; iTo >= 0; iTo--)
-					{
-						if (Routes[FROM_TO(iFrom, iTo)] != -1) continue;
+//=========================================================
+// CGraph - FinishRoutingTables - waits for the routing table
+// build, finishes the visibility traces and installs both.
+// ServerDeactivate calls this so a background build that's
+// still running when the level ends still gets saved,
+// instead of being cancelled by the next level's InitGraph,
+// and no worker outlives the server.
+//=========================================================
+void CGraph :: FinishRoutingTables( void )
+{
+	if ( !g_fSaveGraphWhenBuilt && !g_RouteBuilder.Running() && !g_VisBuild.fRunning )
+		return;
 
-						int cPathSize = FindShortestPath(pMyPath, iFrom, iTo, iHull, iCapMask);
+	if ( g_RouteBuilder.Running() || g_VisBuild.fRunning )
+	{
+		ALERT( at_console, "Finishing the node graph before the level ends.\n" );
+	}
 
-						// Use the computed path to update the routing table.
-						//
-						if (cPathSize > 1)
-						{
-							for (int iNode = 0; iNode < cPathSize-1; iNode++)
-							{
-								int iStart = pMyPath[iNode];
-								int iNext  = pMyPath[iNode+1];
-								for (int iNode1 = iNode+1; iNode1 < cPathSize; iNode1++)
-								{
-									int iEnd = pMyPath[iNode1];
-									Routes[FROM_TO(iStart, iEnd)] = iNext;
-								}
-							}
-#if 0
-							// Well, at first glance, this should work, but actually it's safer
-							// to be told explictly that you can take a series of node in a
-							// particular direction. Some links don't appear to have links in
-							// the opposite direction.
-							//
-							for (iNode = cPathSize-1; iNode >= 1; iNode--)
-							{
-								int iStart = pMyPath[iNode];
-								int iNext  = pMyPath[iNode-1];
-								for (int iNode1 = iNode-1; iNode1 >= 0; iNode1--)
-								{
-									int iEnd = pMyPath[iNode1];
-									Routes[FROM_TO(iStart, iEnd)] = iNext;
-								}
-							}
-#endif
-						}
-						else
-						{
-							Routes[FROM_TO(iFrom, iTo)] = iFrom;
-							Routes[FROM_TO(iTo, iFrom)] = iTo;
-						}
-					}
-				}
+	StepVisibility( 0 );
 
-				for (iFrom = 0; iFrom < m_cNodes; iFrom++)
-				{
-					for (int iTo = 0; iTo < m_cNodes; iTo++)
-					{
-						BestNextNodes[iTo] = Routes[FROM_TO(iFrom, iTo)];
-					}
+	if ( g_RouteBuilder.Running() )
+	{
+		g_RouteBuilder.Wait();
+		PackRoutingTables();
+	}
 
-					// Compress this node's routing table.
-					//
-					int iLastNode = 9999999; // just really big.
-					int cSequence = 0;
-					int cRepeats = 0;
-					int CompressedSize = 0;
-					char *p = pRoute;
-					for (int i = 0; i < m_cNodes; i++)
-					{
-						BOOL CanRepeat = ((BestNextNodes[i] == iLastNode) && cRepeats < 127);
-						BOOL CanSequence = (BestNextNodes[i] == i && cSequence < 128);
+	if ( m_fRoutingComplete )
+	{
+		g_fSaveGraphWhenBuilt = FALSE;
+		FSaveGraph( (char *)STRING( gpGlobals->mapname ) );
+		ALERT( at_console, "Routing tables done.\n" );
+	}
+}
 
-						if (cRepeats)
-						{
-							if (CanRepeat)
-							{
-								cRepeats++;
-							}
-							else
-							{
-								// Emit the repeat phrase.
-								//
-								CompressedSize += 2; // (count-1, iLastNode-i)
-								*p++ = cRepeats - 1;
-								int a = iLastNode - iFrom;
-								int b = iLastNode - iFrom + m_cNodes;
-								int c = iLastNode - iFrom - m_cNodes;
-								if (-128 <= a && a <= 127)
-								{
-									*p++ = a;
-								}
-								else if (-128 <= b && b <= 127)
-								{
-									*p++ = b;
-								}
-								else if (-128 <= c && c <= 127)
-								{
-									*p++ = c;
-								}
-								else
-								{
-									ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
-								}
-								cRepeats = 0;
+//=========================================================
+// CGraph - PackRoutingTables - copies the finished rows
+// into m_pRouteInfo. Identical rows are only stored once.
+//=========================================================
+void CGraph :: PackRoutingTables( void )
+{
+	std::unordered_map<std::string, int> offsets;
+	std::string routeInfo;
+	int nTotalCompressedSize = 0;
 
-								if (CanSequence)
-								{
-									// Start a sequence.
-									//
-									cSequence++;
-								}
-								else
-								{
-									// Start another repeat.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else if (cSequence)
-						{
-							if (CanSequence)
-							{
-								cSequence++;
-							}
-							else
-							{
-								// It may be advantageous to combine
-								// a single-entry sequence phrase with the
-								// next repeat phrase.
-								//
-								if (cSequence == 1 && CanRepeat)
-								{
-									// Combine with repeat phrase.
-									//
-									cRepeats = 2;
-									cSequence = 0;
-								}
-								else
-								{
-									// Emit the sequence phrase.
-									//
-									CompressedSize += 1; // (-count)
-									*p++ = -cSequence;
-									cSequence = 0;
-
-									// Start a repeat sequence.
-									//
-									cRepeats++;
-								}
-							}
-						}
-						else
-						{
-							if (CanSequence)
-							{
-								// Start a sequence phrase.
-								//
-								cSequence++;
-							}
-							else
-							{
-								// Start a repeat sequence.
-								//
-								cRepeats++;
-							}
-						}
-						iLastNode = BestNextNodes[i];
-					}
-					if (cRepeats)
-					{
-						// Emit the repeat phrase.
-						//
-						CompressedSize += 2;
-						*p++ = cRepeats - 1;
-#if 0
-						iLastNode = iFrom + *pRoute;
-						if (iLastNode >= m_cNodes) iLastNode -= m_cNodes;
-						else if (iLastNode < 0) iLastNode += m_cNodes;
-#endif
-						int a = iLastNode - iFrom;
-						int b = iLastNode - iFrom + m_cNodes;
-						int c = iLastNode - iFrom - m_cNodes;
-						if (-128 <= a && a <= 127)
-						{
-							*p++ = a;
-						}
-						else if (-128 <= b && b <= 127)
-						{
-							*p++ = b;
-						}
-						else if (-128 <= c && c <= 127)
-						{
-							*p++ = c;
-						}
-						else
-						{
-							ALERT( at_aiconsole, "Nodes need sorting (%d,%d)!\n", iLastNode, iFrom);
-						}
-					}
-					if (cSequence)
-					{
-						// Emit the Sequence phrase.
-						//
-						CompressedSize += 1;
-						*p++ = -cSequence;
-					}
+	for (int iHull = 0; iHull < MAX_NODE_HULLS; iHull++)
+	{
+		for (int iCap = 0; iCap < 2; iCap++)
+		{
+			for (int iFrom = 0; iFrom < m_cNodes; iFrom++)
+			{
+				int iRow = ( iHull * 2 + iCap ) * m_cNodes + iFrom;
+				const std::string &row = g_RouteBuilder.m_rows[ iRow ];
 
-					// Go find a place to store this thing and point to it.
-					//
-					int nRoute = p - pRoute;
-					if (m_pRouteInfo)
-					{
-						int i;
-						for ( i = 0; i < m_nRouteInfo - nRoute; i++)
-						{
-							if (memcmp(m_pRouteInfo + i, pRoute, nRoute) == 0)
-							{
-								break;
-							}
-						}
-						if (i < m_nRouteInfo - nRoute)
-						{
-							m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = i;
-						}
-						else
-						{
-							char *Tmp = (char *)calloc(sizeof(char), (m_nRouteInfo + nRoute));
-							memcpy(Tmp, m_pRouteInfo, m_nRouteInfo);
-							free(m_pRouteInfo);
-							m_pRouteInfo = Tmp;
-							memcpy(m_pRouteInfo + m_nRouteInfo, pRoute, nRoute);
-							m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = m_nRouteInfo;
-							m_nRouteInfo += nRoute;
-							nTotalCompressedSize += CompressedSize;
-						}
-					}
-					else
-					{
-						m_nRouteInfo = nRoute;
-						m_pRouteInfo = (char *)calloc(sizeof(char), nRoute);
-						memcpy(m_pRouteInfo, pRoute, nRoute);
-						m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = 0;
-						nTotalCompressedSize += CompressedSize;
-					}
+				if ( g_RouteBuilder.m_needSorting[ iRow ] )
+				{
+					ALERT( at_aiconsole, "Nodes need sorting (%d)!\n", iFrom);
+				}
+
+				std::unordered_map<std::string, int>::iterator it = offsets.find( row );
+				if ( it != offsets.end() )
+				{
+					m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = it->second;
+				}
+				else
+				{
+					m_pNodes[ iFrom ].m_pNextBestNode[iHull][iCap] = routeInfo.size();
+					offsets[ row ] = routeInfo.size();
+					routeInfo += row;
+					nTotalCompressedSize += g_RouteBuilder.m_compressedSize[ iRow ];
 				}
 			}
-		}		
-		ALERT( at_aiconsole, "Size of Routes = %d\n", nTotalCompressedSize);
+		}
 	}
-	if (Routes) delete Routes;
-	if (BestNextNodes) delete BestNextNodes;
-	if (pRoute) delete pRoute;
-	if (pMyPath) delete pMyPath;
-	Routes = 0;
-	BestNextNodes = 0;
-	pRoute = 0;
-	pMyPath = 0;
+
+	if ( m_pRouteInfo )
+	{
+		free ( m_pRouteInfo );
+		m_pRouteInfo = NULL;
+	}
+
+	m_nRouteInfo = routeInfo.size();
+	m_pRouteInfo = (char *)calloc( sizeof(char), max( m_nRouteInfo, 1 ) );
+	memcpy( m_pRouteInfo, routeInfo.data(), m_nRouteInfo );
+
+	ALERT( at_aiconsole, "Size of Routes = %d\n", nTotalCompressedSize);
+
+	g_RouteBuilder.Cancel();
 
 #if 0
 	TestRoutingTables();
@@ -47,11 +47,11 @@ public:
 	//
 	int		m_pNextBestNode[MAX_NODE_HULLS][2];
 
-	// Used in finding the shortest path. m_fClosestSoFar is -1 if not visited.
-	// Then it is the distance to the source. If another path uses this node
-	// and has a closer distance, then m_iPreviousNode is also updated.
+	// Used to be the shortest path state, FindShortestPath keeps that in a
+	// CPathSearch now. Still part of the .nod file layout, and SortNodes
+	// borrows m_iPreviousNode for the new node numbers.
 	//
-	float   m_flClosestSoFar; // Used in finding the shortest path.
+	float   m_flClosestSoFar;
 	int		m_iPreviousNode;
 
 	short	m_sHintType;// there is something interesting in the world at this node's position
@@ -104,7 +104,8 @@ typedef struct
 //=========================================================
 // CGraph 
 //=========================================================
-#define	GRAPH_VERSION	(int)16// !!!increment this whever graph/node/link classes change, to obsolesce older disk files.
+#define	GRAPH_VERSION	(int)17// !!!increment this whever graph/node/link classes change, to obsolesce older disk files.
+// utils/nodegraph writes .nod files too, keep its copies of these layouts in step.
 class CGraph
 {
 public:
@@ -131,6 +132,9 @@ public:
 	// search each range. After the search is exhausted, we know we have the closest
 	// node.
 	//
+	// FindNearestNode uses CNodeTree now. The tables and m_Cache are still built
+	// and saved, they're part of the .nod file layout.
+	//
 #define CACHE_SIZE 128
 #define NUM_RANGES 256
 	DIST_INFO *m_di;	// This is m_cNodes long, but the entries don't correspond to CNode entries.
@@ -149,6 +153,11 @@ public:
 	short *m_pHashLinks;
 	int m_nHashLinks;
 
+	// Which nodes can see each other, a row of bits per node. FindCover
+	// skips nodes that can see the threat's node before tracing.
+	unsigned int *m_pVisBits;
+	int m_nVisBits;// in ints
+
 
 	// kinda sleazy. In order to allow variety in active idles for monster groups in a room with more than one node, 
 	// we keep track of the last node we searched from and store it here. Subsequent searches by other monsters will pick
@@ -161,7 +170,7 @@ public:
 	// functions to create the graph
 	int		LinkVisibleNodes ( CLink *pLinkPool, FILE *file, int *piBadNode );
 	int		RejectInlineLinks ( CLink *pLinkPool, FILE *file );
-	int		FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask);
+	int		FindShortestPath ( int *piPath, int iStart, int iDest, int iHull, int afCapMask, int cMaxPath = 0 );
 	int		FindNearestNode ( const Vector &vecOrigin, CBaseEntity *pEntity );
 	int		FindNearestNode ( const Vector &vecOrigin, int afNodeTypes );
 	//int		FindNearestLink ( const Vector &vecTestPoint, int *piNearestLink, BOOL *pfAlongLine );
@@ -181,10 +190,19 @@ public:
 	int		FLoadGraph(char *szMapName);
 	int		FSaveGraph(char *szMapName);
 	int		FSetGraphPointers(void);
-	void	CheckNode(Vector vecOrigin, int iNode);
+	int		CheckNode(const Vector &vecOrigin, int iNode);
+	int		NearestVisibleNode( const Vector &vecOrigin, int afNodeTypes );
+	void	NearestNodeBenchmark( edict_t *pentPlayer, int cQueries );
 
 	void    BuildRegionTables(void);
-	void    ComputeStaticRoutingTables(void);
+	void	BuildVisibility( BOOL fBackground = FALSE );
+	BOOL	StepVisibility( float flBudget );
+	inline int VisRowSize ( void ) { return ( m_cNodes + 31 ) >> 5; }
+	inline BOOL FNodeCanSee ( int iSrcNode, int iDestNode ) { return ( m_pVisBits[ iSrcNode * VisRowSize() + ( iDestNode >> 5 ) ] >> ( iDestNode & 31 ) ) & 1; }
+	void    ComputeStaticRoutingTables( BOOL fBackground = FALSE );
+	void    CheckRoutingTables(void);
+	void    FinishRoutingTables(void);
+	void    PackRoutingTables(void);
 	void    TestRoutingTables(void);
 
 	void	HashInsert(int iSrcNode, int iDestNode, int iKey);
@@ -344,6 +362,127 @@ private:
 
 };
 
+//=========================================================
+// CNodeHeap - Priority queue (smallest item out first) that
+// grows as needed, so big searches never drop nodes.
+//=========================================================
+class CNodeHeap
+{
+public:
+
+	CNodeHeap( void );
+	~CNodeHeap( void );
+	inline int Empty ( void ) { return ( m_cSize == 0 ); }
+	inline int Size ( void ) { return ( m_cSize ); }
+	inline void Clear ( void ) { m_cSize = 0; }
+	void Insert( int, float );
+	int Remove( float & );
+
+private:
+	int	m_cSize;
+	int	m_cMax;
+    struct tag_HEAP_NODE
+    {
+        int   Id;
+        float Priority;
+    } *m_heap;
+	void Heap_SiftDown(int);
+	void Heap_SiftUp(void);
+};
+
+//=========================================================
+// CPathSearch - per node scratch space for FindShortestPath.
+// A node's cost and parent are only valid if its generation
+// matches the current search, so nothing is cleared between
+// searches. Kept out of CNode and CGraph since both are
+// written to the .nod file as they are.
+//=========================================================
+class CPathSearch
+{
+public:
+
+	CPathSearch( void );
+	~CPathSearch( void );
+	void Begin( int cNodes );
+
+	inline int Visited ( int iNode ) { return ( m_pGeneration[ iNode ] == m_iGeneration ); }
+	inline float Cost ( int iNode ) { return ( m_pCost[ iNode ] ); }
+	inline int Previous ( int iNode ) { return ( m_pPrevious[ iNode ] ); }
+	inline void Visit ( int iNode, float flCost, int iPrevious )
+	{
+		m_pGeneration[ iNode ] = m_iGeneration;
+		m_pCost[ iNode ] = flCost;
+		m_pPrevious[ iNode ] = iPrevious;
+	}
+
+	CNodeHeap	m_queue;
+
+private:
+	int		m_cMaxNodes;
+	unsigned int	m_iGeneration;
+	unsigned int	*m_pGeneration;
+	float	*m_pCost;
+	int		*m_pPrevious;
+};
+
+//=========================================================
+// CNodeTree - KD-tree over the nodes' m_vecOriginPeek for
+// FindNearestNode. Hands out nodes of the asked for types
+// nearest first, so the visibility traces can stop at the
+// first node that can be seen. Also holds the nearest node
+// cache, which goes stale with the tree.
+//=========================================================
+#define NEAREST_CACHE_SIZE	1024
+
+class CNodeTree
+{
+public:
+
+	CNodeTree( void );
+	~CNodeTree( void );
+	void Build( CNode *pNodes, int cNodes );
+	void Clear( void );
+	inline int Count ( void ) { return ( m_cNodes ); }
+
+	// nodes of afNodeTypes, nearest first. NextNode returns -1 when there are none left.
+	void BeginQuery( const Vector &vecOrigin, int afNodeTypes );
+	int NextNode( void );
+
+	int CacheLookup( const Vector &vecOrigin, int afNodeTypes, int &iNode );
+	void CacheStore( const Vector &vecOrigin, int afNodeTypes, int iNode );
+
+private:
+	int BuildSubtree( int iFirst, int cCount );
+	float BoxDistance( int iTreeNode );
+
+	CNode	*m_pNodes;
+	int		m_cNodes;
+	int		m_iRoot;
+
+	// one graph node per tree node, the tree nodes are in m_pIndex order
+	struct tag_TREE_NODE
+	{
+		int		iNode;
+		int		iLeft;
+		int		iRight;
+		int		afNodeTypes;	// every type in the subtree
+		Vector	vecMins;		// bounds of the subtree
+		Vector	vecMaxs;
+	} *m_pTree;
+
+	// graph nodes are queued as themselves, subtrees as -( tree node + 1 )
+	CNodeHeap	m_queue;
+	Vector		m_vecQuery;
+	int			m_afQueryTypes;
+
+	struct tag_CACHE_ENTRY
+	{
+		Vector	v;
+		int		afNodeTypes;
+		int		n;
+	} m_Cache[NEAREST_CACHE_SIZE];
+};
+
 //=========================================================
 // hints - these MUST coincide with the HINTS listed under
 // info_node in the FGD file!
@@ -0,0 +1,252 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+//=========================================================
+// pathqueue.cpp - node route searches on a per frame budget
+//=========================================================
+
+#include	<chrono>
+#include	"extdll.h"
+#include	"util.h"
+#include	"cbase.h"
+#include	"monsters.h"
+#include	"nodes.h"
+#include	"game.h"
+#include	"pathqueue.h"
+
+extern CGraph WorldGraph;
+
+CPathQueue g_PathQueue;
+
+static double PathQueueClock( void )
+{
+	return std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+CPathQueue :: CPathQueue( void )
+{
+	Clear();
+}
+
+void CPathQueue :: Clear( void )
+{
+	memset( m_requests, 0, sizeof( m_requests ) );
+	m_iSerial = 0;
+	m_flSpent = 0;
+	m_flSearchStart = 0;
+	m_cSearchDepth = 0;
+}
+
+BOOL CPathQueue :: FEnabled( void )
+{
+	return ( ai_pathbudget.value > 0 );
+}
+
+BOOL CPathQueue :: FHaveBudget( void )
+{
+	return ( !FEnabled() || m_flSpent < ai_pathbudget.value );
+}
+
+//=========================================================
+// BeginFrame - runs queued searches, oldest first, until
+// the budget is spent. At least one always runs so nothing
+// waits forever. Finished routes are dropped after
+// PATHQUEUE_LIFETIME, or once their waiters have picked
+// them up, whichever is later.
+//=========================================================
+void CPathQueue :: BeginFrame( void )
+{
+	int i;
+
+	m_flSpent = 0;
+
+	for ( i = 0; i < PATHQUEUE_SIZE; i++ )
+	{
+		pathrequest_t *pRequest = &m_requests[ i ];
+
+		if ( pRequest->iState != PATHREQ_DONE )
+			continue;
+
+		float flAge = gpGlobals->time - pRequest->flTime;
+		float flLifetime = pRequest->cWaiters ? PATHQUEUE_WAIT_LIFETIME : PATHQUEUE_LIFETIME;
+
+		if ( flAge > flLifetime || pRequest->flTime > gpGlobals->time )
+		{
+			pRequest->iState = PATHREQ_FREE;
+		}
+	}
+
+	do
+	{
+		pathrequest_t *pOldest = NULL;
+
+		for ( i = 0; i < PATHQUEUE_SIZE; i++ )
+		{
+			if ( m_requests[ i ].iState == PATHREQ_PENDING && ( !pOldest || m_requests[ i ].iSerial < pOldest->iSerial ) )
+				pOldest = &m_requests[ i ];
+		}
+
+		if ( !pOldest )
+			break;
+
+		Solve( pOldest );
+	} while ( FHaveBudget() );
+}
+
+//=========================================================
+// Request - finds or queues a route. A new one is searched
+// straight away if there's budget left this frame.
+//=========================================================
+int CPathQueue :: Request( int iSrcNode, int iDestNode, int iHull, int afCapMask )
+{
+	int i;
+	int iFree = -1;
+
+	for ( i = 0; i < PATHQUEUE_SIZE; i++ )
+	{
+		pathrequest_t *pRequest = &m_requests[ i ];
+
+		if ( pRequest->iState == PATHREQ_FREE )
+		{
+			if ( iFree == -1 )
+				iFree = i;
+			continue;
+		}
+
+		if ( pRequest->iSrcNode == iSrcNode && pRequest->iDestNode == iDestNode &&
+			pRequest->iHull == iHull && pRequest->afCapMask == afCapMask )
+		{
+			return i;
+		}
+	}
+
+	if ( iFree == -1 )
+	{
+		// no room, reuse the oldest finished route nobody is waiting for
+		for ( i = 0; i < PATHQUEUE_SIZE; i++ )
+		{
+			if ( m_requests[ i ].iState != PATHREQ_DONE || m_requests[ i ].cWaiters )
+				continue;
+
+			if ( iFree == -1 || m_requests[ i ].flTime < m_requests[ iFree ].flTime )
+				iFree = i;
+		}
+
+		if ( iFree == -1 )
+			return -1;
+	}
+
+	pathrequest_t *pRequest = &m_requests[ iFree ];
+
+	pRequest->iSrcNode = iSrcNode;
+	pRequest->iDestNode = iDestNode;
+	pRequest->iHull = iHull;
+	pRequest->afCapMask = afCapMask;
+	pRequest->iState = PATHREQ_PENDING;
+	pRequest->iSerial = m_iSerial++;
+	pRequest->cPath = 0;
+	pRequest->cWaiters = 0;
+
+	if ( FHaveBudget() )
+	{
+		Solve( pRequest );
+	}
+
+	return iFree;
+}
+
+const pathrequest_t *CPathQueue :: Result( int iRequest )
+{
+	if ( iRequest < 0 || iRequest >= PATHQUEUE_SIZE || m_requests[ iRequest ].iState != PATHREQ_DONE )
+		return NULL;
+
+	return &m_requests[ iRequest ];
+}
+
+//=========================================================
+// Wait - makes *pHandle a waiter on iRequest, dropping any
+// request it waited on before. Handles are the request's
+// serial + 1, so a slot reused for another route doesn't
+// match a stale handle.
+//=========================================================
+void CPathQueue :: Wait( int iRequest, int *pHandle )
+{
+	if ( iRequest < 0 || iRequest >= PATHQUEUE_SIZE || m_requests[ iRequest ].iState == PATHREQ_FREE )
+		return;
+
+	int iHandle = m_requests[ iRequest ].iSerial + 1;
+	if ( *pHandle == iHandle )
+		return;
+
+	Release( pHandle );
+
+	m_requests[ iRequest ].cWaiters++;
+	*pHandle = iHandle;
+}
+
+void CPathQueue :: Release( int *pHandle )
+{
+	if ( !*pHandle )
+		return;
+
+	for ( int i = 0; i < PATHQUEUE_SIZE; i++ )
+	{
+		pathrequest_t *pRequest = &m_requests[ i ];
+
+		if ( pRequest->iState != PATHREQ_FREE && pRequest->iSerial + 1 == *pHandle )
+		{
+			if ( pRequest->cWaiters > 0 )
+				pRequest->cWaiters--;
+			break;
+		}
+	}
+
+	*pHandle = 0;
+}
+
+void CPathQueue :: Solve( pathrequest_t *pRequest )
+{
+	BeginSearch();
+	pRequest->cPath = WorldGraph.FindShortestPath( pRequest->iPath, pRequest->iSrcNode, pRequest->iDestNode, pRequest->iHull, pRequest->afCapMask, MAX_PATH_SIZE );
+	EndSearch();
+
+	pRequest->iState = PATHREQ_DONE;
+	pRequest->flTime = gpGlobals->time;
+}
+
+void CPathQueue :: BeginSearch( void )
+{
+	if ( m_cSearchDepth++ == 0 )
+		m_flSearchStart = PathQueueClock();
+}
+
+void CPathQueue :: EndSearch( void )
+{
+	if ( --m_cSearchDepth == 0 )
+		m_flSpent += PathQueueClock() - m_flSearchStart;
+}
+
+CSyncPathSearch :: CSyncPathSearch( CBaseMonster *pMonster )
+{
+	m_pMonster = pMonster;
+	m_fCanWaitForPath = pMonster->m_fCanWaitForPath;
+	pMonster->m_fCanWaitForPath = FALSE;
+	g_PathQueue.BeginSearch();
+}
+
+CSyncPathSearch :: ~CSyncPathSearch( void )
+{
+	g_PathQueue.EndSearch();
+	m_pMonster->m_fCanWaitForPath = m_fCanWaitForPath;
+}
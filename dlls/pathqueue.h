@@ -0,0 +1,115 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+#ifndef PATHQUEUE_H
+#define PATHQUEUE_H
+
+#define PATHQUEUE_SIZE		64
+#define PATHQUEUE_LIFETIME	0.5	// seconds a finished route can be handed out again
+#define PATHQUEUE_WAIT_LIFETIME	5.0	// seconds a finished route is kept for monsters still waiting on it, well past
+									// the slowest AI LOD think, in case a waiter dies before it comes back
+
+#define PATHREQ_FREE		0
+#define PATHREQ_PENDING		1
+#define PATHREQ_DONE		2
+
+//=========================================================
+// A node route somebody asked for. Routes only depend on
+// the nodes, hull and capabilities, so monsters that ask
+// for the same one share the request.
+//=========================================================
+typedef struct pathrequest_s
+{
+	int		iSrcNode;
+	int		iDestNode;
+	int		iHull;
+	int		afCapMask;
+
+	int		iState;				// PATHREQ_
+	int		iSerial;			// order requests were made in
+	float	flTime;				// when it finished
+	int		cWaiters;			// monsters that queued it and haven't picked it up yet
+
+	int		cPath;				// FindShortestPath's result, 0 if there's no path
+	int		iPath[ MAX_PATH_SIZE ];
+} pathrequest_t;
+
+//=========================================================
+// CPathQueue - spreads node route searches over frames.
+// Searches run while there's ai_pathbudget milliseconds
+// left this frame, the rest wait in the queue and the
+// monster asks again on its next think. 0 turns it off
+// and every search runs right away.
+//=========================================================
+class CPathQueue
+{
+public:
+	CPathQueue( void );
+
+	void	Clear( void );
+
+	// client.cpp -> StartFrame()
+	void	BeginFrame( void );
+
+	BOOL	FEnabled( void );
+	BOOL	FHaveBudget( void );
+
+	// Returns the request for this route, joining one that's already
+	// queued or finished if there is one. -1 if the queue is full.
+	int		Request( int iSrcNode, int iDestNode, int iHull, int afCapMask );
+
+	// NULL until the search has run
+	const pathrequest_t *Result( int iRequest );
+
+	// A monster that has to wait for the route holds a handle on it, so the
+	// result is kept until it comes back. Handles are 0 when not waiting.
+	void	Wait( int iRequest, int *pHandle );
+	void	Release( int *pHandle );
+
+	// Times a search that runs now against this frame's budget. Nested
+	// calls are only counted once.
+	void	BeginSearch( void );
+	void	EndSearch( void );
+
+private:
+	void	Solve( pathrequest_t *pRequest );
+
+	pathrequest_t	m_requests[ PATHQUEUE_SIZE ];
+	int		m_iSerial;
+
+	double	m_flSpent;			// milliseconds searched this frame
+	double	m_flSearchStart;
+	int		m_cSearchDepth;
+};
+
+extern CPathQueue g_PathQueue;
+
+//=========================================================
+// CSyncPathSearch - for the searches that try many routes
+// and need the answers right away (FindCover and the
+// like). Charges them to the budget, and keeps the routes
+// they try from being queued.
+//=========================================================
+class CSyncPathSearch
+{
+public:
+	CSyncPathSearch( CBaseMonster *pMonster );
+	~CSyncPathSearch( void );
+
+private:
+	CBaseMonster	*m_pMonster;
+	BOOL			m_fCanWaitForPath;
+};
+
+#endif // PATHQUEUE_H
@@ -0,0 +1,149 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+//=========================================================
+// perception.cpp - shared line of sight checks for Look()
+//=========================================================
+
+#include	"extdll.h"
+#include	"util.h"
+#include	"cbase.h"
+#include	"game.h"
+#include	"perception.h"
+
+CPerception g_Perception;
+
+CPerception :: CPerception( void )
+{
+	m_iTraces = 0;
+}
+
+void CPerception :: Clear( void )
+{
+	m_sightCache.clear();
+	m_iTraces = 0;
+}
+
+//=========================================================
+// BeginFrame - publishes last frame's trace count and
+// drops results that are too old to be used again
+//=========================================================
+void CPerception :: BeginFrame( void )
+{
+	if ( ai_sighttraces.value != m_iTraces )
+		g_engfuncs.pfnCvar_DirectSet( &ai_sighttraces, UTIL_VarArgs( "%i", m_iTraces ) );
+
+	m_iTraces = 0;
+
+	float flLifetime = max( ai_sightcache.value, 0 );
+
+	std::unordered_map<unsigned int, sightentry_t>::iterator it = m_sightCache.begin();
+	while ( it != m_sightCache.end() )
+	{
+		if ( gpGlobals->time - it->second.flTime > flLifetime || it->second.flTime > gpGlobals->time )
+			it = m_sightCache.erase( it );
+		else
+			++it;
+	}
+}
+
+BOOL CPerception :: TraceSight( CBaseEntity *pLooker, const Vector &vecLooker, const Vector &vecTarget )
+{
+	TraceResult tr;
+
+	UTIL_TraceLine( vecLooker, vecTarget, ignore_monsters, ignore_glass, pLooker->edict(), &tr );
+	m_iTraces++;
+
+	return ( tr.flFraction == 1.0 );
+}
+
+//=========================================================
+// FVisible - CBaseEntity::FVisible, but the trace between
+// two eyes is shared with the other entity's check of us.
+// With ai_sightcache at 0 a result is only reused for the
+// same eye positions in the same frame, so nothing changes.
+//=========================================================
+BOOL CPerception :: FVisible( CBaseEntity *pLooker, CBaseEntity *pTarget )
+{
+	entvars_t *pevLooker = pLooker->pev;
+	entvars_t *pevTarget = pTarget->pev;
+
+	if ( FBitSet( pevTarget->flags, FL_NOTARGET ) )
+		return FALSE;
+
+	// don't look through water
+	if ( ( pevLooker->waterlevel != 3 && pevTarget->waterlevel == 3 ) 
+		|| ( pevLooker->waterlevel == 3 && pevTarget->waterlevel == 0 ) )
+		return FALSE;
+
+	Vector vecLookerOrigin = pevLooker->origin + pevLooker->view_ofs;
+	Vector vecTargetOrigin = pTarget->EyePosition();
+
+	// ignore_monsters still hits brush entities, so the ignored entity only
+	// stops mattering, and the trace only turns symmetric, if neither is one
+	if ( pevLooker->solid == SOLID_BSP || pevTarget->solid == SOLID_BSP )
+		return TraceSight( pLooker, vecLookerOrigin, vecTargetOrigin );
+
+	edict_t *pentLooker = pLooker->edict();
+	edict_t *pentTarget = pTarget->edict();
+	int iLooker = ENTINDEX( pentLooker );
+	int iTarget = ENTINDEX( pentTarget );
+
+	edict_t *pentLo, *pentHi;
+	Vector vecLo, vecHi;
+
+	if ( iLooker < iTarget )
+	{
+		pentLo = pentLooker; vecLo = vecLookerOrigin;
+		pentHi = pentTarget; vecHi = vecTargetOrigin;
+	}
+	else
+	{
+		pentLo = pentTarget; vecLo = vecTargetOrigin;
+		pentHi = pentLooker; vecHi = vecLookerOrigin;
+	}
+
+	unsigned int key = ( (unsigned int)ENTINDEX( pentLo ) << 16 ) | (unsigned int)ENTINDEX( pentHi );
+
+	std::unordered_map<unsigned int, sightentry_t>::iterator it = m_sightCache.find( key );
+	if ( it != m_sightCache.end() )
+	{
+		const sightentry_t &entry = it->second;
+
+		BOOL fSame = ( entry.serialLo == pentLo->serialnumber && entry.serialHi == pentHi->serialnumber );
+
+		if ( fSame )
+		{
+			if ( ai_sightcache.value > 0 )
+				fSame = ( gpGlobals->time - entry.flTime <= ai_sightcache.value );
+			else
+				fSame = ( entry.flTime == gpGlobals->time && entry.vecEyeLo == vecLo && entry.vecEyeHi == vecHi );
+		}
+
+		if ( fSame )
+			return entry.fVisible;
+	}
+
+	sightentry_t entry;
+	entry.vecEyeLo = vecLo;
+	entry.vecEyeHi = vecHi;
+	entry.serialLo = pentLo->serialnumber;
+	entry.serialHi = pentHi->serialnumber;
+	entry.flTime = gpGlobals->time;
+	entry.fVisible = TraceSight( pLooker, vecLookerOrigin, vecTargetOrigin );
+
+	m_sightCache[key] = entry;
+
+	return entry.fVisible;
+}
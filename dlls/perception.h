@@ -0,0 +1,63 @@
+/***
+*
+*	Copyright (c) 1996-2002, Valve LLC. All rights reserved.
+*	
+*	This product contains software technology licensed from Id 
+*	Software, Inc. ("Id Technology").  Id Technology (c) 1996 Id Software, Inc. 
+*	All Rights Reserved.
+*
+*   Use, distribution, and modification of this source code and/or resulting
+*   object code is restricted to non-commercial enhancements to products from
+*   Valve LLC.  All other use, distribution, or modification is prohibited
+*   without written permission from Valve LLC.
+*
+****/
+#ifndef PERCEPTION_H
+#define PERCEPTION_H
+
+#include <unordered_map>
+
+//=========================================================
+// Line of sight result between two entities' eyes. The
+// trace is the same in both directions, so it's stored once
+// per pair, under the lower entity index.
+//=========================================================
+typedef struct sightentry_s
+{
+	Vector	vecEyeLo;		// eye of the lower index entity when traced
+	Vector	vecEyeHi;
+	int		serialLo;		// edict serial numbers, in case a slot got reused
+	int		serialHi;
+	float	flTime;
+	BOOL	fVisible;
+} sightentry_t;
+
+//=========================================================
+// CPerception - shares the eye to eye traces monsters run
+// in Look() for the rest of the server frame, or for
+// ai_sightcache seconds when that's set
+//=========================================================
+class CPerception
+{
+public:
+	CPerception( void );
+
+	void	Clear( void );
+
+	// client.cpp -> StartFrame()
+	void	BeginFrame( void );
+
+	// Same answer as pLooker->FVisible( pTarget )
+	BOOL	FVisible( CBaseEntity *pLooker, CBaseEntity *pTarget );
+
+private:
+	BOOL	TraceSight( CBaseEntity *pLooker, const Vector &vecLooker, const Vector &vecTarget );
+
+	std::unordered_map<unsigned int, sightentry_t> m_sightCache;
+
+	int		m_iTraces;			// traced this frame, shown in ai_sighttraces
+};
+
+extern CPerception g_Perception;
+
+#endif // PERCEPTION_H
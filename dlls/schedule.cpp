@@ -209,6 +209,7 @@ void CBaseMonster :: MaintainSchedule ( void )
 {
 	Schedule_t	*pNewSchedule;
 	int			i;
+	BOOL		fWaitingForPath = FALSE;
 
 	// UNDONE: Tune/fix this 10... This is just here so infinite loops are impossible
 	for ( i = 0; i < 10; i++ )
@@ -270,7 +271,22 @@ void CBaseMonster :: MaintainSchedule ( void )
 			Task_t *pTask = GetTask();
 			ASSERT( pTask != NULL );
 			TaskBegin();
+
+			// path tasks may queue their route in g_PathQueue rather than search it now
+			m_fCanWaitForPath = TRUE;
 			StartTask( pTask );
+			m_fCanWaitForPath = FALSE;
+
+			if ( m_fWaitingForPath )
+			{
+				// the route isn't ready, so the task didn't really fail. Start it
+				// over on the next think, by then the search should have run.
+				m_fWaitingForPath = FALSE;
+				fWaitingForPath = TRUE;
+				ClearConditions( bits_COND_TASK_FAILED );
+				m_iTaskStatus = TASKSTATUS_NEW;
+				break;
+			}
 		}
 
 		// UNDONE: Twice?!!!
@@ -283,7 +299,7 @@ void CBaseMonster :: MaintainSchedule ( void )
 			break;
 	}
 
-	if ( TaskIsRunning() )
+	if ( !fWaitingForPath && TaskIsRunning() )
 	{
 		Task_t *pTask = GetTask();
 		ASSERT( pTask != NULL );
@@ -30,6 +30,7 @@
 #include "player.h"
 #include "weapons.h"
 #include "gamerules.h"
+#include "entitygrid.h"
 #include "UserMessages.h"
 #include <cstdlib>
 #include <stdlib.h>
@@ -403,17 +404,22 @@ void UTIL_MoveToOrigin( edict_t *pent, const Vector &vecGoal, float flDist, int
 
 int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, const Vector &maxs, int flagMask )
 {
-	edict_t		*pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+	edict_t		*pEdict;
 	CBaseEntity *pEntity;
 	int			count;
+	const int	*pIndices;
 
 	count = 0;
 
-	if ( !pEdict )
-		return count;
+	// Only the entities linked near the box, in edict order
+	int numIndices = g_EntityGrid.Query( mins, maxs, flagMask, &pIndices );
 
-	for ( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
+	for ( int i = 0; i < numIndices; i++ )
 	{
+		pEdict = INDEXENT( pIndices[i] );
+		if ( !pEdict )
+			continue;
+
 		if ( pEdict->free )	// Not in use
 			continue;
 		
@@ -445,19 +451,24 @@ int UTIL_EntitiesInBox( CBaseEntity **pList, int listMax, const Vector &mins, co
 
 int UTIL_MonstersInSphere( CBaseEntity **pList, int listMax, const Vector &center, float radius )
 {
-	edict_t		*pEdict = g_engfuncs.pfnPEntityOfEntIndex( 1 );
+	edict_t		*pEdict;
 	CBaseEntity *pEntity;
 	int			count;
 	float		distance, delta;
+	const int	*pIndices;
 
 	count = 0;
 	float radiusSquared = radius * radius;
 
-	if ( !pEdict )
-		return count;
+	Vector vecRadius( fabs( radius ), fabs( radius ), fabs( radius ) );
+	int numIndices = g_EntityGrid.Query( center - vecRadius, center + vecRadius, FL_CLIENT|FL_MONSTER, &pIndices );
 
-	for ( int i = 1; i < gpGlobals->maxEntities; i++, pEdict++ )
+	for ( int i = 0; i < numIndices; i++ )
 	{
+		pEdict = INDEXENT( pIndices[i] );
+		if ( !pEdict )
+			continue;
+
 		if ( pEdict->free )	// Not in use
 			continue;
 		
@@ -990,6 +1001,7 @@ TraceResult UTIL_GetGlobalTrace( )
 void UTIL_SetSize( entvars_t *pev, const Vector &vecMin, const Vector &vecMax )
 {
 	SET_SIZE( ENT(pev), vecMin, vecMax );
+	g_EntityGrid.Relink( ENT(pev) );
 }
 	
 	
@@ -1002,6 +1014,7 @@ float UTIL_VecToYaw( const Vector &vec )
 void UTIL_SetOrigin( entvars_t *pev, const Vector &vecOrigin )
 {
 	SET_ORIGIN(ENT(pev), vecOrigin );
+	g_EntityGrid.Relink( ENT(pev) );
 }
 
 void UTIL_ParticleEffect( const Vector &vecOrigin, const Vector &vecDirection, ULONG ulColor, ULONG ulCount )
@@ -33,6 +33,9 @@
 #include "weapons.h"
 #include "gamerules.h"
 #include "teamplay_gamerules.h"
+#include "entitygrid.h"
+#include "perception.h"
+#include "pathqueue.h"
 
 extern CGraph WorldGraph;
 extern CSoundEnt *pSoundEnt;
@@ -471,6 +474,9 @@ extern DLL_GLOBAL BOOL		g_fGameOver;
 void CWorld :: Spawn( void )
 {
 	g_fGameOver = FALSE;
+	g_EntityGrid.Clear();
+	g_Perception.Clear();
+	g_PathQueue.Clear();
 	Precache( );
 }
 
@@ -12,8 +12,8 @@
 #endif
 
 
-#include "vgui_label.h"
-#include "vgui_imagepanel.h"
+#include "VGUI_Label.h"
+#include "VGUI_ImagePanel.h"
 #include "vgui_defaultinputsignal.h"
 
 
@@ -12,7 +12,7 @@
 #endif
 
 
-#include "vgui_inputsignal.h"
+#include "VGUI_InputSignal.h"
 
 
 namespace vgui
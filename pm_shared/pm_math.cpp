@@ -426,6 +426,7 @@ SinCos
 */
 void SinCos(float radians, float* sine, float* cosine)
 {
+#ifdef _MSC_VER
 	_asm
 	{
 		fld	dword ptr[radians]
@@ -437,6 +438,10 @@ void SinCos(float radians, float* sine, float* cosine)
 					fstp dword ptr[edx]
 						fstp dword ptr[eax]
 	}
+#else
+	*sine = sin(radians);
+	*cosine = cos(radians);
+#endif
 }
 
 /*
@@ -0,0 +1,1859 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Offline node graph compiler
+//
+// Builds maps/graphs/<map>.nod from a compiled bsp, so the first load of
+// a map doesn't have to. Runs the same steps as CTestHull::BuildNodeGraph
+// in the game dll (drop, link, walk, inline rejection, sorting, hashing,
+// region, visibility and routing tables), but traces go straight against the bsp's
+// clipping hulls and the nodes are spread over worker threads. The file
+// has the layout FSaveGraph writes from the 32 bit dll.
+//
+// Usage: nodegraph <maps/map.bsp> [-o <map.nod>] [-threads n]
+//
+// Build, from this directory:
+//   cl /O2 /EHsc /I..\common nodegraph.cpp ..\common\bspfile.c
+//       ..\common\cmdlib.c ..\common\scriplib.c ..\common\mathlib.c
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// cmdlib's qboolean enum doesn't compile as C++
+#define _NOENUMQBOOL
+#include "cmdlib.h"
+#include "mathlib.h"
+extern "C"
+{
+#include "bspfile.h"
+}
+
+// Must match nodes.h / nodes.cpp in the game dll
+#define GRAPH_VERSION			17
+#define MAX_NODES				1024
+#define MAX_NODE_INITIAL_LINKS	128
+#define MAX_NODE_HULLS			4
+#define NODE_HEIGHT				8
+#define HULL_STEP_SIZE			16
+#define NUM_RANGES				256
+#define CACHE_SIZE				128
+
+#define bits_NODE_LAND			( 1 << 0 )
+#define bits_NODE_AIR			( 1 << 1 )
+#define bits_NODE_WATER			( 1 << 2 )
+#define bits_NODE_GROUP_REALM	( bits_NODE_LAND | bits_NODE_AIR | bits_NODE_WATER )
+
+#define bits_LINK_SMALL_HULL	( 1 << 0 )
+#define bits_LINK_HUMAN_HULL	( 1 << 1 )
+#define bits_LINK_LARGE_HULL	( 1 << 2 )
+#define bits_LINK_FLY_HULL		( 1 << 3 )
+
+#define NODE_SMALL_HULL			0
+#define NODE_HUMAN_HULL			1
+#define NODE_LARGE_HULL			2
+#define NODE_FLY_HULL			3
+
+#define ROUTE_LINK_COST			1.0f
+
+// Engine movement constants
+#define STEPSIZE				18
+#define DIST_EPSILON			0.03125f
+
+/*
+====================
+On disk structures
+
+CNode, CLink, DIST_INFO and CGraph as FSaveGraph writes them
+from the Win32 dll, with pointers as 32 bit fields so this
+builds the same file on any platform.
+====================
+*/
+struct nodefile_node_t
+{
+	float	origin[3];
+	float	originpeek[3];
+	byte	region[3];
+	int		nodeinfo;
+
+	int		numlinks;
+	int		firstlink;
+
+	int		nextbestnode[MAX_NODE_HULLS][2];
+
+	float	closestsofar;
+	int		previousnode;
+
+	short	hinttype;
+	short	hintactivity;
+	float	hintyaw;
+};
+
+struct nodefile_link_t
+{
+	int		srcnode;
+	int		destnode;
+	int		linkent;			// entvars_t *, only tested for NULL on load. Here it's
+								// the index into g_brushents + 1.
+	char	linkentmodel[4];	// not NULL terminated
+	int		linkinfo;
+	float	weight;
+};
+
+struct nodefile_distinfo_t
+{
+	int		sortedby[3];
+	int		checkedevent;
+};
+
+struct nodefile_cacheentry_t
+{
+	float	v[3];
+	short	n;
+};
+
+struct nodefile_graph_t
+{
+	int		graphpresent;
+	int		graphpointersset;
+	int		routingcomplete;
+
+	int		pnodes;
+	int		plinkpool;
+	int		prouteinfo;
+
+	int		numnodes;
+	int		numlinks;
+	int		numrouteinfo;
+
+	int		pdi;
+	int		rangestart[3][NUM_RANGES];
+	int		rangeend[3][NUM_RANGES];
+	float	shortest;
+	int		nearest;
+	int		minX, minY, minZ, maxX, maxY, maxZ;
+	int		minBoxX, minBoxY, minBoxZ, maxBoxX, maxBoxY, maxBoxZ;
+	int		checkedcounter;
+	float	regionmin[3], regionmax[3];
+	nodefile_cacheentry_t	cache[CACHE_SIZE];
+
+	int		hashprimes[16];
+	int		phashlinks;
+	int		numhashlinks;
+
+	int		pvisbits;
+	int		numvisbits;
+
+	int		lastactiveidlesearch;
+	int		lastcoversearch;
+};
+
+static_assert( sizeof( nodefile_node_t ) == 88, "CNode layout changed" );
+static_assert( sizeof( nodefile_link_t ) == 24, "CLink layout changed" );
+static_assert( sizeof( nodefile_distinfo_t ) == 16, "DIST_INFO layout changed" );
+static_assert( sizeof( nodefile_graph_t ) == 8404, "CGraph layout changed" );
+
+/*
+====================
+Collision
+
+The world and the solid brush entities, traced the way the
+engine's SV_Move does it. Brush entities are taken where the
+bsp puts them, which is where they spawn.
+====================
+*/
+struct hull_t
+{
+	dclipnode_t*	clipnodes;
+	int				firstclipnode;
+	vec3_t			clip_mins;
+	vec3_t			clip_maxs;
+};
+
+struct trace_t
+{
+	bool	allsolid;
+	bool	startsolid;
+	bool	inopen;
+	bool	inwater;
+	float	fraction;
+	vec3_t	endpos;
+	int		ent;		// ENT_NONE, ENT_WORLD, or index into g_brushents
+};
+
+#define ENT_NONE	-2
+#define ENT_WORLD	-1
+
+struct brushent_t
+{
+	int		model;
+	vec3_t	origin;
+	vec3_t	absmin;
+	vec3_t	absmax;
+	char	szModel[8];
+	bool	solid;
+	int		contents;		// func_water and friends, CONTENTS_EMPTY if none
+	bool	usable[2];		// HandleLinkEnt for a static query, without and with door caps
+};
+
+struct brushclass_t
+{
+	const char*	classname;
+	int			notsolidflags;	// not solid if any of these are set
+	int			solidflags;		// if non-zero, only solid if one of these is set
+};
+
+// Brush entities that spawn SOLID_BSP, and the spawnflags that change that
+static const brushclass_t g_brushclasses[] =
+{
+	{ "func_wall",				0,		0 },
+	{ "func_wall_toggle",		1,		0 },	// SF_WALL_START_OFF
+	{ "func_conveyor",			2,		0 },	// SF_CONVEYOR_NOTSOLID
+	{ "func_door",				8,		0 },	// SF_DOOR_PASSABLE
+	{ "func_door_rotating",		8,		0 },
+	{ "func_water",				8,		0 },
+	{ "momentary_door",			8,		0 },
+	{ "func_pendulum",			8,		0 },
+	{ "func_rotating",			64,		0 },	// SF_ROTATING_NOT_SOLID
+	{ "func_breakable",			0,		0 },
+	{ "func_pushable",			0,		0 },
+	{ "func_button",			0,		0 },
+	{ "func_rot_button",		1,		0 },	// SF_ROTBUTTON_NOTSOLID
+	{ "momentary_rot_button",	0,		1 },	// SF_MOMENTARY_DOOR
+	{ "func_plat",				0,		0 },
+	{ "func_platrot",			0,		0 },
+	{ "func_train",				0,		0 },
+	{ "func_tracktrain",		0,		0 },
+	{ "func_trackchange",		0,		0 },
+	{ "func_trackautochange",	0,		0 },
+	{ "func_guntarget",			0,		0 },
+	{ "func_tank",				0,		0 },
+	{ "func_tanklaser",			0,		0 },
+	{ "func_tankrocket",		0,		0 },
+	{ "func_tankmortar",		0,		0 },
+	{ "func_recharge",			0,		0 },
+	{ "func_healthcharger",		0,		0 },
+	{ NULL,						0,		0 }
+};
+
+static hull_t					g_hulls[MAX_MAP_HULLS];
+static std::vector<dclipnode_t>	g_hull0clipnodes;
+static std::vector<brushent_t>	g_brushents;
+
+/*
+====================
+Graph being built
+====================
+*/
+struct buildnode_t
+{
+	nodefile_node_t					node;
+	std::vector<nodefile_link_t>	links;
+	int								badnode;	// more than MAX_NODE_INITIAL_LINKS
+};
+
+static std::vector<buildnode_t>	g_buildnodes;
+
+static nodefile_graph_t					g_graph;
+static std::vector<nodefile_node_t>		g_nodes;
+static std::vector<nodefile_link_t>		g_links;
+static std::vector<nodefile_distinfo_t>	g_di;
+static std::vector<short>				g_hashlinks;
+static std::vector<unsigned int>		g_visbits;
+static std::string						g_routeinfo;
+
+static int g_numthreads;
+
+/*
+====================
+MakeHulls
+
+Same clip boxes as the engine. Hull 0 is made out of the
+drawing nodes, like Mod_MakeHull0.
+====================
+*/
+static void MakeHulls( void )
+{
+	static const float hullmins[MAX_MAP_HULLS][3] = { { 0, 0, 0 }, { -16, -16, -36 }, { -32, -32, -32 }, { -16, -16, -18 } };
+	static const float hullmaxs[MAX_MAP_HULLS][3] = { { 0, 0, 0 }, { 16, 16, 36 }, { 32, 32, 32 }, { 16, 16, 18 } };
+
+	g_hull0clipnodes.resize(numnodes > 0 ? numnodes : 1);
+	for (int i = 0; i < numnodes; i++)
+	{
+		g_hull0clipnodes[i].planenum = dnodes[i].planenum;
+		for (int j = 0; j < 2; j++)
+		{
+			int child = dnodes[i].children[j];
+			if (child < 0)
+				g_hull0clipnodes[i].children[j] = dleafs[-1 - child].contents;
+			else
+				g_hull0clipnodes[i].children[j] = child;
+		}
+	}
+
+	for (int h = 0; h < MAX_MAP_HULLS; h++)
+	{
+		g_hulls[h].clipnodes = (h == 0) ? &g_hull0clipnodes[0] : dclipnodes;
+		g_hulls[h].firstclipnode = 0;
+		VectorCopy(hullmins[h], g_hulls[h].clip_mins);
+		VectorCopy(hullmaxs[h], g_hulls[h].clip_maxs);
+	}
+}
+
+/*
+====================
+HullForBox
+
+Picks the clip hull for a box the way SV_HullForBsp does
+====================
+*/
+static int HullForBox( const vec3_t mins, const vec3_t maxs )
+{
+	vec3_t size;
+	VectorSubtract(maxs, mins, size);
+
+	if (size[0] <= 8)
+		return 0;
+
+	if (size[0] <= 36)
+	{
+		if (size[2] <= 36)
+			return 3;
+
+		return 1;
+	}
+
+	return 2;
+}
+
+/*
+====================
+HullPointContents
+
+====================
+*/
+static int HullPointContents( const hull_t* hull, int num, const vec3_t p )
+{
+	while (num >= 0)
+	{
+		const dclipnode_t* node = &hull->clipnodes[num];
+		const dplane_t* plane = &dplanes[node->planenum];
+
+		float d;
+		if (plane->type < 3)
+			d = p[plane->type] - plane->dist;
+		else
+			d = DotProduct(plane->normal, p) - plane->dist;
+
+		num = (d < 0) ? node->children[1] : node->children[0];
+	}
+
+	return num;
+}
+
+/*
+====================
+RecursiveHullCheck
+
+Returns false once the trace has hit something
+====================
+*/
+static bool RecursiveHullCheck( const hull_t* hull, int num, float p1f, float p2f, const vec3_t p1, const vec3_t p2, trace_t* trace )
+{
+	if (num < 0)
+	{
+		if (num != CONTENTS_SOLID)
+		{
+			trace->allsolid = false;
+			if (num == CONTENTS_EMPTY)
+				trace->inopen = true;
+			else if (num != CONTENTS_TRANSLUCENT)
+				trace->inwater = true;
+		}
+		else
+		{
+			trace->startsolid = true;
+		}
+
+		return true;
+	}
+
+	const dclipnode_t* node = &hull->clipnodes[num];
+	const dplane_t* plane = &dplanes[node->planenum];
+
+	float t1, t2;
+	if (plane->type < 3)
+	{
+		t1 = p1[plane->type] - plane->dist;
+		t2 = p2[plane->type] - plane->dist;
+	}
+	else
+	{
+		t1 = DotProduct(plane->normal, p1) - plane->dist;
+		t2 = DotProduct(plane->normal, p2) - plane->dist;
+	}
+
+	if (t1 >= 0 && t2 >= 0)
+		return RecursiveHullCheck(hull, node->children[0], p1f, p2f, p1, p2, trace);
+	if (t1 < 0 && t2 < 0)
+		return RecursiveHullCheck(hull, node->children[1], p1f, p2f, p1, p2, trace);
+
+	// put the crosspoint DIST_EPSILON pixels on the near side
+	float frac;
+	if (t1 < 0)
+		frac = (t1 + DIST_EPSILON) / (t1 - t2);
+	else
+		frac = (t1 - DIST_EPSILON) / (t1 - t2);
+
+	if (frac < 0)
+		frac = 0;
+	if (frac > 1)
+		frac = 1;
+
+	float midf = p1f + (p2f - p1f) * frac;
+	vec3_t mid;
+	for (int i = 0; i < 3; i++)
+		mid[i] = p1[i] + frac * (p2[i] - p1[i]);
+
+	int side = (t1 < 0);
+
+	// move up to the node
+	if (!RecursiveHullCheck(hull, node->children[side], p1f, midf, p1, mid, trace))
+		return false;
+
+	if (HullPointContents(hull, node->children[side ^ 1], mid) != CONTENTS_SOLID)
+	{
+		// go past the node
+		return RecursiveHullCheck(hull, node->children[side ^ 1], midf, p2f, mid, p2, trace);
+	}
+
+	if (trace->allsolid)
+		return false;	// never got out of the solid area
+
+	// the other side of the node is solid, this is the impact point.
+	// Back off until the point is out of the solid.
+	while (HullPointContents(hull, hull->firstclipnode, mid) == CONTENTS_SOLID)
+	{
+		frac -= 0.1f;
+		if (frac < 0)
+		{
+			trace->fraction = midf;
+			VectorCopy(mid, trace->endpos);
+			return false;
+		}
+
+		midf = p1f + (p2f - p1f) * frac;
+		for (int i = 0; i < 3; i++)
+			mid[i] = p1[i] + frac * (p2[i] - p1[i]);
+	}
+
+	trace->fraction = midf;
+	VectorCopy(mid, trace->endpos);
+	return false;
+}
+
+/*
+====================
+ClipMoveToModel
+
+====================
+*/
+static trace_t ClipMoveToModel( int model, const vec3_t origin, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end )
+{
+	int h = HullForBox(mins, maxs);
+
+	hull_t hull = g_hulls[h];
+	hull.firstclipnode = dmodels[model].headnode[h];
+
+	vec3_t offset, startl, endl;
+	for (int i = 0; i < 3; i++)
+	{
+		offset[i] = hull.clip_mins[i] - mins[i] + origin[i];
+		startl[i] = start[i] - offset[i];
+		endl[i] = end[i] - offset[i];
+	}
+
+	trace_t trace;
+	memset(&trace, 0, sizeof(trace));
+	trace.fraction = 1;
+	trace.allsolid = true;
+	trace.ent = ENT_NONE;
+	VectorCopy(end, trace.endpos);
+
+	RecursiveHullCheck(&hull, hull.firstclipnode, 0, 1, startl, endl, &trace);
+
+	if (trace.fraction != 1)
+		VectorAdd(trace.endpos, offset, trace.endpos);
+
+	return trace;
+}
+
+/*
+====================
+Move
+
+SV_Move for a box, against the world and, unless fWorldOnly,
+the solid brush entities. Monsters aren't around yet.
+====================
+*/
+static trace_t Move( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, bool fWorldOnly )
+{
+	trace_t trace = ClipMoveToModel(0, vec3_origin, start, mins, maxs, end);
+	if (trace.fraction < 1 || trace.startsolid)
+		trace.ent = ENT_WORLD;
+
+	if (fWorldOnly)
+		return trace;
+
+	vec3_t boxmins, boxmaxs;
+	for (int i = 0; i < 3; i++)
+	{
+		boxmins[i] = ((start[i] < end[i]) ? start[i] : end[i]) + mins[i] - 1;
+		boxmaxs[i] = ((start[i] > end[i]) ? start[i] : end[i]) + maxs[i] + 1;
+	}
+
+	for (size_t e = 0; e < g_brushents.size(); e++)
+	{
+		const brushent_t& ent = g_brushents[e];
+		if (!ent.solid)
+			continue;
+
+		if (trace.allsolid)
+			break;
+
+		if (boxmins[0] > ent.absmax[0] || boxmins[1] > ent.absmax[1] || boxmins[2] > ent.absmax[2] ||
+			boxmaxs[0] < ent.absmin[0] || boxmaxs[1] < ent.absmin[1] || boxmaxs[2] < ent.absmin[2])
+			continue;
+
+		trace_t enttrace = ClipMoveToModel(ent.model, ent.origin, start, mins, maxs, end);
+
+		if (enttrace.allsolid || enttrace.startsolid || enttrace.fraction < trace.fraction)
+		{
+			enttrace.ent = (int)e;
+			if (trace.startsolid)
+			{
+				trace = enttrace;
+				trace.startsolid = true;
+			}
+			else
+			{
+				trace = enttrace;
+			}
+		}
+		else if (enttrace.startsolid)
+		{
+			trace.startsolid = true;
+		}
+	}
+
+	return trace;
+}
+
+/*
+====================
+TraceLine
+
+====================
+*/
+static trace_t TraceLine( const vec3_t start, const vec3_t end )
+{
+	return Move(start, vec3_origin, vec3_origin, end, false);
+}
+
+/*
+====================
+PointContents
+
+UTIL_PointContents, currents count as water and water brush
+entities are checked when the world is empty
+====================
+*/
+static int PointContents( const vec3_t p )
+{
+	int contents = HullPointContents(&g_hulls[0], dmodels[0].headnode[0], p);
+
+	if (contents <= CONTENTS_CURRENT_0 && contents >= CONTENTS_CURRENT_DOWN)
+		return CONTENTS_WATER;
+
+	if (contents != CONTENTS_EMPTY)
+		return contents;
+
+	for (size_t e = 0; e < g_brushents.size(); e++)
+	{
+		const brushent_t& ent = g_brushents[e];
+		if (ent.contents == CONTENTS_EMPTY)
+			continue;
+
+		if (p[0] < ent.absmin[0] || p[1] < ent.absmin[1] || p[2] < ent.absmin[2] ||
+			p[0] > ent.absmax[0] || p[1] > ent.absmax[1] || p[2] > ent.absmax[2])
+			continue;
+
+		vec3_t local;
+		VectorSubtract(p, ent.origin, local);
+
+		if (HullPointContents(&g_hulls[0], dmodels[ent.model].headnode[0], local) != CONTENTS_EMPTY)
+			return ent.contents;
+	}
+
+	return CONTENTS_EMPTY;
+}
+
+/*
+====================
+Walk hull
+
+The test hull that CTestHull walks between nodes with
+WALK_MOVE, stepping up and down stairs like SV_movestep.
+====================
+*/
+struct walkhull_t
+{
+	vec3_t	origin;
+	vec3_t	mins;
+	vec3_t	maxs;
+	bool	swim;
+};
+
+/*
+====================
+CheckBottom
+
+SV_CheckBottom, is there ground under most of the hull
+====================
+*/
+static bool CheckBottom( const walkhull_t* pwalk, bool fWorldOnly )
+{
+	vec3_t mins, maxs, start, stop;
+	VectorAdd(pwalk->origin, pwalk->mins, mins);
+	VectorAdd(pwalk->origin, pwalk->maxs, maxs);
+
+	// quick test, if all the corners are over solid it's fine
+	start[2] = mins[2] - 1;
+	bool fAllSolid = true;
+	for (int x = 0; x <= 1 && fAllSolid; x++)
+	{
+		for (int y = 0; y <= 1 && fAllSolid; y++)
+		{
+			start[0] = x ? maxs[0] : mins[0];
+			start[1] = y ? maxs[1] : mins[1];
+			if (PointContents(start) != CONTENTS_SOLID)
+				fAllSolid = false;
+		}
+	}
+
+	if (fAllSolid)
+		return true;
+
+	// check it for real, the middle has to be on ground
+	// and no corner can be more than a step below it
+	start[2] = mins[2];
+	start[0] = stop[0] = (mins[0] + maxs[0]) * 0.5f;
+	start[1] = stop[1] = (mins[1] + maxs[1]) * 0.5f;
+	stop[2] = start[2] - 2 * STEPSIZE;
+
+	trace_t trace = Move(start, vec3_origin, vec3_origin, stop, fWorldOnly);
+	if (trace.fraction == 1)
+		return false;
+
+	float mid = trace.endpos[2];
+
+	for (int x = 0; x <= 1; x++)
+	{
+		for (int y = 0; y <= 1; y++)
+		{
+			start[0] = stop[0] = x ? maxs[0] : mins[0];
+			start[1] = stop[1] = y ? maxs[1] : mins[1];
+
+			trace = Move(start, vec3_origin, vec3_origin, stop, fWorldOnly);
+			if (trace.fraction == 1 || mid - trace.endpos[2] > STEPSIZE)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+====================
+MoveStep
+
+SV_movestep without an enemy, returns false if the hull
+couldn't make the move and leaves it where it was
+====================
+*/
+static bool MoveStep( walkhull_t* pwalk, const vec3_t move, bool fWorldOnly )
+{
+	vec3_t neworg, end;
+	VectorAdd(pwalk->origin, move, neworg);
+
+	if (pwalk->swim)
+	{
+		trace_t trace = Move(pwalk->origin, pwalk->mins, pwalk->maxs, neworg, fWorldOnly);
+		if (trace.fraction != 1)
+			return false;
+
+		if (PointContents(trace.endpos) == CONTENTS_EMPTY)
+			return false;	// swimmers don't leave the water
+
+		VectorCopy(trace.endpos, pwalk->origin);
+		return true;
+	}
+
+	// push down from a step height above the wished position
+	neworg[2] += STEPSIZE;
+	VectorCopy(neworg, end);
+	end[2] -= STEPSIZE * 2;
+
+	trace_t trace = Move(neworg, pwalk->mins, pwalk->maxs, end, fWorldOnly);
+	if (trace.allsolid)
+		return false;
+
+	if (trace.startsolid)
+	{
+		neworg[2] -= STEPSIZE;
+		trace = Move(neworg, pwalk->mins, pwalk->maxs, end, fWorldOnly);
+		if (trace.allsolid || trace.startsolid)
+			return false;
+	}
+
+	// walked off an edge
+	if (trace.fraction == 1)
+		return false;
+
+	vec3_t oldorg;
+	VectorCopy(pwalk->origin, oldorg);
+	VectorCopy(trace.endpos, pwalk->origin);
+
+	if (!CheckBottom(pwalk, fWorldOnly))
+	{
+		VectorCopy(oldorg, pwalk->origin);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+====================
+WalkMove
+
+WALK_MOVE
+====================
+*/
+static bool WalkMove( walkhull_t* pwalk, float yaw, float dist, bool fWorldOnly )
+{
+	yaw = yaw * Q_PI * 2 / 360;
+
+	vec3_t move;
+	move[0] = cos(yaw) * dist;
+	move[1] = sin(yaw) * dist;
+	move[2] = 0;
+
+	return MoveStep(pwalk, move, fWorldOnly);
+}
+
+/*
+====================
+RunWorkers
+
+Calls func once for every item, spread over g_numthreads
+====================
+*/
+static void RunWorkers( int count, void (*func)( int ) )
+{
+	std::atomic<int> next( 0 );
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < g_numthreads; t++)
+	{
+		threads.push_back(std::thread([&next, count, func]()
+		{
+			int i;
+			while ((i = next++) < count)
+				func(i);
+		}));
+	}
+
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+}
+
+/*
+====================
+LoadEntities
+
+Collects the nodes and brush entities, in spawn order
+====================
+*/
+static void LoadEntities( void )
+{
+	for (int i = 0; i < num_entities; i++)
+	{
+		entity_t* ent = &entities[i];
+		char* classname = ValueForKey(ent, "classname");
+
+		if (!strcmp(classname, "info_node") || !strcmp(classname, "info_node_air"))
+		{
+			if (g_buildnodes.size() >= MAX_NODES)
+			{
+				printf("WARNING: more than %d nodes, the rest are ignored\n", MAX_NODES);
+				continue;
+			}
+
+			buildnode_t bnode;
+			memset(&bnode.node, 0, sizeof(bnode.node));
+			bnode.badnode = 0;
+
+			GetVectorForKey(ent, "origin", bnode.node.origin);
+			VectorCopy(bnode.node.origin, bnode.node.originpeek);
+
+			vec3_t angles;
+			GetVectorForKey(ent, "angles", angles);
+			if (*ValueForKey(ent, "angle"))
+				angles[1] = FloatForKey(ent, "angle");
+
+			bnode.node.hintyaw = angles[1];
+			bnode.node.hinttype = (short)atoi(ValueForKey(ent, "hinttype"));
+			bnode.node.hintactivity = (short)atoi(ValueForKey(ent, "activity"));
+			bnode.node.nodeinfo = !strcmp(classname, "info_node_air") ? bits_NODE_AIR : 0;
+
+			g_buildnodes.push_back(bnode);
+			continue;
+		}
+
+		char* model = ValueForKey(ent, "model");
+		if (model[0] != '*')
+			continue;
+
+		int iModel = atoi(model + 1);
+		if (iModel <= 0 || iModel >= nummodels)
+			continue;
+
+		brushent_t bent;
+		memset(&bent, 0, sizeof(bent));
+		bent.model = iModel;
+		strncpy(bent.szModel, model, sizeof(bent.szModel) - 1);
+		GetVectorForKey(ent, "origin", bent.origin);
+
+		for (int j = 0; j < 3; j++)
+		{
+			bent.absmin[j] = dmodels[iModel].mins[j] + bent.origin[j] - 1;
+			bent.absmax[j] = dmodels[iModel].maxs[j] + bent.origin[j] + 1;
+		}
+
+		int spawnflags = atoi(ValueForKey(ent, "spawnflags"));
+		int skin = atoi(ValueForKey(ent, "skin"));
+
+		for (const brushclass_t* pclass = g_brushclasses; pclass->classname; pclass++)
+		{
+			if (strcmp(pclass->classname, classname))
+				continue;
+
+			bent.solid = !(spawnflags & pclass->notsolidflags) && (!pclass->solidflags || (spawnflags & pclass->solidflags));
+			break;
+		}
+
+		// special contents brushes aren't solid, they're water
+		bent.contents = CONTENTS_EMPTY;
+		if (skin < 0)
+		{
+			bent.solid = false;
+			bent.contents = skin;
+		}
+
+		// HandleLinkEnt with NODEGRAPH_STATIC: doors need bits_CAP_OPEN_DOORS,
+		// breakables are always worth a try, anything else blocks the link
+		if (!strcmp(classname, "func_door") || !strcmp(classname, "func_door_rotating"))
+		{
+			bent.usable[0] = false;
+			bent.usable[1] = true;
+		}
+		else if (!strcmp(classname, "func_breakable"))
+		{
+			bent.usable[0] = bent.usable[1] = true;
+		}
+
+		if (bent.solid || bent.contents != CONTENTS_EMPTY)
+			g_brushents.push_back(bent);
+	}
+}
+
+/*
+====================
+DropNodes
+
+Flags water nodes, and drops land nodes to the floor then
+lifts them NODE_HEIGHT so they link across bumps and stairs
+====================
+*/
+static void DropNodes( void )
+{
+	for (size_t i = 0; i < g_buildnodes.size(); i++)
+	{
+		nodefile_node_t* pnode = &g_buildnodes[i].node;
+
+		if (pnode->nodeinfo & bits_NODE_AIR)
+			continue;
+
+		if (PointContents(pnode->origin) == CONTENTS_WATER)
+		{
+			pnode->nodeinfo |= bits_NODE_WATER;
+			continue;
+		}
+
+		pnode->nodeinfo |= bits_NODE_LAND;
+
+		vec3_t end;
+		VectorCopy(pnode->origin, end);
+		end[2] -= 384;
+
+		trace_t trace = TraceLine(pnode->origin, end);
+
+		pnode->originpeek[2] = pnode->origin[2] = trace.endpos[2] + NODE_HEIGHT;
+	}
+}
+
+/*
+====================
+LinkVisibleNodes
+
+Links node i to every node in its realm it can see. A
+brush entity that's the only thing in the way becomes the
+link's entity.
+====================
+*/
+static void LinkVisibleNodes( int i )
+{
+	buildnode_t* psrc = &g_buildnodes[i];
+
+	for (int j = 0; j < (int)g_buildnodes.size(); j++)
+	{
+		if (j == i)
+			continue;
+
+		const buildnode_t* pdest = &g_buildnodes[j];
+
+		if ((psrc->node.nodeinfo & bits_NODE_GROUP_REALM) != (pdest->node.nodeinfo & bits_NODE_GROUP_REALM))
+			continue;
+
+		trace_t trace = TraceLine(psrc->node.origin, pdest->node.origin);
+		if (trace.startsolid)
+			continue;
+
+		nodefile_link_t link;
+		memset(&link, 0, sizeof(link));
+		link.srcnode = i;
+		link.destnode = j;
+
+		if (trace.fraction != 1.0)
+		{
+			// make sure the ent is the only thing in the way
+			int hitent = trace.ent;
+
+			trace = TraceLine(pdest->node.origin, psrc->node.origin);
+			if (trace.ent != hitent || hitent < 0)
+				continue;
+
+			link.linkent = hitent + 1;
+			memcpy(link.linkentmodel, g_brushents[hitent].szModel, 4);
+		}
+
+		psrc->links.push_back(link);
+
+		if (psrc->links.size() == MAX_NODE_INITIAL_LINKS)
+		{
+			psrc->badnode = 1;
+			return;
+		}
+	}
+}
+
+/*
+====================
+WalkLinks
+
+Walks each hull from node i to each of its links, and drops
+the links no hull can get through
+====================
+*/
+static void WalkLinks( int i )
+{
+	static const float hullmins[MAX_NODE_HULLS][3] = { { -12, -12, 0 }, { -16, -16, 0 }, { -32, -32, 0 }, { -32, -32, 0 } };
+	static const float hullmaxs[MAX_NODE_HULLS][3] = { { 12, 12, 24 }, { 16, 16, 72 }, { 32, 32, 64 }, { 32, 32, 64 } };
+
+	buildnode_t* psrc = &g_buildnodes[i];
+
+	for (int j = 0; j < (int)psrc->links.size(); j++)
+	{
+		nodefile_link_t* plink = &psrc->links[j];
+		const nodefile_node_t* pdest = &g_buildnodes[plink->destnode].node;
+
+		plink->linkinfo = bits_LINK_SMALL_HULL | bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL | bits_LINK_FLY_HULL;
+
+		bool fSkipRemainingHulls = false;
+		for (int hull = 0; hull < MAX_NODE_HULLS; hull++)
+		{
+			if (fSkipRemainingHulls && (hull == NODE_HUMAN_HULL || hull == NODE_LARGE_HULL))
+				continue;
+
+			if (hull == NODE_FLY_HULL)
+			{
+				// the fly hull is a large hull centered on the line
+				vec3_t start, end;
+				VectorCopy(psrc->node.origin, start);
+				VectorCopy(pdest->originpeek, end);
+				start[2] += 32;
+				end[2] += 32;
+
+				trace_t trace = Move(start, g_hulls[2].clip_mins, g_hulls[2].clip_maxs, end, false);
+				if (trace.startsolid || trace.fraction < 1.0)
+					plink->linkinfo &= ~bits_LINK_FLY_HULL;
+
+				continue;
+			}
+
+			walkhull_t walk;
+			VectorCopy(psrc->node.origin, walk.origin);
+			VectorCopy(hullmins[hull], walk.mins);
+			VectorCopy(hullmaxs[hull], walk.maxs);
+			walk.swim = (psrc->node.nodeinfo & bits_NODE_WATER) != 0;
+
+			// land walks only collide with the world
+			bool fWorldOnly = !walk.swim;
+
+			vec3_t delta;
+			VectorSubtract(pdest->origin, walk.origin, delta);
+
+			float yaw = 0;
+			if (delta[0] != 0 || delta[1] != 0)
+			{
+				yaw = atan2(delta[1], delta[0]) * 180 / Q_PI;
+				if (yaw < 0)
+					yaw += 360;
+			}
+
+			float dist = sqrt(delta[0] * delta[0] + delta[1] * delta[1]);
+
+			bool fWalkFailed = false;
+			for (int step = 0; step < dist && !fWalkFailed; step += HULL_STEP_SIZE)
+			{
+				float stepsize = HULL_STEP_SIZE;
+
+				if ((step + stepsize) >= (dist - 1))
+					stepsize = (dist - step) - 1;
+
+				if (!WalkMove(&walk, yaw, stepsize, fWorldOnly))
+					fWalkFailed = true;
+			}
+
+			if (!fWalkFailed)
+			{
+				VectorSubtract(walk.origin, pdest->origin, delta);
+				if (VectorLength(delta) > 64)
+					fWalkFailed = true;
+			}
+
+			if (fWalkFailed)
+			{
+				switch (hull)
+				{
+				case NODE_SMALL_HULL:	// if this hull can't fit, nothing can
+					plink->linkinfo &= ~(bits_LINK_SMALL_HULL | bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL);
+					fSkipRemainingHulls = true;
+					break;
+				case NODE_HUMAN_HULL:
+					plink->linkinfo &= ~(bits_LINK_HUMAN_HULL | bits_LINK_LARGE_HULL);
+					fSkipRemainingHulls = true;
+					break;
+				case NODE_LARGE_HULL:
+					plink->linkinfo &= ~bits_LINK_LARGE_HULL;
+					break;
+				}
+			}
+		}
+
+		if (plink->linkinfo == 0)
+		{
+			// same swap with the last link the game does
+			psrc->links[j] = psrc->links.back();
+			psrc->links.pop_back();
+			j--;
+		}
+	}
+}
+
+/*
+====================
+RejectInlineLinks
+
+Drops links that pass by (almost) straight through another
+of the node's neighbours, and sets the link weights
+====================
+*/
+static int RejectInlineLinks( int i )
+{
+	buildnode_t* psrc = &g_buildnodes[i];
+	int cRejected = 0;
+
+	for (int j = 0; j < (int)psrc->links.size(); j++)
+	{
+		const nodefile_node_t* pcheck = &g_buildnodes[psrc->links[j].destnode].node;
+
+		float checkdir[2] = { pcheck->origin[0] - psrc->node.origin[0], pcheck->origin[1] - psrc->node.origin[1] };
+		float checkdist = sqrt(checkdir[0] * checkdir[0] + checkdir[1] * checkdir[1]);
+		if (checkdist != 0)
+		{
+			checkdir[0] /= checkdist;
+			checkdir[1] /= checkdist;
+		}
+
+		psrc->links[j].weight = checkdist;
+
+		for (int k = 0; k < (int)psrc->links.size(); k++)
+		{
+			if (k == j)
+				continue;
+
+			const nodefile_node_t* ptest = &g_buildnodes[psrc->links[k].destnode].node;
+
+			float testdir[2] = { ptest->origin[0] - psrc->node.origin[0], ptest->origin[1] - psrc->node.origin[1] };
+			float testdist = sqrt(testdir[0] * testdir[0] + testdir[1] * testdir[1]);
+			if (testdist != 0)
+			{
+				testdir[0] /= testdist;
+				testdir[1] /= testdist;
+			}
+
+			if (checkdir[0] * testdir[0] + checkdir[1] * testdir[1] >= 0.998 && testdist < checkdist)
+			{
+				psrc->links[j] = psrc->links.back();
+				psrc->links.pop_back();
+				j--;
+
+				cRejected++;
+				break;
+			}
+		}
+	}
+
+	return cRejected;
+}
+
+/*
+====================
+SortNodes
+
+CGraph::SortNodes, renumbers the nodes so linked nodes have
+close numbers, which the routing table encoding relies on
+====================
+*/
+static void SortNodes( void )
+{
+	int numnodes = (int)g_nodes.size();
+	std::vector<int> newnumber(numnodes, -1);
+
+	int iNodeCnt = 0;
+	if (numnodes)
+		newnumber[0] = iNodeCnt++;
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		for (int j = 0; j < g_nodes[i].numlinks; j++)
+		{
+			int iDestNode = g_links[g_nodes[i].firstlink + j].destnode;
+			if (newnumber[iDestNode] == -1)
+				newnumber[iDestNode] = iNodeCnt++;
+		}
+	}
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		if (newnumber[i] == -1)
+			newnumber[i] = iNodeCnt++;
+	}
+
+	for (size_t i = 0; i < g_links.size(); i++)
+	{
+		g_links[i].srcnode = newnumber[g_links[i].srcnode];
+		g_links[i].destnode = newnumber[g_links[i].destnode];
+	}
+
+	std::vector<nodefile_node_t> sorted(numnodes);
+	for (int i = 0; i < numnodes; i++)
+		sorted[newnumber[i]] = g_nodes[i];
+
+	g_nodes.swap(sorted);
+
+	// the game leaves each node's new number in m_iPreviousNode
+	for (int i = 0; i < numnodes; i++)
+		g_nodes[i].previousnode = i;
+}
+
+/*
+====================
+NodePairHash
+
+CRC32 of a tagNodePair, same as the engine's CRC32 functions
+====================
+*/
+static unsigned int NodePairHash( int iSrcNode, int iDestNode )
+{
+	short np[2];
+	np[0] = (short)iSrcNode;
+	np[1] = (short)iDestNode;
+
+	unsigned int crc = 0xFFFFFFFF;
+	const byte* p = (const byte *)np;
+	for (int i = 0; i < (int)sizeof(np); i++)
+	{
+		crc ^= p[i];
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+
+	return crc ^ 0xFFFFFFFF;
+}
+
+/*
+====================
+HashChoosePrimes
+
+CGraph::HashChoosePrimes
+====================
+*/
+static void HashChoosePrimes( int TableSize )
+{
+	static const int Primes[] =
+	{ 1, 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+	71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151,
+	157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239,
+	241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337,
+	347, 349, 353, 359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433,
+	439, 443, 449, 457, 461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541,
+	547, 557, 563, 569, 571, 577, 587, 593, 599, 601, 607, 613, 617, 619, 631, 641,
+	643, 647, 653, 659, 661, 673, 677, 683, 691, 701, 709, 719, 727, 733, 739, 743,
+	751, 757, 761, 769, 773, 787, 797, 809, 811, 821, 823, 827, 829, 839, 853, 857,
+	859, 863, 877, 881, 883, 887, 907, 911, 919, 929, 937, 941, 947, 953, 967, 971,
+	977, 983, 991, 997, 1009, 1013, 1019, 1021, 1031, 1033, 1039, 0 };
+	const int NumPrimes = sizeof(Primes) / sizeof(Primes[0]);
+
+	int* HashPrimes = g_graph.hashprimes;
+
+	int LargestPrime = TableSize / 2;
+	if (LargestPrime > Primes[NumPrimes - 2])
+		LargestPrime = Primes[NumPrimes - 2];
+
+	int Spacing = LargestPrime / 16;
+
+	// one prime out of each of 16 zones between 0 and LargestPrime
+	int iPrime = 0;
+	for (int iZone = 1; iPrime < 16; iZone += Spacing)
+	{
+		int Lower = Primes[0];
+		for (int jPrime = 0; Primes[jPrime] != 0; jPrime++)
+		{
+			if (jPrime != 0 && TableSize % Primes[jPrime] == 0)
+				continue;
+
+			int Upper = Primes[jPrime];
+			if (Lower <= iZone && iZone <= Upper)
+			{
+				HashPrimes[iPrime++] = (iZone - Lower <= Upper - iZone) ? Lower : Upper;
+				break;
+			}
+			Lower = Upper;
+		}
+	}
+
+	// alternate negative and positive steps
+	for (iPrime = 0; iPrime < 16; iPrime += 2)
+		HashPrimes[iPrime] = TableSize - HashPrimes[iPrime];
+
+	// shuffle to reduce correlation with the bits in the key
+	for (iPrime = 0; iPrime < 16 - 1; iPrime++)
+	{
+		int Pick = rand() % (16 - iPrime);
+		int Temp = HashPrimes[Pick];
+		HashPrimes[Pick] = HashPrimes[15 - iPrime];
+		HashPrimes[15 - iPrime] = Temp;
+	}
+}
+
+/*
+====================
+BuildLinkLookups
+
+CGraph::BuildLinkLookups, the (src, dest) -> link hash
+HashSearch probes
+====================
+*/
+static void BuildLinkLookups( void )
+{
+	int numhashlinks = 3 * (int)g_links.size() / 2 + 3;
+
+	HashChoosePrimes(numhashlinks);
+	g_hashlinks.assign(numhashlinks, -1);
+
+	for (size_t i = 0; i < g_links.size(); i++)
+	{
+		unsigned int hash = NodePairHash(g_links[i].srcnode, g_links[i].destnode);
+
+		int di = g_graph.hashprimes[hash & 15];
+		int slot = (hash >> 4) % numhashlinks;
+		while (g_hashlinks[slot] != -1)
+		{
+			slot += di;
+			if (slot >= numhashlinks)
+				slot -= numhashlinks;
+		}
+
+		g_hashlinks[slot] = (short)i;
+	}
+
+	g_graph.numhashlinks = numhashlinks;
+}
+
+/*
+====================
+CountUnpairedLinks
+
+Links whose destination doesn't link back
+====================
+*/
+static int CountUnpairedLinks( void )
+{
+	int cUnpaired = 0;
+
+	for (size_t i = 0; i < g_links.size(); i++)
+	{
+		const nodefile_node_t* pdest = &g_nodes[g_links[i].destnode];
+
+		bool fFound = false;
+		for (int j = 0; j < pdest->numlinks && !fFound; j++)
+			fFound = (g_links[pdest->firstlink + j].destnode == g_links[i].srcnode);
+
+		if (!fFound)
+			cUnpaired++;
+	}
+
+	return cUnpaired;
+}
+
+/*
+====================
+BuildRegionTables
+
+CGraph::BuildRegionTables, for FindNearestNode
+====================
+*/
+static inline int CalcRange( int x, int lower, int upper )
+{
+	return NUM_RANGES * (x - lower) / ((upper - lower + 1));
+}
+
+static int RegionCode( const nodefile_node_t* pnode, int axis )
+{
+	int x = pnode->region[0];
+	int y = pnode->region[1];
+	int z = pnode->region[2];
+
+	switch (axis)
+	{
+	case 0:
+		return (x << 16) + (y << 8) + z;
+	case 1:
+		return (y << 16) + (z << 8) + x;
+	default:
+		return (z << 16) + (x << 8) + y;
+	}
+}
+
+static void BuildRegionTables( void )
+{
+	int numnodes = (int)g_nodes.size();
+
+	g_di.assign(numnodes, nodefile_distinfo_t());
+
+	for (int i = 0; i < 3; i++)
+	{
+		g_graph.regionmin[i] = 999999999.0;
+		g_graph.regionmax[i] = -999999999.0;
+	}
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			if (g_nodes[i].origin[j] < g_graph.regionmin[j])
+				g_graph.regionmin[j] = g_nodes[i].origin[j];
+			if (g_nodes[i].origin[j] > g_graph.regionmax[j])
+				g_graph.regionmax[j] = g_nodes[i].origin[j];
+		}
+	}
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		for (int j = 0; j < 3; j++)
+			g_nodes[i].region[j] = CalcRange((int)g_nodes[i].origin[j], (int)g_graph.regionmin[j], (int)g_graph.regionmax[j]);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < NUM_RANGES; j++)
+		{
+			g_graph.rangestart[i][j] = 255;
+			g_graph.rangeend[i][j] = 0;
+		}
+
+		for (int j = 0; j < numnodes; j++)
+			g_di[j].sortedby[i] = j;
+
+		// same exchange sort as the game, so equal codes end up in the same order
+		for (int j = 0; j < numnodes - 1; j++)
+		{
+			for (int k = j + 1; k < numnodes; k++)
+			{
+				if (RegionCode(&g_nodes[g_di[k].sortedby[i]], i) < RegionCode(&g_nodes[g_di[j].sortedby[i]], i))
+				{
+					int Tmp = g_di[j].sortedby[i];
+					g_di[j].sortedby[i] = g_di[k].sortedby[i];
+					g_di[k].sortedby[i] = Tmp;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			int code = g_nodes[g_di[i].sortedby[j]].region[j];
+
+			if (i < g_graph.rangestart[j][code])
+				g_graph.rangestart[j][code] = i;
+			if (g_graph.rangeend[j][code] < i)
+				g_graph.rangeend[j][code] = i;
+		}
+	}
+}
+
+/*
+====================
+BuildVisibility
+
+CGraph::BuildVisibility, a row of bits per node saying
+which nodes it can see from peek to peek. Each worker
+traces the rest of its own row, the other half is filled
+in from the transpose afterwards.
+====================
+*/
+static inline int VisRowSize( void )
+{
+	return ((int)g_nodes.size() + 31) >> 5;
+}
+
+static void BuildVisibilityRow( int i )
+{
+	int numnodes = (int)g_nodes.size();
+	unsigned int* prow = &g_visbits[i * VisRowSize()];
+
+	prow[i >> 5] |= 1u << (i & 31);
+
+	for (int j = i + 1; j < numnodes; j++)
+	{
+		trace_t trace = TraceLine(g_nodes[i].originpeek, g_nodes[j].originpeek);
+
+		if (trace.fraction == 1.0 && !trace.startsolid)
+			prow[j >> 5] |= 1u << (j & 31);
+	}
+}
+
+static void BuildVisibility( void )
+{
+	int numnodes = (int)g_nodes.size();
+	int cRow = VisRowSize();
+
+	g_visbits.assign(cRow * numnodes, 0);
+	g_graph.numvisbits = (int)g_visbits.size();
+
+	RunWorkers(numnodes, BuildVisibilityRow);
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		for (int j = i + 1; j < numnodes; j++)
+		{
+			if ((g_visbits[i * cRow + (j >> 5)] >> (j & 31)) & 1)
+				g_visbits[j * cRow + (i >> 5)] |= 1u << (i & 31);
+		}
+	}
+}
+
+/*
+====================
+CompressRouteRow
+
+Same run length encoding as the game's CompressRouteRow
+====================
+*/
+static void EmitRepeat( std::string& row, int cRepeats, int iLastNode, int iFrom, int numnodes, bool* pfNeedSorting )
+{
+	row += (char)(cRepeats - 1);
+
+	int a = iLastNode - iFrom;
+	int b = iLastNode - iFrom + numnodes;
+	int c = iLastNode - iFrom - numnodes;
+	if (-128 <= a && a <= 127)
+		row += (char)a;
+	else if (-128 <= b && b <= 127)
+		row += (char)b;
+	else if (-128 <= c && c <= 127)
+		row += (char)c;
+	else
+		*pfNeedSorting = true;
+}
+
+static void CompressRouteRow( int numnodes, int iFrom, const std::vector<int>& BestNextNodes, std::string& row, bool* pfNeedSorting )
+{
+	int iLastNode = 9999999;
+	int cSequence = 0;
+	int cRepeats = 0;
+
+	row.clear();
+
+	for (int i = 0; i < numnodes; i++)
+	{
+		bool CanRepeat = (BestNextNodes[i] == iLastNode && cRepeats < 127);
+		bool CanSequence = (BestNextNodes[i] == i && cSequence < 128);
+
+		if (cRepeats)
+		{
+			if (CanRepeat)
+			{
+				cRepeats++;
+			}
+			else
+			{
+				EmitRepeat(row, cRepeats, iLastNode, iFrom, numnodes, pfNeedSorting);
+				cRepeats = 0;
+
+				if (CanSequence)
+					cSequence++;
+				else
+					cRepeats++;
+			}
+		}
+		else if (cSequence)
+		{
+			if (CanSequence)
+			{
+				cSequence++;
+			}
+			else if (cSequence == 1 && CanRepeat)
+			{
+				// fold a single entry sequence into the repeat
+				cRepeats = 2;
+				cSequence = 0;
+			}
+			else
+			{
+				row += (char)(-cSequence);
+				cSequence = 0;
+				cRepeats++;
+			}
+		}
+		else
+		{
+			if (CanSequence)
+				cSequence++;
+			else
+				cRepeats++;
+		}
+
+		iLastNode = BestNextNodes[i];
+	}
+
+	if (cRepeats)
+		EmitRepeat(row, cRepeats, iLastNode, iFrom, numnodes, pfNeedSorting);
+
+	if (cSequence)
+		row += (char)(-cSequence);
+}
+
+/*
+====================
+Routing tables
+
+One Dijkstra search per node, hull and door capability, like
+the game's CRouteBuilder
+====================
+*/
+static std::vector<std::string>	g_routerows;
+static std::vector<char>		g_routeneedsorting;
+
+static void BuildRouteRow( int iRow )
+{
+	static const int hullmasks[MAX_NODE_HULLS] = { bits_LINK_SMALL_HULL, bits_LINK_HUMAN_HULL, bits_LINK_LARGE_HULL, bits_LINK_FLY_HULL };
+
+	int numnodes = (int)g_nodes.size();
+	int iTable = iRow / numnodes;
+	int iFrom = iRow % numnodes;
+	int iHullMask = hullmasks[iTable / 2];
+	int iCap = iTable % 2;
+
+	std::vector<float> cost(numnodes, -1);
+	std::vector<int> firsthop(numnodes, iFrom);
+
+	typedef std::pair<float, int> queued_t;
+	std::priority_queue<queued_t, std::vector<queued_t>, std::greater<queued_t> > queue;
+
+	cost[iFrom] = 0;
+	queue.push(queued_t(0.0f, iFrom));
+
+	while (!queue.empty())
+	{
+		queued_t top = queue.top();
+		queue.pop();
+
+		int iCurrentNode = top.second;
+		if (top.first > cost[iCurrentNode] + 0.0005)
+			continue;
+
+		const nodefile_node_t* pnode = &g_nodes[iCurrentNode];
+		for (int i = 0; i < pnode->numlinks; i++)
+		{
+			const nodefile_link_t* plink = &g_links[pnode->firstlink + i];
+
+			if ((plink->linkinfo & iHullMask) != iHullMask)
+				continue;
+
+			if (plink->linkent && !g_brushents[plink->linkent - 1].usable[iCap])
+				continue;
+
+			int iVisitNode = plink->destnode;
+			float flOurDistance = cost[iCurrentNode] + plink->weight + ROUTE_LINK_COST;
+
+			if (cost[iVisitNode] < 0 || flOurDistance < cost[iVisitNode] - 0.001)
+			{
+				cost[iVisitNode] = flOurDistance;
+				firsthop[iVisitNode] = (iCurrentNode == iFrom) ? iVisitNode : firsthop[iCurrentNode];
+				queue.push(queued_t(flOurDistance, iVisitNode));
+			}
+		}
+	}
+
+	bool fNeedSorting = false;
+	CompressRouteRow(numnodes, iFrom, firsthop, g_routerows[iRow], &fNeedSorting);
+	g_routeneedsorting[iRow] = fNeedSorting;
+}
+
+/*
+====================
+PackRoutingTables
+
+Lays the rows out in m_pRouteInfo order, storing identical
+rows once
+====================
+*/
+static void PackRoutingTables( void )
+{
+	int numnodes = (int)g_nodes.size();
+	std::unordered_map<std::string, int> offsets;
+
+	g_routeinfo.clear();
+
+	for (int iHull = 0; iHull < MAX_NODE_HULLS; iHull++)
+	{
+		for (int iCap = 0; iCap < 2; iCap++)
+		{
+			for (int iFrom = 0; iFrom < numnodes; iFrom++)
+			{
+				int iRow = (iHull * 2 + iCap) * numnodes + iFrom;
+				const std::string& row = g_routerows[iRow];
+
+				if (g_routeneedsorting[iRow])
+					printf("WARNING: nodes need sorting (%d)!\n", iFrom);
+
+				std::unordered_map<std::string, int>::iterator it = offsets.find(row);
+				if (it != offsets.end())
+				{
+					g_nodes[iFrom].nextbestnode[iHull][iCap] = it->second;
+				}
+				else
+				{
+					g_nodes[iFrom].nextbestnode[iHull][iCap] = (int)g_routeinfo.size();
+					offsets[row] = (int)g_routeinfo.size();
+					g_routeinfo += row;
+				}
+			}
+		}
+	}
+}
+
+/*
+====================
+WriteGraph
+
+FSaveGraph
+====================
+*/
+static void WriteGraph( const char* pszPath )
+{
+	g_graph.numnodes = (int)g_nodes.size();
+	g_graph.numlinks = (int)g_links.size();
+	g_graph.numrouteinfo = (int)g_routeinfo.size();
+
+	FILE* f = SafeOpenWrite((char *)pszPath);
+
+	int version = GRAPH_VERSION;
+	SafeWrite(f, &version, sizeof(version));
+	SafeWrite(f, &g_graph, sizeof(g_graph));
+
+	if (!g_nodes.empty())
+		SafeWrite(f, &g_nodes[0], sizeof(nodefile_node_t) * g_nodes.size());
+	if (!g_links.empty())
+		SafeWrite(f, &g_links[0], sizeof(nodefile_link_t) * g_links.size());
+	if (!g_di.empty())
+		SafeWrite(f, &g_di[0], sizeof(nodefile_distinfo_t) * g_di.size());
+	if (!g_routeinfo.empty())
+		SafeWrite(f, (void *)g_routeinfo.data(), g_routeinfo.size());
+	if (!g_hashlinks.empty())
+		SafeWrite(f, &g_hashlinks[0], sizeof(short) * g_hashlinks.size());
+	if (!g_visbits.empty())
+		SafeWrite(f, &g_visbits[0], sizeof(unsigned int) * g_visbits.size());
+
+	fclose(f);
+}
+
+/*
+====================
+main
+
+====================
+*/
+int main( int argc, char** argv )
+{
+	const char* pszBSP = NULL;
+	const char* pszOut = NULL;
+
+	g_numthreads = std::thread::hardware_concurrency();
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-threads") && i + 1 < argc)
+			g_numthreads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			pszOut = argv[++i];
+		else if (argv[i][0] != '-')
+			pszBSP = argv[i];
+	}
+
+	if (!pszBSP)
+	{
+		fprintf(stderr, "usage: nodegraph <maps/map.bsp> [-o <map.nod>] [-threads n]\n");
+		return 1;
+	}
+
+	if (g_numthreads < 1)
+		g_numthreads = 1;
+
+	// maps/foo.bsp -> maps/graphs/foo.nod, where the game looks for it
+	char szOut[1024];
+	if (pszOut)
+	{
+		strncpy(szOut, pszOut, sizeof(szOut) - 1);
+		szOut[sizeof(szOut) - 1] = '\0';
+	}
+	else
+	{
+		char szPath[1024], szBase[256];
+		ExtractFilePath((char *)pszBSP, szPath);
+		ExtractFileBase((char *)pszBSP, szBase);
+		sprintf(szOut, "%sgraphs", szPath);
+		Q_mkdir(szOut);
+		sprintf(szOut, "%sgraphs/%s.nod", szPath, szBase);
+	}
+
+	double start = I_FloatTime();
+
+	LoadBSPFile((char *)pszBSP);
+	ParseEntities();
+	MakeHulls();
+	LoadEntities();
+
+	int numnodes = (int)g_buildnodes.size();
+	printf("%d nodes, %d brush entities, %d threads\n", numnodes, (int)g_brushents.size(), g_numthreads);
+
+	DropNodes();
+
+	RunWorkers(numnodes, LinkVisibleNodes);
+
+	int cInitialLinks = 0;
+	for (int i = 0; i < numnodes; i++)
+	{
+		if (g_buildnodes[i].badnode)
+		{
+			const float* org = g_buildnodes[i].node.origin;
+			Error("Node %d at (%.0f %.0f %.0f) has more than %d links\n", i, org[0], org[1], org[2], MAX_NODE_INITIAL_LINKS);
+		}
+		cInitialLinks += (int)g_buildnodes[i].links.size();
+	}
+
+	RunWorkers(numnodes, WalkLinks);
+
+	int cRejected = 0;
+	for (int i = 0; i < numnodes; i++)
+		cRejected += RejectInlineLinks(i);
+
+	// compact into the link pool
+	g_nodes.resize(numnodes);
+	for (int i = 0; i < numnodes; i++)
+	{
+		buildnode_t* pbuild = &g_buildnodes[i];
+
+		g_nodes[i] = pbuild->node;
+		g_nodes[i].firstlink = (int)g_links.size();
+		g_nodes[i].numlinks = (int)pbuild->links.size();
+
+		g_links.insert(g_links.end(), pbuild->links.begin(), pbuild->links.end());
+	}
+
+	printf("%d initial links, %d after walking and inline rejection (%d inline)\n", cInitialLinks, (int)g_links.size(), cRejected);
+
+	SortNodes();
+	BuildLinkLookups();
+
+	int cUnpaired = CountUnpairedLinks();
+	if (cUnpaired)
+		printf("WARNING: %d links don't connect back\n", cUnpaired);
+
+	BuildRegionTables();
+	BuildVisibility();
+
+	// push the land nodes back down to the ground
+	for (int i = 0; i < numnodes; i++)
+	{
+		if (g_nodes[i].nodeinfo & bits_NODE_LAND)
+			g_nodes[i].origin[2] -= NODE_HEIGHT;
+	}
+
+	int numrows = MAX_NODE_HULLS * 2 * numnodes;
+	g_routerows.assign(numrows, std::string());
+	g_routeneedsorting.assign(numrows, 0);
+	if (numnodes)
+		RunWorkers(numrows, BuildRouteRow);
+	PackRoutingTables();
+
+	WriteGraph(szOut);
+
+	printf("%d route bytes, wrote %s in %.1f seconds\n", (int)g_routeinfo.size(), szOut, I_FloatTime() - start);
+	return 0;
+}
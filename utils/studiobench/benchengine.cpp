@@ -0,0 +1,659 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Null engine for the studio renderer benchmark
+//
+// The world is empty: traces hit nothing, there is no lightmap and
+// every model passes the view frustum check.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "studio.h"
+#include "entity_state.h"
+#include "cl_entity.h"
+#include "dlight.h"
+#include "triangleapi.h"
+#include "r_studioint.h"
+#include "pmtrace.h"
+#include "r_efx.h"
+#include "event_api.h"
+#include "pm_defs.h"
+#include "ref_params.h"
+#include "elightlist.h"
+#include "Exports.h"
+
+#include "benchengine.h"
+
+// cl_util.h routes this through gEngfuncs, the engine's own is pm_math's
+#undef AngleVectors
+void AngleVectors( const float* angles, float* forward, float* right, float* up );
+
+#define MAX_BENCH_CVARS		64
+
+#define IDSTUDIOHEADER		(((int)'T'<<24)+('S'<<16)+('D'<<8)+'I')
+#define STUDIO_VERSION		10
+
+// What the engine registers these as
+struct benchcvardefault_t
+{
+	const char*	name;
+	const char*	value;
+};
+
+static const benchcvardefault_t g_cvarDefaults[] =
+{
+	{ "cl_himodels",		"0" },
+	{ "developer",			"0" },
+	{ "r_drawentities",		"1" },
+	{ "lambert",			"1.5" },
+	{ "r_glowshellfreq",	"2.2" },
+	{ "sv_skyvec_x",		"0" },
+	{ "sv_skyvec_y",		"0" },
+	{ "sv_skyvec_z",		"0" },
+	{ "sv_skycolor_r",		"0" },
+	{ "sv_skycolor_g",		"0" },
+	{ "sv_skycolor_b",		"0" },
+	{ "direct",				"0.9" },
+};
+
+benchengine_t			g_BenchEngine;
+
+extern engine_studio_api_t IEngineStudio;
+
+cl_enginefunc_t			gEngfuncs;
+ref_params_t			g_refparams;
+
+static cvar_t			g_cvars[MAX_BENCH_CVARS];
+static int				g_iNumCvars;
+
+static cl_entity_t		g_viewModel;
+static entity_state_t	g_playerState;
+static player_info_t	g_playerInfo;
+
+static dlight_t			g_dlights[MAX_GOLDSRC_DLIGHTS];
+static dlight_t			g_elights[MAX_GOLDSRC_ELIGHTS];
+
+static float			g_boneTransform[MAXSTUDIOBONES][3][4];
+static float			g_lightTransform[MAXSTUDIOBONES][3][4];
+static float			g_aliasTransform[3][4];
+static float			g_rotationMatrix[3][4];
+
+static int				g_iStudioModelCount;
+static int				g_iModelsDrawn;
+static int				g_iForceFaceFlags;
+
+static mspriteframe_t	g_chromeFrame;
+static msprite_t		g_chromeSprite;
+static model_t			g_chromeModel;
+
+static unsigned int		g_iRandomSeed = 1;
+
+/*
+====================
+BenchEngine_FindCvar
+
+====================
+*/
+static cvar_t* BenchEngine_FindCvar( const char* pszName )
+{
+	for (int i = 0; i < g_iNumCvars; i++)
+	{
+		if (!strcmp(g_cvars[i].name, pszName))
+			return &g_cvars[i];
+	}
+
+	return NULL;
+}
+
+/*
+====================
+BenchEngine_AddCvar
+
+====================
+*/
+static cvar_t* BenchEngine_AddCvar( const char* pszName, const char* pszValue, int flags )
+{
+	if (g_iNumCvars == MAX_BENCH_CVARS)
+	{
+		fprintf(stderr, "studiobench: too many cvars, %s not registered\n", pszName);
+		exit(1);
+	}
+
+	cvar_t* pcvar = &g_cvars[g_iNumCvars];
+	g_iNumCvars++;
+
+	pcvar->name = strdup(pszName);
+	pcvar->string = strdup(pszValue);
+	pcvar->flags = flags;
+	pcvar->value = (float)atof(pszValue);
+	return pcvar;
+}
+
+/*
+====================
+BenchEngine_LoadFile
+
+====================
+*/
+static byte* BenchEngine_LoadFile( const char* pszPath, int* plength )
+{
+	char szPath[MAX_PATH * 2];
+	snprintf(szPath, sizeof(szPath), "%s/%s", g_BenchEngine.gamedir, pszPath);
+
+	FILE* pFile = fopen(szPath, "rb");
+	if (!pFile)
+		return NULL;
+
+	fseek(pFile, 0, SEEK_END);
+	int length = (int)ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	// Text files get parsed, so keep a terminator after the data
+	byte* pbuffer = (byte*)malloc(length + 1);
+	if (fread(pbuffer, 1, length, pFile) != (size_t)length)
+	{
+		fclose(pFile);
+		free(pbuffer);
+		return NULL;
+	}
+
+	fclose(pFile);
+	pbuffer[length] = '\0';
+
+	if (plength)
+		*plength = length;
+
+	return pbuffer;
+}
+
+// ================================= //
+// =====	Client engine funcs	===== //
+// ================================= //
+
+static cvar_t* Eng_RegisterVariable( char* szName, char* szValue, int flags )
+{
+	cvar_t* pcvar = BenchEngine_FindCvar(szName);
+	if (pcvar)
+		return pcvar;
+
+	return BenchEngine_AddCvar(szName, szValue, flags);
+}
+
+static int Eng_AddCommand( char*, void (*)(void) ) { return 1; }
+static int Eng_HookUserMsg( char*, pfnUserMsgHook ) { return 1; }
+static int Eng_GetMaxClients( void ) { return 1; }
+static int Eng_Cmd_Argc( void ) { return 0; }
+static char* Eng_Cmd_Argv( int ) { return (char*)""; }
+static void Eng_WeaponAnim( int, int ) {}
+static const char* Eng_GetGameDirectory( void ) { return g_BenchEngine.gamedir; }
+static float Eng_GetClientTime( void ) { return (float)g_BenchEngine.time; }
+static cl_entity_t* Eng_GetViewModel( void ) { return &g_viewModel; }
+
+static void Eng_Con_Printf( char* fmt, ... )
+{
+	va_list argptr;
+	va_start(argptr, fmt);
+	vfprintf(stderr, fmt, argptr);
+	va_end(argptr);
+}
+
+static void Eng_Con_DPrintf( char* fmt, ... )
+{
+	cvar_t* pdeveloper = BenchEngine_FindCvar("developer");
+	if (!pdeveloper || pdeveloper->value < 1)
+		return;
+
+	va_list argptr;
+	va_start(argptr, fmt);
+	vfprintf(stderr, fmt, argptr);
+	va_end(argptr);
+}
+
+static void Eng_Con_NPrintf( int, char*, ... ) {}
+
+static void Eng_GetViewAngles( float* angles )
+{
+	VectorCopy(g_BenchEngine.viewangles, angles);
+}
+
+static cl_entity_t* Eng_GetEntityByIndex( int idx )
+{
+	if (idx < 0 || idx >= g_BenchEngine.numentities)
+		return NULL;
+
+	return &g_BenchEngine.pentities[idx];
+}
+
+static cl_entity_t* Eng_GetLocalPlayer( void )
+{
+	return Eng_GetEntityByIndex(BENCH_PLAYER_ENTITY);
+}
+
+static int Eng_PM_PointContents( float*, int* truecontents )
+{
+	if (truecontents)
+		*truecontents = CONTENTS_EMPTY;
+
+	return CONTENTS_EMPTY;
+}
+
+static float Eng_RandomFloat( float flLow, float flHigh )
+{
+	g_iRandomSeed = g_iRandomSeed * 1103515245 + 12345;
+	float f = (float)((g_iRandomSeed >> 16) & 0x7FFF) / 32767.0f;
+	return flLow + (flHigh - flLow) * f;
+}
+
+static long Eng_RandomLong( long lLow, long lHigh )
+{
+	g_iRandomSeed = g_iRandomSeed * 1103515245 + 12345;
+	return lLow + (long)((g_iRandomSeed >> 16) & 0x7FFF) % (lHigh - lLow + 1);
+}
+
+static byte* Eng_COM_LoadFile( char* path, int, int* pLength )
+{
+	return BenchEngine_LoadFile(path, pLength);
+}
+
+static void Eng_COM_FreeFile( void* buffer )
+{
+	free(buffer);
+}
+
+static char* Eng_COM_ParseFile( char* data, char* token )
+{
+	token[0] = '\0';
+	if (!data)
+		return NULL;
+
+	// Skip whitespace and comments
+	while (true)
+	{
+		while (*data && *data <= ' ')
+			data++;
+
+		if (!*data)
+			return NULL;
+
+		if (data[0] != '/' || data[1] != '/')
+			break;
+
+		while (*data && *data != '\n')
+			data++;
+	}
+
+	int len = 0;
+	if (*data == '\"')
+	{
+		data++;
+		while (*data && *data != '\"' && len < 1023)
+			token[len++] = *data++;
+
+		if (*data == '\"')
+			data++;
+	}
+	else
+	{
+		while (*data > ' ' && len < 1023)
+			token[len++] = *data++;
+	}
+
+	token[len] = '\0';
+	return data;
+}
+
+// ================================= //
+// =====	Effects API			===== //
+// ================================= //
+
+/*
+====================
+Efx_AllocLight
+
+Slot 0 comes back first, the elight list keeps
+it as the start of the array
+====================
+*/
+static dlight_t* Efx_AllocLight( dlight_t* plights, int numlights, int key )
+{
+	if (key)
+	{
+		for (int i = 0; i < numlights; i++)
+		{
+			if (plights[i].key == key)
+				return &plights[i];
+		}
+	}
+
+	for (int i = 0; i < numlights; i++)
+	{
+		if (plights[i].die < g_BenchEngine.time)
+		{
+			plights[i] = dlight_t();
+			plights[i].key = key;
+			return &plights[i];
+		}
+	}
+
+	plights[0] = dlight_t();
+	plights[0].key = key;
+	return &plights[0];
+}
+
+static dlight_t* Efx_AllocDlight( int key ) { return Efx_AllocLight(g_dlights, MAX_GOLDSRC_DLIGHTS, key); }
+static dlight_t* Efx_AllocElight( int key ) { return Efx_AllocLight(g_elights, MAX_GOLDSRC_ELIGHTS, key); }
+
+// ================================= //
+// =====	Event API			===== //
+// ================================= //
+
+static void Ev_SetUpPlayerPrediction( int, int ) {}
+static void Ev_PushPMStates( void ) {}
+static void Ev_PopPMStates( void ) {}
+static void Ev_SetSolidPlayers( int ) {}
+static void Ev_SetTraceHull( int ) {}
+
+static void Ev_PlayerTrace( float*, float* end, int, int, pmtrace_t* tr )
+{
+	// Nothing to hit
+	*tr = pmtrace_t();
+	tr->fraction = 1.0f;
+	tr->inopen = true;
+	tr->ent = -1;
+	VectorCopy(end, tr->endpos);
+}
+
+// ================================= //
+// =====	Triangle API		===== //
+// ================================= //
+
+static void Tri_RenderMode( int ) {}
+static void Tri_Fog( float*, float, float, int ) {}
+
+static triangleapi_t	g_triAPI;
+static efx_api_t		g_efxAPI;
+static event_api_t		g_eventAPI;
+
+// ================================= //
+// =====	Studio engine funcs	===== //
+// ================================= //
+
+static void* Studio_Mem_Calloc( int number, size_t size ) { return calloc(number, size); }
+static void* Studio_Cache_Check( cache_user_t* c ) { return c->data; }
+static void* Studio_Mod_Extradata( model_t* mod ) { return mod ? mod->cache.data : NULL; }
+static cl_entity_t* Studio_GetCurrentEntity( void ) { return g_BenchEngine.pcurrententity; }
+static player_info_t* Studio_PlayerInfo( int ) { return &g_playerInfo; }
+static entity_state_t* Studio_GetPlayerState( int ) { return &g_playerState; }
+static cl_entity_t* Studio_GetViewEntity( void ) { return Eng_GetLocalPlayer(); }
+static model_t* Studio_GetChromeSprite( void ) { return &g_chromeModel; }
+static int Studio_StudioCheckBBox( void ) { return 1; }
+static int Studio_IsHardware( void ) { return 1; }
+static int Studio_GetForceFaceFlags( void ) { return g_iForceFaceFlags; }
+static void Studio_SetForceFaceFlags( int flags ) { g_iForceFaceFlags = flags; }
+static model_t* Studio_SetupPlayerModel( int ) { return NULL; }
+
+static float**** Studio_GetBoneTransform( void ) { return (float****)g_boneTransform; }
+static float**** Studio_GetLightTransform( void ) { return (float****)g_lightTransform; }
+static float*** Studio_GetAliasTransform( void ) { return (float***)g_aliasTransform; }
+static float*** Studio_GetRotationMatrix( void ) { return (float***)g_rotationMatrix; }
+
+static void Studio_SetupModel( int, void**, void** ) {}
+static void Studio_DynamicLight( cl_entity_t*, alight_t* ) {}
+static void Studio_EntityLight( alight_t* ) {}
+static void Studio_SetupLighting( alight_t* ) {}
+static void Studio_Nothing( void ) {}
+static void Studio_SetupSkin( void*, int ) {}
+static void Studio_SetRemapColors( int, int ) {}
+static void Studio_SetHeader( void* ) {}
+static void Studio_SetRenderModel( model_t* ) {}
+static void Studio_SetupRenderer( int ) {}
+static void Studio_GL_SetRenderMode( int ) {}
+
+static model_t* Studio_Mod_ForName( const char* name, int )
+{
+	return BenchEngine_LoadModel(name);
+}
+
+static model_t* Studio_GetModelByIndex( int index )
+{
+	if (index <= 0 || index >= g_BenchEngine.nummodels)
+		return NULL;
+
+	return &g_BenchEngine.models[index];
+}
+
+static void Studio_LoadCacheFile( char* path, cache_user_t* cu )
+{
+	cu->data = BenchEngine_LoadFile(path, NULL);
+}
+
+static cvar_t* Studio_GetCvar( const char* name )
+{
+	cvar_t* pcvar = BenchEngine_FindCvar(name);
+	if (pcvar)
+		return pcvar;
+
+	for (unsigned int i = 0; i < sizeof(g_cvarDefaults) / sizeof(g_cvarDefaults[0]); i++)
+	{
+		if (!strcmp(g_cvarDefaults[i].name, name))
+			return BenchEngine_AddCvar(name, g_cvarDefaults[i].value, 0);
+	}
+
+	return NULL;
+}
+
+static void Studio_GetTimes( int* framecount, double* current, double* old )
+{
+	*framecount = g_BenchEngine.framecount;
+	*current = g_BenchEngine.time;
+	*old = g_BenchEngine.oldtime;
+}
+
+static void Studio_GetViewInfo( float* origin, float* upv, float* rightv, float* vpnv )
+{
+	VectorCopy(g_BenchEngine.vieworg, origin);
+	AngleVectors(g_BenchEngine.viewangles, vpnv, rightv, upv);
+}
+
+static void Studio_GetModelCounters( int** s, int** a )
+{
+	*s = &g_iStudioModelCount;
+	*a = &g_iModelsDrawn;
+}
+
+static void Studio_GetAliasScale( float* x, float* y )
+{
+	*x = *y = 1.0f;
+}
+
+// ================================= //
+// =====	Client exports		===== //
+// ================================= //
+
+extern "C" int CL_DLLEXPORT CL_IsThirdPerson( void )
+{
+	return 0;
+}
+
+extern "C" void CL_DLLEXPORT HUD_StudioEvent( const struct mstudioevent_s*, const struct cl_entity_s* )
+{
+}
+
+/*
+====================
+BenchEngine_Init
+
+====================
+*/
+void BenchEngine_Init( const char* pszGameDir )
+{
+	strncpy(g_BenchEngine.gamedir, pszGameDir, sizeof(g_BenchEngine.gamedir) - 1);
+
+	g_triAPI.RenderMode = Tri_RenderMode;
+	g_triAPI.Fog = Tri_Fog;
+
+	g_efxAPI.CL_AllocDlight = Efx_AllocDlight;
+	g_efxAPI.CL_AllocElight = Efx_AllocElight;
+
+	g_eventAPI.EV_SetUpPlayerPrediction = Ev_SetUpPlayerPrediction;
+	g_eventAPI.EV_PushPMStates = Ev_PushPMStates;
+	g_eventAPI.EV_PopPMStates = Ev_PopPMStates;
+	g_eventAPI.EV_SetSolidPlayers = Ev_SetSolidPlayers;
+	g_eventAPI.EV_SetTraceHull = Ev_SetTraceHull;
+	g_eventAPI.EV_PlayerTrace = Ev_PlayerTrace;
+
+	memset(&gEngfuncs, 0, sizeof(gEngfuncs));
+	gEngfuncs.pfnRegisterVariable = Eng_RegisterVariable;
+	gEngfuncs.pfnAngleVectors = AngleVectors;
+	gEngfuncs.pfnAddCommand = Eng_AddCommand;
+	gEngfuncs.pfnHookUserMsg = Eng_HookUserMsg;
+	gEngfuncs.GetViewAngles = Eng_GetViewAngles;
+	gEngfuncs.GetMaxClients = Eng_GetMaxClients;
+	gEngfuncs.Cmd_Argc = Eng_Cmd_Argc;
+	gEngfuncs.Cmd_Argv = Eng_Cmd_Argv;
+	gEngfuncs.Con_Printf = Eng_Con_Printf;
+	gEngfuncs.Con_DPrintf = Eng_Con_DPrintf;
+	gEngfuncs.Con_NPrintf = Eng_Con_NPrintf;
+	gEngfuncs.GetLocalPlayer = Eng_GetLocalPlayer;
+	gEngfuncs.GetViewModel = Eng_GetViewModel;
+	gEngfuncs.GetEntityByIndex = Eng_GetEntityByIndex;
+	gEngfuncs.GetClientTime = Eng_GetClientTime;
+	gEngfuncs.PM_PointContents = Eng_PM_PointContents;
+	gEngfuncs.pfnWeaponAnim = Eng_WeaponAnim;
+	gEngfuncs.pfnRandomFloat = Eng_RandomFloat;
+	gEngfuncs.pfnRandomLong = Eng_RandomLong;
+	gEngfuncs.pfnGetGameDirectory = Eng_GetGameDirectory;
+	gEngfuncs.COM_LoadFile = Eng_COM_LoadFile;
+	gEngfuncs.COM_ParseFile = Eng_COM_ParseFile;
+	gEngfuncs.COM_FreeFile = Eng_COM_FreeFile;
+	gEngfuncs.pTriAPI = &g_triAPI;
+	gEngfuncs.pEfxAPI = &g_efxAPI;
+	gEngfuncs.pEventAPI = &g_eventAPI;
+
+	memset(&IEngineStudio, 0, sizeof(IEngineStudio));
+	IEngineStudio.Mem_Calloc = Studio_Mem_Calloc;
+	IEngineStudio.Cache_Check = Studio_Cache_Check;
+	IEngineStudio.LoadCacheFile = Studio_LoadCacheFile;
+	IEngineStudio.Mod_ForName = Studio_Mod_ForName;
+	IEngineStudio.Mod_Extradata = Studio_Mod_Extradata;
+	IEngineStudio.GetModelByIndex = Studio_GetModelByIndex;
+	IEngineStudio.GetCurrentEntity = Studio_GetCurrentEntity;
+	IEngineStudio.PlayerInfo = Studio_PlayerInfo;
+	IEngineStudio.GetPlayerState = Studio_GetPlayerState;
+	IEngineStudio.GetViewEntity = Studio_GetViewEntity;
+	IEngineStudio.GetTimes = Studio_GetTimes;
+	IEngineStudio.GetCvar = Studio_GetCvar;
+	IEngineStudio.GetViewInfo = Studio_GetViewInfo;
+	IEngineStudio.GetChromeSprite = Studio_GetChromeSprite;
+	IEngineStudio.GetModelCounters = Studio_GetModelCounters;
+	IEngineStudio.GetAliasScale = Studio_GetAliasScale;
+	IEngineStudio.StudioGetBoneTransform = Studio_GetBoneTransform;
+	IEngineStudio.StudioGetLightTransform = Studio_GetLightTransform;
+	IEngineStudio.StudioGetAliasTransform = Studio_GetAliasTransform;
+	IEngineStudio.StudioGetRotationMatrix = Studio_GetRotationMatrix;
+	IEngineStudio.StudioSetupModel = Studio_SetupModel;
+	IEngineStudio.StudioCheckBBox = Studio_StudioCheckBBox;
+	IEngineStudio.StudioDynamicLight = Studio_DynamicLight;
+	IEngineStudio.StudioEntityLight = Studio_EntityLight;
+	IEngineStudio.StudioSetupLighting = Studio_SetupLighting;
+	IEngineStudio.StudioDrawPoints = Studio_Nothing;
+	IEngineStudio.StudioDrawHulls = Studio_Nothing;
+	IEngineStudio.StudioDrawAbsBBox = Studio_Nothing;
+	IEngineStudio.StudioDrawBones = Studio_Nothing;
+	IEngineStudio.StudioSetupSkin = Studio_SetupSkin;
+	IEngineStudio.StudioSetRemapColors = Studio_SetRemapColors;
+	IEngineStudio.SetupPlayerModel = Studio_SetupPlayerModel;
+	IEngineStudio.StudioClientEvents = Studio_Nothing;
+	IEngineStudio.GetForceFaceFlags = Studio_GetForceFaceFlags;
+	IEngineStudio.SetForceFaceFlags = Studio_SetForceFaceFlags;
+	IEngineStudio.StudioSetHeader = Studio_SetHeader;
+	IEngineStudio.SetRenderModel = Studio_SetRenderModel;
+	IEngineStudio.SetupRenderer = Studio_SetupRenderer;
+	IEngineStudio.RestoreRenderer = Studio_Nothing;
+	IEngineStudio.SetChromeOrigin = Studio_Nothing;
+	IEngineStudio.IsHardware = Studio_IsHardware;
+	IEngineStudio.GL_StudioDrawShadow = Studio_Nothing;
+	IEngineStudio.GL_SetRenderMode = Studio_GL_SetRenderMode;
+
+	// Single frame sprite for the glow shell
+	g_chromeSprite.numframes = 1;
+	g_chromeSprite.frames[0].type = SPR_SINGLE;
+	g_chromeSprite.frames[0].frameptr = &g_chromeFrame;
+
+	strcpy(g_chromeModel.name, "sprites/chrome.spr");
+	g_chromeModel.type = mod_sprite;
+	g_chromeModel.cache.data = &g_chromeSprite;
+
+	// Index 0 is never used, 1 is an empty world without a lightmap
+	g_BenchEngine.nummodels = 2;
+	strcpy(g_BenchEngine.models[1].name, "maps/bench.bsp");
+	g_BenchEngine.models[1].type = mod_brush;
+}
+
+/*
+====================
+BenchEngine_LoadModel
+
+====================
+*/
+model_t* BenchEngine_LoadModel( const char* pszName )
+{
+	for (int i = 1; i < g_BenchEngine.nummodels; i++)
+	{
+		if (!strcmp(g_BenchEngine.models[i].name, pszName))
+			return &g_BenchEngine.models[i];
+	}
+
+	if (strlen(pszName) >= MAX_MODEL_NAME)
+	{
+		fprintf(stderr, "studiobench: model name %s is too long\n", pszName);
+		return NULL;
+	}
+
+	if (g_BenchEngine.nummodels == MAX_BENCH_MODELS)
+	{
+		fprintf(stderr, "studiobench: too many models, %s not loaded\n", pszName);
+		return NULL;
+	}
+
+	int length = 0;
+	studiohdr_t* phdr = (studiohdr_t*)BenchEngine_LoadFile(pszName, &length);
+	if (!phdr)
+	{
+		fprintf(stderr, "studiobench: couldn't load %s/%s\n", g_BenchEngine.gamedir, pszName);
+		return NULL;
+	}
+
+	if (length < (int)sizeof(studiohdr_t) || phdr->id != IDSTUDIOHEADER || phdr->version != STUDIO_VERSION)
+	{
+		fprintf(stderr, "studiobench: %s is not a studio model\n", pszName);
+		free(phdr);
+		return NULL;
+	}
+
+	model_t* pmodel = &g_BenchEngine.models[g_BenchEngine.nummodels];
+	g_BenchEngine.nummodels++;
+
+	strcpy(pmodel->name, pszName);
+	pmodel->type = mod_studio;
+	pmodel->cache.data = phdr;
+	VectorCopy(phdr->bbmin, pmodel->mins);
+	VectorCopy(phdr->bbmax, pmodel->maxs);
+
+	return pmodel;
+}
+
+/*
+====================
+BenchEngine_ModelIndex
+
+====================
+*/
+int BenchEngine_ModelIndex( const model_t* pmodel )
+{
+	return (int)(pmodel - g_BenchEngine.models);
+}
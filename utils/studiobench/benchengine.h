@@ -0,0 +1,49 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Null engine for the studio renderer benchmark
+//
+// Fills in the engine interfaces the client renderer calls (gEngfuncs,
+// IEngineStudio) from a scripted scene instead of a running game.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#ifndef BENCHENGINE_H
+#define BENCHENGINE_H
+
+#define MAX_BENCH_MODELS		16
+
+// Entity slots the engine would use itself
+#define BENCH_WORLD_ENTITY		0
+#define BENCH_PLAYER_ENTITY		1
+#define BENCH_FIRST_ENTITY		2
+
+struct benchengine_t
+{
+	char			gamedir[MAX_PATH];
+
+	// Model precache list, slot 1 is the world like in the engine
+	model_t			models[MAX_BENCH_MODELS];
+	int				nummodels;
+
+	// Entity list, the first slots are taken by the world and the player
+	cl_entity_t*	pentities;
+	int				numentities;
+	cl_entity_t*	pcurrententity;
+
+	int				framecount;
+	double			time;
+	double			oldtime;
+
+	vec3_t			vieworg;
+	vec3_t			viewangles;
+};
+
+extern benchengine_t g_BenchEngine;
+
+void BenchEngine_Init( const char* pszGameDir );
+
+model_t* BenchEngine_LoadModel( const char* pszName );
+int BenchEngine_ModelIndex( const model_t* pmodel );
+
+#endif // BENCHENGINE_H
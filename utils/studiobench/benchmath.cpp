@@ -0,0 +1,13 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Player movement math the renderer uses, built for the benchmark
+//
+// pm_math.cpp and cl_dll/util.cpp both define vec3_origin, as different
+// types. MSVC's decorated names keep the two apart, g++ doesn't, so the
+// pm_shared one gets renamed here. Nothing in the benchmark uses it.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#define vec3_origin pm_vec3_origin
+#include "pm_math.cpp"
@@ -0,0 +1,199 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Null GL backend, counts what the renderer would have submitted
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "windows.h"
+#include "gl/gl.h"
+
+#include "nullgl.h"
+
+nullglstats_t g_NullGLStats;
+
+// Client array state, glDrawElements reads through it
+static const GLfloat*	g_pVertexArray;
+static int				g_iVertexStride;
+
+/*
+====================
+nglReset
+
+====================
+*/
+void nglReset( void )
+{
+	memset(&g_NullGLStats, 0, sizeof(g_NullGLStats));
+}
+
+/*
+====================
+nglArrayVertex
+
+====================
+*/
+static inline const GLfloat* nglArrayVertex( unsigned int index )
+{
+	return (const GLfloat*)((const char*)g_pVertexArray + index * g_iVertexStride);
+}
+
+// ================================= //
+// =====	Geometry			===== //
+// ================================= //
+
+void APIENTRY glBegin( GLenum )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.primitives++;
+}
+
+void APIENTRY glEnd( void )
+{
+	g_NullGLStats.calls++;
+}
+
+void APIENTRY glColor4f( GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.checksum += red + green + blue + alpha;
+}
+
+void APIENTRY glTexCoord2f( GLfloat s, GLfloat t )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.checksum += s + t;
+}
+
+void APIENTRY glTexCoord2fv( const GLfloat* v )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.checksum += v[0] + v[1];
+}
+
+void APIENTRY glVertex3fv( const GLfloat* v )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.vertexes++;
+	g_NullGLStats.checksum += v[0] + v[1] + v[2];
+}
+
+void APIENTRY glVertexPointer( GLint size, GLenum, GLsizei stride, const GLvoid* pointer )
+{
+	g_NullGLStats.calls++;
+
+	g_pVertexArray = (const GLfloat*)pointer;
+	g_iVertexStride = stride ? stride : size * sizeof(GLfloat);
+}
+
+void APIENTRY glColorPointer( GLint, GLenum, GLsizei, const GLvoid* )
+{
+	g_NullGLStats.calls++;
+}
+
+void APIENTRY glTexCoordPointer( GLint, GLenum, GLsizei, const GLvoid* )
+{
+	g_NullGLStats.calls++;
+}
+
+void APIENTRY glDrawElements( GLenum, GLsizei count, GLenum type, const GLvoid* indices )
+{
+	g_NullGLStats.calls++;
+	g_NullGLStats.primitives++;
+	g_NullGLStats.indexes += count;
+
+	if (!g_pVertexArray)
+		return;
+
+	// Touch the data the way the driver would
+	for (int i = 0; i < count; i++)
+	{
+		unsigned int index;
+		if (type == GL_UNSIGNED_INT)
+			index = ((const GLuint*)indices)[i];
+		else if (type == GL_UNSIGNED_SHORT)
+			index = ((const GLushort*)indices)[i];
+		else
+			index = ((const GLubyte*)indices)[i];
+
+		g_NullGLStats.checksum += nglArrayVertex(index)[2];
+	}
+}
+
+// ================================= //
+// =====	State				===== //
+// ================================= //
+
+void APIENTRY glAlphaFunc( GLenum, GLclampf ) { g_NullGLStats.calls++; }
+void APIENTRY glBindTexture( GLenum, GLuint ) { g_NullGLStats.calls++; }
+void APIENTRY glBlendFunc( GLenum, GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glClear( GLbitfield ) { g_NullGLStats.calls++; }
+void APIENTRY glColorMask( GLboolean, GLboolean, GLboolean, GLboolean ) { g_NullGLStats.calls++; }
+void APIENTRY glCullFace( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glDepthFunc( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glDepthMask( GLboolean ) { g_NullGLStats.calls++; }
+void APIENTRY glDepthRange( GLclampd, GLclampd ) { g_NullGLStats.calls++; }
+void APIENTRY glDisable( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glDisableClientState( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glDrawBuffer( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glEnable( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glEnableClientState( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glFogf( GLenum, GLfloat ) { g_NullGLStats.calls++; }
+void APIENTRY glFogfv( GLenum, const GLfloat* ) { g_NullGLStats.calls++; }
+void APIENTRY glFogi( GLenum, GLint ) { g_NullGLStats.calls++; }
+void APIENTRY glPointSize( GLfloat ) { g_NullGLStats.calls++; }
+void APIENTRY glPopAttrib( void ) { g_NullGLStats.calls++; }
+void APIENTRY glPopClientAttrib( void ) { g_NullGLStats.calls++; }
+void APIENTRY glPushAttrib( GLbitfield ) { g_NullGLStats.calls++; }
+void APIENTRY glPushClientAttrib( GLbitfield ) { g_NullGLStats.calls++; }
+void APIENTRY glReadBuffer( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glShadeModel( GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glStencilFunc( GLenum, GLint, GLuint ) { g_NullGLStats.calls++; }
+void APIENTRY glStencilMask( GLuint ) { g_NullGLStats.calls++; }
+void APIENTRY glStencilOp( GLenum, GLenum, GLenum ) { g_NullGLStats.calls++; }
+void APIENTRY glTexEnvi( GLenum, GLenum, GLint ) { g_NullGLStats.calls++; }
+void APIENTRY glViewport( GLint, GLint, GLsizei, GLsizei ) { g_NullGLStats.calls++; }
+
+GLenum APIENTRY glGetError( void )
+{
+	return GL_NO_ERROR;
+}
+
+void APIENTRY glGetIntegerv( GLenum, GLint* params )
+{
+	*params = 0;
+}
+
+const GLubyte* APIENTRY glGetString( GLenum )
+{
+	// No extensions, so nothing goes looking for FBOs
+	return (const GLubyte*)"";
+}
+
+// ================================= //
+// =====	Extensions			===== //
+// ================================= //
+
+static void APIENTRY nglActiveTexture( GLenum ) { g_NullGLStats.calls++; }
+static void APIENTRY nglClientActiveTexture( GLenum ) { g_NullGLStats.calls++; }
+static void APIENTRY nglActiveStencilFaceEXT( GLenum ) { g_NullGLStats.calls++; }
+
+/*
+====================
+wglGetProcAddress
+
+====================
+*/
+PROC wglGetProcAddress( const char* pszName )
+{
+	if (!strcmp(pszName, "glActiveTexture"))
+		return (PROC)nglActiveTexture;
+
+	if (!strcmp(pszName, "glClientActiveTexture"))
+		return (PROC)nglClientActiveTexture;
+
+	if (!strcmp(pszName, "glActiveStencilFaceEXT"))
+		return (PROC)nglActiveStencilFaceEXT;
+
+	return NULL;
+}
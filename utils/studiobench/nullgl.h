@@ -0,0 +1,29 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Null GL backend, counts what the renderer would have submitted
+//
+// The real GL entry points the client renderer links against are
+// defined in nullgl.cpp, so the renderer code runs unchanged.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#ifndef NULLGL_H
+#define NULLGL_H
+
+struct nullglstats_t
+{
+	long long	calls;
+	long long	primitives;
+	long long	vertexes;
+	long long	indexes;
+
+	// Sum of everything submitted, so the optimizer can't drop the work
+	double		checksum;
+};
+
+extern nullglstats_t g_NullGLStats;
+
+void nglReset( void );
+
+#endif // NULLGL_H
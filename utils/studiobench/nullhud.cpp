@@ -0,0 +1,91 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Null HUD for the studio renderer benchmark
+//
+// The renderer reads a few fields of gHUD (times, pause state, the cached
+// view model), so a real CHud has to exist. None of its elements ever run,
+// they only need their virtual functions defined.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "hud.h"
+#include "cl_util.h"
+
+CHud gHUD;
+
+CHud::~CHud()
+{
+}
+
+int CHudAmmo::Init( void ) { return 0; }
+int CHudAmmo::VidInit( void ) { return 0; }
+int CHudAmmo::Draw( float ) { return 0; }
+void CHudAmmo::Think( void ) {}
+void CHudAmmo::Reset( void ) {}
+
+int CHudAmmoSecondary::Init( void ) { return 0; }
+int CHudAmmoSecondary::VidInit( void ) { return 0; }
+int CHudAmmoSecondary::Draw( float ) { return 0; }
+void CHudAmmoSecondary::Reset( void ) {}
+
+int CHudHealth::Init( void ) { return 0; }
+int CHudHealth::VidInit( void ) { return 0; }
+int CHudHealth::Draw( float ) { return 0; }
+void CHudHealth::Reset( void ) {}
+
+int CHudGeiger::Init( void ) { return 0; }
+int CHudGeiger::VidInit( void ) { return 0; }
+int CHudGeiger::Draw( float ) { return 0; }
+
+int CHudTrain::Init( void ) { return 0; }
+int CHudTrain::VidInit( void ) { return 0; }
+int CHudTrain::Draw( float ) { return 0; }
+
+int CHudBattery::Init( void ) { return 0; }
+int CHudBattery::VidInit( void ) { return 0; }
+int CHudBattery::Draw( float ) { return 0; }
+
+int CHudFlashlight::Init( void ) { return 0; }
+int CHudFlashlight::VidInit( void ) { return 0; }
+int CHudFlashlight::Draw( float ) { return 0; }
+void CHudFlashlight::Reset( void ) {}
+
+int CHudMessage::Init( void ) { return 0; }
+int CHudMessage::VidInit( void ) { return 0; }
+int CHudMessage::Draw( float ) { return 0; }
+void CHudMessage::Reset( void ) {}
+
+int CHudStatusBar::Init( void ) { return 0; }
+int CHudStatusBar::VidInit( void ) { return 0; }
+int CHudStatusBar::Draw( float ) { return 0; }
+void CHudStatusBar::Reset( void ) {}
+
+int CHudStatusIcons::Init( void ) { return 0; }
+int CHudStatusIcons::VidInit( void ) { return 0; }
+int CHudStatusIcons::Draw( float ) { return 0; }
+void CHudStatusIcons::Reset( void ) {}
+
+int CHudDeathNotice::Init( void ) { return 0; }
+int CHudDeathNotice::VidInit( void ) { return 0; }
+int CHudDeathNotice::Draw( float ) { return 0; }
+void CHudDeathNotice::InitHUDData( void ) {}
+
+int CHudSayText::Init( void ) { return 0; }
+int CHudSayText::VidInit( void ) { return 0; }
+int CHudSayText::Draw( float ) { return 0; }
+void CHudSayText::InitHUDData( void ) {}
+
+int CHudMenu::Init( void ) { return 0; }
+int CHudMenu::VidInit( void ) { return 0; }
+int CHudMenu::Draw( float ) { return 0; }
+void CHudMenu::Reset( void ) {}
+void CHudMenu::InitHUDData( void ) {}
+
+int CHudTextMessage::Init( void ) { return 0; }
+
+int CHudSpectator::Init( void ) { return 0; }
+int CHudSpectator::VidInit( void ) { return 0; }
+int CHudSpectator::Draw( float ) { return 0; }
+void CHudSpectator::Reset( void ) {}
+void CHudSpectator::InitHUDData( void ) {}
@@ -0,0 +1,32 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Forced include for building the client renderer with g++
+//
+// The standard headers go first, cl_dll defines min and max as macros and
+// they would break <algorithm> and friends if included later. The VGUI
+// headers declare the enums hud.h forward declares, g++ rejects the forward
+// declarations otherwise.
+//
+//
+// $NoKeywords: $
+//=============================================================================
+
+#ifndef BENCHPLATFORM_H
+#define BENCHPLATFORM_H
+
+#include "windows.h"
+
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "VGUI.h"
+#include "VGUI_KeyCode.h"
+#include "VGUI_MouseCode.h"
+#include "VGUI_Image.h"
+
+#endif // BENCHPLATFORM_H
@@ -0,0 +1,66 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Just enough of <windows.h> to build the client renderer with g++
+//
+// Sizes follow Win32, so DWORD and LONG stay 32 bit on LP64 targets.
+//
+//
+// $NoKeywords: $
+//=============================================================================
+
+#ifndef BENCH_WINDOWS_H
+#define BENCH_WINDOWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+// Calling conventions and storage classes
+#define WINAPI
+#define APIENTRY
+#define WINGDIAPI
+#define CALLBACK
+#define _cdecl
+#define __cdecl
+#define _stdcall
+#define __stdcall
+#define __declspec(x)
+#define __forceinline		inline
+#define __int64				long long
+
+// CRT names
+#define _snprintf			snprintf
+#define _vsnprintf			vsnprintf
+#define stricmp				strcasecmp
+#define _stricmp			strcasecmp
+#define strnicmp			strncasecmp
+#define _strnicmp			strncasecmp
+
+#define MAX_PATH			260
+#define TRUE				1
+#define FALSE				0
+
+typedef int					BOOL;
+typedef uint32_t			DWORD;
+typedef uint16_t			WORD;
+typedef uint8_t				BYTE;
+typedef int32_t				LONG;
+typedef uint32_t			ULONG;
+typedef void*				HANDLE;
+typedef void*				HMODULE;
+typedef void*				HWND;
+typedef void*				HDC;
+typedef void				(*PROC)( void );
+
+typedef struct { LONG x, y; } POINT;
+typedef struct { LONG left, top, right, bottom; } RECT;
+
+// Provided by nullgl.cpp
+PROC wglGetProcAddress( const char* pszName );
+
+#endif // BENCH_WINDOWS_H
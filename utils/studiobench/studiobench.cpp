@@ -0,0 +1,483 @@
+//========= Copyright  1996-2002, Valve LLC, All rights reserved. ============
+//
+// Purpose: Headless benchmark for the CPU side of the studio model renderer
+//
+// Links the client's own renderer (StudioModelRenderer.cpp, studio_model.cpp,
+// studio_util.cpp and what they use) against a null engine, HUD and GL, then
+// draws a scripted set of entities through CGameStudioModelRenderer. Stage
+// times come from overriding the renderer's virtual stage functions, so the
+// code being measured is the code the game runs. No engine or GPU is needed.
+//
+// Build, from this directory:
+//   g++ -std=c++14 -O2 -fpermissive -include benchplatform.h
+//       -DCLIENT_DLL -DCLIENT_WEAPONS -DELIGHTS -DHL25_UPDATE
+//       -Iplatform -I../../cl_dll -I../../dlls -I../../common -I../../engine
+//       -I../../pm_shared -I../../game_shared -I../../public -I../vgui/include
+//       studiobench.cpp benchengine.cpp benchmath.cpp nullhud.cpp nullgl.cpp
+//       ../../cl_dll/StudioModelRenderer.cpp ../../cl_dll/GameStudioModelRenderer.cpp
+//       ../../cl_dll/studio_model.cpp ../../cl_dll/studio_util.cpp
+//       ../../cl_dll/svd_render.cpp ../../cl_dll/svdformat.cpp
+//       ../../cl_dll/elightlist.cpp ../../cl_dll/r_lightgrid.cpp
+//       ../../cl_dll/r_studioqueue.cpp ../../cl_dll/fog.cpp
+//       ../../cl_dll/tracecache.cpp ../../cl_dll/util.cpp ../../cl_dll/parsemsg.cpp
+//       -o studiobench
+//
+// platform/ stands in for the Windows headers, -fpermissive is needed
+// for hud_spectator.h. benchmath.cpp pulls in pm_math.cpp, see there why.
+//
+// Model paths are relative to the game directory, like in the engine.
+// Shadow volume data is loaded from, or written to, the .svd next to it.
+//
+// $NoKeywords: $
+//=============================================================================
+
+#include "hud.h"
+#include "cl_util.h"
+#include "const.h"
+#include "com_model.h"
+#include "studio.h"
+#include "entity_state.h"
+#include "cl_entity.h"
+#include "dlight.h"
+#include "triangleapi.h"
+#include "r_studioint.h"
+#include "pm_defs.h"
+#include "ref_params.h"
+
+#include "studio_util.h"
+#include "StudioModelRenderer.h"
+#include "GameStudioModelRenderer.h"
+#include "elightlist.h"
+#include "fog.h"
+#include "svd_render.h"
+#include "svdformat.h"
+#include "r_lightgrid.h"
+#include "r_studioqueue.h"
+#include "tracecache.h"
+
+#include "benchengine.h"
+#include "nullgl.h"
+
+#define MAX_BENCH_LIGHTS	32
+#define MAX_STAGE_DEPTH		16
+
+// Engine frame the animation is advanced by
+#define BENCH_FRAMETIME		(1.0 / 60.0)
+
+// Spacing between entities
+#define BENCH_GRIDSIZE		64.0f
+
+enum benchstage_t
+{
+	STAGE_TRANSFORM = 0,
+	STAGE_BONES,
+	STAGE_LIGHTING,
+	STAGE_CHROME,
+	STAGE_SHADOWS,
+	STAGE_DRAW,
+	STAGE_FLUSH,
+	STAGE_OTHER,
+
+	NUM_BENCH_STAGES
+};
+
+static const char* g_szStageNames[NUM_BENCH_STAGES] =
+{
+	"transform",
+	"bones",
+	"lighting",
+	"chrome",
+	"shadows",
+	"draw",
+	"flush",
+	"other"
+};
+
+typedef std::chrono::steady_clock benchclock;
+
+// Exclusive time per stage, a stage's time stops while a nested one runs
+static double				g_stageNs[NUM_BENCH_STAGES];
+static int					g_stageStack[MAX_STAGE_DEPTH];
+static int					g_iStageDepth;
+static benchclock::time_point g_stageStart;
+
+static unsigned int			g_iRandomSeed = 1;
+
+/*
+====================
+Bench_EnterStage
+
+====================
+*/
+static void Bench_EnterStage( int stage )
+{
+	benchclock::time_point now = benchclock::now();
+	if (g_iStageDepth > 0)
+		g_stageNs[g_stageStack[g_iStageDepth - 1]] += std::chrono::duration<double, std::nano>(now - g_stageStart).count();
+
+	g_stageStack[g_iStageDepth] = stage;
+	g_iStageDepth++;
+	g_stageStart = now;
+}
+
+/*
+====================
+Bench_LeaveStage
+
+====================
+*/
+static void Bench_LeaveStage( void )
+{
+	benchclock::time_point now = benchclock::now();
+
+	g_iStageDepth--;
+	g_stageNs[g_stageStack[g_iStageDepth]] += std::chrono::duration<double, std::nano>(now - g_stageStart).count();
+	g_stageStart = now;
+}
+
+class CBenchStageScope
+{
+public:
+	CBenchStageScope( int stage ) { Bench_EnterStage(stage); }
+	~CBenchStageScope( void ) { Bench_LeaveStage(); }
+};
+
+//
+// The game's renderer, with every stage timed
+//
+class CBenchStudioRenderer : public CGameStudioModelRenderer
+{
+public:
+	void StudioSetUpTransform( int trivial_accept ) override
+	{
+		CBenchStageScope scope(STAGE_TRANSFORM);
+		CGameStudioModelRenderer::StudioSetUpTransform(trivial_accept);
+	}
+
+	void StudioSetupBones( void ) override
+	{
+		CBenchStageScope scope(STAGE_BONES);
+		CGameStudioModelRenderer::StudioSetupBones();
+	}
+
+	void StudioSaveBones( void ) override
+	{
+		CBenchStageScope scope(STAGE_BONES);
+		CGameStudioModelRenderer::StudioSaveBones();
+	}
+
+	void StudioMergeBones( model_t* psubmodel ) override
+	{
+		CBenchStageScope scope(STAGE_BONES);
+		CGameStudioModelRenderer::StudioMergeBones(psubmodel);
+	}
+
+	void StudioCalcAttachments( void ) override
+	{
+		CBenchStageScope scope(STAGE_BONES);
+		CGameStudioModelRenderer::StudioCalcAttachments();
+	}
+
+	void StudioDynamicLight( void ) override
+	{
+		CBenchStageScope scope(STAGE_LIGHTING);
+		CGameStudioModelRenderer::StudioDynamicLight();
+	}
+
+	void StudioEntityLight( void ) override
+	{
+		CBenchStageScope scope(STAGE_LIGHTING);
+		CGameStudioModelRenderer::StudioEntityLight();
+	}
+
+	void StudioSetLightVectors( void ) override
+	{
+		CBenchStageScope scope(STAGE_LIGHTING);
+		CGameStudioModelRenderer::StudioSetLightVectors();
+	}
+
+	void StudioSetChromeVectors( void ) override
+	{
+		CBenchStageScope scope(STAGE_CHROME);
+		CGameStudioModelRenderer::StudioSetChromeVectors();
+	}
+
+	void StudioSetupShadows( void ) override
+	{
+		CBenchStageScope scope(STAGE_SHADOWS);
+		CGameStudioModelRenderer::StudioSetupShadows();
+	}
+
+	bool StudioShouldDrawShadow( void ) override
+	{
+		CBenchStageScope scope(STAGE_SHADOWS);
+		return CGameStudioModelRenderer::StudioShouldDrawShadow();
+	}
+
+	void StudioDrawShadow( void ) override
+	{
+		CBenchStageScope scope(STAGE_SHADOWS);
+		CGameStudioModelRenderer::StudioDrawShadow();
+	}
+
+	void StudioSetupRenderer( int rendermode ) override
+	{
+		CBenchStageScope scope(STAGE_DRAW);
+		CGameStudioModelRenderer::StudioSetupRenderer(rendermode);
+	}
+
+	// Vertex transform, per vertex lighting and chrome, mesh submission
+	void StudioDrawPoints( void ) override
+	{
+		CBenchStageScope scope(STAGE_DRAW);
+		CGameStudioModelRenderer::StudioDrawPoints();
+	}
+};
+
+extern ref_params_t g_refparams;
+
+static CBenchStudioRenderer g_BenchRenderer;
+
+/*
+====================
+BenchRandom
+
+====================
+*/
+static float BenchRandom( float flLow, float flHigh )
+{
+	g_iRandomSeed = g_iRandomSeed * 1103515245 + 12345;
+	float f = (float)((g_iRandomSeed >> 16) & 0x7FFF) / 32767.0f;
+	return flLow + (flHigh - flLow) * f;
+}
+
+/*
+====================
+SetupScene
+
+====================
+*/
+static int SetupScene( model_t* pmodel, int numentities, int numlights )
+{
+	studiohdr_t* phdr = (studiohdr_t*)IEngineStudio.Mod_Extradata(pmodel);
+	mstudioseqdesc_t* pseqdescs = (mstudioseqdesc_t *)((byte *)phdr + phdr->seqindex);
+
+	// Only sequences stored in the model itself can be used
+	int sequences[MAXSTUDIOSEQUENCES];
+	int numsequences = 0;
+	for (int i = 0; i < phdr->numseq && numsequences < MAXSTUDIOSEQUENCES; i++)
+	{
+		if (pseqdescs[i].seqgroup == 0)
+			sequences[numsequences++] = i;
+	}
+
+	if (!numsequences)
+		return 0;
+
+	g_BenchEngine.numentities = BENCH_FIRST_ENTITY + numentities;
+	g_BenchEngine.pentities = new cl_entity_t[g_BenchEngine.numentities]();
+
+	for (int i = 0; i < g_BenchEngine.numentities; i++)
+		g_BenchEngine.pentities[i].index = i;
+
+	// Lay entities out on a grid, facing random ways
+	int rowsize = (int)ceil(sqrt((double)numentities));
+	for (int i = 0; i < numentities; i++)
+	{
+		cl_entity_t* pent = &g_BenchEngine.pentities[BENCH_FIRST_ENTITY + i];
+		pent->model = pmodel;
+
+		pent->origin[0] = (i % rowsize) * BENCH_GRIDSIZE;
+		pent->origin[1] = (i / rowsize) * BENCH_GRIDSIZE;
+		pent->origin[2] = 0;
+
+		pent->angles[0] = 0;
+		pent->angles[1] = BenchRandom(0, 360);
+		pent->angles[2] = 0;
+
+		pent->curstate.modelindex = BenchEngine_ModelIndex(pmodel);
+		pent->curstate.sequence = sequences[(int)BenchRandom(0, numsequences - 0.01f)];
+		pent->curstate.frame = BenchRandom(0, pseqdescs[pent->curstate.sequence].numframes - 1);
+		pent->curstate.framerate = 1.0f;
+		pent->curstate.blending[0] = (byte)BenchRandom(0, 255);
+		pent->curstate.renderamt = 255;
+		pent->curstate.movetype = MOVETYPE_NONE;
+
+		VectorCopy(pent->origin, pent->curstate.origin);
+		VectorCopy(pent->angles, pent->curstate.angles);
+		pent->latched.prevsequence = pent->curstate.sequence;
+	}
+
+	// Look down at the grid from one corner
+	float gridsize = rowsize * BENCH_GRIDSIZE;
+	g_BenchEngine.vieworg[0] = -BENCH_GRIDSIZE;
+	g_BenchEngine.vieworg[1] = -BENCH_GRIDSIZE;
+	g_BenchEngine.vieworg[2] = gridsize * 0.5f;
+	g_BenchEngine.viewangles[0] = 30;
+	g_BenchEngine.viewangles[1] = 45;
+	g_BenchEngine.viewangles[2] = 0;
+
+	// Same lights the map would have sent
+	for (int i = 0; i < numlights; i++)
+	{
+		Vector origin, color;
+		origin[0] = BenchRandom(-64, gridsize);
+		origin[1] = BenchRandom(-64, gridsize);
+		origin[2] = BenchRandom(16, 128);
+
+		color[0] = BenchRandom(0.2f, 1);
+		color[1] = BenchRandom(0.2f, 1);
+		color[2] = BenchRandom(0.2f, 1);
+
+		gELightList.AddEntityLight(g_BenchEngine.numentities + i, origin, color, BenchRandom(256, 512), false);
+	}
+
+	return numsequences;
+}
+
+/*
+====================
+RunFrame
+
+What the engine does for one frame
+with only studio models in view
+====================
+*/
+static void RunFrame( void )
+{
+	g_BenchEngine.framecount++;
+	g_BenchEngine.oldtime = g_BenchEngine.time;
+	g_BenchEngine.time += BENCH_FRAMETIME;
+
+	ref_params_t params;
+	memset(&params, 0, sizeof(params));
+	VectorCopy(g_BenchEngine.vieworg, params.vieworg);
+	VectorCopy(g_BenchEngine.viewangles, params.viewangles);
+	params.time = g_BenchEngine.time;
+	params.frametime = BENCH_FRAMETIME;
+	params.viewentity = BENCH_PLAYER_ENTITY;
+
+	gHUD.m_flTime = g_BenchEngine.time;
+	gHUD.m_flTimeDelta = BENCH_FRAMETIME;
+	gHUD.m_flAbsTime += BENCH_FRAMETIME;
+	memcpy(&gHUD.r_params, &params, sizeof(params));
+	g_refparams = params;
+
+	gELightList.CalcRefDef(&params);
+	SVD_CheckInit();
+	g_StudioRenderQueue.BeginFrame(params.vieworg);
+	gFog.CalcRefDef(&params);
+
+	for (int i = BENCH_FIRST_ENTITY; i < g_BenchEngine.numentities; i++)
+	{
+		g_BenchEngine.pcurrententity = &g_BenchEngine.pentities[i];
+
+		CBenchStageScope scope(STAGE_OTHER);
+		g_BenchRenderer.StudioDrawModel(STUDIO_RENDER | STUDIO_EVENTS);
+	}
+
+	// Meshes deferred during the solid entity pass
+	CBenchStageScope scope(STAGE_FLUSH);
+	g_StudioRenderQueue.Flush();
+}
+
+/*
+====================
+main
+
+====================
+*/
+int main( int argc, char** argv )
+{
+	const char* pszModel = NULL;
+	const char* pszGameDir = ".";
+	int numentities = 100;
+	int numlights = 4;
+	int numframes = 100;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-game") && i + 1 < argc)
+			pszGameDir = argv[++i];
+		else if (!strcmp(argv[i], "-entities") && i + 1 < argc)
+			numentities = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-lights") && i + 1 < argc)
+			numlights = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-frames") && i + 1 < argc)
+			numframes = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-seed") && i + 1 < argc)
+			g_iRandomSeed = (unsigned int)atoi(argv[++i]);
+		else if (argv[i][0] != '-')
+			pszModel = argv[i];
+	}
+
+	if (!pszModel)
+	{
+		fprintf(stderr, "usage: studiobench <models/name.mdl> [-game <dir>] [-entities n] [-lights n] [-frames n] [-seed n]\n");
+		return 1;
+	}
+
+	if (numentities < 1) numentities = 1;
+	if (numframes < 1) numframes = 1;
+	if (numlights < 0) numlights = 0;
+	if (numlights > MAX_BENCH_LIGHTS) numlights = MAX_BENCH_LIGHTS;
+
+	BenchEngine_Init(pszGameDir);
+
+	// Same order as CHud::Init
+	gELightList.Init();
+	gFog.Init();
+	SVD_Init();
+	g_StudioRenderQueue.Init();
+	g_LightProbeGrid.Init();
+	g_BenchRenderer.Init();
+
+	model_t* pmodel = BenchEngine_LoadModel(pszModel);
+	if (!pmodel)
+		return 1;
+
+	// And CHud::VidInit, once the models are precached
+	gELightList.VidInit();
+	gFog.VidInit();
+	SVD_VidInit();
+	g_StudioRenderQueue.VidInit();
+	g_LightProbeGrid.VidInit();
+	g_TraceCache.VidInit();
+	g_BenchRenderer.VidInit();
+
+	if (!SetupScene(pmodel, numentities, numlights))
+	{
+		fprintf(stderr, "studiobench: %s has no sequences stored in the model file\n", pszModel);
+		return 1;
+	}
+
+	// Shadow volume data gets built while loading, keep it out of the timing
+	RunFrame();
+
+	memset(g_stageNs, 0, sizeof(g_stageNs));
+	nglReset();
+
+	for (int frame = 0; frame < numframes; frame++)
+		RunFrame();
+
+	// Machine readable results, one stage per line
+	double samples = (double)numentities * numframes;
+	double totalns = 0;
+
+	printf("stage,ns_per_entity\n");
+	for (int i = 0; i < NUM_BENCH_STAGES; i++)
+	{
+		printf("%s,%.1f\n", g_szStageNames[i], g_stageNs[i] / samples);
+		totalns += g_stageNs[i];
+	}
+	printf("total,%.1f\n", totalns / samples);
+
+	printf("gl_calls_per_entity,%.1f\n", g_NullGLStats.calls / samples);
+	printf("gl_primitives_per_entity,%.1f\n", g_NullGLStats.primitives / samples);
+	printf("gl_vertexes_per_entity,%.1f\n", g_NullGLStats.vertexes / samples);
+	printf("gl_indexes_per_entity,%.1f\n", g_NullGLStats.indexes / samples);
+	printf("checksum,%g\n", g_NullGLStats.checksum);
+
+	delete[] g_BenchEngine.pentities;
+	return 0;
+}